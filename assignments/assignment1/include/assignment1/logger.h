@@ -1,6 +1,7 @@
 // logger.h - Simple logging utilities for INFO and ERROR messages
-// Provides thread-unsafe logging to stdout/stderr; suitable for single-threaded CLI apps.
-// Dependencies: std::string, iostream
+// Writes through perf's logger: synchronous until main() calls perf::log_open(),
+// then asynchronous and safe from any thread (see perf/log.h).
+// Dependencies: std::string, perf_core
 
 #ifndef ASSIGNMENT1_LOGGER_H
 #define ASSIGNMENT1_LOGGER_H
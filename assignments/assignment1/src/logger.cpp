@@ -1,12 +1,12 @@
 // logger.cpp - Simple logging implementation
-// Thread-unsafe; writes INFO to stdout, ERROR to stderr with prefixes.
+// Forwards to perf::log_write; INFO to stdout, ERROR to stderr with prefixes.
 
 #include "assignment1/logger.h"
-#include <iostream>
+#include "perf/log.h"
 
 namespace assignment1 {
 
-void log_info(const std::string& msg) { std::cout << "[INFO] " << msg << std::endl; }
-void log_error(const std::string& msg) { std::cerr << "[ERROR] " << msg << std::endl; }
+void log_info(const std::string& msg) { perf::log_write(perf::LOG_INFO, msg); }
+void log_error(const std::string& msg) { perf::log_write(perf::LOG_ERROR, msg); }
 
 } // namespace assignment1
@@ -1,6 +1,10 @@
 // main.cpp - Entry point for π approximation CLI
 // Parses a single integer n from argv, invokes approximate_pi(n), logs timing/error.
+// With --counters, hardware counters are read around approximate_pi (perf/counters.h).
 // Lifecycle: start → parse n → compute π → report results (value, error, time) → done.
+// Timing uses the shared harness (perf/bench.h): warm-up runs, then repeated wall-clock
+// runs summarized as min/median/mean/stddev/CI, optionally written as JSON/CSV.
+// The rate is also placed under this host's measured roofline (perf/roofline.h).
 // Cross-platform: defines _USE_MATH_DEFINES for Windows before including <cmath> to get M_PI.
 
 // Windows requires _USE_MATH_DEFINES before <cmath> to expose M_PI
@@ -19,11 +23,14 @@
 #include <cstdlib>
 #include <cerrno>
 #include <climits>
-#include <ctime>
 #include <sstream>
 #include <string>
 #include "assignment1/pi.h"
 #include "assignment1/logger.h"
+#include "perf/bench.h"
+#include "perf/counters.h"
+#include "perf/log.h"
+#include "perf/roofline.h"
 
 using assignment1::approximate_pi;
 using assignment1::log_error;
@@ -45,15 +52,64 @@ static bool parse_positive_int(const char* s, int& out)
     return true;
 }
 
+// Floating-point operations per midpoint sample: i - 0.5, * h, x * x, 1 + x², 4 / (...), sum +=
+static const double FLOPS_PER_SAMPLE = 6.0;
+
+// Log arithmetic intensity and percent of peak against the serial ceilings
+// of this host, measuring them on first use (cached per host).
+static void log_roofline(double flops, double bytes, double secs)
+{
+    perf::Roofline roof;
+    std::string err;
+    if (perf::acquire_roofline(roof, err)) {
+        log_info("roofline ceilings measured for host " + roof.host);
+    }
+    if (!err.empty()) {
+        log_error(err);
+    }
+    const perf::Ceiling ceiling = perf::serial_ceiling(roof);
+    log_info(perf::format_roofline(ceiling, perf::roofline_point(ceiling, flops, bytes, secs)));
+}
+
 int main(int argc, char** argv)
 {
     log_info("assignment1 start");
 
-    // Require exactly one command-line argument: n (number of subintervals)
-    if (argc != 2) {
-        log_error("Usage: assignment1 <n>  (n must be a positive integer)");
+    // Require n (number of subintervals), optionally followed by options
+    const std::string usage = std::string("Usage: assignment1 <n> [--counters] ") + perf::bench_usage()
+                            + "  (n must be a positive integer)";
+    if (argc < 2) {
+        log_error(usage);
         return 1;
     }
+    bool counters = false;
+    perf::BenchConfig bench;
+    for (int i = 2; i < argc; ) {
+        std::string err;
+        const int rc = perf::parse_bench_option(argc, argv, i, bench, err);
+        if (rc < 0) {
+            log_error(err);
+            return 1;
+        }
+        if (rc == 0 && std::string(argv[i]) == "--counters") {
+            counters = true;
+            ++i;
+        } else if (rc == 0) {
+            log_error(usage);
+            return 1;
+        }
+    }
+
+    // Asynchronous logging from here on; --log also writes a tagged log file
+    {
+        perf::LogConfig log_cfg;
+        log_cfg.path = bench.log_path;
+        std::string err;
+        if (!perf::log_open(log_cfg, err)) {
+            log_error(err);
+            return 1;
+        }
+    }
 
     int n = 0;
     if (!parse_positive_int(argv[1], n)) {
@@ -74,14 +130,30 @@ int main(int argc, char** argv)
         log_info(oss.str());
     }
 
-    // Time the π approximation
-    const std::clock_t t0 = std::clock();
-    const double pi_est = approximate_pi(n);
-    const std::clock_t t1 = std::clock();
+    // Hardware counters of this thread around the kernel, if requested
+    perf::CounterSet ctr;
+    if (counters) {
+        std::string err;
+        if (!ctr.open(1, err)) {
+            log_info("counters unavailable: " + err);
+        } else if (!err.empty()) {
+            log_info("counters not supported: " + err);
+        }
+    }
+
+    // Time the π approximation: warm-up runs, then timed runs (counted ones only)
+    double pi_est = 0.0;
+    perf::Sampler sampler(bench);
+    while (sampler.next()) {
+        if (!sampler.warming_up()) ctr.start();
+        pi_est = approximate_pi(n);
+        ctr.stop();
+    }
+    const perf::Stats stats = sampler.stats();
 
     // Compute absolute error vs. reference M_PI
     const double abs_err = (pi_est > M_PI) ? (pi_est - M_PI) : (M_PI - pi_est);
-    const double secs = static_cast<double>(t1 - t0) / static_cast<double>(CLOCKS_PER_SEC);
+    const double secs = stats.median;
 
     // Report π estimate with high precision
     {
@@ -99,7 +171,7 @@ int main(int argc, char** argv)
         oss << "abs error vs M_PI = " << abs_err;
         log_info(oss.str());
     }
-    // Report elapsed time in seconds
+    // Report the median wall time in seconds, then the full statistics
     {
         std::ostringstream oss;
         oss.setf(std::ios::fixed);
@@ -107,6 +179,23 @@ int main(int argc, char** argv)
         oss << "elapsed = " << secs << " s";
         log_info(oss.str());
     }
+    log_info(perf::format_stats(stats));
+    {
+        std::ostringstream params;
+        params << "n=" << n;
+        perf::BenchReport report("assignment1");
+        report.add(params.str(), sampler.samples(), stats);
+        std::string err;
+        if (!report.write(bench, err)) {
+            log_error(err);
+        }
+    }
+    // The integrand lives in registers: no memory traffic, AI is unbounded
+    log_roofline(FLOPS_PER_SAMPLE * static_cast<double>(n), 0.0, secs);
+    if (ctr.is_open()) {
+        // Summed over the timed runs
+        log_info("counters: " + perf::format_counters(ctr.read_total()));
+    }
 
     log_info("assignment1 done");
     return 0;
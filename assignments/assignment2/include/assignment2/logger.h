@@ -1,6 +1,7 @@
 /*
  * logger.h — Simple console logging utilities
- * Routes info to stdout with [INFO] prefix and errors to stderr with [ERROR] prefix.
+ * Routes info to stdout with [INFO] prefix and errors to stderr with [ERROR] prefix,
+ * through perf's logger (asynchronous once main() calls perf::log_open()).
  */
 #ifndef ASSIGNMENT2_LOGGER_H
 #define ASSIGNMENT2_LOGGER_H
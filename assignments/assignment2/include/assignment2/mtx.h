@@ -0,0 +1,64 @@
+/*
+ * mtx.h — Matrix Market (.mtx) reader with chunked parallel parsing
+ * Reads "array" (dense, column-major) and "coordinate" (sparse) files into a
+ * dense Matrix or a CSR structure. The body is streamed in large blocks; each
+ * block is split at line boundaries and parsed by OpenMP threads when available.
+ */
+#ifndef ASSIGNMENT2_MTX_H
+#define ASSIGNMENT2_MTX_H
+
+#include "assignment2/matrix.h"
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace assignment2 {
+
+// Parsed banner and size line of a Matrix Market file
+struct MtxHeader {
+  bool coordinate;      // "coordinate" (sparse) vs "array" (dense)
+  bool pattern;         // field "pattern": entries carry no value (read as 1.0)
+  bool symmetric;       // "symmetric" or "skew-symmetric": lower triangle only
+  bool skew;            // "skew-symmetric": mirrored entries are negated
+  int rows;
+  int cols;
+  std::size_t entries;  // stored entries: nnz lines or array values
+  MtxHeader();
+};
+
+// Compressed sparse row matrix; row r spans [row_ptr[r], row_ptr[r+1])
+// Column order within a row follows file order (no sorting is performed).
+struct CsrMatrix {
+  int rows;
+  int cols;
+  std::vector<std::size_t> row_ptr;
+  std::vector<int> col_idx;
+  std::vector<double> values;
+  CsrMatrix();
+};
+
+// Parse one decimal floating-point number starting at s (no leading spaces).
+// Exact fast path when the digits form an integer below 2^53 and |exponent| <= 22
+// (covers %.15e output); anything else (17-digit mantissas, inf/nan, hex) falls
+// back to std::strtod, so results always match strtod.
+// Returns pointer past the number, or s itself if nothing was parsed.
+const char* parse_double(const char* s, const char* end, double& out);
+
+// Read a Matrix Market stream into CSR; symmetric storage is expanded.
+// Explicit zeros of coordinate files are kept; zeros of array files are dropped.
+// Throws std::runtime_error on malformed input or unsupported variants (complex).
+void read_mtx(std::istream& in, CsrMatrix& out, MtxHeader* header = 0);
+
+// Read a square Matrix Market stream into a dense Matrix (resized to rows×rows).
+// Throws std::runtime_error if the matrix is not square or the input is malformed.
+void read_mtx(std::istream& in, Matrix& out, MtxHeader* header = 0);
+
+// Convenience wrappers that open path in binary mode; throw if it cannot be opened
+void read_mtx_file(const std::string& path, CsrMatrix& out, MtxHeader* header = 0);
+void read_mtx_file(const std::string& path, Matrix& out, MtxHeader* header = 0);
+
+} // namespace assignment2
+
+#endif // ASSIGNMENT2_MTX_H
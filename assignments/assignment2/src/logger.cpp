@@ -1,13 +1,13 @@
 /*
  * logger.cpp — Implementation of console logging
- * Simple wrappers around std::cout and std::cerr with prefixes.
+ * Thin wrappers around perf::log_write with the INFO/ERROR levels.
  */
 #include "assignment2/logger.h"
-#include <iostream>
+#include "perf/log.h"
 
 namespace assignment2 {
 
-void log_info(const std::string& msg)  { std::cout << "[INFO] "  << msg << std::endl; }
-void log_error(const std::string& msg) { std::cerr << "[ERROR] " << msg << std::endl; }
+void log_info(const std::string& msg)  { perf::log_write(perf::LOG_INFO, msg); }
+void log_error(const std::string& msg) { perf::log_write(perf::LOG_ERROR, msg); }
 
 } // namespace assignment2
@@ -18,14 +18,17 @@ Matrix::Matrix(int size) : n(size), data()
 }
 
 // Row-major indexing: row i, column j → data[i*n + j]
+// Computed in size_type: i*n overflows int once n exceeds 46340
 double& Matrix::at(int i, int j)
 {
-  return data[static_cast<std::vector<double>::size_type>(i * n + j)];
+  typedef std::vector<double>::size_type size_type;
+  return data[static_cast<size_type>(i) * static_cast<size_type>(n) + static_cast<size_type>(j)];
 }
 
 const double& Matrix::at(int i, int j) const
 {
-  return data[static_cast<std::vector<double>::size_type>(i * n + j)];
+  typedef std::vector<double>::size_type size_type;
+  return data[static_cast<size_type>(i) * static_cast<size_type>(n) + static_cast<size_type>(j)];
 }
 
 // Initialize A[i][j] = i+1 (same value along each row for testing)
@@ -0,0 +1,561 @@
+/*
+ * mtx.cpp — Matrix Market reader: header parsing, block streaming, parallel parse
+ * Each block read from the stream ends on a line boundary. Threads split it at
+ * newlines, count data lines (pass 1), take an exclusive prefix sum, then parse
+ * straight into the shared entry arrays (pass 2), so nothing has to be merged.
+ */
+#include "assignment2/mtx.h"
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace assignment2 {
+
+MtxHeader::MtxHeader()
+  : coordinate(true), pattern(false), symmetric(false), skew(false),
+    rows(0), cols(0), entries(0)
+{
+}
+
+CsrMatrix::CsrMatrix() : rows(0), cols(0), row_ptr(), col_idx(), values()
+{
+}
+
+namespace {
+
+// Bytes requested from the stream per block (the carried-over tail comes on top)
+const std::size_t kBlockBytes = static_cast<std::size_t>(32) << 20;
+
+// Smallest slice worth handing to a thread; keeps tiny files single-threaded
+const std::size_t kMinSliceBytes = static_cast<std::size_t>(64) << 10;
+
+// Powers of ten that are exact in double precision (10^0 .. 10^22)
+const double kExactPow10[] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// 2^53: every non-negative integer below it is exactly representable
+const double kMaxExactInteger = 9007199254740992.0;
+
+inline bool is_blank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+inline bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+inline const char* skip_blanks(const char* p, const char* end)
+{
+  while (p < end && is_blank(*p)) ++p;
+  return p;
+}
+
+// Pointer just past the next '\n' at or after p (end if there is none)
+inline const char* next_line(const char* p, const char* end)
+{
+  const void* nl = std::memchr(p, '\n', static_cast<std::size_t>(end - p));
+  return nl ? static_cast<const char*>(nl) + 1 : end;
+}
+
+// Data lines are non-empty and not comments
+inline bool is_data_line(const char* p, const char* end)
+{
+  p = skip_blanks(p, end);
+  return p < end && *p != '\n' && *p != '%';
+}
+
+// Parse a positive 1-based index into out; returns s on failure or overflow
+const char* parse_index(const char* s, const char* end, long& out)
+{
+  const char* p = s;
+  long v = 0;
+  while (p < end && is_digit(*p)) {
+    v = v * 10 + (*p - '0');
+    if (v > INT_MAX) return s;
+    ++p;
+  }
+  if (p == s) return s;
+  out = v;
+  return p;
+}
+
+// Slow path: hand the token to strtod through a NUL-terminated copy
+// (stack buffer for ordinary tokens, heap only for pathological lengths)
+const char* parse_double_slow(const char* s, const char* end, double& out)
+{
+  const char* p = s;
+  while (p < end && !is_blank(*p) && *p != '\n') ++p;
+  const std::size_t len = static_cast<std::size_t>(p - s);
+
+  char local[64];
+  std::string heap;
+  const char* token = local;
+  if (len < sizeof(local)) {
+    std::memcpy(local, s, len);
+    local[len] = '\0';
+  } else {
+    heap.assign(s, p);
+    token = heap.c_str();
+  }
+  char* endp = 0;
+  const double v = std::strtod(token, &endp);
+  if (endp == token) return s;
+  out = v;
+  return s + (endp - token);
+}
+
+// Storage for every entry stored in the file, sized from the header up front
+struct EntryArrays {
+  std::vector<int> row;     // 0-based row (coordinate format only)
+  std::vector<int> col;     // 0-based column (coordinate format only)
+  std::vector<double> val;  // value (1.0 for pattern matrices)
+};
+
+// Parse a whole token of decimal digits into out; false on anything else or overflow
+bool parse_count(const std::string& tok, std::size_t& out)
+{
+  if (tok.empty()) return false;
+  const std::size_t max = static_cast<std::size_t>(-1);
+  std::size_t v = 0;
+  for (std::size_t i = 0; i < tok.size(); ++i) {
+    if (!is_digit(tok[i])) return false;
+    const std::size_t d = static_cast<std::size_t>(tok[i] - '0');
+    if (v > (max - d) / 10) return false;
+    v = v * 10 + d;
+  }
+  out = v;
+  return true;
+}
+
+std::string to_lower(const std::string& s)
+{
+  std::string r(s);
+  for (std::size_t i = 0; i < r.size(); ++i) {
+    r[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(r[i])));
+  }
+  return r;
+}
+
+// Read the banner, comments and size line; leaves the stream at the first body byte
+void read_header(std::istream& in, MtxHeader& h)
+{
+  std::string line;
+  if (!std::getline(in, line)) throw std::runtime_error("mtx: empty input");
+
+  std::istringstream banner(line);
+  std::string magic, object, format, field, symmetry;
+  banner >> magic >> object >> format >> field >> symmetry;
+  if (magic != "%%MatrixMarket") throw std::runtime_error("mtx: missing %%MatrixMarket banner");
+  object = to_lower(object); format = to_lower(format);
+  field = to_lower(field);   symmetry = to_lower(symmetry);
+
+  if (object != "matrix") throw std::runtime_error("mtx: unsupported object \"" + object + "\"");
+  if (format == "coordinate") h.coordinate = true;
+  else if (format == "array") h.coordinate = false;
+  else throw std::runtime_error("mtx: unknown format \"" + format + "\"");
+
+  if (field == "pattern") h.pattern = true;
+  else if (field != "real" && field != "double" && field != "integer")
+    throw std::runtime_error("mtx: unsupported field \"" + field + "\"");
+  if (h.pattern && !h.coordinate) throw std::runtime_error("mtx: pattern field requires coordinate format");
+
+  if (symmetry == "symmetric") h.symmetric = true;
+  else if (symmetry == "skew-symmetric") { h.symmetric = true; h.skew = true; }
+  else if (symmetry != "general") throw std::runtime_error("mtx: unsupported symmetry \"" + symmetry + "\"");
+
+  // Skip comments and blank lines up to the size line
+  for (;;) {
+    if (!std::getline(in, line)) throw std::runtime_error("mtx: missing size line");
+    const std::string::size_type first = line.find_first_not_of(" \t\r");
+    if (first == std::string::npos || line[first] == '%') continue;
+    break;
+  }
+
+  // Integers only ("3.5" is not a count), and nothing after them
+  std::istringstream size_line(line);
+  std::string rows_tok, cols_tok, count_tok, extra;
+  size_line >> rows_tok >> cols_tok;
+  if (h.coordinate) size_line >> count_tok;
+  std::size_t rows = 0, cols = 0, count = 0;
+  if (!size_line || (size_line >> extra) || !parse_count(rows_tok, rows) ||
+      !parse_count(cols_tok, cols) || (h.coordinate && !parse_count(count_tok, count)) ||
+      rows == 0 || cols == 0 || rows > static_cast<std::size_t>(INT_MAX) ||
+      cols > static_cast<std::size_t>(INT_MAX))
+    throw std::runtime_error("mtx: invalid size line \"" + line + "\"");
+  if (h.symmetric && rows != cols) throw std::runtime_error("mtx: symmetric matrix must be square");
+
+  h.rows = static_cast<int>(rows);
+  h.cols = static_cast<int>(cols);
+  const std::size_t r = rows;
+  const std::size_t c = cols;
+  if (h.coordinate) h.entries = count;
+  else if (!h.symmetric) h.entries = r * c;
+  else if (!h.skew) h.entries = r * (r + 1) / 2;   // lower triangle incl. diagonal
+  else h.entries = r * (r - 1) / 2;                // strictly lower triangle
+}
+
+// Nothing but blanks up to the end of the line
+inline bool at_line_end(const char* p, const char* end)
+{
+  p = skip_blanks(p, end);
+  return p == end || *p == '\n';
+}
+
+// Parse one data line into entry k; returns false on malformed content,
+// including anything after the last field
+bool parse_entry(const char* p, const char* end, const MtxHeader& h, EntryArrays& e, std::size_t k)
+{
+  p = skip_blanks(p, end);
+  if (h.coordinate) {
+    long i = 0, j = 0;
+    const char* q = parse_index(p, end, i);
+    if (q == p) return false;
+    p = skip_blanks(q, end);
+    q = parse_index(p, end, j);
+    if (q == p) return false;
+    if (i < 1 || i > h.rows || j < 1 || j > h.cols) return false;
+    e.row[k] = static_cast<int>(i - 1);
+    e.col[k] = static_cast<int>(j - 1);
+    if (h.pattern) { e.val[k] = 1.0; return at_line_end(q, end); }
+    p = skip_blanks(q, end);
+  }
+  double v = 0.0;
+  const char* q = parse_double(p, end, v);
+  if (q == p) return false;
+  e.val[k] = v;
+  return at_line_end(q, end);
+}
+
+// Parse complete lines [buf, buf+len) into entries starting at index base.
+// Returns the number of entries parsed; throws on malformed or excess lines.
+std::size_t parse_block(const char* buf, std::size_t len, const MtxHeader& h,
+                        EntryArrays& e, std::size_t base)
+{
+  const char* const end = buf + len;
+
+  int slices = 1;
+#ifdef _OPENMP
+  slices = omp_get_max_threads();
+#endif
+  const std::size_t max_slices = len / kMinSliceBytes + 1;
+  if (static_cast<std::size_t>(slices) > max_slices) slices = static_cast<int>(max_slices);
+  if (slices < 1) slices = 1;
+
+  // Slice boundaries, each moved forward to the start of a line
+  std::vector<std::size_t> start(static_cast<std::size_t>(slices) + 1, 0);
+  start[slices] = len;
+  for (int t = 1; t < slices; ++t) {
+    std::size_t pos = len / static_cast<std::size_t>(slices) * static_cast<std::size_t>(t);
+    if (buf[pos - 1] != '\n') pos = static_cast<std::size_t>(next_line(buf + pos, end) - buf);
+    start[t] = std::max(pos, start[t - 1]);
+  }
+
+  // Pass 1: data lines per slice
+  std::vector<std::size_t> count(static_cast<std::size_t>(slices) + 1, 0);
+#ifdef _OPENMP
+  #pragma omp parallel for schedule(static, 1) num_threads(slices)
+#endif
+  for (int t = 0; t < slices; ++t) {
+    const char* p = buf + start[t];
+    const char* const stop = buf + start[t + 1];
+    std::size_t n = 0;
+    while (p < stop) {
+      if (is_data_line(p, stop)) ++n;
+      p = next_line(p, stop);
+    }
+    count[t + 1] = n;
+  }
+  for (int t = 0; t < slices; ++t) count[t + 1] += count[t];
+  if (base + count[slices] > h.entries)
+    throw std::runtime_error("mtx: more entries than declared in the size line");
+
+  // Pass 2: parse each slice into its reserved index range
+  std::vector<std::size_t> bad(static_cast<std::size_t>(slices), 0);
+#ifdef _OPENMP
+  #pragma omp parallel for schedule(static, 1) num_threads(slices)
+#endif
+  for (int t = 0; t < slices; ++t) {
+    const char* p = buf + start[t];
+    const char* const stop = buf + start[t + 1];
+    std::size_t k = base + count[t];
+    while (p < stop) {
+      if (is_data_line(p, stop)) {
+        if (!parse_entry(p, stop, h, e, k)) { bad[t] = k + 1; break; }
+        ++k;
+      }
+      p = next_line(p, stop);
+    }
+  }
+  for (int t = 0; t < slices; ++t) {
+    if (bad[t]) {
+      std::ostringstream oss;
+      oss << "mtx: malformed entry #" << bad[t];
+      throw std::runtime_error(oss.str());
+    }
+  }
+  return count[slices];
+}
+
+// Bytes from the current position to the end, or false if the stream cannot seek
+bool remaining_bytes(std::istream& in, std::size_t& out)
+{
+  const std::streampos here = in.tellg();
+  if (here == std::streampos(-1)) { in.clear(); return false; }
+  in.seekg(0, std::ios::end);
+  const std::streampos end = in.tellg();
+  in.clear();
+  in.seekg(here);
+  if (end == std::streampos(-1) || !in) return false;
+  out = static_cast<std::size_t>(end - here);
+  return true;
+}
+
+// Reject a declared entry count the file cannot hold before sizing storage for it:
+// coordinate files store at most rows*cols entries (the lower triangle when
+// symmetric, which expansion doubles), and every entry takes at least
+// "i j\n", "i j v\n" or "v\n" bytes of what is left in the stream
+void check_entry_count(std::istream& in, const MtxHeader& h)
+{
+  const std::size_t max = static_cast<std::size_t>(-1);
+  const std::size_t r = static_cast<std::size_t>(h.rows);
+  const std::size_t c = static_cast<std::size_t>(h.cols);
+  if (h.coordinate) {
+    std::size_t limit = max;
+    if (!h.symmetric && r <= max / c) limit = r * c;
+    else if (h.symmetric && r <= max / (r + 1)) limit = r * (r + 1) / 2;
+    if (h.entries > limit) {
+      std::ostringstream oss;
+      oss << "mtx: " << h.entries << " entries do not fit a " << h.rows << "x" << h.cols
+          << (h.symmetric ? " symmetric" : "") << " matrix";
+      throw std::runtime_error(oss.str());
+    }
+  }
+  std::size_t bytes = 0;
+  if (!remaining_bytes(in, bytes)) return;
+  const std::size_t per_entry = !h.coordinate ? 2 : (h.pattern ? 4 : 6);
+  if (h.entries > (bytes + 1) / per_entry) {  // the last line may lack its newline
+    std::ostringstream oss;
+    oss << "mtx: " << h.entries << " entries declared but only " << bytes << " bytes follow";
+    throw std::runtime_error(oss.str());
+  }
+}
+
+// Stream the body in blocks that end on a newline and parse each block
+void read_body(std::istream& in, const MtxHeader& h, EntryArrays& e)
+{
+  check_entry_count(in, h);
+  if (h.coordinate) {
+    e.row.resize(h.entries);
+    e.col.resize(h.entries);
+  }
+  e.val.resize(h.entries);
+
+  std::vector<char> buf(kBlockBytes);
+  std::size_t have = 0;
+  std::size_t parsed = 0;
+  bool eof = false;
+  while (!eof) {
+    if (have == buf.size()) buf.resize(buf.size() * 2);  // a single line longer than a block
+    in.read(&buf[have], static_cast<std::streamsize>(buf.size() - have));
+    have += static_cast<std::size_t>(in.gcount());
+    eof = !in;
+    if (in.bad()) throw std::runtime_error("mtx: read error");
+
+    std::size_t usable = have;
+    if (!eof) {
+      while (usable > 0 && buf[usable - 1] != '\n') --usable;
+      if (usable == 0) continue;
+    }
+    if (usable > 0) parsed += parse_block(&buf[0], usable, h, e, parsed);
+    std::copy(buf.begin() + static_cast<std::ptrdiff_t>(usable),
+              buf.begin() + static_cast<std::ptrdiff_t>(have), buf.begin());
+    have -= usable;
+  }
+
+  if (parsed != h.entries) {
+    std::ostringstream oss;
+    oss << "mtx: expected " << h.entries << " entries, found " << parsed;
+    throw std::runtime_error(oss.str());
+  }
+}
+
+// Visit every logical entry (i, j, v), including mirrored symmetric entries
+template <class Sink>
+void for_each_entry(const MtxHeader& h, const EntryArrays& e, Sink& sink)
+{
+  if (h.coordinate) {
+    for (std::size_t k = 0; k < h.entries; ++k) {
+      const int i = e.row[k], j = e.col[k];
+      const double v = e.val[k];
+      sink(i, j, v);
+      if (h.symmetric && i != j) sink(j, i, h.skew ? -v : v);
+    }
+    return;
+  }
+  // Array format is column-major; symmetric variants store the lower triangle
+  std::size_t k = 0;
+  for (int j = 0; j < h.cols; ++j) {
+    const int i0 = !h.symmetric ? 0 : (h.skew ? j + 1 : j);
+    for (int i = i0; i < h.rows; ++i) {
+      const double v = e.val[k++];
+      sink(i, j, v);
+      if (h.symmetric && i != j) sink(j, i, h.skew ? -v : v);
+    }
+  }
+}
+
+// Sink: accumulate into a dense row-major buffer
+struct DenseSink {
+  std::vector<double>& data;
+  std::size_t n;
+  DenseSink(std::vector<double>& d, std::size_t cols) : data(d), n(cols) {}
+  void operator()(int i, int j, double v)
+  {
+    data[static_cast<std::size_t>(i) * n + static_cast<std::size_t>(j)] += v;
+  }
+};
+
+// Sink: count entries per row (row_ptr[i + 1]). Zeros are dropped only when
+// drop_zeros is set (array files, which store every element); explicit zeros
+// of coordinate files are entries and stay.
+struct CsrCountSink {
+  std::vector<std::size_t>& row_ptr;
+  bool drop_zeros;
+  CsrCountSink(std::vector<std::size_t>& rp, bool drop) : row_ptr(rp), drop_zeros(drop) {}
+  void operator()(int i, int, double v)
+  {
+    if (!(drop_zeros && v == 0.0)) ++row_ptr[static_cast<std::size_t>(i) + 1];
+  }
+};
+
+// Sink: scatter entries to their row's next free slot (same zero rule)
+struct CsrFillSink {
+  std::vector<std::size_t>& cursor;
+  CsrMatrix& m;
+  bool drop_zeros;
+  CsrFillSink(std::vector<std::size_t>& c, CsrMatrix& out, bool drop)
+    : cursor(c), m(out), drop_zeros(drop) {}
+  void operator()(int i, int j, double v)
+  {
+    if (drop_zeros && v == 0.0) return;
+    const std::size_t slot = cursor[static_cast<std::size_t>(i)]++;
+    m.col_idx[slot] = j;
+    m.values[slot] = v;
+  }
+};
+
+} // namespace
+
+const char* parse_double(const char* s, const char* end, double& out)
+{
+  const char* p = s;
+  bool negative = false;
+  if (p < end && (*p == '+' || *p == '-')) { negative = (*p == '-'); ++p; }
+
+  double mantissa = 0.0;  // all digits as an integer, exact while below 2^53
+  int exponent = 0;       // decimal exponent applied to mantissa
+  bool any_digit = false;
+
+  for (; p < end && is_digit(*p); ++p) {
+    any_digit = true;
+    mantissa = mantissa * 10.0 + static_cast<double>(*p - '0');
+  }
+  if (p < end && *p == '.') {
+    for (++p; p < end && is_digit(*p); ++p) {
+      any_digit = true;
+      --exponent;
+      mantissa = mantissa * 10.0 + static_cast<double>(*p - '0');
+    }
+  }
+  if (!any_digit) return parse_double_slow(s, end, out);  // inf, nan, hex, or garbage
+  // Integers below 2^53 accumulate exactly; a computed value at or above it may be rounded
+  if (mantissa >= kMaxExactInteger) return parse_double_slow(s, end, out);
+
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    const char* q = p + 1;
+    bool exp_negative = false;
+    if (q < end && (*q == '+' || *q == '-')) { exp_negative = (*q == '-'); ++q; }
+    if (q < end && is_digit(*q)) {
+      int e = 0;
+      for (; q < end && is_digit(*q); ++q) {
+        if (e < 100000) e = e * 10 + (*q - '0');
+      }
+      exponent += exp_negative ? -e : e;
+      p = q;
+    }
+  }
+
+  // mantissa < 2^53 and 10^|exponent| exact => one correctly rounded operation
+  double v = mantissa;
+  if (mantissa != 0.0 && exponent != 0) {
+    if (exponent > 22 || exponent < -22) return parse_double_slow(s, end, out);
+    v = (exponent > 0) ? mantissa * kExactPow10[exponent] : mantissa / kExactPow10[-exponent];
+  }
+  out = negative ? -v : v;
+  return p;
+}
+
+void read_mtx(std::istream& in, CsrMatrix& out, MtxHeader* header)
+{
+  MtxHeader h;
+  read_header(in, h);
+  EntryArrays e;
+  read_body(in, h, e);
+
+  out.rows = h.rows;
+  out.cols = h.cols;
+  out.row_ptr.assign(static_cast<std::size_t>(h.rows) + 1, 0);
+  CsrCountSink counter(out.row_ptr, !h.coordinate);
+  for_each_entry(h, e, counter);
+  for (int i = 0; i < h.rows; ++i) out.row_ptr[i + 1] += out.row_ptr[i];
+
+  const std::size_t nnz = out.row_ptr[static_cast<std::size_t>(h.rows)];
+  out.col_idx.resize(nnz);
+  out.values.resize(nnz);
+  std::vector<std::size_t> cursor(out.row_ptr.begin(), out.row_ptr.end() - 1);
+  CsrFillSink filler(cursor, out, !h.coordinate);
+  for_each_entry(h, e, filler);
+
+  if (header) *header = h;
+}
+
+void read_mtx(std::istream& in, Matrix& out, MtxHeader* header)
+{
+  MtxHeader h;
+  read_header(in, h);
+  if (h.rows != h.cols) throw std::runtime_error("mtx: dense Matrix requires a square matrix");
+  EntryArrays e;
+  read_body(in, h, e);
+
+  const std::size_t n = static_cast<std::size_t>(h.rows);
+  out.n = h.rows;
+  out.data.assign(n * n, 0.0);
+  DenseSink sink(out.data, n);
+  for_each_entry(h, e, sink);
+
+  if (header) *header = h;
+}
+
+void read_mtx_file(const std::string& path, CsrMatrix& out, MtxHeader* header)
+{
+  std::ifstream in(path.c_str(), std::ios::in | std::ios::binary);
+  if (!in) throw std::runtime_error("mtx: cannot open \"" + path + "\"");
+  read_mtx(in, out, header);
+}
+
+void read_mtx_file(const std::string& path, Matrix& out, MtxHeader* header)
+{
+  std::ifstream in(path.c_str(), std::ios::in | std::ios::binary);
+  if (!in) throw std::runtime_error("mtx: cannot open \"" + path + "\"");
+  read_mtx(in, out, header);
+}
+
+} // namespace assignment2
@@ -0,0 +1,165 @@
+/*
+ * mtx_bench.cpp — Parse-throughput benchmark for the Matrix Market reader
+ * Parses a .mtx file (or a synthetic coordinate matrix generated in memory)
+ * several times and reports MB/s for the chunked reader and, optionally, for
+ * a plain iostream reference parser. Wall time via perf::now_seconds().
+ */
+#include "assignment2/mtx.h"
+#include "assignment2/logger.h"
+#include "perf/bench.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using assignment2::CsrMatrix;
+using assignment2::MtxHeader;
+using assignment2::log_error;
+using assignment2::log_info;
+using perf::now_seconds;
+
+static void usage()
+{
+  log_error("Usage: assignment2_mtx_bench (<file.mtx> | --synthetic <n> <nnz>) [--reps k] [--iostream]");
+}
+
+// Parse positive integer from C-string; returns false on error or out-of-range
+static bool parse_positive_int(const char* s, int& out)
+{
+  if (!s || *s == '\0') return false;
+  errno = 0; char* endp = 0; long v = std::strtol(s, &endp, 10);
+  if (errno == ERANGE) return false;
+  if (endp == s || *endp != '\0') return false;
+  if (v <= 0 || v > INT_MAX) return false;
+  out = static_cast<int>(v); return true;
+}
+
+// Build a general real coordinate matrix with nnz pseudo-random entries
+static std::string make_synthetic(int n, int nnz)
+{
+  std::ostringstream oss;
+  oss.setf(std::ios::scientific); oss.precision(15);
+  oss << "%%MatrixMarket matrix coordinate real general\n";
+  oss << "% synthetic benchmark input\n";
+  oss << n << " " << n << " " << nnz << "\n";
+  unsigned int state = 12345u;
+  for (int k = 0; k < nnz; ++k) {
+    state = state * 1103515245u + 12345u; const int i = static_cast<int>((state >> 8) % static_cast<unsigned int>(n)) + 1;
+    state = state * 1103515245u + 12345u; const int j = static_cast<int>((state >> 8) % static_cast<unsigned int>(n)) + 1;
+    state = state * 1103515245u + 12345u; const double v = static_cast<double>(state >> 8) / 16777216.0 - 0.5;
+    oss << i << " " << j << " " << v << "\n";
+  }
+  return oss.str();
+}
+
+// Reference parser: the same file read token by token with operator>>
+static std::size_t parse_with_iostream(const std::string& text)
+{
+  std::istringstream in(text);
+  std::string line;
+  std::getline(in, line);
+  while (std::getline(in, line) && (line.empty() || line[0] == '%')) {}
+  std::istringstream size_line(line);
+  long rows = 0, cols = 0, nnz = 0;
+  size_line >> rows >> cols >> nnz;
+  std::vector<int> ri, ci; std::vector<double> vv;
+  ri.reserve(static_cast<std::size_t>(nnz)); ci.reserve(static_cast<std::size_t>(nnz)); vv.reserve(static_cast<std::size_t>(nnz));
+  int i = 0, j = 0; double v = 0.0;
+  while (in >> i >> j >> v) { ri.push_back(i - 1); ci.push_back(j - 1); vv.push_back(v); }
+  return vv.size();
+}
+
+static void log_rate(const char* parser, std::size_t bytes, double best_s, std::size_t nnz)
+{
+  const double mb = static_cast<double>(bytes) / 1e6;
+  const double rate = (best_s > 0.0) ? mb / best_s : 0.0;
+  std::ostringstream oss; oss.setf(std::ios::fixed); oss.precision(2);
+  oss << "parser=" << parser << " bytes=" << bytes << " nnz=" << nnz
+      << " best_ms=" << best_s * 1000.0 << " MB/s=" << rate;
+  log_info(oss.str());
+}
+
+int main(int argc, char** argv)
+{
+  std::string path;
+  int syn_n = 0, syn_nnz = 0, reps = 3;
+  bool iostream_ref = false;
+  for (int a = 1; a < argc; ++a) {
+    if (std::strcmp(argv[a], "--synthetic") == 0 && a + 2 < argc) {
+      if (!parse_positive_int(argv[a + 1], syn_n) || !parse_positive_int(argv[a + 2], syn_nnz)) { usage(); return 1; }
+      a += 2;
+    } else if (std::strcmp(argv[a], "--reps") == 0 && a + 1 < argc) {
+      if (!parse_positive_int(argv[++a], reps)) { usage(); return 1; }
+    } else if (std::strcmp(argv[a], "--iostream") == 0) {
+      iostream_ref = true;
+    } else if (argv[a][0] != '-' && path.empty()) {
+      path = argv[a];
+    } else {
+      usage(); return 1;
+    }
+  }
+  if (path.empty() == (syn_n == 0)) { usage(); return 1; }
+
+  try {
+    // Load the whole input once so repetitions measure parsing, not disk I/O
+    std::string text;
+    if (!path.empty()) {
+      std::ifstream f(path.c_str(), std::ios::in | std::ios::binary);
+      if (!f) { log_error("cannot open \"" + path + "\""); return 1; }
+      text.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    } else {
+      text = make_synthetic(syn_n, syn_nnz);
+    }
+
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    log_info("assignment2_mtx_bench start");
+    { std::ostringstream o; o << "input=" << (path.empty() ? std::string("synthetic") : path)
+                             << " bytes=" << text.size() << " reps=" << reps << " threads=" << threads;
+      log_info(o.str()); }
+
+    double best = 0.0;
+    CsrMatrix m;
+    MtxHeader h;
+    for (int r = 0; r < reps; ++r) {
+      std::istringstream in(text);
+      const double t0 = now_seconds();
+      assignment2::read_mtx(in, m, &h);
+      const double dt = now_seconds() - t0;
+      if (r == 0 || dt < best) best = dt;
+    }
+    { std::ostringstream o; o << "rows=" << m.rows << " cols=" << m.cols << " stored=" << h.entries
+                             << " nnz=" << m.values.size();
+      log_info(o.str()); }
+    log_rate("chunked", text.size(), best, h.entries);
+
+    if (iostream_ref && h.coordinate && !h.pattern) {
+      double best_ref = 0.0; std::size_t n = 0;
+      for (int r = 0; r < reps; ++r) {
+        const double t0 = now_seconds();
+        n = parse_with_iostream(text);
+        const double dt = now_seconds() - t0;
+        if (r == 0 || dt < best_ref) best_ref = dt;
+      }
+      log_rate("iostream", text.size(), best_ref, n);
+    }
+
+    log_info("assignment2_mtx_bench done");
+    return 0;
+  } catch (const std::bad_alloc&) { log_error("allocation failed: std::bad_alloc"); return 1; }
+    catch (const std::exception& e) { std::ostringstream oss; oss << "runtime error: " << e.what(); log_error(oss.str()); return 1; }
+}
@@ -4,18 +4,31 @@
  * validates timing/FLOPS are non-negative. Uses extern "C" for Unity integration.
  */
 #include "assignment2/matrix.h"
+#include "assignment2/mtx.h"
 
 /* Wrap Unity C header for C++ linkage */
 extern "C" {
 #include "vendor/unity/unity.h"
 }
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include <ctime>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 
 using assignment2::Matrix;
 using assignment2::initA;
 using assignment2::initB;
 using assignment2::multiply;
+using assignment2::CsrMatrix;
+using assignment2::MtxHeader;
+using assignment2::parse_double;
+using assignment2::read_mtx;
 
 // Test small N=3 case against known closed-form: C[i][j] = N*(i+1)/(j+1)
 static void test_small_N_exact_values(void)
@@ -54,11 +67,177 @@ static void test_flops_and_time_non_negative(void)
   TEST_ASSERT_DOUBLE_WITHIN(0.0, expect, got);
 }
 
+// Fast float parser: exact fast path and strtod fallback agree with literals
+static void test_parse_double(void)
+{
+  const char* cases[] = { "1", "-2.5", "0.000123", "6.02214076e23", "1e-300",
+                          "3.141592653589793238", "+.5", "7E+2", "-0" };
+  const double expect[] = { 1.0, -2.5, 0.000123, 6.02214076e23, 1e-300,
+                            3.141592653589793238, 0.5, 700.0, 0.0 };
+  for (int k = 0; k < 9; ++k) {
+    const char* s = cases[k];
+    const char* end = s + std::string(s).size();
+    double v = 99.0;
+    const char* p = parse_double(s, end, v);
+    TEST_ASSERT_TRUE(p == end);
+    TEST_ASSERT_TRUE(v == expect[k]);
+  }
+  double v = 0.0;
+  const char* bad = "x1";
+  TEST_ASSERT_TRUE(parse_double(bad, bad + 2, v) == bad);
+}
+
+// Coordinate general file into CSR: 3x4 with comments and blank lines
+static void test_mtx_coordinate_csr(void)
+{
+  std::istringstream in(
+    "%%MatrixMarket matrix coordinate real general\n"
+    "% comment\n"
+    "3 4 4\n"
+    "1 1 1.5\n"
+    "\n"
+    "3 4 -2\n"
+    "2 2 4e1\n"
+    "1 3 0.25");
+  CsrMatrix m;
+  MtxHeader h;
+  read_mtx(in, m, &h);
+  TEST_ASSERT_TRUE(m.rows == 3 && m.cols == 4);
+  TEST_ASSERT_TRUE(m.values.size() == 4);
+  TEST_ASSERT_TRUE(m.row_ptr[1] == 2 && m.row_ptr[2] == 3 && m.row_ptr[3] == 4);
+  TEST_ASSERT_TRUE(m.col_idx[0] == 0 && m.col_idx[1] == 2);
+  TEST_ASSERT_DOUBLE_WITHIN(0.0, 0.25, m.values[1]);
+  TEST_ASSERT_DOUBLE_WITHIN(0.0, 40.0, m.values[2]);
+  TEST_ASSERT_DOUBLE_WITHIN(0.0, -2.0, m.values[3]);
+}
+
+// Explicit zeros of a coordinate file are entries; zeros of an array file are not
+static void test_mtx_zeros(void)
+{
+  std::istringstream coo(
+    "%%MatrixMarket matrix coordinate real general\n"
+    "2 2 2\n"
+    "1 1 0\n"
+    "2 2 5\n");
+  CsrMatrix c;
+  read_mtx(coo, c);
+  TEST_ASSERT_TRUE(c.values.size() == 2 && c.row_ptr[1] == 1 && c.row_ptr[2] == 2);
+  TEST_ASSERT_DOUBLE_WITHIN(0.0, 0.0, c.values[0]);
+
+  std::istringstream arr(
+    "%%MatrixMarket matrix array real general\n"
+    "2 2\n"
+    "0\n2\n0\n4\n");
+  CsrMatrix a;
+  read_mtx(arr, a);
+  TEST_ASSERT_TRUE(a.values.size() == 2 && a.row_ptr[1] == 0 && a.row_ptr[2] == 2);
+}
+
+// A body over several slices (more than kMinSliceBytes per thread) parses
+// the same with 4 threads as with 1
+static void test_mtx_parallel_slices(void)
+{
+  const int n = 1000;
+  std::string text = "%%MatrixMarket matrix coordinate real general\n";
+  char line[64];
+  std::sprintf(line, "%d %d %d\n", n, n, 20 * n);
+  text += line;
+  for (int k = 0; k < 20 * n; ++k) {
+    if (k % 997 == 0) text += "% comment inside the body\n";
+    std::sprintf(line, "%d %d %.15e\n", k % n + 1, (k * 7) % n + 1, 0.5 + k);
+    text += line;
+  }
+  TEST_ASSERT_TRUE(text.size() > 4 * (static_cast<std::size_t>(64) << 10));
+
+  CsrMatrix serial, parallel;
+#ifdef _OPENMP
+  const int threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+  std::istringstream in1(text);
+  read_mtx(in1, serial);
+#ifdef _OPENMP
+  omp_set_num_threads(4);
+#endif
+  std::istringstream in4(text);
+  read_mtx(in4, parallel);
+#ifdef _OPENMP
+  omp_set_num_threads(threads);
+#endif
+  TEST_ASSERT_TRUE(serial.values.size() == static_cast<std::size_t>(20 * n));
+  TEST_ASSERT_TRUE(serial.row_ptr == parallel.row_ptr);
+  TEST_ASSERT_TRUE(serial.col_idx == parallel.col_idx);
+  TEST_ASSERT_TRUE(serial.values == parallel.values);
+  TEST_ASSERT_DOUBLE_WITHIN(0.0, 0.5, serial.values[0]);  // row 1 starts with k = 0
+}
+
+// Symmetric coordinate and general array files into a dense Matrix
+static void test_mtx_dense(void)
+{
+  std::istringstream sym(
+    "%%MatrixMarket matrix coordinate real symmetric\n"
+    "2 2 2\n"
+    "1 1 3\n"
+    "2 1 5\n");
+  Matrix S(1);
+  read_mtx(sym, S);
+  TEST_ASSERT_TRUE(S.n == 2);
+  TEST_ASSERT_DOUBLE_WITHIN(0.0, 3.0, S.at(0, 0));
+  TEST_ASSERT_DOUBLE_WITHIN(0.0, 5.0, S.at(1, 0));
+  TEST_ASSERT_DOUBLE_WITHIN(0.0, 5.0, S.at(0, 1));
+  TEST_ASSERT_DOUBLE_WITHIN(0.0, 0.0, S.at(1, 1));
+
+  // Array storage is column-major: values fill column 0 first
+  std::istringstream arr(
+    "%%MatrixMarket matrix array real general\n"
+    "2 2\n"
+    "1\n2\n3\n4\n");
+  Matrix D(1);
+  read_mtx(arr, D);
+  TEST_ASSERT_DOUBLE_WITHIN(0.0, 1.0, D.at(0, 0));
+  TEST_ASSERT_DOUBLE_WITHIN(0.0, 2.0, D.at(1, 0));
+  TEST_ASSERT_DOUBLE_WITHIN(0.0, 3.0, D.at(0, 1));
+  TEST_ASSERT_DOUBLE_WITHIN(0.0, 4.0, D.at(1, 1));
+}
+
+// Malformed inputs are reported via std::runtime_error
+static void test_mtx_errors(void)
+{
+  const char* inputs[] = {
+    "%%MatrixMarket matrix coordinate complex general\n1 1 1\n1 1 1 0\n",
+    "%%MatrixMarket matrix coordinate real general\n2 2 2\n1 1 1\n",
+    "%%MatrixMarket matrix coordinate real general\n2 2 1\n3 1 1\n",
+    "not a matrix market file\n",
+    "%%MatrixMarket matrix coordinate real general\n2 2 1.5\n1 1 1\n",  // non-integer nnz
+    "%%MatrixMarket matrix coordinate real general\n2 2 1 9\n1 1 1\n",  // extra size field
+    "%%MatrixMarket matrix coordinate real general\n2 2 1\n1 1 1.5x\n",  // junk after value
+    "%%MatrixMarket matrix coordinate real general\n2 2 1\n1 1 1 2\n",  // extra field
+    "%%MatrixMarket matrix coordinate pattern general\n2 2 1\n1 1 3\n",  // value in pattern
+    "%%MatrixMarket matrix coordinate real general\n2 2 5\n1 1 1\n1 2 1\n2 1 1\n2 2 1\n1 1 1\n",  // nnz > rows*cols
+    "%%MatrixMarket matrix coordinate real symmetric\n2 2 4\n1 1 1\n2 1 1\n2 2 1\n2 1 1\n",  // nnz > lower triangle
+    "%%MatrixMarket matrix coordinate real general\n2000000000 2000000000 4000000000000000000\n1 1 1\n",  // nnz > stream
+    "%%MatrixMarket matrix array real general\n100000 100000\n1\n"  // values > stream
+  };
+  for (int k = 0; k < 13; ++k) {
+    std::istringstream in(inputs[k]);
+    CsrMatrix m;
+    bool threw = false;
+    try { read_mtx(in, m); } catch (const std::runtime_error&) { threw = true; }
+    TEST_ASSERT_TRUE(threw);
+  }
+}
+
 // Unity test runner entry point
 int main(void)
 {
   UnityBegin("assignment2");
   RUN_TEST(test_small_N_exact_values);
   RUN_TEST(test_flops_and_time_non_negative);
+  RUN_TEST(test_parse_double);
+  RUN_TEST(test_mtx_coordinate_csr);
+  RUN_TEST(test_mtx_zeros);
+  RUN_TEST(test_mtx_parallel_slices);
+  RUN_TEST(test_mtx_dense);
+  RUN_TEST(test_mtx_errors);
   return UnityEnd();
 }
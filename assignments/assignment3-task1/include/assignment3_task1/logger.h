@@ -1,6 +1,7 @@
 // logger.h — Simple logging utilities for assignment3-task1
 // Provides info/error logging to stdout/stderr with prefixed labels.
-// Thread-safe if stdout/stderr are thread-safe (standard streams usually are).
+// Goes through perf's logger: after perf::log_open() it is asynchronous and
+// safe inside parallel regions (see perf/log.h).
 
 #ifndef ASSIGNMENT3_TASK1_LOGGER_H
 #define ASSIGNMENT3_TASK1_LOGGER_H
@@ -1,17 +1,17 @@
 // logger.cpp — Implementation of logging utilities
-// Simple wrappers around cout/cerr with prefixed labels.
+// Thin wrappers around perf::log_write with the INFO/ERROR levels.
 
 #include "assignment3_task1/logger.h"
-#include <iostream>
+#include "perf/log.h"
 
 namespace assignment3_task1 {
 
 void log_info(const std::string& msg) {
-  std::cout << "[INFO] " << msg << std::endl;
+  perf::log_write(perf::LOG_INFO, msg);
 }
 
 void log_error(const std::string& msg) {
-  std::cerr << "[ERROR] " << msg << std::endl;
+  perf::log_write(perf::LOG_ERROR, msg);
 }
 
 }  // namespace assignment3_task1
@@ -1,6 +1,10 @@
 // main.cpp — Driver program for pi approximation with timing and error reporting
 // Parses command-line arguments, runs parallel pi computation, and logs results.
 // Requires one argument: the number of intervals (n) for the midpoint rule.
+// Timing uses the shared harness (perf/bench.h): warm-up, repeated wall-clock runs
+// and their statistics, optionally written as JSON/CSV.
+// The rate is also placed under this host's measured roofline (perf/roofline.h).
+// With --counters, per-thread hardware counters are read around the kernel.
 
 // Ensure M_PI is defined on MSVC
 #ifdef _MSC_VER
@@ -18,6 +22,10 @@
 
 #include "assignment3_task1/pi.h"
 #include "assignment3_task1/logger.h"
+#include "perf/bench.h"
+#include "perf/counters.h"
+#include "perf/log.h"
+#include "perf/roofline.h"
 
 #ifdef _OPENMP
 #  include <omp.h>
@@ -26,7 +34,6 @@
 #include <cstdlib>
 #include <cerrno>
 #include <climits>
-#include <ctime>
 #include <sstream>
 #include <string>
 #include <iostream>
@@ -37,7 +44,7 @@ using assignment3_task1::log_info;
 
 // Print usage message to stderr
 static void print_usage() {
-  std::cerr << "Usage: assignment3-task1 <n>" << std::endl;
+  std::cerr << "Usage: assignment3-task1 <n> [--counters] " << perf::bench_usage() << std::endl;
 }
 
 // Parse a positive integer from a string; returns false on error
@@ -67,25 +74,61 @@ static bool parse_positive_int(const char* str, int& result) {
   return true;
 }
 
-// Get current wall-clock time in milliseconds
-static double get_wall_time_ms() {
-#ifdef _OPENMP
-  // Use high-resolution OpenMP timer if available
-  return omp_get_wtime() * 1000.0;
-#else
-  // Fall back to clock() (less precise, may wrap on long runs)
-  const clock_t ticks = clock();
-  return 1000.0 * static_cast<double>(ticks) / static_cast<double>(CLOCKS_PER_SEC);
-#endif
+// Floating-point operations per midpoint sample: i + 0.5, * h, x * x, 1 + x², 4 / (...), sum +=
+static const double kFlopsPerSample = 6.0;
+
+// Log arithmetic intensity and percent of peak against the all-thread
+// ceilings of this host, measuring them on first use (cached per host).
+static void log_roofline(double flops, double bytes, double seconds) {
+  perf::Roofline roof;
+  std::string err;
+  if (perf::acquire_roofline(roof, err)) {
+    log_info("roofline ceilings measured for host " + roof.host);
+  }
+  if (!err.empty()) {
+    log_error(err);
+  }
+  const perf::Ceiling ceiling = perf::parallel_ceiling(roof);
+  log_info(perf::format_roofline(ceiling, perf::roofline_point(ceiling, flops, bytes, seconds)));
 }
 
 int main(int argc, char** argv) {
-  // Validate argument count
-  if (argc != 2) {
+  // Validate arguments: n, optionally followed by --counters and harness options
+  if (argc < 2) {
     log_error("invalid arguments");
     print_usage();
     return 1;
   }
+  bool counters = false;
+  perf::BenchConfig bench;
+  for (int i = 2; i < argc; ) {
+    std::string err;
+    const int rc = perf::parse_bench_option(argc, argv, i, bench, err);
+    if (rc < 0) {
+      log_error(err);
+      print_usage();
+      return 1;
+    }
+    if (rc == 0 && std::string(argv[i]) == "--counters") {
+      counters = true;
+      ++i;
+    } else if (rc == 0) {
+      log_error(std::string("unknown option: ") + argv[i]);
+      print_usage();
+      return 1;
+    }
+  }
+
+  // Asynchronous logging from here on; --log also writes a tagged log file
+  {
+    perf::LogConfig log_cfg;
+    log_cfg.path = bench.log_path;
+    std::string err;
+    if (!perf::log_open(log_cfg, err)) {
+      log_error(err);
+      return 1;
+    }
+  }
 
   // Parse the number of intervals
   int n = 0;
@@ -119,14 +162,32 @@ int main(int argc, char** argv) {
     log_info(oss.str());
   }
 
-  // Compute pi with timing
-  const double start_time = get_wall_time_ms();
-  const double computed_pi = approximate_pi_parallel(n);
-  const double end_time = get_wall_time_ms();
+  // Hardware counters on every thread of the kernel's parallel region
+  perf::CounterSet ctr;
+  if (counters) {
+    std::string err;
+    if (!ctr.open(thread_count, err)) {
+      log_info("counters unavailable: " + err);
+    } else if (!err.empty()) {
+      log_info("counters not supported: " + err);
+    }
+  }
+
+  // Compute pi: warm-up runs, then timed runs (counters cover the timed ones)
+  double computed_pi = 0.0;
+  perf::Sampler sampler(bench);
+  while (sampler.next()) {
+    if (!sampler.warming_up()) {
+      ctr.start();
+    }
+    computed_pi = approximate_pi_parallel(n);
+    ctr.stop();
+  }
+  const perf::Stats stats = sampler.stats();
 
-  // Calculate absolute error
+  // Calculate absolute error; elapsed time is the median run
   const double error = (computed_pi > M_PI) ? (computed_pi - M_PI) : (M_PI - computed_pi);
-  const long elapsed_ms = static_cast<long>(end_time - start_time + 0.5);
+  const long elapsed_ms = static_cast<long>(stats.median * 1000.0 + 0.5);
 
   // Log results with appropriate precision
   {
@@ -145,6 +206,28 @@ int main(int argc, char** argv) {
            << " elapsed_ms=" << elapsed_ms;
     log_info(output.str());
   }
+  log_info(perf::format_stats(stats));
+  {
+    std::ostringstream params;
+    params << "n=" << n << " threads=" << thread_count;
+    perf::BenchReport report("assignment3-task1");
+    report.add(params.str(), sampler.samples(), stats);
+    std::string err;
+    if (!report.write(bench, err)) {
+      log_error(err);
+    }
+  }
+
+  // The integrand lives in registers: no memory traffic, AI is unbounded
+  log_roofline(kFlopsPerSample * static_cast<double>(n), 0.0, stats.median);
+  if (ctr.is_open()) {
+    for (int t = 0; t < ctr.threads(); ++t) {
+      std::ostringstream oss;
+      oss << "counters thread=" << t << " " << perf::format_counters(ctr.read_thread(t));
+      log_info(oss.str());
+    }
+    log_info("counters: " + perf::format_counters(ctr.read_total()));
+  }
 
   log_info("assignment3-task1 done");
   return 0;
@@ -1,5 +1,6 @@
 /* logger.h: Simple message logging for assignment3-task2.
- * Thread-safe via cout/cerr atomicity (each call outputs single line).
+ * Goes through perf's logger: after perf::log_open() it is asynchronous and
+ * safe from any thread (see perf/log.h).
  */
 #ifndef ASSIGNMENT3_TASK2_LOGGER_H
 #define ASSIGNMENT3_TASK2_LOGGER_H
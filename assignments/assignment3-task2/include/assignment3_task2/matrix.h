@@ -1,5 +1,6 @@
 /* matrix.h: N×N dense matrix operations with row-major layout.
- * Provides matrix initialization and multiplication (serial & parallel).
+ * Provides matrix initialization, multiplication (serial & parallel) and
+ * a randomized O(N^2) check of the product (Freivalds).
  * Matrices stored as std::vector<double>, indexed i*N + j.
  */
 #ifndef ASSIGNMENT3_TASK2_MATRIX_H
@@ -29,6 +30,49 @@ namespace assignment3_task2
                            const std::vector<double>& B,
                            std::vector<double>& C,
                            int N);
+
+    // Innermost loop of the blocked kernel: a dot product over k (i-j-k, as
+    // in multiply_serial) or a row update streaming rows of B (i-k-j).
+    enum LoopOrder
+    {
+        ORDER_IJK,
+        ORDER_IKJ
+    };
+
+    // Parameters of multiply_blocked; chosen per host by the autotuner (tune.h).
+    struct KernelConfig
+    {
+        int block_i;      // Rows of C per tile (also the unit of thread work)
+        int block_k;      // Depth of the A/B panels
+        int block_j;      // Columns of C per tile
+        LoopOrder order;
+        int threads;      // OpenMP threads (0 = runtime default)
+
+        // Defaults: 64 x 128 x 256 tiles, i-k-j, runtime thread count.
+        KernelConfig();
+    };
+
+    // Compute C = A * B with cache blocking and the given loop order; rows
+    // of tiles are split across threads. cfg.threads > 0 sets the thread
+    // count of this call only (num_threads clause).
+    void multiply_blocked(const std::vector<double>& A,
+                          const std::vector<double>& B,
+                          std::vector<double>& C,
+                          int N,
+                          const KernelConfig& cfg);
+
+    // Verify C == A * B in O(N^2) with Freivalds' algorithm: compare A(Br)
+    // with Cr for the vector r of perf::freivalds_vector(seed, N).
+    // Row residuals are scaled by (|A|(|B|r))_i; max_residual receives the
+    // largest one. Loops are parallelized with OpenMP when available.
+    // Returns true when max_residual <= perf::freivalds_tolerance(N), which
+    // misses single-term errors at large N (see perf/freivalds.h).
+    bool freivalds_verify(const std::vector<double>& A,
+                          const std::vector<double>& B,
+                          const std::vector<double>& C,
+                          int N,
+                          unsigned int seed,
+                          double& max_residual);
 }
 
 #endif
@@ -0,0 +1,82 @@
+/* ooc.h: Out-of-core tiled matrix multiplication for N beyond RAM.
+ * A, B and C live in files (N×N doubles, row-major, native byte order, no
+ * header). C is computed one T×T tile at a time; the A and B tiles of the
+ * next step are read by an I/O thread (pread) while the current step is
+ * multiplied, and finished C tiles are written back the same way.
+ * Memory use is six tiles (A, B, C each double-buffered), independent of N.
+ */
+#ifndef ASSIGNMENT3_TASK2_OOC_H
+#define ASSIGNMENT3_TASK2_OOC_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace assignment3_task2
+{
+    // One step of the tile schedule: C(ci,cj) += A(ci,k) * B(k,cj).
+    struct TileStep
+    {
+        int ci;
+        int cj;
+        int k;
+    };
+
+    // Timing and I/O counters of one out-of-core multiply.
+    struct OocResult
+    {
+        double c00, c0L, cL0, cLL;  // Corner elements of C
+        double elapsed_s;           // Wall time of the multiply (I/O included)
+        double compute_s;           // Time in the tile kernel
+        double io_s;                // Time the I/O thread spent in pread/pwrite
+        double wait_s;              // Time the kernel waited for I/O
+        double bytes_read;
+        double bytes_written;
+        long tile_reads;            // Input tiles read from disk
+        long tile_reuses;           // Input tiles kept from the previous step
+
+        OocResult();
+    };
+
+    // Write A (A[i][j] = i + 1) and B (B[i][j] = 1/(j+1)) row by row, using
+    // O(N) memory. Returns false and sets err on I/O failure.
+    bool write_input_files(const std::string& pathA,
+                           const std::string& pathB,
+                           int N,
+                           std::string& err);
+
+    // Largest tile side whose six T×T buffers fit in budget_bytes,
+    // clamped to [1, N].
+    int ooc_tile_for_budget(int N, std::size_t budget_bytes);
+
+    // Tile schedule over a tiles×tiles grid. C tiles are visited row by row
+    // with serpentine columns, and the k order reverses on every C tile, so
+    // consecutive C tiles share an input tile (the A tile within a row, the
+    // B tile across rows) which is then not read again.
+    void ooc_schedule(int tiles, std::vector<TileStep>& steps);
+
+    // C = A * B with A and B read from files and C written to pathC, using
+    // T×T tiles. Returns false and sets err on I/O failure.
+    bool multiply_out_of_core(const std::string& pathA,
+                              const std::string& pathB,
+                              const std::string& pathC,
+                              int N,
+                              int tile,
+                              OocResult& out,
+                              std::string& err);
+
+    // Freivalds check of the product stored in files (see freivalds_verify),
+    // streaming one row at a time: O(N) memory, one pass over B and one over
+    // A and C together.
+    // Returns true if the residual is within tolerance; on I/O failure sets
+    // err, max_residual to HUGE_VAL and returns false.
+    bool freivalds_verify_files(const std::string& pathA,
+                                const std::string& pathB,
+                                const std::string& pathC,
+                                int N,
+                                unsigned int seed,
+                                double& max_residual,
+                                std::string& err);
+}
+
+#endif
@@ -0,0 +1,62 @@
+/* tune.h: Autotuner for multiply_blocked with a per-host cache file.
+ * The search times the kernel on a sample N and changes one parameter at a
+ * time (threads, block_j, block_k, block_i, loop order), keeping a change
+ * only when it is faster. The best configuration is kept only if it beats
+ * multiply_parallel on the same sample; the winning kernel and its
+ * parameters are stored as key=value lines in $A3T2_TUNE_DIR (else $HOME,
+ * else the working directory) under .assignment3-task2-tune-<host>
+ * (perf::host_name()), and the driver loads it at startup.
+ */
+#ifndef ASSIGNMENT3_TASK2_TUNE_H
+#define ASSIGNMENT3_TASK2_TUNE_H
+
+#include "assignment3_task2/matrix.h"
+
+#include <string>
+
+namespace assignment3_task2
+{
+    // Outcome of autotune_kernel.
+    struct TuneResult
+    {
+        KernelConfig best;
+        bool blocked;        // Whether best beats multiply_parallel (gflops > base_gflops)
+        double gflops;       // Rate of best on the sample
+        double base_gflops;  // Rate of multiply_parallel on the same sample
+        int evaluations;     // Configurations timed
+
+        TuneResult();
+    };
+
+    // Cache file path for a host (see above).
+    std::string tune_cache_path(const std::string& host);
+
+    // One-line description, e.g. "bi=64 bk=128 bj=256 order=ikj threads=8".
+    std::string format_kernel_config(const KernelConfig& cfg);
+
+    // Read a cache written by save_tune_cache. blocked tells whether the
+    // winner was multiply_blocked(cfg) or multiply_parallel. Fails (with err)
+    // if the file is missing, was written for another host, or holds invalid
+    // values.
+    bool load_tune_cache(const std::string& path,
+                         const std::string& host,
+                         KernelConfig& cfg,
+                         bool& blocked,
+                         double& gflops,
+                         std::string& err);
+
+    // Write the winning kernel (kernel=blocked|parallel), cfg and its rate;
+    // returns false (with err) on I/O failure.
+    bool save_tune_cache(const std::string& path,
+                         const std::string& host,
+                         const KernelConfig& cfg,
+                         bool blocked,
+                         double gflops,
+                         std::string& err);
+
+    // Search kernel parameters on an N×N sample (N of a few hundred keeps
+    // the search to seconds).
+    void autotune_kernel(int N, TuneResult& out);
+}
+
+#endif
@@ -1,18 +1,18 @@
 /* logger.cpp: Simple stdout/stderr logging implementation.
- * Each call outputs a single line with prefix; thread-safe via stream atomicity.
+ * Each call forwards one line to perf::log_write with the INFO/ERROR level.
  */
 #include "assignment3_task2/logger.h"
-#include <iostream>
+#include "perf/log.h"
 
 namespace assignment3_task2
 {
     void log_info(const std::string& msg)
     {
-        std::cout << "[INFO] " << msg << std::endl;
+        perf::log_write(perf::LOG_INFO, msg);
     }
 
     void log_error(const std::string& msg)
     {
-        std::cerr << "[ERROR] " << msg << std::endl;
+        perf::log_write(perf::LOG_ERROR, msg);
     }
 }
@@ -1,9 +1,31 @@
 /* main.cpp: Command-line driver for parallel matrix multiplication benchmark.
  * Parses N from argv, initializes A and B, performs multiplication, and reports timing.
- * Uses OpenMP for timing and parallelization when available; falls back to serial otherwise.
+ * The whole product is verified with a Freivalds check (O(N^2), threaded).
+ * Uses OpenMP for parallelization when available; falls back to serial otherwise.
+ * The in-memory multiply is timed by the shared harness (perf/bench.h): warm-up,
+ * repeated runs on a monotonic clock, statistics and optional JSON/CSV output.
+ * With --ooc DIR the matrices live in files under DIR and are streamed in tiles,
+ * so N is bounded by disk space instead of RAM.
+ * The in-memory multiply uses the kernel cached for this host by --tune (see
+ * tune.h): the blocked kernel if it beat multiply_parallel, else
+ * multiply_parallel, which is also used when no cache exists.
+ * Rates are placed under this host's measured roofline (perf/roofline.h);
+ * --counters reads per-thread hardware counters around it (perf/counters.h).
+ * --trace FILE writes a Chrome trace JSON of the phases of every thread
+ * (perf/trace.h): init, runs and tiles, or generate, io, compute tile and wait
+ * with --ooc, then verify.
  */
 #include "assignment3_task2/matrix.h"
 #include "assignment3_task2/logger.h"
+#include "assignment3_task2/ooc.h"
+#include "assignment3_task2/tune.h"
+#include "perf/bench.h"
+#include "perf/counters.h"
+#include "perf/freivalds.h"
+#include "perf/log.h"
+#include "perf/roofline.h"
+#include "perf/sysmem.h"
+#include "perf/trace.h"
 
 #include <vector>
 #include <string>
@@ -21,29 +43,40 @@
 
 using assignment3_task2::log_info;
 using assignment3_task2::log_error;
+using perf::now_seconds;
 
 static void print_usage()
 {
-    std::fprintf(stderr, "Usage: assignment3-task2 <N>\n");
+    std::fprintf(stderr, "Usage: assignment3-task2 <N> [--ooc DIR] [--tile T] [--tune] [--counters] "
+                         "[--trace FILE] %s\n",
+                 perf::bench_usage());
 }
 
-// Parse and validate N from command-line arguments.
-// Returns false on error (prints diagnostic and usage).
-// Enforces: N > 0, N <= INT_MAX, and 3*N*N*sizeof(double) <= 1 GiB.
-static bool parse_N(int argc, char** argv, int& N)
+// Parsed command line. ooc_dir is empty for the in-memory multiply;
+// tile == 0 lets the out-of-core mode size tiles from the memory budget;
+// tune re-runs the kernel search and rewrites the host's cache;
+// counters reads hardware counters around the in-memory multiply;
+// trace_path names the phase trace to write (empty = none);
+// bench holds the harness settings (the out-of-core multiply runs once).
+struct Options
 {
-    if (argc != 2)
-    {
-        log_error("invalid argument count");
-        print_usage();
-        return false;
-    }
+    int N;
+    std::string ooc_dir;
+    int tile;
+    bool tune;
+    bool counters;
+    std::string trace_path;
+    perf::BenchConfig bench;
 
-    const char* s = argv[1];
+    Options() : N(0), tile(0), tune(false), counters(false) {}
+};
+
+// Parse a positive int; logs "invalid <what>" and returns false otherwise.
+static bool parse_positive(const char* s, const char* what, int& out)
+{
     if (!s || *s == '\0')
     {
-        log_error("missing N");
-        print_usage();
+        log_error(std::string("missing ") + what);
         return false;
     }
 
@@ -53,73 +86,492 @@ static bool parse_N(int argc, char** argv, int& N)
 
     if (errno == ERANGE)
     {
-        log_error(std::string("invalid N (out of range): ") + s);
-        print_usage();
+        log_error(std::string("invalid ") + what + " (out of range): " + s);
         return false;
     }
     if (endp == s || *endp != '\0')
     {
-        log_error(std::string("invalid N (not an integer): ") + s);
-        print_usage();
+        log_error(std::string("invalid ") + what + " (not an integer): " + s);
         return false;
     }
     if (val <= 0)
     {
-        log_error("N must be positive");
+        log_error(std::string(what) + " must be positive");
+        return false;
+    }
+    if (val > INT_MAX)
+    {
+        log_error(std::string(what) + " exceeds INT_MAX");
+        return false;
+    }
+
+    out = static_cast<int>(val);
+    return true;
+}
+
+// Parse and validate N and options from command-line arguments.
+// Returns false on error (prints diagnostic and usage).
+// Enforces: N > 0, N <= INT_MAX, and that the working set fits the
+// RAM-derived budget (3/4 of available memory, see perf/sysmem.h): three N×N
+// matrices in memory, or six tiles with --ooc.
+static bool parse_args(int argc, char** argv, Options& opt)
+{
+    if (argc < 2)
+    {
+        log_error("invalid argument count");
+        print_usage();
+        return false;
+    }
+    if (!parse_positive(argv[1], "N", opt.N))
+    {
         print_usage();
         return false;
     }
 
-    // Prevent excessive memory allocation: 3 N×N matrices must fit in 1 GiB.
+    for (int a = 2; a < argc; ++a)
+    {
+        const std::string arg = argv[a];
+        std::string err;
+        int next = a;
+        const int rc = perf::parse_bench_option(argc, argv, next, opt.bench, err);
+        if (rc < 0)
+        {
+            log_error(err);
+            print_usage();
+            return false;
+        }
+        if (rc > 0)
+        {
+            a = next - 1;
+            continue;
+        }
+        if ((arg == "--ooc" || arg == "--tile" || arg == "--trace") && a + 1 >= argc)
+        {
+            log_error("missing value for " + arg);
+            print_usage();
+            return false;
+        }
+        if (arg == "--ooc")
+        {
+            opt.ooc_dir = argv[++a];
+        }
+        else if (arg == "--tile")
+        {
+            if (!parse_positive(argv[++a], "tile", opt.tile))
+            {
+                print_usage();
+                return false;
+            }
+        }
+        else if (arg == "--trace")
+        {
+            opt.trace_path = argv[++a];
+        }
+        else if (arg == "--tune")
+        {
+            opt.tune = true;
+        }
+        else if (arg == "--counters")
+        {
+            opt.counters = true;
+        }
+        else
+        {
+            log_error("unknown option: " + arg);
+            print_usage();
+            return false;
+        }
+    }
+    if (opt.tile > 0 && opt.ooc_dir.empty())
+    {
+        log_error("--tile requires --ooc");
+        return false;
+    }
+    if (opt.tune && !opt.ooc_dir.empty())
+    {
+        log_error("--tune applies to the in-memory multiply, not --ooc");
+        return false;
+    }
+    if (opt.counters && !opt.ooc_dir.empty())
+    {
+        log_error("--counters applies to the in-memory multiply, not --ooc");
+        return false;
+    }
+
+    const double limit =
+        static_cast<double>(perf::memory_budget_bytes());
+    if (!opt.ooc_dir.empty())
+    {
+        if (opt.tile > opt.N)
+        {
+            opt.tile = opt.N;
+        }
+        const double bytes =
+            6.0 * static_cast<double>(opt.tile) * static_cast<double>(opt.tile) *
+            static_cast<double>(sizeof(double));
+        if (bytes > limit)
+        {
+            std::ostringstream oss;
+            oss << "tile too large for available memory (need " << bytes
+                << " bytes, budget " << limit << " bytes)";
+            log_error(oss.str());
+            return false;
+        }
+        return true;
+    }
+
+    // Prevent excessive memory allocation: 3 N×N matrices must fit in the budget.
     const double bytes =
-        3.0 * static_cast<double>(val) * static_cast<double>(val) *
+        3.0 * static_cast<double>(opt.N) * static_cast<double>(opt.N) *
         static_cast<double>(sizeof(double));
-    const double limit = 1024.0 * 1024.0 * 1024.0;
 
     if (bytes > limit)
     {
-        log_error("N too large for safe allocation; choose a smaller N");
+        std::ostringstream oss;
+        oss << "N too large for available memory (need " << bytes
+            << " bytes, budget " << limit << " bytes); choose a smaller N or use --ooc DIR";
+        log_error(oss.str());
         return false;
     }
+    return true;
+}
 
-    if (val > INT_MAX)
+// Log the corner elements of C (sanity check against the closed form).
+static void log_corners(int N, double c00, double c0L, double cL0, double cLL)
+{
+    const int last = N - 1;
+    std::ostringstream oss;
+    oss.setf(std::ios::fixed);
+    oss.precision(6);
+    oss << "C[0][0]=" << c00
+        << " C[0][" << last << "]=" << c0L
+        << " C[" << last << "][0]=" << cL0
+        << " C[" << last << "][" << last << "]=" << cLL;
+    log_info(oss.str());
+}
+
+// Log elapsed time and GFLOPS for one N×N multiply (2*N^3 operations).
+static void log_performance(int N, double elapsed_s)
+{
+    const double flops =
+        2.0 *
+        static_cast<double>(N) *
+        static_cast<double>(N) *
+        static_cast<double>(N);
+
+    double gflops = 0.0;
+    if (elapsed_s > 0.0)
     {
-        log_error("N exceeds INT_MAX");
-        return false;
+        gflops = flops / (elapsed_s * 1e9);
     }
 
-    N = static_cast<int>(val);
-    return true;
+    std::ostringstream oss;
+    oss.setf(std::ios::fixed);
+    oss.precision(2);
+    oss << "elapsed_ms=" << elapsed_s * 1000.0;
+    oss << " flops=" << flops;
+    oss << " gflops=" << gflops;
+    log_info(oss.str());
+}
+
+// Log arithmetic intensity and percent of peak for one N×N multiply against
+// the all-thread ceilings of this host, measured on first use and cached.
+// Traffic is the compulsory 3*N^2 doubles (A and B read, C written once).
+static void log_roofline(int N, double elapsed_s)
+{
+    perf::Roofline roof;
+    std::string err;
+    if (perf::acquire_roofline(roof, err))
+    {
+        log_info("roofline ceilings measured for host " + roof.host);
+    }
+    if (!err.empty())
+    {
+        log_error(err);
+    }
+    const double n = static_cast<double>(N);
+    const perf::Ceiling ceiling = perf::parallel_ceiling(roof);
+    log_info(perf::format_roofline(
+        ceiling,
+        perf::roofline_point(ceiling, 2.0 * n * n * n, 3.0 * n * n * sizeof(double), elapsed_s)));
+}
+
+// Log a Freivalds result; returns whether it passed.
+static bool log_verification(int N, unsigned int seed, double residual, bool verified,
+                             double verify_s)
+{
+    std::ostringstream oss;
+    oss << "verify=freivalds seed=" << seed
+        << " residual=" << residual
+        << " tol=" << perf::freivalds_tolerance(N);
+    oss.setf(std::ios::fixed);
+    oss.precision(2);
+    oss << " verify_ms=" << verify_s * 1000.0
+        << " status=" << (verified ? "ok" : "FAILED");
+    if (verified)
+    {
+        log_info(oss.str());
+    }
+    else
+    {
+        log_error(oss.str());
+    }
+    return verified;
+}
+
+// Side of the autotuner's sample problem: large enough to leave the caches,
+// small enough that the search takes seconds.
+static const int kTuneSampleN = 512;
+
+// Log the harness statistics and write them as JSON/CSV if requested.
+static void log_bench(const Options& opt, const std::string& mode, const std::vector<double>& samples,
+                      const perf::Stats& stats)
+{
+    log_info(perf::format_stats(stats));
+    std::ostringstream params;
+    params << "N=" << opt.N << " mode=" << mode << " threads=" << perf::default_threads();
+    perf::BenchReport report("assignment3-task2");
+    report.add(params.str(), samples, stats);
+    std::string err;
+    if (!report.write(opt.bench, err))
+    {
+        log_error(err);
+    }
+}
+
+// Log per-thread and total hardware counters of the multiply, if open.
+static void log_counters(const perf::CounterSet& ctr)
+{
+    if (!ctr.is_open())
+    {
+        return;
+    }
+    for (int t = 0; t < ctr.threads(); ++t)
+    {
+        std::ostringstream oss;
+        oss << "counters thread=" << t << " " << perf::format_counters(ctr.read_thread(t));
+        log_info(oss.str());
+    }
+    log_info("counters: " + perf::format_counters(ctr.read_total()));
+}
+
+// Pick the kernel for the in-memory multiply. With tune, search on a sample
+// and save the winner; otherwise load this host's cache. Returns true and
+// fills cfg when the blocked kernel should be used, false when
+// multiply_parallel won or there is no cache.
+static bool configure_kernel(int N, bool tune, assignment3_task2::KernelConfig& cfg)
+{
+    const std::string host = perf::host_name();
+    const std::string path = assignment3_task2::tune_cache_path(host);
+    std::string err;
+    bool blocked = false;
+    if (tune)
+    {
+        const int sample = (N < kTuneSampleN) ? N : kTuneSampleN;
+        assignment3_task2::TuneResult res;
+        const double t0 = now_seconds();
+        assignment3_task2::autotune_kernel(sample, res);
+        std::ostringstream oss;
+        oss.setf(std::ios::fixed);
+        oss.precision(2);
+        oss << "tune: sample_n=" << sample << " evaluations=" << res.evaluations
+            << " base_gflops=" << res.base_gflops << " best_gflops=" << res.gflops
+            << " tune_ms=" << (now_seconds() - t0) * 1000.0;
+        log_info(oss.str());
+        const double gflops = res.blocked ? res.gflops : res.base_gflops;
+        if (!assignment3_task2::save_tune_cache(path, host, res.best, res.blocked, gflops, err))
+        {
+            log_error(err);
+        }
+        cfg = res.best;
+        blocked = res.blocked;
+    }
+    else
+    {
+        double gflops = 0.0;
+        if (!assignment3_task2::load_tune_cache(path, host, cfg, blocked, gflops, err))
+        {
+            log_info("kernel=default (" + err + "; run with --tune to create it)");
+            return false;
+        }
+    }
+    if (blocked)
+    {
+        log_info("kernel=tuned " + assignment3_task2::format_kernel_config(cfg) + " cache=" + path);
+    }
+    else
+    {
+        log_info("kernel=parallel (no blocked configuration beat it) cache=" + path);
+    }
+    return blocked;
+}
+
+// Stop tracing and write the phase trace of all threads to path.
+static void write_trace(const std::string& path)
+{
+    std::vector<perf::TraceEvent> events;
+    const unsigned long dropped = perf::trace_stop(events);
+    std::string err;
+    if (!perf::write_chrome_trace(path, events, std::vector<std::string>(1, "assignment3-task2"),
+                                  err))
+    {
+        log_error(err);
+        return;
+    }
+    std::ostringstream oss;
+    oss << "trace: file=" << path << " events=" << events.size() << " dropped=" << dropped;
+    log_info(oss.str());
 }
 
-// High-resolution wall-clock timer.
-// Uses omp_get_wtime() when OpenMP is available; otherwise std::clock().
-static double now_seconds()
+// Out-of-core mode: generate A and B under dir, multiply tile by tile with
+// prefetch, verify from the files, then remove them. Returns the exit code.
+static int run_out_of_core(const Options& opt)
 {
+    const int N = opt.N;
+    const int tile = (opt.tile > 0)
+        ? opt.tile
+        : assignment3_task2::ooc_tile_for_budget(N, perf::memory_budget_bytes());
+    const std::string pathA = opt.ooc_dir + "/a3t2_A.bin";
+    const std::string pathB = opt.ooc_dir + "/a3t2_B.bin";
+    const std::string pathC = opt.ooc_dir + "/a3t2_C.bin";
+    {
+        std::ostringstream oss;
+        oss.setf(std::ios::fixed);
+        oss.precision(1);
+        oss << "mode=out-of-core dir=" << opt.ooc_dir << " tile=" << tile
+            << " tiles=" << (N + tile - 1) / tile
+            << " tile_mib=" << 6.0 * tile * tile * sizeof(double) / (1024.0 * 1024.0);
 #ifdef _OPENMP
-    return omp_get_wtime();  // More accurate wall-clock time
-#else
-    const std::clock_t c = std::clock();
-    return static_cast<double>(c) / static_cast<double>(CLOCKS_PER_SEC);
+        oss << " threads=" << omp_get_max_threads();
 #endif
+        log_info(oss.str());
+    }
+
+    std::string err;
+    perf::trace_begin("generate");
+    const double tg0 = now_seconds();
+    const bool generated = assignment3_task2::write_input_files(pathA, pathB, N, err);
+    perf::trace_end("generate");
+    if (!generated)
+    {
+        log_error(err);
+        std::remove(pathA.c_str());
+        std::remove(pathB.c_str());
+        return 1;
+    }
+    {
+        std::ostringstream oss;
+        oss.setf(std::ios::fixed);
+        oss.precision(2);
+        oss << "gen_ms=" << (now_seconds() - tg0) * 1000.0;
+        log_info(oss.str());
+    }
+
+    assignment3_task2::OocResult res;
+    int rc = 0;
+    if (!assignment3_task2::multiply_out_of_core(pathA, pathB, pathC, N, tile, res, err))
+    {
+        log_error(err);
+        rc = 1;
+    }
+    else
+    {
+        log_corners(N, res.c00, res.c0L, res.cL0, res.cLL);
+
+        // I/O hidden behind compute: 1 when the kernel never waited
+        const double hidden = (res.io_s > 0.0)
+            ? 1.0 - ((res.wait_s < res.io_s) ? res.wait_s : res.io_s) / res.io_s
+            : 1.0;
+        const double mib = 1024.0 * 1024.0;
+        const double input_bytes = 2.0 * static_cast<double>(N) * static_cast<double>(N) *
+                                   static_cast<double>(sizeof(double));
+        std::ostringstream oss;
+        oss.setf(std::ios::fixed);
+        oss.precision(2);
+        oss << "io: read_mib=" << res.bytes_read / mib
+            << " written_mib=" << res.bytes_written / mib
+            << " reread_factor=" << res.bytes_read / input_bytes
+            << " tile_reads=" << res.tile_reads
+            << " tile_reuses=" << res.tile_reuses
+            << " io_ms=" << res.io_s * 1000.0
+            << " compute_ms=" << res.compute_s * 1000.0
+            << " wait_ms=" << res.wait_s * 1000.0
+            << " overlap=" << hidden * 100.0 << "%";
+        log_info(oss.str());
+
+        const unsigned int seed =
+            static_cast<unsigned int>(std::time(0)) * 2654435761u + 1u;
+        double residual = 0.0;
+        perf::trace_begin("verify");
+        const double tv0 = now_seconds();
+        const bool verified = assignment3_task2::freivalds_verify_files(
+            pathA, pathB, pathC, N, seed, residual, err);
+        perf::trace_end("verify");
+        if (!err.empty())
+        {
+            log_error(err);
+        }
+        if (!log_verification(N, seed, residual, verified, now_seconds() - tv0))
+        {
+            rc = 3;
+        }
+        log_performance(N, res.elapsed_s);
+        const std::vector<double> once(1, res.elapsed_s);
+        log_bench(opt, "out-of-core", once, perf::summarize(once, 0.0));
+        log_roofline(N, res.elapsed_s);
+    }
+
+    std::remove(pathA.c_str());
+    std::remove(pathB.c_str());
+    std::remove(pathC.c_str());
+    if (!opt.trace_path.empty())
+    {
+        write_trace(opt.trace_path);
+    }
+    log_info("assignment3-task2 done");
+    return rc;
 }
 
 int main(int argc, char** argv)
 {
-    int N = 0;
-    if (!parse_N(argc, argv, N))
+    Options opt;
+    if (!parse_args(argc, argv, opt))
     {
         return 1;
     }
+    const int N = opt.N;
+
+    // Asynchronous logging from here on; --log also writes a tagged log file
+    {
+        perf::LogConfig log_cfg;
+        log_cfg.path = opt.bench.log_path;
+        std::string err;
+        if (!perf::log_open(log_cfg, err))
+        {
+            log_error(err);
+            return 1;
+        }
+    }
 
     log_info("assignment3-task2 start");
 
+    // Phase timeline (--trace), written at the end of the run
+    if (!opt.trace_path.empty())
+    {
+        perf::trace_start(0);
+    }
+
     {
         std::ostringstream oss;
         oss << "N=" << N;
         log_info(oss.str());
     }
 
+    if (!opt.ooc_dir.empty())
+    {
+        return run_out_of_core(opt);
+    }
+
     // Detect OpenMP availability at compile time.
     bool parallel = false;
 #ifdef _OPENMP
@@ -143,15 +595,19 @@ int main(int argc, char** argv)
         log_info("mode=serial");
     }
 
+    assignment3_task2::KernelConfig kernel;
+    const bool blocked = configure_kernel(N, opt.tune, kernel);
+
     std::vector<double> A;
     std::vector<double> B;
     std::vector<double> C;
 
     try
     {
+        perf::TraceScope phase("init");
         assignment3_task2::init_A(A, N);
         assignment3_task2::init_B(B, N);
-        C.resize(N * N);
+        C.resize(static_cast<std::size_t>(N) * static_cast<std::size_t>(N));
     }
     catch (const std::bad_alloc&)
     {
@@ -159,63 +615,79 @@ int main(int argc, char** argv)
         return 1;
     }
 
-    const double t0 = now_seconds();
-
-    if (parallel)
+    // Counters follow the threads of the kernel's parallel region: the tuned
+    // count when the blocked kernel sets one, else the runtime default.
+    perf::CounterSet ctr;
+    if (opt.counters)
     {
-        assignment3_task2::multiply_parallel(A, B, C, N);
+        const int threads = (blocked && kernel.threads > 0) ? kernel.threads
+                          : parallel ? perf::default_threads() : 1;
+        std::string err;
+        if (!ctr.open(threads, err))
+        {
+            log_info("counters unavailable: " + err);
+        }
+        else if (!err.empty())
+        {
+            log_info("counters not supported: " + err);
+        }
     }
-    else
+
+    // Warm-up runs, then timed runs; every run overwrites C with the same product
+    perf::Sampler sampler(opt.bench);
+    while (sampler.next())
     {
-        assignment3_task2::multiply_serial(A, B, C, N);
+        perf::TraceScope run(sampler.warming_up() ? "warm-up" : "run");
+        if (!sampler.warming_up())
+        {
+            ctr.start();
+        }
+        if (blocked)
+        {
+            assignment3_task2::multiply_blocked(A, B, C, N, kernel);
+        }
+        else if (parallel)
+        {
+            assignment3_task2::multiply_parallel(A, B, C, N);
+        }
+        else
+        {
+            assignment3_task2::multiply_serial(A, B, C, N);
+        }
+        ctr.stop();
     }
-
-    const double t1 = now_seconds();
-    const double elapsed_s = (t1 > t0) ? (t1 - t0) : 0.0;
-    const double elapsed_ms = elapsed_s * 1000.0;
+    const perf::Stats stats = sampler.stats();
+    const double elapsed_s = stats.median;
 
     // Print corner elements to verify computation (sanity check).
     if (N > 0)
     {
-        const int last = N - 1;
-        const double c00 = C[0 * N + 0];
-        const double c0L = C[0 * N + last];
-        const double cL0 = C[last * N + 0];
-        const double cLL = C[last * N + last];
-
-        std::ostringstream oss;
-        oss.setf(std::ios::fixed);
-        oss.precision(6);
-        oss << "C[0][0]=" << c00
-            << " C[0][" << last << "]=" << c0L
-            << " C[" << last << "][0]=" << cL0
-            << " C[" << last << "][" << last << "]=" << cLL;
-        log_info(oss.str());
+        const std::size_t lastRow = static_cast<std::size_t>(N - 1) * static_cast<std::size_t>(N);
+        log_corners(N, C[0], C[N - 1], C[lastRow], C[lastRow + N - 1]);
     }
 
-    // Compute GFLOPS: matrix multiply is 2*N^3 floating-point operations.
-    const double flops =
-        2.0 *
-        static_cast<double>(N) *
-        static_cast<double>(N) *
-        static_cast<double>(N);
-
-    double gflops = 0.0;
-    if (elapsed_s > 0.0)
-    {
-        gflops = flops / (elapsed_s * 1e9);
-    }
+    // Verify every element of C (not just the corners) in O(N^2).
+    // The seed varies per run and is logged so failures can be reproduced.
+    const unsigned int seed =
+        static_cast<unsigned int>(std::time(0)) * 2654435761u + 1u;
+    double residual = 0.0;
+    perf::trace_begin("verify");
+    const double tv0 = now_seconds();
+    const bool ok = assignment3_task2::freivalds_verify(A, B, C, N, seed, residual);
+    const double tv1 = now_seconds();
+    perf::trace_end("verify");
+    const bool verified =
+        log_verification(N, seed, residual, ok, (tv1 > tv0) ? (tv1 - tv0) : 0.0);
 
+    log_performance(N, elapsed_s);
+    log_bench(opt, blocked ? "tuned" : parallel ? "parallel" : "serial", sampler.samples(), stats);
+    log_roofline(N, elapsed_s);
+    log_counters(ctr);
+    if (!opt.trace_path.empty())
     {
-        std::ostringstream oss;
-        oss.setf(std::ios::fixed);
-        oss.precision(2);
-        oss << "elapsed_ms=" << elapsed_ms;
-        oss << " flops=" << flops;
-        oss << " gflops=" << gflops;
-        log_info(oss.str());
+        write_trace(opt.trace_path);
     }
 
     log_info("assignment3-task2 done");
-    return 0;
+    return verified ? 0 : 3;
 }
@@ -3,6 +3,11 @@
  * Parallel multiplication distributes rows across threads with static scheduling.
  */
 #include "assignment3_task2/matrix.h"
+#include "perf/freivalds.h"
+#include "perf/trace.h"
+
+#include <cmath>
+#include <cstddef>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -11,14 +16,22 @@
 namespace assignment3_task2
 {
     // Convert 2D index (i,j) to 1D row-major offset.
-    static inline int idx(int N, int i, int j)
+    // 64-bit: i * N overflows int once N exceeds 46340.
+    static inline std::size_t idx(int N, int i, int j)
+    {
+        return static_cast<std::size_t>(i) * static_cast<std::size_t>(N) +
+               static_cast<std::size_t>(j);
+    }
+
+    // Number of elements in an N×N matrix, without int overflow.
+    static inline std::size_t elems(int N)
     {
-        return i * N + j;
+        return static_cast<std::size_t>(N) * static_cast<std::size_t>(N);
     }
 
     void init_A(std::vector<double>& A, int N)
     {
-        A.resize(N * N);
+        A.resize(elems(N));
         for (int i = 0; i < N; ++i)
         {
             const double base = static_cast<double>(i + 1);
@@ -31,7 +44,7 @@ namespace assignment3_task2
 
     void init_B(std::vector<double>& B, int N)
     {
-        B.resize(N * N);
+        B.resize(elems(N));
         for (int j = 0; j < N; ++j)
         {
             const double col = 1.0 / static_cast<double>(j + 1);
@@ -47,18 +60,18 @@ namespace assignment3_task2
                          std::vector<double>& C,
                          int N)
     {
-        C.assign(N * N, 0.0);
+        C.assign(elems(N), 0.0);
 
         // Classic triple-loop: C[i][j] = sum_k A[i][k] * B[k][j]
         for (int i = 0; i < N; ++i)
         {
-            const int row = i * N;  // Pre-compute row offset for A and C
+            const std::size_t row = idx(N, i, 0);  // Pre-compute row offset for A and C
             for (int j = 0; j < N; ++j)
             {
                 double sum = 0.0;
                 for (int k = 0; k < N; ++k)
                 {
-                    sum += A[row + k] * B[k * N + j];
+                    sum += A[row + k] * B[idx(N, k, j)];
                 }
                 C[row + j] = sum;
             }
@@ -70,7 +83,7 @@ namespace assignment3_task2
                            std::vector<double>& C,
                            int N)
     {
-        C.assign(N * N, 0.0);
+        C.assign(elems(N), 0.0);
 
 #if defined(_OPENMP)
         // Parallelize outer loop over rows with static scheduling.
@@ -80,13 +93,13 @@ namespace assignment3_task2
         #pragma omp parallel for schedule(static)
         for (int i = 0; i < N; ++i)
         {
-            const int row = i * N;
+            const std::size_t row = idx(N, i, 0);
             for (int j = 0; j < N; ++j)
             {
                 double sum = 0.0;  // Each thread has private sum
                 for (int k = 0; k < N; ++k)
                 {
-                    sum += A[row + k] * B[k * N + j];
+                    sum += A[row + k] * B[idx(N, k, j)];
                 }
                 C[row + j] = sum;  // Each thread writes to distinct C elements
             }
@@ -96,4 +109,142 @@ namespace assignment3_task2
         multiply_serial(A, B, C, N);
 #endif
     }
+
+    KernelConfig::KernelConfig()
+        : block_i(64), block_k(128), block_j(256), order(ORDER_IKJ), threads(0)
+    {
+    }
+
+    void multiply_blocked(const std::vector<double>& A,
+                          const std::vector<double>& B,
+                          std::vector<double>& C,
+                          int N,
+                          const KernelConfig& cfg)
+    {
+        C.assign(elems(N), 0.0);
+        const int bi = (cfg.block_i > 0) ? cfg.block_i : 1;
+        const int bk = (cfg.block_k > 0) ? cfg.block_k : 1;
+        const int bj = (cfg.block_j > 0) ? cfg.block_j : 1;
+        const int row_tiles = (N + bi - 1) / bi;
+
+        // Each thread owns whole row tiles of C, so writes never conflict.
+        // The thread count applies to this region only, not to later ones.
+#if defined(_OPENMP)
+        const int threads = (cfg.threads > 0) ? cfg.threads : omp_get_max_threads();
+        #pragma omp parallel for schedule(static) num_threads(threads)
+#endif
+        for (int t = 0; t < row_tiles; ++t)
+        {
+            perf::TraceScope tile("tile");
+            const int i0 = t * bi;
+            const int i1 = (i0 + bi < N) ? i0 + bi : N;
+            for (int kk = 0; kk < N; kk += bk)
+            {
+                const int k1 = (kk + bk < N) ? kk + bk : N;
+                for (int jj = 0; jj < N; jj += bj)
+                {
+                    const int j1 = (jj + bj < N) ? jj + bj : N;
+                    for (int i = i0; i < i1; ++i)
+                    {
+                        double* c_row = &C[idx(N, i, 0)];
+                        const double* a_row = &A[idx(N, i, 0)];
+                        if (cfg.order == ORDER_IJK)
+                        {
+                            for (int j = jj; j < j1; ++j)
+                            {
+                                double sum = c_row[j];
+                                for (int k = kk; k < k1; ++k)
+                                {
+                                    sum += a_row[k] * B[idx(N, k, j)];
+                                }
+                                c_row[j] = sum;
+                            }
+                        }
+                        else
+                        {
+                            for (int k = kk; k < k1; ++k)
+                            {
+                                const double a = a_row[k];
+                                const double* b_row = &B[idx(N, k, 0)];
+                                for (int j = jj; j < j1; ++j)
+                                {
+                                    c_row[j] += a * b_row[j];
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    bool freivalds_verify(const std::vector<double>& A,
+                          const std::vector<double>& B,
+                          const std::vector<double>& C,
+                          int N,
+                          unsigned int seed,
+                          double& max_residual)
+    {
+        max_residual = 0.0;
+        if (N <= 0)
+        {
+            return true;
+        }
+        const std::size_t n = static_cast<std::size_t>(N);
+
+        std::vector<double> r;
+        perf::freivalds_vector(seed, N, r);
+
+        // Br and |B|r: one pass over B, rows split across threads
+        std::vector<double> Br(n);
+        std::vector<double> absBr(n);
+#if defined(_OPENMP)
+        #pragma omp parallel for schedule(static)
+#endif
+        for (int k = 0; k < N; ++k)
+        {
+            const std::size_t row = static_cast<std::size_t>(k) * n;
+            double s = 0.0;
+            double a = 0.0;
+            for (int j = 0; j < N; ++j)
+            {
+                s += B[row + j] * r[j];
+                a += std::fabs(B[row + j]) * r[j];
+            }
+            Br[k] = s;
+            absBr[k] = a;
+        }
+
+        // Per row: A(Br), its scale and Cr; residuals kept per row because
+        // OpenMP 3.0 has no max reduction
+        std::vector<double> residual(n);
+#if defined(_OPENMP)
+        #pragma omp parallel for schedule(static)
+#endif
+        for (int i = 0; i < N; ++i)
+        {
+            const std::size_t row = static_cast<std::size_t>(i) * n;
+            double abr = 0.0;
+            double scale = 0.0;
+            double cr = 0.0;
+            for (int k = 0; k < N; ++k)
+            {
+                abr += A[row + k] * Br[k];
+                scale += std::fabs(A[row + k]) * absBr[k];
+                cr += C[row + k] * r[k];
+            }
+            const double diff = std::fabs(abr - cr);
+            residual[i] = (scale > 0.0) ? diff / scale : diff;
+        }
+
+        for (int i = 0; i < N; ++i)
+        {
+            // Written so that a NaN residual also fails the check
+            if (!(residual[i] <= max_residual))
+            {
+                max_residual = (residual[i] == residual[i]) ? residual[i] : HUGE_VAL;
+            }
+        }
+        return max_residual <= perf::freivalds_tolerance(N);
+    }
 }
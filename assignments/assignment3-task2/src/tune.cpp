@@ -0,0 +1,263 @@
+/* tune.cpp: Coordinate-descent search over KernelConfig and its cache file.
+ * Each candidate is timed as the best of two runs with perf::now_seconds(),
+ * a wall clock, since std::clock() sums CPU time over threads and would
+ * hide any parallel speedup.
+ */
+#include "assignment3_task2/tune.h"
+#include "perf/bench.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace assignment3_task2
+{
+    // Candidate values per parameter, searched in this order
+    static const int kBlockICandidates[] = {16, 32, 64, 128};
+    static const int kBlockKCandidates[] = {32, 64, 128, 256, 512};
+    static const int kBlockJCandidates[] = {64, 128, 256, 512, 1024};
+    // Full passes of coordinate descent
+    static const int kTunePasses = 2;
+
+    TuneResult::TuneResult()
+        : blocked(false), gflops(0.0), base_gflops(0.0), evaluations(0)
+    {
+    }
+
+    using perf::now_seconds;
+
+    std::string tune_cache_path(const std::string& host)
+    {
+        const char* dir = std::getenv("A3T2_TUNE_DIR");
+        if (!dir || !*dir)
+        {
+            dir = std::getenv("HOME");
+        }
+        const std::string prefix = (dir && *dir) ? std::string(dir) + "/" : std::string();
+        return prefix + ".assignment3-task2-tune-" + host;
+    }
+
+    std::string format_kernel_config(const KernelConfig& cfg)
+    {
+        std::ostringstream oss;
+        oss << "bi=" << cfg.block_i << " bk=" << cfg.block_k << " bj=" << cfg.block_j
+            << " order=" << (cfg.order == ORDER_IJK ? "ijk" : "ikj") << " threads=";
+        if (cfg.threads > 0)
+        {
+            oss << cfg.threads;
+        }
+        else
+        {
+            oss << "default";
+        }
+        return oss.str();
+    }
+
+    bool load_tune_cache(const std::string& path,
+                         const std::string& host,
+                         KernelConfig& cfg,
+                         bool& blocked,
+                         double& gflops,
+                         std::string& err)
+    {
+        std::ifstream in(path.c_str());
+        if (!in)
+        {
+            err = "no tune cache at " + path;
+            return false;
+        }
+        KernelConfig c;
+        std::string file_host;
+        // Files without a kernel line predate the comparison: blocked only
+        std::string kernel = "blocked";
+        gflops = 0.0;
+        std::string line;
+        while (std::getline(in, line))
+        {
+            if (line.empty() || line[0] == '#')
+            {
+                continue;
+            }
+            const std::string::size_type eq = line.find('=');
+            if (eq == std::string::npos)
+            {
+                err = "malformed line in " + path + ": " + line;
+                return false;
+            }
+            const std::string key = line.substr(0, eq);
+            const std::string val = line.substr(eq + 1);
+            const int iv = std::atoi(val.c_str());
+            if (key == "host")          { file_host = val; }
+            else if (key == "kernel")   { kernel = val; }
+            else if (key == "block_i")  { c.block_i = iv; }
+            else if (key == "block_k")  { c.block_k = iv; }
+            else if (key == "block_j")  { c.block_j = iv; }
+            else if (key == "order")    { c.order = (val == "ijk") ? ORDER_IJK : ORDER_IKJ; }
+            else if (key == "threads")  { c.threads = iv; }
+            else if (key == "gflops")   { gflops = std::atof(val.c_str()); }
+            // Unknown keys are ignored so newer files stay readable
+        }
+        if (file_host != host)
+        {
+            err = path + " was tuned for host '" + file_host + "'";
+            return false;
+        }
+        if (c.block_i <= 0 || c.block_k <= 0 || c.block_j <= 0 || c.threads < 0 ||
+            (kernel != "blocked" && kernel != "parallel"))
+        {
+            err = "invalid values in " + path;
+            return false;
+        }
+        cfg = c;
+        blocked = (kernel == "blocked");
+        return true;
+    }
+
+    bool save_tune_cache(const std::string& path,
+                         const std::string& host,
+                         const KernelConfig& cfg,
+                         bool blocked,
+                         double gflops,
+                         std::string& err)
+    {
+        std::ofstream out(path.c_str());
+        if (!out)
+        {
+            err = "cannot write tune cache " + path;
+            return false;
+        }
+        out << "# assignment3-task2 kernel autotune cache (written by --tune)\n"
+            << "host=" << host << "\n"
+            << "kernel=" << (blocked ? "blocked" : "parallel") << "\n"
+            << "block_i=" << cfg.block_i << "\n"
+            << "block_k=" << cfg.block_k << "\n"
+            << "block_j=" << cfg.block_j << "\n"
+            << "order=" << (cfg.order == ORDER_IJK ? "ijk" : "ikj") << "\n"
+            << "threads=" << cfg.threads << "\n"
+            << "gflops=" << gflops << "\n";
+        out.flush();
+        if (!out)
+        {
+            err = "write failed for " + path;
+            return false;
+        }
+        return true;
+    }
+
+    // GFLOPS of multiply_blocked(cfg), or of multiply_parallel when cfg is 0.
+    static double time_kernel(const KernelConfig* cfg,
+                              const std::vector<double>& A,
+                              const std::vector<double>& B,
+                              std::vector<double>& C,
+                              int N)
+    {
+        double best = 0.0;
+        for (int rep = 0; rep < 2; ++rep)
+        {
+            const double t0 = now_seconds();
+            if (cfg)
+            {
+                multiply_blocked(A, B, C, N, *cfg);
+            }
+            else
+            {
+                multiply_parallel(A, B, C, N);
+            }
+            const double dt = now_seconds() - t0;
+            if (rep == 0 || dt < best)
+            {
+                best = dt;
+            }
+        }
+        const double flops = 2.0 * static_cast<double>(N) * static_cast<double>(N) *
+                             static_cast<double>(N);
+        return (best > 0.0) ? flops / (best * 1e9) : 0.0;
+    }
+
+    // Try each value of one parameter, keeping the fastest.
+    static void tune_parameter(KernelConfig& cfg,
+                               int KernelConfig::*field,
+                               const int* values,
+                               int count,
+                               const std::vector<double>& A,
+                               const std::vector<double>& B,
+                               std::vector<double>& C,
+                               int N,
+                               TuneResult& out)
+    {
+        for (int v = 0; v < count; ++v)
+        {
+            if (cfg.*field == values[v])
+            {
+                continue;
+            }
+            KernelConfig trial = cfg;
+            trial.*field = values[v];
+            const double g = time_kernel(&trial, A, B, C, N);
+            ++out.evaluations;
+            if (g > out.gflops)
+            {
+                out.gflops = g;
+                cfg = trial;
+            }
+        }
+    }
+
+    void autotune_kernel(int N, TuneResult& out)
+    {
+        out = TuneResult();
+        std::vector<double> A;
+        std::vector<double> B;
+        std::vector<double> C;
+        init_A(A, N);
+        init_B(B, N);
+
+        // Thread counts: the runtime default, then halvings down to 1
+        std::vector<int> threads;
+#ifdef _OPENMP
+        const int max_threads = omp_get_max_threads();
+        for (int t = max_threads; t >= 1; t /= 2)
+        {
+            threads.push_back(t);
+        }
+#else
+        threads.push_back(1);
+#endif
+
+        out.base_gflops = time_kernel(0, A, B, C, N);
+        KernelConfig cfg;
+        cfg.threads = threads[0];
+        out.gflops = time_kernel(&cfg, A, B, C, N);
+        out.evaluations = 2;
+
+        const int ni = static_cast<int>(sizeof(kBlockICandidates) / sizeof(kBlockICandidates[0]));
+        const int nk = static_cast<int>(sizeof(kBlockKCandidates) / sizeof(kBlockKCandidates[0]));
+        const int nj = static_cast<int>(sizeof(kBlockJCandidates) / sizeof(kBlockJCandidates[0]));
+        for (int pass = 0; pass < kTunePasses; ++pass)
+        {
+            tune_parameter(cfg, &KernelConfig::threads, &threads[0],
+                           static_cast<int>(threads.size()), A, B, C, N, out);
+            tune_parameter(cfg, &KernelConfig::block_j, kBlockJCandidates, nj, A, B, C, N, out);
+            tune_parameter(cfg, &KernelConfig::block_k, kBlockKCandidates, nk, A, B, C, N, out);
+            tune_parameter(cfg, &KernelConfig::block_i, kBlockICandidates, ni, A, B, C, N, out);
+
+            KernelConfig flip = cfg;
+            flip.order = (cfg.order == ORDER_IKJ) ? ORDER_IJK : ORDER_IKJ;
+            const double g = time_kernel(&flip, A, B, C, N);
+            ++out.evaluations;
+            if (g > out.gflops)
+            {
+                out.gflops = g;
+                cfg = flip;
+            }
+        }
+        out.best = cfg;
+        // The blocked kernel must earn its place: ties go to multiply_parallel
+        out.blocked = out.gflops > out.base_gflops;
+    }
+}
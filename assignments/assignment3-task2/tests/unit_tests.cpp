@@ -1,11 +1,16 @@
 // unit_tests.cpp: Unity-based tests for assignment3-task2 matrix operations.
 // Validates correctness of initialization and serial/parallel multiplication.
 #include "assignment3_task2/matrix.h"
+#include "assignment3_task2/ooc.h"
+#include "assignment3_task2/tune.h"
+#include "perf/freivalds.h"
 
 extern "C" {
 #include "vendor/unity/unity.h"
 }
 
+#include <cstdio>
+#include <string>
 #include <vector>
 
 // Test small 2×2 matrix multiplication for known values.
@@ -51,12 +56,169 @@ static void test_parallel_matches_serial_3(void)
     }
 }
 
+// Freivalds check accepts a correct product and rejects one wrong interior
+// element (N=17 so the error is away from the corners the driver prints).
+static void test_freivalds_detects_error(void)
+{
+    const int N = 17;
+    std::vector<double> A;
+    std::vector<double> B;
+    std::vector<double> C;
+
+    assignment3_task2::init_A(A, N);
+    assignment3_task2::init_B(B, N);
+    assignment3_task2::multiply_parallel(A, B, C, N);
+
+    double residual = 1.0;
+    TEST_ASSERT_TRUE(assignment3_task2::freivalds_verify(A, B, C, N, 42u, residual));
+    TEST_ASSERT_TRUE(residual <= perf::freivalds_tolerance(N));
+
+    C[8 * N + 9] *= 1.0 + 1e-6;
+    TEST_ASSERT_TRUE(!assignment3_task2::freivalds_verify(A, B, C, N, 42u, residual));
+}
+
+// Consecutive C tiles of the schedule share one input tile, and every
+// (ci, cj, k) triple appears exactly once.
+static void test_ooc_schedule_reuse(void)
+{
+    const int tiles = 3;
+    std::vector<assignment3_task2::TileStep> steps;
+    assignment3_task2::ooc_schedule(tiles, steps);
+    TEST_ASSERT_TRUE(steps.size() == 27);
+
+    std::vector<int> seen(27, 0);
+    for (size_t s = 0; s < steps.size(); ++s)
+    {
+        ++seen[(steps[s].ci * tiles + steps[s].cj) * tiles + steps[s].k];
+        if (s > 0 && (steps[s].ci != steps[s - 1].ci || steps[s].cj != steps[s - 1].cj))
+        {
+            const bool sameA = steps[s].ci == steps[s - 1].ci && steps[s].k == steps[s - 1].k;
+            const bool sameB = steps[s].k == steps[s - 1].k && steps[s].cj == steps[s - 1].cj;
+            TEST_ASSERT_TRUE(sameA || sameB);
+        }
+    }
+    for (int t = 0; t < 27; ++t)
+    {
+        TEST_ASSERT_TRUE(seen[t] == 1);
+    }
+}
+
+// Out-of-core multiply with ragged tiles (N=37, T=8) matches the in-memory
+// result element by element and passes the file-based Freivalds check.
+static void test_ooc_matches_in_memory(void)
+{
+    const int N = 37;
+    const std::string pathA = "a3t2_test_A.bin";
+    const std::string pathB = "a3t2_test_B.bin";
+    const std::string pathC = "a3t2_test_C.bin";
+    std::string err;
+    TEST_ASSERT_TRUE(assignment3_task2::write_input_files(pathA, pathB, N, err));
+
+    assignment3_task2::OocResult res;
+    TEST_ASSERT_TRUE(assignment3_task2::multiply_out_of_core(pathA, pathB, pathC, N, 8, res, err));
+    TEST_ASSERT_TRUE(res.tile_reuses > 0);
+
+    std::vector<double> A;
+    std::vector<double> B;
+    std::vector<double> C;
+    assignment3_task2::init_A(A, N);
+    assignment3_task2::init_B(B, N);
+    assignment3_task2::multiply_serial(A, B, C, N);
+
+    std::vector<double> Cf(C.size());
+    std::FILE* f = std::fopen(pathC.c_str(), "rb");
+    TEST_ASSERT_TRUE(f != 0);
+    TEST_ASSERT_TRUE(std::fread(&Cf[0], sizeof(double), Cf.size(), f) == Cf.size());
+    std::fclose(f);
+    for (size_t i = 0; i < C.size(); ++i)
+    {
+        TEST_ASSERT_DOUBLE_WITHIN(1e-9, C[i], Cf[i]);
+    }
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, C[C.size() - 1], res.cLL);
+
+    double residual = 1.0;
+    TEST_ASSERT_TRUE(assignment3_task2::freivalds_verify_files(pathA, pathB, pathC, N, 7u,
+                                                               residual, err));
+    std::remove(pathA.c_str());
+    std::remove(pathB.c_str());
+    std::remove(pathC.c_str());
+}
+
+// Blocked kernel with ragged tiles (N=23, blocks 5x7x4) matches the serial
+// product in both loop orders.
+static void test_blocked_matches_serial(void)
+{
+    const int N = 23;
+    std::vector<double> A;
+    std::vector<double> B;
+    std::vector<double> Cs;
+    std::vector<double> Cb;
+    assignment3_task2::init_A(A, N);
+    assignment3_task2::init_B(B, N);
+    assignment3_task2::multiply_serial(A, B, Cs, N);
+
+    assignment3_task2::KernelConfig cfg;
+    cfg.block_i = 5;
+    cfg.block_k = 7;
+    cfg.block_j = 4;
+    for (int o = 0; o < 2; ++o)
+    {
+        cfg.order = (o == 0) ? assignment3_task2::ORDER_IJK : assignment3_task2::ORDER_IKJ;
+        assignment3_task2::multiply_blocked(A, B, Cb, N, cfg);
+        TEST_ASSERT_TRUE(Cb.size() == Cs.size());
+        for (size_t i = 0; i < Cs.size(); ++i)
+        {
+            TEST_ASSERT_DOUBLE_WITHIN(1e-9, Cs[i], Cb[i]);
+        }
+    }
+}
+
+// A saved tune cache reads back unchanged (including the winning kernel) and
+// is rejected for another host.
+static void test_tune_cache_roundtrip(void)
+{
+    const std::string path = "a3t2_test_tune_cache";
+    assignment3_task2::KernelConfig cfg;
+    cfg.block_i = 32;
+    cfg.block_k = 256;
+    cfg.block_j = 1024;
+    cfg.order = assignment3_task2::ORDER_IJK;
+    cfg.threads = 3;
+    std::string err;
+    TEST_ASSERT_TRUE(assignment3_task2::save_tune_cache(path, "nodeA", cfg, true, 12.5, err));
+
+    assignment3_task2::KernelConfig got;
+    bool blocked = false;
+    double gflops = 0.0;
+    TEST_ASSERT_TRUE(assignment3_task2::load_tune_cache(path, "nodeA", got, blocked, gflops, err));
+    TEST_ASSERT_TRUE(blocked);
+    TEST_ASSERT_TRUE(got.block_i == 32);
+    TEST_ASSERT_TRUE(got.block_k == 256);
+    TEST_ASSERT_TRUE(got.block_j == 1024);
+    TEST_ASSERT_TRUE(got.order == assignment3_task2::ORDER_IJK);
+    TEST_ASSERT_TRUE(got.threads == 3);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 12.5, gflops);
+
+    TEST_ASSERT_TRUE(!assignment3_task2::load_tune_cache(path, "nodeB", got, blocked, gflops, err));
+
+    // A host where multiply_parallel won keeps using it
+    TEST_ASSERT_TRUE(assignment3_task2::save_tune_cache(path, "nodeA", cfg, false, 9.0, err));
+    TEST_ASSERT_TRUE(assignment3_task2::load_tune_cache(path, "nodeA", got, blocked, gflops, err));
+    TEST_ASSERT_TRUE(!blocked);
+    std::remove(path.c_str());
+}
+
 int main(void)
 {
     UnityBegin("assignment3-task2");
 
     RUN_TEST(test_small_N_2);
     RUN_TEST(test_parallel_matches_serial_3);
+    RUN_TEST(test_freivalds_detects_error);
+    RUN_TEST(test_ooc_schedule_reuse);
+    RUN_TEST(test_ooc_matches_in_memory);
+    RUN_TEST(test_blocked_matches_serial);
+    RUN_TEST(test_tune_cache_roundtrip);
 
     return UnityEnd();
 }
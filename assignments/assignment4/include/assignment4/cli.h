@@ -1,11 +1,16 @@
 // Command-line interface: parses ping-pong benchmark options.
-// Validates ranges and stores defaults (warmup=10, iters=100, min=4B, max=10MiB, factor=2).
-// Depends on: <string> for error reporting.
+// Validates ranges and stores defaults (warmup=10, iters=100, min=4B, max=10MiB, factor=2,
+// mode=ping-pong, window=64, all collectives, all RMA ops and syncs).
+// Harness output options (--outlier-k, --json, --csv, --log) go to perf::BenchConfig.
+// Depends on: <string> for error reporting, perf/bench.h.
 
 #ifndef ASSIGNMENT4_CLI_H
 #define ASSIGNMENT4_CLI_H
 
 #include <string>
+#include <vector>
+
+#include "perf/bench.h"
 
 namespace assignment4 {
 
@@ -17,7 +22,28 @@ struct Options {
     int min_bytes;  // smallest message size (>=1)
     int max_bytes;  // largest message size (>=min_bytes)
     int factor;     // geometric growth factor (>=2); next_size = current * factor
-    Options() : warmup(10), iters(100), min_bytes(4), max_bytes(10485760), factor(2) {}
+    std::string mode;  // "ping-pong" (latency), "bidir" (simultaneous exchange),
+                       // "stream" (windowed one-way bandwidth), "multipair"
+                       // (P/2 concurrent pairs), "allpairs" (P x P matrix),
+                       // "collectives" (latency of MPI collectives) or "rma"
+                       // (one-sided put/get/accumulate)
+    std::vector<int> windows;  // stream mode: messages in flight per ack, one sweep per value;
+                               // rma mode: operations per epoch (first value)
+    std::vector<std::string> collectives;  // collectives mode: ops to run, in order
+    std::vector<std::string> rma_ops;      // rma mode: put, get, acc
+    std::vector<std::string> rma_syncs;    // rma mode: fence, pscw, lock
+    bool hist;                 // ping-pong: log every histogram bucket per size
+    std::string samples_path;  // ping-pong: raw latencies as CSV (empty = none)
+    perf::BenchConfig bench;  // outlier threshold and JSON/CSV paths (warmup/iters above)
+    Options() : warmup(10), iters(100), min_bytes(4), max_bytes(10485760), factor(2),
+                mode("ping-pong"), windows(1, 64), collectives(default_collectives()),
+                rma_ops(default_rma_ops()), rma_syncs(default_rma_syncs()), hist(false) {}
+
+    // barrier, bcast, reduce, allreduce, allgather, alltoall
+    static std::vector<std::string> default_collectives();
+    // put, get, acc and fence, pscw, lock
+    static std::vector<std::string> default_rma_ops();
+    static std::vector<std::string> default_rma_syncs();
 };
 
 // Parses command-line arguments into Options.
@@ -0,0 +1,52 @@
+// Collective operation latency: MPI_Barrier, MPI_Bcast, MPI_Reduce,
+// MPI_Allreduce, MPI_Allgather and MPI_Alltoall over the message sizes.
+// Every rank times each call; the per-rank medians are reported as
+// min/avg/max across ranks.
+// Depends on: <string>, <vector>, MPI (run_collectives only), Options from cli.h.
+
+#ifndef ASSIGNMENT4_COLLECTIVES_H
+#define ASSIGNMENT4_COLLECTIVES_H
+
+#include <string>
+#include <vector>
+
+namespace assignment4 {
+
+struct Options;
+
+// Benchmarked collectives, in the default run order.
+enum Collective {
+    COLL_BARRIER,
+    COLL_BCAST,
+    COLL_REDUCE,
+    COLL_ALLREDUCE,
+    COLL_ALLGATHER,
+    COLL_ALLTOALL,
+    COLL_COUNT
+};
+
+// Option name of a collective ("barrier", "bcast", ...); "?" if out of range.
+const char* collective_name(int op);
+
+// Inverse of collective_name; -1 for an unknown name.
+int collective_from_name(const std::string& name);
+
+// Bytes each rank contributes per call for a requested size: the reductions
+// work on doubles (MPI_SUM), so their size is rounded up to a multiple of 8;
+// MPI_Barrier moves no data (0). MPI_Allgather and MPI_Alltoall send this
+// much to every rank (P times in total for MPI_Alltoall).
+int collective_bytes(int op, int size);
+
+// Runs each collective named in opt.collectives over 'sizes' (MPI_Barrier
+// once, it has no size) on all ranks, root 0 for MPI_Bcast/MPI_Reduce.
+// Each iteration is timed alone and followed by an untimed barrier, so a
+// call never overlaps the previous one. Rank 0 logs per op and size the
+// min/avg/max over ranks of each rank's median latency. Returns 0 on success.
+int run_collectives(const std::vector<int>& sizes,
+                    const Options& opt,
+                    int rank,
+                    int world);
+
+} // namespace assignment4
+
+#endif
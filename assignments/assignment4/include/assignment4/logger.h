@@ -1,6 +1,7 @@
 // Simple rank-aware logging: root-only info, all-ranks error.
 // Ensures only rank 0 prints results; errors go to stderr for all ranks.
-// Depends on: <string>, <iostream>, <cstdio>.
+// Both go through perf's logger (asynchronous after perf::log_open()).
+// Depends on: <string>, perf_core.
 
 #ifndef ASSIGNMENT4_LOGGER_H
 #define ASSIGNMENT4_LOGGER_H
@@ -10,7 +11,8 @@
 namespace assignment4 {
 
 // Logs info message to stdout only if rank == 0.
-// Prevents duplicate output in multi-rank MPI runs.
+// Prevents duplicate output in multi-rank MPI runs. Once the log is open,
+// every rank's message also reaches its own log file (if any).
 void log_info_root(int rank, const std::string& msg);
 
 // Logs error message to stderr unconditionally.
@@ -0,0 +1,64 @@
+// Multi-pair and all-pairs point-to-point measurements on any number of ranks.
+// Multi-pair: P/2 disjoint pairs ping-pong at the same time (aggregate bandwidth
+// under load). All-pairs: every rank pair in turn, giving P x P latency and
+// bandwidth matrices annotated with intra-node / inter-node placement.
+// The matrix helpers are MPI-free so they can be unit-tested.
+// Depends on: <string>, <vector>, MPI (run_* only), Options from cli.h.
+
+#ifndef ASSIGNMENT4_PAIRS_H
+#define ASSIGNMENT4_PAIRS_H
+
+#include <string>
+#include <vector>
+
+namespace assignment4 {
+
+struct Options;
+
+// Partner of 'rank' in multi-pair mode: rank r < P/2 pairs with r + P/2, so with
+// ranks placed node by node the pairs cross between the two halves of the job.
+// Returns -1 if world is odd or rank is out of range.
+int multipair_partner(int rank, int world);
+
+// Formats a ranks x ranks matrix (row-major, m[i * ranks + j]) with 'precision'
+// decimals, one string per line: a header of rank labels, then one row per rank.
+// Cells of pairs on different nodes (node[i] != node[j]) are marked with '*';
+// the diagonal is '-'.
+std::vector<std::string> format_pair_matrix(const std::vector<double>& m,
+                                            const std::vector<int>& node,
+                                            int ranks,
+                                            int precision);
+
+// One line per placement class present (intra-node, inter-node) over the
+// pairs i < j: pair count, min/median/max of the matrix and the worst pair
+// (highest value if higher_is_worse, else lowest), e.g.
+// "lat_us inter-node pairs=6 min=1.20 median=1.31 max=4.80 worst=r2-r5".
+std::vector<std::string> format_pair_summary(const std::vector<double>& m,
+                                             const std::vector<int>& node,
+                                             int ranks,
+                                             const std::string& name,
+                                             bool higher_is_worse);
+
+// Concurrent ping-pong between the P/2 pairs of multipair_partner, for each
+// size in 'sizes'. Requires an even world >= 2 (MPI_Abort otherwise).
+// Rank 0 logs per size the min/avg/max one-way latency over pairs and the
+// aggregate bandwidth, sum over pairs of size / one-way latency (MB/s).
+// Returns 0 on success.
+int run_multipair(const std::vector<int>& sizes,
+                  const Options& opt,
+                  int rank,
+                  int world);
+
+// Ping-pong between every rank pair, one pair at a time, at the smallest size
+// (latency) and the largest size (bandwidth) of 'sizes'. Requires world >= 2.
+// Rank 0 logs the node placement, both matrices (up to 32 ranks) and their
+// per-class summaries, and writes every pair's samples at both sizes to the
+// JSON/CSV report. Returns 0 on success.
+int run_allpairs(const std::vector<int>& sizes,
+                 const Options& opt,
+                 int rank,
+                 int world);
+
+} // namespace assignment4
+
+#endif
@@ -1,5 +1,7 @@
-// MPI ping-pong latency measurement between rank 0 and rank 1.
-// Uses MPI_Send/MPI_Recv for synchronous point-to-point timing.
+// MPI point-to-point measurements between rank 0 and rank 1.
+// Ping-pong uses MPI_Send/MPI_Recv for latency; the bidirectional mode
+// exchanges messages both ways at once with MPI_Irecv/MPI_Isend, and the
+// streaming mode keeps a window of sends in flight for one-way bandwidth.
 // Depends on: <vector>, MPI, Options from cli.h.
 
 #ifndef ASSIGNMENT4_PINGPONG_H
@@ -15,12 +17,33 @@ struct Options;
 // Preconditions: world == 2, rank in {0,1}, MPI_Init already called.
 // Rank 0 sends/receives and measures round-trip time; rank 1 echoes silently.
 // Returns 0 on success, 1 on error (calls MPI_Abort on fatal errors).
-// Latency = (round_trip_time / (2 * iters)) * 1e6 microseconds.
+// Each round trip is timed; latency = median(round_trip_time / 2) * 1e6 microseconds,
+// logged with min/mean/stddev/CI and written to opt.bench's JSON/CSV files.
 int run_pingpong(const std::vector<int>& sizes,
                  const Options& opt,
                  int rank,
                  int world);
 
+// Runs the bidirectional (full-duplex) benchmark for each size in 'sizes'.
+// Same preconditions and return value as run_pingpong. In every iteration
+// both ranks post MPI_Irecv, then MPI_Isend, then wait for both; rank 0 times
+// the exchange. Logs the median exchange time as latency_us and the aggregate
+// bandwidth of both directions, bw_mbs = 2 * bytes / median / 1e6 (MB/s).
+int run_bidir(const std::vector<int>& sizes,
+              const Options& opt,
+              int rank,
+              int world);
+
+// Runs the streaming (osu_bw style) benchmark for each window in opt.windows
+// and each size in 'sizes'. Same preconditions and return value as run_pingpong.
+// In every iteration rank 0 posts W MPI_Isend and waits for them, rank 1 posts
+// W MPI_Irecv, waits, then sends a zero-byte ack that rank 0 receives.
+// Rank 0 times the iteration; bw_mbs = W * bytes / median / 1e6 (MB/s).
+int run_stream(const std::vector<int>& sizes,
+               const Options& opt,
+               int rank,
+               int world);
+
 } // namespace assignment4
 
 #endif
@@ -0,0 +1,62 @@
+// One-sided (RMA) latency and bandwidth between rank 0 (origin) and rank 1
+// (target): MPI_Put, MPI_Get and MPI_Accumulate, each under fence,
+// post-start-complete-wait (PSCW) and passive-target lock synchronization.
+// Each size also gets the two-sided reference (ping-pong latency, streaming
+// bandwidth) from the same run, to compare like with like.
+// Depends on: <string>, <vector>, MPI (run_rma only), Options from cli.h.
+
+#ifndef ASSIGNMENT4_RMA_H
+#define ASSIGNMENT4_RMA_H
+
+#include <string>
+#include <vector>
+
+namespace assignment4 {
+
+struct Options;
+
+// One-sided operations, in the default run order.
+enum RmaOp {
+    RMA_PUT,
+    RMA_GET,
+    RMA_ACC,
+    RMA_OP_COUNT
+};
+
+// Synchronization of an access epoch, in the default run order.
+enum RmaSync {
+    SYNC_FENCE,
+    SYNC_PSCW,
+    SYNC_LOCK,
+    SYNC_COUNT
+};
+
+// Option names: "put", "get", "acc" and "fence", "pscw", "lock"; "?" if out of range.
+const char* rma_op_name(int op);
+const char* rma_sync_name(int sync);
+
+// Inverses of the above; -1 for an unknown name.
+int rma_op_from_name(const std::string& name);
+int rma_sync_from_name(const std::string& name);
+
+// Bytes moved per operation for a requested size: MPI_Accumulate adds doubles
+// (MPI_SUM), so its size is rounded up to a multiple of 8.
+int rma_bytes(int op, int size);
+
+// Runs every op in opt.rma_ops under every sync in opt.rma_syncs over 'sizes'.
+// Preconditions: world == 2 (MPI_Abort otherwise), MPI_Init already called.
+// Latency: one operation per epoch, rank 0 times the epoch. MPI_Win_fence and
+// MPI_Win_unlock return once the operation is complete at the target;
+// MPI_Win_complete only completes it at the origin (the target waits in
+// MPI_Win_wait). Bandwidth: W = opt.windows[0] (the CLI allows one value)
+// operations per epoch, bw_mbs = W * bytes / median epoch / 1e6. The two-sided
+// reference is measured at the same byte count (rma_bytes).
+// Returns 0 on success.
+int run_rma(const std::vector<int>& sizes,
+            const Options& opt,
+            int rank,
+            int world);
+
+} // namespace assignment4
+
+#endif
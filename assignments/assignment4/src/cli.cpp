@@ -1,8 +1,12 @@
 // Command-line parser for ping-pong benchmark options.
-// Handles --warmup, --iters, --min-bytes, --max-bytes, --factor.
+// Handles --warmup, --iters, --min-bytes, --max-bytes, --factor, --mode, --window,
+// --ops, --rma-ops, --sync, --hist, --samples, and the harness's
+// --outlier-k, --json, --csv, --log (perf/bench.h).
 // Uses strtol for safe integer parsing; validates constraints.
 
 #include "assignment4/cli.h"
+#include "assignment4/collectives.h"
+#include "assignment4/rma.h"
 #include <cstdlib>
 #include <cerrno>
 #include <climits>
@@ -23,10 +27,69 @@ bool parse_int(const char* s, int& out) {
     return true;
 }
 
+// Comma-separated items, e.g. "put,get"; empty items are kept (and rejected
+// by the callers)
+void split_list(const char* s, std::vector<std::string>& out) {
+    out.clear();
+    const std::string all = s ? s : "";
+    std::string::size_type pos = 0;
+    while (true) {
+        const std::string::size_type comma = all.find(',', pos);
+        out.push_back(all.substr(pos, comma == std::string::npos ? std::string::npos
+                                                                 : comma - pos));
+        if (comma == std::string::npos) return;
+        pos = comma + 1;
+    }
+}
+
+// Comma-separated positive integers, e.g. "1,8,64"
+bool parse_int_list(const char* s, std::vector<int>& out) {
+    std::vector<std::string> items;
+    split_list(s, items);
+    out.clear();
+    for (std::size_t k = 0; k < items.size(); ++k) {
+        int v;
+        if (!parse_int(items[k].c_str(), v) || v <= 0) return false;
+        out.push_back(v);
+    }
+    return true;
+}
+
+// Comma-separated names, each accepted by valid (returns >= 0 for a known name)
+bool parse_name_list(const char* s, int (*valid)(const std::string&),
+                     std::vector<std::string>& out, std::string& bad) {
+    split_list(s, out);
+    for (std::size_t k = 0; k < out.size(); ++k) {
+        if (valid(out[k]) < 0) { bad = out[k]; return false; }
+    }
+    return true;
+}
+
 }
 
 namespace assignment4 {
 
+std::vector<std::string> Options::default_collectives()
+{
+    std::vector<std::string> ops;
+    for (int op = 0; op < COLL_COUNT; ++op) ops.push_back(collective_name(op));
+    return ops;
+}
+
+std::vector<std::string> Options::default_rma_ops()
+{
+    std::vector<std::string> ops;
+    for (int op = 0; op < RMA_OP_COUNT; ++op) ops.push_back(rma_op_name(op));
+    return ops;
+}
+
+std::vector<std::string> Options::default_rma_syncs()
+{
+    std::vector<std::string> syncs;
+    for (int sync = 0; sync < SYNC_COUNT; ++sync) syncs.push_back(rma_sync_name(sync));
+    return syncs;
+}
+
 bool parse_cli(int argc, char** argv, Options& opt, std::string& err)
 {
     int i = 1;
@@ -64,6 +127,65 @@ bool parse_cli(int argc, char** argv, Options& opt, std::string& err)
             if (v < 2) { err = "--factor must be >= 2"; return false; }
             opt.factor = v; i += 2; continue;
         }
+        if (0 == std::strcmp(a, "--mode")) {
+            if (i + 1 >= argc) { err = "missing value for --mode"; return false; }
+            const std::string v = argv[i+1];
+            if (v != "ping-pong" && v != "bidir" && v != "stream" &&
+                v != "multipair" && v != "allpairs" && v != "collectives" && v != "rma") {
+                err = "--mode must be ping-pong, bidir, stream, multipair, allpairs, collectives"
+                      " or rma";
+                return false;
+            }
+            opt.mode = v; i += 2; continue;
+        }
+        if (0 == std::strcmp(a, "--window")) {
+            if (i + 1 >= argc) { err = "missing value for --window"; return false; }
+            if (!parse_int_list(argv[i+1], opt.windows)) {
+                err = "--window must be a comma-separated list of values > 0"; return false;
+            }
+            i += 2; continue;
+        }
+        if (0 == std::strcmp(a, "--ops")) {
+            if (i + 1 >= argc) { err = "missing value for --ops"; return false; }
+            std::string bad;
+            if (!parse_name_list(argv[i+1], collective_from_name, opt.collectives, bad)) {
+                err = "invalid --ops entry '" + bad +
+                      "' (barrier, bcast, reduce, allreduce, allgather, alltoall)";
+                return false;
+            }
+            i += 2; continue;
+        }
+        if (0 == std::strcmp(a, "--rma-ops")) {
+            if (i + 1 >= argc) { err = "missing value for --rma-ops"; return false; }
+            std::string bad;
+            if (!parse_name_list(argv[i+1], rma_op_from_name, opt.rma_ops, bad)) {
+                err = "invalid --rma-ops entry '" + bad + "' (put, get, acc)"; return false;
+            }
+            i += 2; continue;
+        }
+        if (0 == std::strcmp(a, "--sync")) {
+            if (i + 1 >= argc) { err = "missing value for --sync"; return false; }
+            std::string bad;
+            if (!parse_name_list(argv[i+1], rma_sync_from_name, opt.rma_syncs, bad)) {
+                err = "invalid --sync entry '" + bad + "' (fence, pscw, lock)"; return false;
+            }
+            i += 2; continue;
+        }
+        if (0 == std::strcmp(a, "--hist")) {
+            opt.hist = true; i += 1; continue;
+        }
+        if (0 == std::strcmp(a, "--samples")) {
+            if (i + 1 >= argc || argv[i+1][0] == '\0') { err = "missing value for --samples"; return false; }
+            opt.samples_path = argv[i+1]; i += 2; continue;
+        }
+
+        // Round trips are repeated by --warmup/--iters; only the harness's
+        // outlier and output options apply here
+        if (0 == std::strcmp(a, "--outlier-k") || 0 == std::strcmp(a, "--json") ||
+            0 == std::strcmp(a, "--csv") || 0 == std::strcmp(a, "--log")) {
+            if (perf::parse_bench_option(argc, argv, i, opt.bench, err) < 0) return false;
+            continue;
+        }
 
         err = std::string("invalid option: ") + a;
         return false;
@@ -71,6 +193,9 @@ bool parse_cli(int argc, char** argv, Options& opt, std::string& err)
 
     // Final cross-field validation
     if (opt.min_bytes > opt.max_bytes) { err = "min-bytes must be <= max-bytes"; return false; }
+    if (opt.mode == "rma" && opt.windows.size() > 1) {
+        err = "--mode rma takes a single --window value"; return false;
+    }
     return true;
 }
 
@@ -0,0 +1,157 @@
+// Collective latency benchmark: every rank times each call of the collective
+// and keeps the median; rank 0 gathers the medians and reports their spread.
+// Buffers are sized for the largest size once per collective.
+
+#include "assignment4/collectives.h"
+#include "assignment4/cli.h"
+#include "assignment4/logger.h"
+#include "common.h"
+#include "perf/bench.h"
+
+#include <climits>
+#include <sstream>
+
+#include <mpi.h>
+
+namespace assignment4 {
+
+namespace {
+
+const char* const kNames[COLL_COUNT] = {
+    "barrier", "bcast", "reduce", "allreduce", "allgather", "alltoall"
+};
+
+// One call of 'op' with 'bytes' per rank (see collective_bytes)
+void call_collective(int op, int bytes, std::vector<char>& sendbuf, std::vector<char>& recvbuf)
+{
+    const int doubles = bytes / static_cast<int>(sizeof(double));
+    switch (op) {
+    case COLL_BARRIER:
+        MPI_Barrier(MPI_COMM_WORLD);
+        break;
+    case COLL_BCAST:
+        MPI_Bcast(&sendbuf[0], bytes, MPI_BYTE, 0, MPI_COMM_WORLD);
+        break;
+    case COLL_REDUCE:
+        MPI_Reduce(&sendbuf[0], &recvbuf[0], doubles, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        break;
+    case COLL_ALLREDUCE:
+        MPI_Allreduce(&sendbuf[0], &recvbuf[0], doubles, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+        break;
+    case COLL_ALLGATHER:
+        MPI_Allgather(&sendbuf[0], bytes, MPI_BYTE, &recvbuf[0], bytes, MPI_BYTE, MPI_COMM_WORLD);
+        break;
+    case COLL_ALLTOALL:
+        MPI_Alltoall(&sendbuf[0], bytes, MPI_BYTE, &recvbuf[0], bytes, MPI_BYTE, MPI_COMM_WORLD);
+        break;
+    default:
+        break;
+    }
+}
+
+} // namespace
+
+const char* collective_name(int op)
+{
+    return (op >= 0 && op < COLL_COUNT) ? kNames[op] : "?";
+}
+
+int collective_from_name(const std::string& name)
+{
+    for (int op = 0; op < COLL_COUNT; ++op) {
+        if (name == kNames[op]) return op;
+    }
+    return -1;
+}
+
+int collective_bytes(int op, int size)
+{
+    switch (op) {
+    case COLL_BARRIER:
+        return 0;
+    case COLL_REDUCE:
+    case COLL_ALLREDUCE:
+        return round_up_to_doubles(size);
+    default:
+        return size;
+    }
+}
+
+int run_collectives(const std::vector<int>& sizes,
+                    const Options& opt,
+                    int rank,
+                    int world)
+{
+    log_settings(sizes, opt, rank, world);
+
+    perf::BenchReport report("assignment4");
+    std::vector<double> samples;
+    std::vector<double> medians(rank == 0 ? world : 1);
+
+    for (std::size_t c = 0; c < opt.collectives.size(); ++c) {
+        const int op = collective_from_name(opt.collectives[c]);
+
+        // MPI_Barrier has no size; the gathers and all-to-all need a slot per rank
+        std::vector<int> op_sizes = (op == COLL_BARRIER) ? std::vector<int>(1, 0) : sizes;
+        const int max_bytes = op_sizes.empty() ? 0 : collective_bytes(op, op_sizes.back());
+        const int slot = (max_bytes > 0) ? max_bytes : 1;
+        const int send_slots = (op == COLL_ALLTOALL) ? world : 1;
+        const int recv_slots = (op == COLL_ALLGATHER || op == COLL_ALLTOALL) ? world : 1;
+        if (static_cast<double>(recv_slots) * slot > INT_MAX) {
+            if (rank == 0) {
+                std::ostringstream oss;
+                oss << collective_name(op) << " needs " << recv_slots << " x " << slot
+                    << " B per rank, over 2 GiB; lower --max-bytes";
+                log_error(oss.str());
+            }
+            MPI_Abort(MPI_COMM_WORLD, 1);
+            return 1;
+        }
+        std::vector<char> sendbuf, recvbuf;
+        allocate(sendbuf, send_slots * slot, rank);
+        allocate(recvbuf, recv_slots * slot, rank);
+
+        for (std::size_t i = 0; i < op_sizes.size(); ++i) {
+            const int bytes = collective_bytes(op, op_sizes[i]);
+
+            MPI_Barrier(MPI_COMM_WORLD);
+            for (int w = 0; w < opt.warmup; ++w) {
+                call_collective(op, bytes, sendbuf, recvbuf);
+                MPI_Barrier(MPI_COMM_WORLD);
+            }
+
+            samples.clear();
+            for (int it = 0; it < opt.iters; ++it) {
+                const double t0 = perf::now_seconds();
+                call_collective(op, bytes, sendbuf, recvbuf);
+                samples.push_back(perf::now_seconds() - t0);
+                MPI_Barrier(MPI_COMM_WORLD);
+            }
+
+            double median = perf::summarize(samples, opt.bench.outlier_k).median;
+            MPI_Gather(&median, 1, MPI_DOUBLE, &medians[0], 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+            if (rank == 0) {
+                // One sample per rank: the spread is between ranks
+                const perf::Stats s = perf::summarize(medians, 0.0);
+
+                std::ostringstream oss;
+                oss.setf(std::ios::fixed);
+                oss.precision(2);
+                oss << "op=" << collective_name(op) << " size=" << bytes
+                    << " B lat_us_min=" << s.min * 1e6 << " lat_us_avg=" << s.mean * 1e6
+                    << " lat_us_max=" << s.max * 1e6;
+                log_info_root(rank, oss.str());
+
+                std::ostringstream params;
+                params << "mode=collectives op=" << collective_name(op) << " bytes=" << bytes;
+                report.add(params.str(), medians, s);
+            }
+        }
+    }
+
+    write_report(report, opt, rank);
+    return 0;
+}
+
+} // namespace assignment4
@@ -0,0 +1,95 @@
+// Helpers shared by the benchmark modes: rank check, settings line, allocation,
+// streaming window, report.
+
+#include "common.h"
+#include "assignment4/cli.h"
+#include "assignment4/logger.h"
+
+#include <new>
+#include <sstream>
+#include <string>
+
+#include <mpi.h>
+
+namespace assignment4 {
+
+void require_two_ranks(int rank, int world)
+{
+    if (world != 2) {
+        if (rank == 0) {
+            std::ostringstream oss;
+            oss << "world size must be 2 (got " << world << ")";
+            log_error(oss.str());
+        }
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+}
+
+int round_up_to_doubles(int bytes)
+{
+    const int d = static_cast<int>(sizeof(double));
+    return (bytes <= d) ? d : ((bytes % d) ? bytes + d - bytes % d : bytes);
+}
+
+void log_settings(const std::vector<int>& sizes, const Options& opt, int rank, int world)
+{
+    std::ostringstream oss;
+    oss << "ranks=" << world
+        << " warmup=" << opt.warmup
+        << " iters=" << opt.iters
+        << " min=" << (sizes.empty() ? 0 : sizes.front())
+        << " max=" << (sizes.empty() ? 0 : sizes.back())
+        << " factor=" << opt.factor;
+    log_info_root(rank, oss.str());
+    log_info_root(rank, "mode=" + opt.mode);
+}
+
+// Sizes the buffer (peers need the same size); aborts if memory runs out
+void allocate(std::vector<char>& buf, int bytes, int rank)
+{
+    try { buf.resize(bytes); }
+    catch (const std::bad_alloc&) {
+        if (rank == 0) {
+            std::ostringstream oss; oss << "allocation failed for size=" << bytes;
+            log_error(oss.str());
+        }
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+}
+
+// The files record this benchmark's own warm-up and iteration counts
+void write_report(const perf::BenchReport& report, const Options& opt, int rank)
+{
+    perf::BenchConfig out = opt.bench;
+    out.warmup = opt.warmup;
+    out.reps = opt.iters;
+    std::string err;
+    if (rank == 0 && !report.write(out, err)) {
+        log_error(err);
+    }
+}
+
+// As in osu_bw, all W messages use one buffer on each side: the contents are
+// never read, only the transfer counts
+void stream_window(std::vector<char>& buf, std::vector<MPI_Request>& req, int bytes,
+                   int rank)
+{
+    const int TAG_DATA = 103;
+    const int TAG_ACK = 104;
+    const int window = static_cast<int>(req.size());
+    if (rank == 0) {
+        for (int k = 0; k < window; ++k) {
+            MPI_Isend(&buf[0], bytes, MPI_BYTE, 1, TAG_DATA, MPI_COMM_WORLD, &req[k]);
+        }
+        MPI_Waitall(window, &req[0], MPI_STATUSES_IGNORE);
+        MPI_Recv(&buf[0], 0, MPI_BYTE, 1, TAG_ACK, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    } else {
+        for (int k = 0; k < window; ++k) {
+            MPI_Irecv(&buf[0], bytes, MPI_BYTE, 0, TAG_DATA, MPI_COMM_WORLD, &req[k]);
+        }
+        MPI_Waitall(window, &req[0], MPI_STATUSES_IGNORE);
+        MPI_Send(&buf[0], 0, MPI_BYTE, 0, TAG_ACK, MPI_COMM_WORLD);
+    }
+}
+
+} // namespace assignment4
@@ -0,0 +1,45 @@
+// Helpers shared by the benchmark modes (pingpong.cpp, pairs.cpp, collectives.cpp,
+// rma.cpp): the rank check, settings line, reduction sizes, buffer allocation, the
+// streaming window and the JSON/CSV report.
+// Internal header (src/), not installed. Depends on: <vector>, perf/bench.h, MPI.
+
+#ifndef ASSIGNMENT4_COMMON_H
+#define ASSIGNMENT4_COMMON_H
+
+#include <vector>
+
+#include "perf/bench.h"
+
+#include <mpi.h>
+
+namespace assignment4 {
+
+struct Options;
+
+// MPI_Abort unless world == 2 (ping-pong, bidir, stream, rma).
+void require_two_ranks(int rank, int world);
+
+// Logs the sweep settings and "mode=<mode>" (rank 0).
+void log_settings(const std::vector<int>& sizes, const Options& opt, int rank, int world);
+
+// Bytes of a reduction over doubles for a requested size: rounded up to a
+// multiple of sizeof(double), at least one double.
+int round_up_to_doubles(int bytes);
+
+// Sizes the buffer (peers need the same size); MPI_Abort if memory runs out.
+void allocate(std::vector<char>& buf, int bytes, int rank);
+
+// One streaming window between ranks 0 and 1: rank 0 sends req.size()
+// messages of 'bytes' with MPI_Isend, rank 1 receives them and acknowledges
+// with an empty message. Used by stream mode and as the two-sided reference
+// of the RMA modes.
+void stream_window(std::vector<char>& buf, std::vector<MPI_Request>& req, int bytes,
+                   int rank);
+
+// Writes the report to opt.bench's JSON/CSV files (rank 0) with the
+// benchmark's own warm-up and iteration counts.
+void write_report(const perf::BenchReport& report, const Options& opt, int rank);
+
+} // namespace assignment4
+
+#endif
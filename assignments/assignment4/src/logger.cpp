@@ -1,23 +1,23 @@
 // Minimal logging utilities for MPI applications.
 // log_info_root: only rank 0 prints to stdout (avoids duplicate output).
 // log_error: all ranks print to stderr for debugging.
+// With the log open, the console filter is perf::LogConfig::console instead.
 
 #include "assignment4/logger.h"
-#include <iostream>
-#include <cstdio>
+#include "perf/log.h"
 
 namespace assignment4 {
 
 void log_info_root(int rank, const std::string& msg)
 {
-    if (rank == 0) {
-        std::cout << "[INFO] " << msg << std::endl;
+    if (rank == 0 || perf::log_is_open()) {
+        perf::log_write(perf::LOG_INFO, msg);
     }
 }
 
 void log_error(const std::string& msg)
 {
-    std::fprintf(stderr, "[ERROR] %s\n", msg.c_str());
+    perf::log_write(perf::LOG_ERROR, msg);
 }
 
 } // namespace assignment4
@@ -6,6 +6,10 @@
 #include "assignment4/logger.h"
 #include "assignment4/sizes.h"
 #include "assignment4/pingpong.h"
+#include "assignment4/pairs.h"
+#include "assignment4/collectives.h"
+#include "assignment4/rma.h"
+#include "perf/log.h"
 
 #include <mpi.h>
 #include <vector>
@@ -28,27 +32,55 @@ int main(int argc, char** argv)
     if (!parse_cli(argc, argv, opt, err)) {
         if (rank == 0) {
             log_error(err);
-            std::fprintf(stderr, "Usage: assignment4 [--warmup 10] [--iters 100] [--min-bytes 4] [--max-bytes 10485760] [--factor 2]\n");
+            std::fprintf(stderr, "Usage: assignment4 [--warmup 10] [--iters 100] [--min-bytes 4] [--max-bytes 10485760] [--factor 2] [--mode ping-pong|bidir|stream|multipair|allpairs|collectives|rma] [--window 64[,W...]] [--ops bcast,...] [--rma-ops put,get,acc] [--sync fence,pscw,lock] [--hist] [--samples FILE] [--outlier-k K] [--json FILE] [--csv FILE] [--log FILE]\n");
         }
         MPI_Finalize();
         return 1;
     }
 
+    // Asynchronous logging from here on; --log FILE gives each rank FILE.<rank>
+    perf::LogConfig log_cfg;
+    log_cfg.rank = rank;
+    log_cfg.ranks = world;
+    log_cfg.console = (rank == 0);
+    log_cfg.path = opt.bench.log_path;
+    if (!perf::log_open(log_cfg, err)) {
+        log_error(err);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
     log_info_root(rank, "assignment4 start");
 
     std::vector<int> sizes;
     if (!make_sizes(opt.min_bytes, opt.max_bytes, opt.factor, sizes)) {
         if (rank == 0) log_error("invalid size parameters");
+        perf::log_close();
         MPI_Finalize();
         return 1;
     }
 
-    const int rc = run_pingpong(sizes, opt, rank, world);
+    int rc = 0;
+    if (opt.mode == "bidir") {
+        rc = run_bidir(sizes, opt, rank, world);
+    } else if (opt.mode == "stream") {
+        rc = run_stream(sizes, opt, rank, world);
+    } else if (opt.mode == "multipair") {
+        rc = run_multipair(sizes, opt, rank, world);
+    } else if (opt.mode == "allpairs") {
+        rc = run_allpairs(sizes, opt, rank, world);
+    } else if (opt.mode == "collectives") {
+        rc = run_collectives(sizes, opt, rank, world);
+    } else if (opt.mode == "rma") {
+        rc = run_rma(sizes, opt, rank, world);
+    } else {
+        rc = run_pingpong(sizes, opt, rank, world);
+    }
 
     if (rc == 0) {
         log_info_root(rank, "assignment4 done");
     }
 
+    perf::log_close();
     MPI_Finalize();
     return (rc == 0) ? 0 : 1;
 }
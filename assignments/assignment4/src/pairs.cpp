@@ -0,0 +1,349 @@
+// Multi-pair and all-pairs ping-pong on any number of ranks.
+// Multi-pair runs P/2 disjoint ping-pongs at once and sums their bandwidth.
+// All-pairs runs one pair at a time (the others wait at a barrier) and builds
+// latency and bandwidth matrices. Node placement comes from
+// MPI_Comm_split_type (MPI-3), or processor names on older MPI.
+
+#include "assignment4/pairs.h"
+#include "assignment4/cli.h"
+#include "assignment4/logger.h"
+#include "common.h"
+#include "perf/bench.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+#include <mpi.h>
+
+namespace assignment4 {
+
+namespace {
+
+const int TAG_PING = 110;
+const int TAG_PONG = 111;
+const int TAG_SAMPLES = 112;
+
+// 'count' round trips with peer; the initiator appends half of each to samples
+void round_trips(std::vector<char>& buf, int bytes, int peer, bool initiator, int count,
+                 std::vector<double>* samples)
+{
+    for (int it = 0; it < count; ++it) {
+        if (initiator) {
+            const double t0 = perf::now_seconds();
+            MPI_Send(&buf[0], bytes, MPI_BYTE, peer, TAG_PING, MPI_COMM_WORLD);
+            MPI_Recv(&buf[0], bytes, MPI_BYTE, peer, TAG_PONG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            if (samples) samples->push_back(0.5 * (perf::now_seconds() - t0));
+        } else {
+            MPI_Recv(&buf[0], bytes, MPI_BYTE, peer, TAG_PING, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            MPI_Send(&buf[0], bytes, MPI_BYTE, peer, TAG_PONG, MPI_COMM_WORLD);
+        }
+    }
+}
+
+// Median one-way latency (seconds) of warm-up plus measured round trips;
+// only meaningful on the initiator, which also keeps the per-round-trip samples
+double measure_pair(std::vector<char>& buf, int bytes, int peer, bool initiator,
+                    const Options& opt, std::vector<double>& samples)
+{
+    samples.clear();
+    round_trips(buf, bytes, peer, initiator, opt.warmup, 0);
+    round_trips(buf, bytes, peer, initiator, opt.iters, &samples);
+    return initiator ? perf::summarize(samples, opt.bench.outlier_k).median : 0.0;
+}
+
+// Node of every world rank, as the lowest world rank on the same node
+std::vector<int> node_of_ranks(int rank, int world)
+{
+    int leader = rank;
+#if defined(MPI_VERSION) && MPI_VERSION >= 3
+    MPI_Comm node_comm;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node_comm);
+    MPI_Allreduce(&rank, &leader, 1, MPI_INT, MPI_MIN, node_comm);
+    MPI_Comm_free(&node_comm);
+#else
+    // MPI-2: ranks reporting the same processor name share a node
+    char name[MPI_MAX_PROCESSOR_NAME];
+    std::memset(name, 0, sizeof(name));
+    int len = 0;
+    MPI_Get_processor_name(name, &len);
+    std::vector<char> all(static_cast<std::size_t>(world) * MPI_MAX_PROCESSOR_NAME);
+    MPI_Allgather(name, MPI_MAX_PROCESSOR_NAME, MPI_CHAR,
+                  &all[0], MPI_MAX_PROCESSOR_NAME, MPI_CHAR, MPI_COMM_WORLD);
+    for (int r = 0; r < world; ++r) {
+        if (0 == std::strncmp(&all[r * MPI_MAX_PROCESSOR_NAME], name, MPI_MAX_PROCESSOR_NAME)) {
+            leader = r;
+            break;
+        }
+    }
+#endif
+    std::vector<int> node(world, 0);
+    MPI_Allgather(&leader, 1, MPI_INT, &node[0], 1, MPI_INT, MPI_COMM_WORLD);
+    return node;
+}
+
+std::string fixed(double v, int precision)
+{
+    char buf[48];
+    std::sprintf(buf, "%.*f", precision, v);
+    return buf;
+}
+
+std::string pad(const std::string& s, std::size_t width)
+{
+    return (s.size() >= width) ? s : std::string(width - s.size(), ' ') + s;
+}
+
+std::string rank_label(int r)
+{
+    std::ostringstream oss;
+    oss << "r" << r;
+    return oss.str();
+}
+
+} // namespace
+
+int multipair_partner(int rank, int world)
+{
+    if (world < 2 || world % 2 != 0 || rank < 0 || rank >= world) return -1;
+    const int half = world / 2;
+    return (rank < half) ? rank + half : rank - half;
+}
+
+std::vector<std::string> format_pair_matrix(const std::vector<double>& m,
+                                            const std::vector<int>& node,
+                                            int ranks,
+                                            int precision)
+{
+    std::vector<std::string> lines;
+    std::string header = pad("", 6);
+    for (int j = 0; j < ranks; ++j) {
+        header += pad(rank_label(j), 9) + " ";
+    }
+    lines.push_back(header);
+    for (int i = 0; i < ranks; ++i) {
+        std::string row = pad(rank_label(i), 6);
+        for (int j = 0; j < ranks; ++j) {
+            if (i == j) {
+                row += pad("-", 9) + " ";
+            } else {
+                row += pad(fixed(m[i * ranks + j], precision), 9);
+                row += (node[i] != node[j]) ? "*" : " ";
+            }
+        }
+        lines.push_back(row);
+    }
+    return lines;
+}
+
+std::vector<std::string> format_pair_summary(const std::vector<double>& m,
+                                             const std::vector<int>& node,
+                                             int ranks,
+                                             const std::string& name,
+                                             bool higher_is_worse)
+{
+    std::vector<std::string> lines;
+    for (int inter = 0; inter < 2; ++inter) {
+        std::vector<double> values;
+        int worst_i = -1, worst_j = -1;
+        double worst = 0.0;
+        for (int i = 0; i < ranks; ++i) {
+            for (int j = i + 1; j < ranks; ++j) {
+                if ((node[i] != node[j]) != (inter == 1)) continue;
+                const double v = m[i * ranks + j];
+                if (worst_i < 0 || (higher_is_worse ? v > worst : v < worst)) {
+                    worst = v; worst_i = i; worst_j = j;
+                }
+                values.push_back(v);
+            }
+        }
+        if (values.empty()) continue;
+        std::sort(values.begin(), values.end());
+        const std::size_t n = values.size();
+        const double median = (n % 2) ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+        std::ostringstream oss;
+        oss << name << (inter ? " inter-node" : " intra-node") << " pairs=" << n
+            << " min=" << fixed(values.front(), 2) << " median=" << fixed(median, 2)
+            << " max=" << fixed(values.back(), 2)
+            << " worst=" << rank_label(worst_i) << "-" << rank_label(worst_j);
+        lines.push_back(oss.str());
+    }
+    return lines;
+}
+
+int run_multipair(const std::vector<int>& sizes,
+                  const Options& opt,
+                  int rank,
+                  int world)
+{
+    const int partner = multipair_partner(rank, world);
+    if (partner < 0) {
+        if (rank == 0) {
+            std::ostringstream oss;
+            oss << "multipair mode needs an even number of ranks (got " << world << ")";
+            log_error(oss.str());
+        }
+        MPI_Abort(MPI_COMM_WORLD, 1);
+        return 1;
+    }
+    const int pairs = world / 2;
+    const bool initiator = rank < pairs;
+
+    log_settings(sizes, opt, rank, world);
+    {
+        const std::vector<int> node = node_of_ranks(rank, world);
+        int inter = 0;
+        for (int r = 0; r < pairs; ++r) {
+            if (node[r] != node[r + pairs]) ++inter;
+        }
+        std::ostringstream oss;
+        oss << "pairs=" << pairs << " inter_node_pairs=" << inter
+            << " (r<i> with r<i+" << pairs << ">)";
+        log_info_root(rank, oss.str());
+    }
+
+    std::vector<char> buf;
+    allocate(buf, sizes.empty() ? 1 : sizes.back(), rank);
+
+    perf::BenchReport report("assignment4");
+    std::vector<double> lats(rank == 0 ? world : 1);
+    std::vector<double> samples;
+
+    for (std::size_t i = 0; i < sizes.size(); ++i) {
+        const int bytes = sizes[i];
+
+        // All pairs start together, so they load the network at the same time
+        MPI_Barrier(MPI_COMM_WORLD);
+        double lat = measure_pair(buf, bytes, partner, initiator, opt, samples);
+        MPI_Gather(&lat, 1, MPI_DOUBLE, &lats[0], 1, MPI_DOUBLE,
+                   0, MPI_COMM_WORLD);
+
+        if (rank == 0) {
+            // lats[0 .. pairs) are the initiators' one-way latencies
+            std::vector<double> pair_lat(lats.begin(), lats.begin() + pairs);
+            double sum = 0.0, agg_bw = 0.0;
+            int slowest = 0;
+            for (int p = 0; p < pairs; ++p) {
+                sum += pair_lat[p];
+                agg_bw += (pair_lat[p] > 0.0) ? bytes / pair_lat[p] / 1e6 : 0.0;
+                if (pair_lat[p] > pair_lat[slowest]) slowest = p;
+            }
+            const perf::Stats s = perf::summarize(pair_lat, 0.0);
+
+            std::ostringstream oss;
+            oss.setf(std::ios::fixed);
+            oss.precision(2);
+            oss << "pairs=" << pairs << " size=" << bytes << " B lat_us_min=" << s.min * 1e6
+                << " lat_us_avg=" << sum / pairs * 1e6 << " lat_us_max=" << s.max * 1e6
+                << " agg_bw_mbs=" << agg_bw
+                << " slowest=" << rank_label(slowest) << "-" << rank_label(slowest + pairs);
+            log_info_root(rank, oss.str());
+
+            // One sample per pair: the spread is between pairs, not iterations
+            std::ostringstream params;
+            params << "mode=multipair pairs=" << pairs << " bytes=" << bytes;
+            report.add(params.str(), pair_lat, s);
+        }
+    }
+
+    write_report(report, opt, rank);
+    return 0;
+}
+
+int run_allpairs(const std::vector<int>& sizes,
+                 const Options& opt,
+                 int rank,
+                 int world)
+{
+    if (world < 2) {
+        if (rank == 0) log_error("allpairs mode needs at least 2 ranks");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+        return 1;
+    }
+    const int lat_bytes = sizes.empty() ? 1 : sizes.front();
+    const int bw_bytes = sizes.empty() ? 1 : sizes.back();
+
+    log_settings(sizes, opt, rank, world);
+    const std::vector<int> node = node_of_ranks(rank, world);
+
+    std::vector<char> buf;
+    allocate(buf, bw_bytes, rank);
+
+    // Each pair's initiator fills its entries; the sum at rank 0 merges them.
+    // Rank 0 also collects every pair's samples for the JSON/CSV report.
+    const std::size_t cells = static_cast<std::size_t>(world) * world;
+    std::vector<double> lat(cells, 0.0), bw(cells, 0.0);
+    std::vector<double> small_s, large_s;
+    perf::BenchReport report("assignment4");
+    for (int i = 0; i < world; ++i) {
+        for (int j = i + 1; j < world; ++j) {
+            if (rank == i || rank == j) {
+                const bool initiator = (rank == i);
+                const int peer = initiator ? j : i;
+                const double small = measure_pair(buf, lat_bytes, peer, initiator, opt, small_s);
+                const double large = measure_pair(buf, bw_bytes, peer, initiator, opt, large_s);
+                if (initiator) {
+                    lat[i * world + j] = lat[j * world + i] = small * 1e6;
+                    bw[i * world + j] = bw[j * world + i] = (large > 0.0) ? bw_bytes / large / 1e6 : 0.0;
+                }
+                // After the timed round trips, so the transfer is not measured
+                if (initiator && rank != 0) {
+                    MPI_Send(&small_s[0], opt.iters, MPI_DOUBLE, 0, TAG_SAMPLES, MPI_COMM_WORLD);
+                    MPI_Send(&large_s[0], opt.iters, MPI_DOUBLE, 0, TAG_SAMPLES, MPI_COMM_WORLD);
+                }
+            }
+            if (rank == 0) {
+                if (i != 0) {
+                    small_s.resize(opt.iters);
+                    large_s.resize(opt.iters);
+                    MPI_Recv(&small_s[0], opt.iters, MPI_DOUBLE, i, TAG_SAMPLES, MPI_COMM_WORLD,
+                             MPI_STATUS_IGNORE);
+                    MPI_Recv(&large_s[0], opt.iters, MPI_DOUBLE, i, TAG_SAMPLES, MPI_COMM_WORLD,
+                             MPI_STATUS_IGNORE);
+                }
+                std::ostringstream params;
+                params << "mode=allpairs i=" << i << " j=" << j << " bytes=" << lat_bytes;
+                report.add(params.str(), small_s, perf::summarize(small_s, opt.bench.outlier_k));
+                params.str("");
+                params << "mode=allpairs i=" << i << " j=" << j << " bytes=" << bw_bytes;
+                report.add(params.str(), large_s, perf::summarize(large_s, opt.bench.outlier_k));
+            }
+            // One pair at a time: the others must not share the links
+            MPI_Barrier(MPI_COMM_WORLD);
+        }
+    }
+
+    std::vector<double> lat_all(rank == 0 ? cells : 1), bw_all(rank == 0 ? cells : 1);
+    MPI_Reduce(&lat[0], &lat_all[0], static_cast<int>(cells), MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&bw[0], &bw_all[0], static_cast<int>(cells), MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    if (rank == 0) {
+        std::ostringstream placement;
+        placement << "pairs=" << world * (world - 1) / 2 << " lat_bytes=" << lat_bytes
+                  << " bw_bytes=" << bw_bytes << " node_of:";
+        for (int r = 0; r < world; ++r) {
+            placement << " " << rank_label(r) << "=" << rank_label(node[r]);
+        }
+        log_info_root(rank, placement.str());
+
+        const int kMaxMatrixRanks = 32;
+        if (world <= kMaxMatrixRanks) {
+            std::vector<std::string> lines = format_pair_matrix(lat_all, node, world, 2);
+            log_info_root(rank, "one-way latency_us (row, column = ranks; * = inter-node)");
+            for (std::size_t k = 0; k < lines.size(); ++k) log_info_root(rank, lines[k]);
+            lines = format_pair_matrix(bw_all, node, world, 0);
+            log_info_root(rank, "bandwidth_mbs (row, column = ranks; * = inter-node)");
+            for (std::size_t k = 0; k < lines.size(); ++k) log_info_root(rank, lines[k]);
+        }
+        std::vector<std::string> lines = format_pair_summary(lat_all, node, world, "latency_us", true);
+        const std::vector<std::string> more = format_pair_summary(bw_all, node, world, "bw_mbs", false);
+        lines.insert(lines.end(), more.begin(), more.end());
+        for (std::size_t k = 0; k < lines.size(); ++k) log_info_root(rank, lines[k]);
+    }
+
+    write_report(report, opt, rank);
+    return 0;
+}
+
+} // namespace assignment4
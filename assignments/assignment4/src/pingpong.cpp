@@ -1,22 +1,43 @@
 // MPI ping-pong latency benchmark: rank 0 sends to rank 1, rank 1 echoes back.
 // Measures one-way latency from round-trip time over multiple iterations.
 // Uses MPI_Send/MPI_Recv for synchronous point-to-point communication.
+// The bidirectional mode has both ranks send at once (MPI_Irecv/MPI_Isend) to
+// measure full-duplex bandwidth; the streaming mode keeps a window of
+// messages in flight to measure one-way bandwidth.
+// Every round trip is timed on its own (perf/bench.h clock) and the samples are
+// summarized: median, spread and a confidence interval instead of one average,
+// plus tail percentiles from a log-bucketed histogram (perf/histogram.h).
 
 #include "assignment4/pingpong.h"
 #include "assignment4/logger.h"
 #include "assignment4/cli.h"
+#include "common.h"
+#include "perf/bench.h"
+#include "perf/histogram.h"
 
 #include <vector>
 #include <string>
 #include <sstream>
-#include <new>
+#include <cstdio>
 
 #include <mpi.h>
 
 namespace assignment4 {
 
-// Returns current wall-clock time in seconds via MPI_Wtime().
-static double now_sec() { return MPI_Wtime(); }
+namespace {
+
+// One bidirectional exchange with the peer. The receive is posted before the
+// send, so neither message arrives unexpected (no extra copy on either side).
+void exchange(std::vector<char>& sendbuf, std::vector<char>& recvbuf, int bytes, int peer)
+{
+    const int TAG_EXCHANGE = 102;
+    MPI_Request req[2];
+    MPI_Irecv(&recvbuf[0], bytes, MPI_BYTE, peer, TAG_EXCHANGE, MPI_COMM_WORLD, &req[0]);
+    MPI_Isend(&sendbuf[0], bytes, MPI_BYTE, peer, TAG_EXCHANGE, MPI_COMM_WORLD, &req[1]);
+    MPI_Waitall(2, req, MPI_STATUSES_IGNORE);
+}
+
+} // namespace
 
 int run_pingpong(const std::vector<int>& sizes,
                  const Options& opt,
@@ -24,47 +45,35 @@ int run_pingpong(const std::vector<int>& sizes,
                  int world)
 {
     // Ping-pong requires exactly 2 ranks
-    if (world != 2) {
-        if (rank == 0) {
-            std::ostringstream oss;
-            oss << "world size must be 2 (got " << world << ")";
-            log_error(oss.str());
-        }
-        MPI_Abort(MPI_COMM_WORLD, 1);
-        return 1;
-    }
+    require_two_ranks(rank, world);
 
     // Distinct tags for ping and pong directions
     const int TAG_PING = 100;
     const int TAG_PONG = 101;
 
-    {
-        std::ostringstream oss;
-        oss << "ranks=" << world
-            << " warmup=" << opt.warmup
-            << " iters=" << opt.iters
-            << " min=" << (sizes.empty() ? 0 : sizes.front())
-            << " max=" << (sizes.empty() ? 0 : sizes.back())
-            << " factor=" << opt.factor;
-        log_info_root(rank, oss.str());
-        log_info_root(rank, "mode=ping-pong");
+    log_settings(sizes, opt, rank, world);
+
+    // Raw one-way latencies, one CSV row per round trip (rank 0)
+    std::FILE* raw = 0;
+    if (rank == 0 && !opt.samples_path.empty()) {
+        raw = std::fopen(opt.samples_path.c_str(), "w");
+        if (!raw) {
+            log_error("cannot write " + opt.samples_path);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+            return 1;
+        }
+        std::fprintf(raw, "bytes,iter,latency_us\n");
     }
 
+    perf::BenchReport report("assignment4");
+    std::vector<double> samples;
+
     // Loop over each message size
     for (std::size_t i = 0; i < sizes.size(); ++i) {
         const int bytes = sizes[i];
 
-        // Allocate buffer (both ranks need same size)
         std::vector<char> buf;
-        try { buf.resize(bytes); }
-        catch (const std::bad_alloc&) {
-            if (rank == 0) {
-                std::ostringstream oss; oss << "allocation failed for size=" << bytes;
-                log_error(oss.str());
-            }
-            MPI_Abort(MPI_COMM_WORLD, 1);
-            return 1;
-        }
+        allocate(buf, bytes, rank);
 
         MPI_Barrier(MPI_COMM_WORLD);
 
@@ -81,14 +90,14 @@ int run_pingpong(const std::vector<int>& sizes,
 
         MPI_Barrier(MPI_COMM_WORLD);
 
-        // Measured iterations: rank 0 times the round-trip
-        double t0 = 0.0, t1 = 0.0;
-        if (rank == 0) t0 = now_sec();
-
+        // Measured iterations: rank 0 times each round trip; a sample is half of it
+        samples.clear();
         for (int it = 0; it < opt.iters; ++it) {
             if (rank == 0) {
+                const double t0 = perf::now_seconds();
                 MPI_Send(&buf[0], bytes, MPI_BYTE, 1, TAG_PING, MPI_COMM_WORLD);
                 MPI_Recv(&buf[0], bytes, MPI_BYTE, 1, TAG_PONG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                samples.push_back(0.5 * (perf::now_seconds() - t0));
             } else {
                 MPI_Recv(&buf[0], bytes, MPI_BYTE, 0, TAG_PING, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
                 MPI_Send(&buf[0], bytes, MPI_BYTE, 0, TAG_PONG, MPI_COMM_WORLD);
@@ -96,19 +105,180 @@ int run_pingpong(const std::vector<int>& sizes,
         }
 
         if (rank == 0) {
-            t1 = now_sec();
-            const double rt = (t1 > t0) ? (t1 - t0) : 0.0;
-            // One-way latency = round_trip / (2 * iterations), converted to microseconds
-            const double one_way_us = (opt.iters > 0) ? (rt / (2.0 * opt.iters) * 1e6) : 0.0;
+            // One-way latency = median round trip / 2, in microseconds
+            const perf::Stats s = perf::summarize(samples, opt.bench.outlier_k);
 
             std::ostringstream oss;
             oss.setf(std::ios::fixed);
             oss.precision(2);
-            oss << "size=" << bytes << " B latency_us=" << one_way_us;
+            oss << "size=" << bytes << " B latency_us=" << s.median * 1e6
+                << " min_us=" << s.min * 1e6 << " mean_us=" << s.mean * 1e6
+                << " stddev_us=" << s.stddev * 1e6 << " ci95_us=" << s.ci95 * 1e6
+                << " outliers=" << s.outliers;
             log_info_root(rank, oss.str());
+
+            // The tail keeps every round trip: outliers are what it is about
+            perf::Histogram hist;
+            hist.add_all(samples);
+            std::ostringstream tail;
+            tail << "size=" << bytes << " B " << perf::format_percentiles_us(hist);
+            log_info_root(rank, tail.str());
+
+            if (opt.hist) {
+                const std::vector<perf::Histogram::Bucket> b = hist.buckets();
+                for (std::size_t k = 0; k < b.size(); ++k) {
+                    char line[128];
+                    std::sprintf(line, "hist: size=%d B lower_us=%.3f upper_us=%.3f count=%lu",
+                                 bytes, b[k].lower * 1e6, b[k].upper * 1e6, b[k].count);
+                    log_info_root(rank, line);
+                }
+            }
+            if (raw) {
+                for (std::size_t k = 0; k < samples.size(); ++k) {
+                    std::fprintf(raw, "%d,%lu,%.3f\n", bytes, static_cast<unsigned long>(k),
+                                 samples[k] * 1e6);
+                }
+            }
+
+            std::ostringstream params;
+            params << "bytes=" << bytes;
+            report.add(params.str(), samples, s);
+        }
+    }
+
+    if (raw) {
+        std::fclose(raw);
+    }
+    write_report(report, opt, rank);
+    return 0;
+}
+
+int run_bidir(const std::vector<int>& sizes,
+              const Options& opt,
+              int rank,
+              int world)
+{
+    require_two_ranks(rank, world);
+
+    const int peer = 1 - rank;
+
+    log_settings(sizes, opt, rank, world);
+
+    perf::BenchReport report("assignment4");
+    std::vector<double> samples;
+
+    for (std::size_t i = 0; i < sizes.size(); ++i) {
+        const int bytes = sizes[i];
+
+        // Separate send and receive buffers: both are in flight at once
+        std::vector<char> sendbuf, recvbuf;
+        allocate(sendbuf, bytes, rank);
+        allocate(recvbuf, bytes, rank);
+
+        MPI_Barrier(MPI_COMM_WORLD);
+
+        for (int w = 0; w < opt.warmup; ++w) {
+            exchange(sendbuf, recvbuf, bytes, peer);
+        }
+
+        MPI_Barrier(MPI_COMM_WORLD);
+
+        // Measured iterations: rank 0's sample is one whole exchange
+        samples.clear();
+        for (int it = 0; it < opt.iters; ++it) {
+            const double t0 = perf::now_seconds();
+            exchange(sendbuf, recvbuf, bytes, peer);
+            samples.push_back(perf::now_seconds() - t0);
+        }
+
+        if (rank == 0) {
+            // Both directions move 'bytes' during one exchange
+            const perf::Stats s = perf::summarize(samples, opt.bench.outlier_k);
+            const double bw_mbs = (s.median > 0.0) ? 2.0 * bytes / s.median / 1e6 : 0.0;
+
+            std::ostringstream oss;
+            oss.setf(std::ios::fixed);
+            oss.precision(2);
+            oss << "size=" << bytes << " B latency_us=" << s.median * 1e6
+                << " bw_mbs=" << bw_mbs
+                << " min_us=" << s.min * 1e6 << " mean_us=" << s.mean * 1e6
+                << " stddev_us=" << s.stddev * 1e6 << " ci95_us=" << s.ci95 * 1e6
+                << " outliers=" << s.outliers;
+            log_info_root(rank, oss.str());
+
+            std::ostringstream params;
+            params << "mode=bidir bytes=" << bytes;
+            report.add(params.str(), samples, s);
+        }
+    }
+
+    write_report(report, opt, rank);
+    return 0;
+}
+
+
+int run_stream(const std::vector<int>& sizes,
+               const Options& opt,
+               int rank,
+               int world)
+{
+    require_two_ranks(rank, world);
+
+    log_settings(sizes, opt, rank, world);
+
+    perf::BenchReport report("assignment4");
+    std::vector<double> samples;
+
+    for (std::size_t w = 0; w < opt.windows.size(); ++w) {
+        const int window = opt.windows[w];
+        std::vector<MPI_Request> req(window);
+
+        for (std::size_t i = 0; i < sizes.size(); ++i) {
+            const int bytes = sizes[i];
+
+            std::vector<char> buf;
+            allocate(buf, bytes, rank);
+
+            MPI_Barrier(MPI_COMM_WORLD);
+
+            for (int it = 0; it < opt.warmup; ++it) {
+                stream_window(buf, req, bytes, rank);
+            }
+
+            MPI_Barrier(MPI_COMM_WORLD);
+
+            // Measured iterations: rank 0's sample is one window plus its ack
+            samples.clear();
+            for (int it = 0; it < opt.iters; ++it) {
+                const double t0 = perf::now_seconds();
+                stream_window(buf, req, bytes, rank);
+                samples.push_back(perf::now_seconds() - t0);
+            }
+
+            if (rank == 0) {
+                const perf::Stats s = perf::summarize(samples, opt.bench.outlier_k);
+                const double bw_mbs =
+                    (s.median > 0.0) ? static_cast<double>(window) * bytes / s.median / 1e6 : 0.0;
+                const double msg_rate = (s.median > 0.0) ? window / s.median : 0.0;
+
+                std::ostringstream oss;
+                oss.setf(std::ios::fixed);
+                oss.precision(2);
+                oss << "window=" << window << " size=" << bytes << " B bw_mbs=" << bw_mbs
+                    << " msgs_per_s=" << msg_rate
+                    << " window_us=" << s.median * 1e6 << " min_us=" << s.min * 1e6
+                    << " stddev_us=" << s.stddev * 1e6 << " ci95_us=" << s.ci95 * 1e6
+                    << " outliers=" << s.outliers;
+                log_info_root(rank, oss.str());
+
+                std::ostringstream params;
+                params << "mode=stream window=" << window << " bytes=" << bytes;
+                report.add(params.str(), samples, s);
+            }
         }
     }
 
+    write_report(report, opt, rank);
     return 0;
 }
 
@@ -0,0 +1,258 @@
+// One-sided benchmark: rank 0 accesses a window on rank 1 in timed epochs.
+// All access epochs use MPI-2 calls (fence, PSCW, lock/unlock), so the mode
+// works with the MPI libraries the two-sided modes support.
+
+#include "assignment4/rma.h"
+#include "assignment4/cli.h"
+#include "assignment4/logger.h"
+#include "common.h"
+#include "perf/bench.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include <mpi.h>
+
+namespace assignment4 {
+
+namespace {
+
+const char* const kOpNames[RMA_OP_COUNT] = { "put", "get", "acc" };
+const char* const kSyncNames[SYNC_COUNT] = { "fence", "pscw", "lock" };
+
+const int TARGET = 1;
+
+// 'count' operations of 'bytes' from rank 0 to displacement 0 of the target.
+// As in osu_put_bw, the operations of one epoch share the buffers; only the
+// transfer is measured, the contents are never read.
+void issue(int op, int bytes, int count, std::vector<char>& local, MPI_Win win)
+{
+    const int doubles = bytes / static_cast<int>(sizeof(double));
+    for (int k = 0; k < count; ++k) {
+        switch (op) {
+        case RMA_PUT:
+            MPI_Put(&local[0], bytes, MPI_BYTE, TARGET, 0, bytes, MPI_BYTE, win);
+            break;
+        case RMA_GET:
+            MPI_Get(&local[0], bytes, MPI_BYTE, TARGET, 0, bytes, MPI_BYTE, win);
+            break;
+        default:
+            MPI_Accumulate(&local[0], doubles, MPI_DOUBLE, TARGET, 0, doubles, MPI_DOUBLE,
+                           MPI_SUM, win);
+            break;
+        }
+    }
+}
+
+// One access epoch on both ranks: the origin (rank 0) issues 'count'
+// operations; the target takes part as the synchronization requires
+void epoch(int op, int sync, int bytes, int count, int rank, std::vector<char>& local,
+           MPI_Win win, MPI_Group peer)
+{
+    switch (sync) {
+    case SYNC_FENCE:
+        // The fence of the previous epoch (or the opening one) started this one
+        if (rank == 0) issue(op, bytes, count, local, win);
+        MPI_Win_fence(0, win);
+        break;
+    case SYNC_PSCW:
+        if (rank == 0) {
+            MPI_Win_start(peer, 0, win);
+            issue(op, bytes, count, local, win);
+            MPI_Win_complete(win);
+        } else {
+            MPI_Win_post(peer, 0, win);
+            MPI_Win_wait(win);
+        }
+        break;
+    default:
+        // Passive target: rank 1 makes no call (it waits in the next barrier)
+        if (rank == 0) {
+            MPI_Win_lock(MPI_LOCK_EXCLUSIVE, TARGET, 0, win);
+            issue(op, bytes, count, local, win);
+            MPI_Win_unlock(TARGET, win);
+        }
+        break;
+    }
+}
+
+// Warm-up, then 'iters' epochs timed on rank 0; returns the samples' statistics
+perf::Stats time_epochs(int op, int sync, int bytes, int count, int rank, const Options& opt,
+                        std::vector<char>& local, MPI_Win win, MPI_Group peer,
+                        std::vector<double>& samples)
+{
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (sync == SYNC_FENCE) MPI_Win_fence(MPI_MODE_NOPRECEDE, win);
+    for (int w = 0; w < opt.warmup; ++w) {
+        epoch(op, sync, bytes, count, rank, local, win, peer);
+    }
+    samples.clear();
+    for (int it = 0; it < opt.iters; ++it) {
+        const double t0 = perf::now_seconds();
+        epoch(op, sync, bytes, count, rank, local, win, peer);
+        samples.push_back(perf::now_seconds() - t0);
+    }
+    if (sync == SYNC_FENCE) MPI_Win_fence(MPI_MODE_NOSUCCEED, win);
+    MPI_Barrier(MPI_COMM_WORLD);
+    return perf::summarize(samples, opt.bench.outlier_k);
+}
+
+// Two-sided reference on the same buffers: median one-way ping-pong latency
+// and streaming bandwidth with the same window (seconds, MB/s; rank 0)
+void two_sided(int bytes, int window, int rank, const Options& opt, std::vector<char>& buf,
+               double& latency, double& bw_mbs)
+{
+    const int TAG_PING = 120;
+    const int TAG_PONG = 121;
+    std::vector<double> samples;
+    MPI_Barrier(MPI_COMM_WORLD);
+    for (int it = -opt.warmup; it < opt.iters; ++it) {
+        const double t0 = perf::now_seconds();
+        if (rank == 0) {
+            MPI_Send(&buf[0], bytes, MPI_BYTE, 1, TAG_PING, MPI_COMM_WORLD);
+            MPI_Recv(&buf[0], bytes, MPI_BYTE, 1, TAG_PONG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        } else {
+            MPI_Recv(&buf[0], bytes, MPI_BYTE, 0, TAG_PING, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            MPI_Send(&buf[0], bytes, MPI_BYTE, 0, TAG_PONG, MPI_COMM_WORLD);
+        }
+        if (it >= 0) samples.push_back(0.5 * (perf::now_seconds() - t0));
+    }
+    latency = perf::summarize(samples, opt.bench.outlier_k).median;
+
+    std::vector<MPI_Request> req(window);
+    MPI_Barrier(MPI_COMM_WORLD);
+    samples.clear();
+    for (int it = -opt.warmup; it < opt.iters; ++it) {
+        const double t0 = perf::now_seconds();
+        stream_window(buf, req, bytes, rank);
+        if (it >= 0) samples.push_back(perf::now_seconds() - t0);
+    }
+    const double median = perf::summarize(samples, opt.bench.outlier_k).median;
+    bw_mbs = (median > 0.0) ? static_cast<double>(window) * bytes / median / 1e6 : 0.0;
+}
+
+} // namespace
+
+const char* rma_op_name(int op)
+{
+    return (op >= 0 && op < RMA_OP_COUNT) ? kOpNames[op] : "?";
+}
+
+const char* rma_sync_name(int sync)
+{
+    return (sync >= 0 && sync < SYNC_COUNT) ? kSyncNames[sync] : "?";
+}
+
+int rma_op_from_name(const std::string& name)
+{
+    for (int op = 0; op < RMA_OP_COUNT; ++op) {
+        if (name == kOpNames[op]) return op;
+    }
+    return -1;
+}
+
+int rma_sync_from_name(const std::string& name)
+{
+    for (int sync = 0; sync < SYNC_COUNT; ++sync) {
+        if (name == kSyncNames[sync]) return sync;
+    }
+    return -1;
+}
+
+int rma_bytes(int op, int size)
+{
+    return (op == RMA_ACC) ? round_up_to_doubles(size) : size;
+}
+
+int run_rma(const std::vector<int>& sizes,
+            const Options& opt,
+            int rank,
+            int world)
+{
+    require_two_ranks(rank, world);
+
+    const int window = opt.windows.empty() ? 64 : opt.windows[0];
+    log_settings(sizes, opt, rank, world);
+    {
+        std::ostringstream oss;
+        oss << "origin=r0 target=r1 window=" << window;
+        log_info_root(rank, oss.str());
+    }
+
+    // Every rank exposes a window of the largest (accumulate-rounded) size;
+    // only rank 1's is accessed
+    const int max_bytes = sizes.empty() ? 8 : rma_bytes(RMA_ACC, sizes.back());
+    std::vector<char> exposed, local;
+    allocate(exposed, max_bytes, rank);
+    allocate(local, max_bytes, rank);
+    MPI_Win win;
+    MPI_Win_create(&exposed[0], static_cast<MPI_Aint>(max_bytes), 1, MPI_INFO_NULL,
+                   MPI_COMM_WORLD, &win);
+
+    // PSCW names the peer group: the target for rank 0, the origin for rank 1
+    MPI_Group world_group, peer;
+    int peer_rank = 1 - rank;
+    MPI_Comm_group(MPI_COMM_WORLD, &world_group);
+    MPI_Group_incl(world_group, 1, &peer_rank, &peer);
+
+    // The two-sided reference, once per byte count the ops move (accumulate
+    // rounds sizes up), so every line compares equal transfers
+    std::vector<int> ref_bytes;
+    for (std::size_t o = 0; o < opt.rma_ops.size(); ++o) {
+        for (std::size_t i = 0; i < sizes.size(); ++i) {
+            ref_bytes.push_back(rma_bytes(rma_op_from_name(opt.rma_ops[o]), sizes[i]));
+        }
+    }
+    std::sort(ref_bytes.begin(), ref_bytes.end());
+    ref_bytes.erase(std::unique(ref_bytes.begin(), ref_bytes.end()), ref_bytes.end());
+    std::vector<double> p2p_lat(ref_bytes.size(), 0.0), p2p_bw(ref_bytes.size(), 0.0);
+    for (std::size_t k = 0; k < ref_bytes.size(); ++k) {
+        two_sided(ref_bytes[k], window, rank, opt, local, p2p_lat[k], p2p_bw[k]);
+    }
+
+    perf::BenchReport report("assignment4");
+    std::vector<double> samples;
+    for (std::size_t o = 0; o < opt.rma_ops.size(); ++o) {
+        const int op = rma_op_from_name(opt.rma_ops[o]);
+        for (std::size_t y = 0; y < opt.rma_syncs.size(); ++y) {
+            const int sync = rma_sync_from_name(opt.rma_syncs[y]);
+            for (std::size_t i = 0; i < sizes.size(); ++i) {
+                const int bytes = rma_bytes(op, sizes[i]);
+                const std::size_t ref =
+                    std::lower_bound(ref_bytes.begin(), ref_bytes.end(), bytes) - ref_bytes.begin();
+
+                const perf::Stats bw = time_epochs(op, sync, bytes, window, rank, opt, local,
+                                                   win, peer, samples);
+                const perf::Stats s = time_epochs(op, sync, bytes, 1, rank, opt, local,
+                                                  win, peer, samples);
+                if (rank != 0) continue;
+
+                const double bw_mbs =
+                    (bw.median > 0.0) ? static_cast<double>(window) * bytes / bw.median / 1e6 : 0.0;
+                std::ostringstream oss;
+                oss.setf(std::ios::fixed);
+                oss.precision(2);
+                oss << "op=" << rma_op_name(op) << " sync=" << rma_sync_name(sync)
+                    << " size=" << bytes << " B latency_us=" << s.median * 1e6
+                    << " bw_mbs=" << bw_mbs
+                    << " p2p_latency_us=" << p2p_lat[ref] * 1e6 << " p2p_bw_mbs=" << p2p_bw[ref]
+                    << " min_us=" << s.min * 1e6 << " ci95_us=" << s.ci95 * 1e6
+                    << " outliers=" << s.outliers;
+                log_info_root(rank, oss.str());
+
+                std::ostringstream params;
+                params << "mode=rma op=" << rma_op_name(op) << " sync=" << rma_sync_name(sync)
+                       << " bytes=" << bytes;
+                report.add(params.str(), samples, s);
+            }
+        }
+    }
+
+    MPI_Group_free(&peer);
+    MPI_Group_free(&world_group);
+    MPI_Win_free(&win);
+    write_report(report, opt, rank);
+    return 0;
+}
+
+} // namespace assignment4
@@ -1,8 +1,11 @@
-// Unit tests for assignment4 helpers (CLI parser and size generator).
+// Unit tests for assignment4 helpers (CLI parser, size generator, pair matrices).
 // Uses Unity test framework to validate parsing, defaults, and geometric sequences.
 
 #include "assignment4/cli.h"
 #include "assignment4/sizes.h"
+#include "assignment4/pairs.h"
+#include "assignment4/collectives.h"
+#include "assignment4/rma.h"
 
 extern "C" {
 #include "vendor/unity/unity.h"
@@ -26,6 +29,9 @@ static void test_cli_defaults(void)
     TEST_ASSERT_INT_EQUAL(4, opt.min_bytes);
     TEST_ASSERT_INT_EQUAL(10485760, opt.max_bytes);
     TEST_ASSERT_INT_EQUAL(2, opt.factor);
+    TEST_ASSERT_TRUE(opt.mode == "ping-pong");
+    TEST_ASSERT_INT_EQUAL(1, (int)opt.windows.size());
+    TEST_ASSERT_INT_EQUAL(64, opt.windows[0]);
 }
 
 // Test: CLI parser correctly sets custom values from arguments
@@ -54,6 +60,83 @@ static void test_cli_custom(void)
     TEST_ASSERT_INT_EQUAL(2, opt.factor);
 }
 
+// Test: harness output options are accepted, others still rejected
+static void test_cli_bench_options(void)
+{
+    Options opt;
+    std::string err;
+    const char* argv0 = "assignment4";
+    const char* a1 = "--json"; const char* v1 = "pp.json";
+    const char* a2 = "--outlier-k"; const char* v2 = "0";
+    char* argv[] = { (char*)argv0, (char*)a1, (char*)v1, (char*)a2, (char*)v2, 0 };
+    TEST_ASSERT_TRUE(parse_cli(5, argv, opt, err));
+    TEST_ASSERT_TRUE(opt.bench.json_path == "pp.json");
+    TEST_ASSERT_TRUE(opt.bench.outlier_k == 0.0);
+
+    Options bad;
+    const char* a3 = "--reps"; const char* v3 = "3";
+    char* argv_bad[] = { (char*)argv0, (char*)a3, (char*)v3, 0 };
+    TEST_ASSERT_TRUE(!parse_cli(3, argv_bad, bad, err));
+}
+
+// Test: --mode accepts the known modes only
+static void test_cli_mode(void)
+{
+    Options opt;
+    std::string err;
+    const char* argv0 = "assignment4";
+    const char* a1 = "--mode"; const char* v1 = "bidir";
+    char* argv[] = { (char*)argv0, (char*)a1, (char*)v1, 0 };
+    TEST_ASSERT_TRUE(parse_cli(3, argv, opt, err));
+    TEST_ASSERT_TRUE(opt.mode == "bidir");
+
+    Options bad;
+    const char* v2 = "duplex";
+    char* argv_bad[] = { (char*)argv0, (char*)a1, (char*)v2, 0 };
+    TEST_ASSERT_TRUE(!parse_cli(3, argv_bad, bad, err));
+}
+
+// Test: --window takes a comma-separated sweep of positive values
+static void test_cli_window(void)
+{
+    Options opt;
+    std::string err;
+    const char* argv0 = "assignment4";
+    const char* a1 = "--window"; const char* v1 = "1,8,64";
+    char* argv[] = { (char*)argv0, (char*)a1, (char*)v1, 0 };
+    TEST_ASSERT_TRUE(parse_cli(3, argv, opt, err));
+    TEST_ASSERT_INT_EQUAL(3, (int)opt.windows.size());
+    TEST_ASSERT_INT_EQUAL(1, opt.windows[0]);
+    TEST_ASSERT_INT_EQUAL(8, opt.windows[1]);
+    TEST_ASSERT_INT_EQUAL(64, opt.windows[2]);
+
+    const char* bad_values[] = { "8,", "0", "4,x", "" };
+    for (int k = 0; k < 4; ++k) {
+        Options bad;
+        char* argv_bad[] = { (char*)argv0, (char*)a1, (char*)bad_values[k], 0 };
+        TEST_ASSERT_TRUE(!parse_cli(3, argv_bad, bad, err));
+    }
+}
+
+// Test: histogram dump and raw sample file options
+static void test_cli_tail_options(void)
+{
+    Options opt;
+    std::string err;
+    TEST_ASSERT_TRUE(!opt.hist && opt.samples_path.empty());
+    const char* argv0 = "assignment4";
+    const char* a1 = "--hist";
+    const char* a2 = "--samples"; const char* v2 = "raw.csv";
+    char* argv[] = { (char*)argv0, (char*)a1, (char*)a2, (char*)v2, 0 };
+    TEST_ASSERT_TRUE(parse_cli(4, argv, opt, err));
+    TEST_ASSERT_TRUE(opt.hist);
+    TEST_ASSERT_TRUE(opt.samples_path == "raw.csv");
+
+    Options bad;
+    char* argv_bad[] = { (char*)argv0, (char*)a2, 0 };
+    TEST_ASSERT_TRUE(!parse_cli(2, argv_bad, bad, err));
+}
+
 // Test: size generator produces correct geometric sequence [4, 8, 16, 32, 64]
 static void test_sizes_geom(void)
 {
@@ -67,13 +150,131 @@ static void test_sizes_geom(void)
     TEST_ASSERT_INT_EQUAL(64, s[4]);
 }
 
+// Test: multi-pair partners pair the two halves; odd worlds are rejected
+static void test_multipair_partner(void)
+{
+    TEST_ASSERT_INT_EQUAL(3, multipair_partner(0, 6));
+    TEST_ASSERT_INT_EQUAL(5, multipair_partner(2, 6));
+    TEST_ASSERT_INT_EQUAL(1, multipair_partner(4, 6));
+    TEST_ASSERT_INT_EQUAL(1, multipair_partner(0, 2));
+    TEST_ASSERT_INT_EQUAL(-1, multipair_partner(0, 5));
+    TEST_ASSERT_INT_EQUAL(-1, multipair_partner(6, 6));
+}
+
+// Test: 3 ranks on 2 nodes (r0, r1 on node 0; r2 on node 2): matrix cells
+// marked by placement, summary per class with the worst pair
+static void test_pair_matrix(void)
+{
+    std::vector<int> node(3, 0);
+    node[2] = 2;
+    std::vector<double> m(9, 0.0);
+    m[0 * 3 + 1] = m[1 * 3 + 0] = 0.5;
+    m[0 * 3 + 2] = m[2 * 3 + 0] = 2.0;
+    m[1 * 3 + 2] = m[2 * 3 + 1] = 3.0;
+
+    const std::vector<std::string> lines = format_pair_matrix(m, node, 3, 2);
+    TEST_ASSERT_INT_EQUAL(4, (int)lines.size());
+    TEST_ASSERT_TRUE(lines[0] == "             r0        r1        r2 ");
+    TEST_ASSERT_TRUE(lines[1] == "    r0        -      0.50      2.00*");
+    TEST_ASSERT_TRUE(lines[3] == "    r2     2.00*     3.00*        - ");
+
+    const std::vector<std::string> sum = format_pair_summary(m, node, 3, "latency_us", true);
+    TEST_ASSERT_INT_EQUAL(2, (int)sum.size());
+    TEST_ASSERT_TRUE(sum[0] == "latency_us intra-node pairs=1 min=0.50 median=0.50 max=0.50 worst=r0-r1");
+    TEST_ASSERT_TRUE(sum[1] == "latency_us inter-node pairs=2 min=2.00 median=2.50 max=3.00 worst=r1-r2");
+
+    const std::vector<std::string> bw = format_pair_summary(m, node, 3, "bw_mbs", false);
+    TEST_ASSERT_TRUE(bw[1].find("worst=r0-r2") != std::string::npos);
+}
+
+// Test: --ops selects collectives by name; sizes of the reductions round up to doubles
+static void test_collectives(void)
+{
+    Options def;
+    TEST_ASSERT_INT_EQUAL(COLL_COUNT, (int)def.collectives.size());
+    TEST_ASSERT_TRUE(def.collectives[0] == "barrier");
+
+    Options opt;
+    std::string err;
+    const char* argv0 = "assignment4";
+    const char* a1 = "--ops"; const char* v1 = "bcast,allreduce";
+    char* argv[] = { (char*)argv0, (char*)a1, (char*)v1, 0 };
+    TEST_ASSERT_TRUE(parse_cli(3, argv, opt, err));
+    TEST_ASSERT_INT_EQUAL(2, (int)opt.collectives.size());
+    TEST_ASSERT_TRUE(opt.collectives[1] == "allreduce");
+
+    Options bad;
+    const char* v2 = "bcast,scan";
+    char* argv_bad[] = { (char*)argv0, (char*)a1, (char*)v2, 0 };
+    TEST_ASSERT_TRUE(!parse_cli(3, argv_bad, bad, err));
+
+    TEST_ASSERT_INT_EQUAL(COLL_ALLTOALL, collective_from_name("alltoall"));
+    TEST_ASSERT_INT_EQUAL(-1, collective_from_name("scan"));
+    TEST_ASSERT_INT_EQUAL(0, collective_bytes(COLL_BARRIER, 64));
+    TEST_ASSERT_INT_EQUAL(4, collective_bytes(COLL_BCAST, 4));
+    TEST_ASSERT_INT_EQUAL(8, collective_bytes(COLL_REDUCE, 4));
+    TEST_ASSERT_INT_EQUAL(24, collective_bytes(COLL_ALLREDUCE, 20));
+    TEST_ASSERT_INT_EQUAL(64, collective_bytes(COLL_ALLREDUCE, 64));
+}
+
+// Test: --rma-ops/--sync select by name; accumulate sizes round up to doubles
+static void test_rma_options(void)
+{
+    Options def;
+    TEST_ASSERT_INT_EQUAL(RMA_OP_COUNT, (int)def.rma_ops.size());
+    TEST_ASSERT_INT_EQUAL(SYNC_COUNT, (int)def.rma_syncs.size());
+    TEST_ASSERT_TRUE(def.rma_syncs[2] == "lock");
+
+    Options opt;
+    std::string err;
+    const char* argv0 = "assignment4";
+    const char* a1 = "--rma-ops"; const char* v1 = "get,acc";
+    const char* a2 = "--sync"; const char* v2 = "pscw";
+    char* argv[] = { (char*)argv0, (char*)a1, (char*)v1, (char*)a2, (char*)v2, 0 };
+    TEST_ASSERT_TRUE(parse_cli(5, argv, opt, err));
+    TEST_ASSERT_INT_EQUAL(2, (int)opt.rma_ops.size());
+    TEST_ASSERT_TRUE(opt.rma_ops[0] == "get");
+    TEST_ASSERT_INT_EQUAL(1, (int)opt.rma_syncs.size());
+    TEST_ASSERT_INT_EQUAL(SYNC_PSCW, rma_sync_from_name(opt.rma_syncs[0]));
+
+    Options bad;
+    const char* v3 = "put,";
+    char* argv_bad[] = { (char*)argv0, (char*)a1, (char*)v3, 0 };
+    TEST_ASSERT_TRUE(!parse_cli(3, argv_bad, bad, err));
+
+    TEST_ASSERT_INT_EQUAL(-1, rma_op_from_name("cas"));
+    TEST_ASSERT_INT_EQUAL(4, rma_bytes(RMA_PUT, 4));
+    TEST_ASSERT_INT_EQUAL(8, rma_bytes(RMA_ACC, 4));
+    TEST_ASSERT_INT_EQUAL(16, rma_bytes(RMA_ACC, 13));
+    TEST_ASSERT_INT_EQUAL(4096, rma_bytes(RMA_ACC, 4096));
+
+    // One window per epoch size: a sweep is rejected, one value is fine
+    const char* a4 = "--mode"; const char* v4 = "rma";
+    const char* a5 = "--window"; const char* v5 = "1,8"; const char* v6 = "8";
+    char* argv_sweep[] = { (char*)argv0, (char*)a4, (char*)v4, (char*)a5, (char*)v5, 0 };
+    Options sweep;
+    TEST_ASSERT_TRUE(!parse_cli(5, argv_sweep, sweep, err));
+    char* argv_one[] = { (char*)argv0, (char*)a4, (char*)v4, (char*)a5, (char*)v6, 0 };
+    Options one;
+    TEST_ASSERT_TRUE(parse_cli(5, argv_one, one, err));
+    TEST_ASSERT_INT_EQUAL(8, one.windows[0]);
+}
+
 int main(void)
 {
     UnityBegin("assignment4 helpers");
 
     RUN_TEST(test_cli_defaults);
     RUN_TEST(test_cli_custom);
+    RUN_TEST(test_cli_bench_options);
+    RUN_TEST(test_cli_mode);
+    RUN_TEST(test_cli_window);
+    RUN_TEST(test_cli_tail_options);
     RUN_TEST(test_sizes_geom);
+    RUN_TEST(test_multipair_partner);
+    RUN_TEST(test_pair_matrix);
+    RUN_TEST(test_collectives);
+    RUN_TEST(test_rma_options);
 
     return UnityEnd();
 }
@@ -3,7 +3,9 @@
  * @brief Command-line argument parsing for assignment5 MPI GEMM.
  *
  * Provides a simple parser for matrix size N and iteration count,
- * supporting both positional arguments and named options (--iters).
+ * supporting both positional arguments and named options (--iters,
+ * --shared-B, --sched, --dist, --block, --weights, --algo, --rep, --tune,
+ * --counters, --rank-detail, --trace) plus the benchmark harness options (perf/bench.h).
  */
 
 #ifndef ASSIGNMENT5_CLI_H
@@ -11,8 +13,28 @@
 
 #include <string>
 
+#include "assignment5/dist.h"
+#include "perf/bench.h"
+
 namespace a5 {
 
+/**
+ * @brief How rows of C are assigned to ranks.
+ */
+enum Schedule {
+  SCHEDULE_STATIC,   ///< Fixed contiguous row block per rank
+  SCHEDULE_DYNAMIC   ///< Ranks claim row chunks from a shared counter
+};
+
+/**
+ * @brief Multiplication algorithm.
+ */
+enum Algorithm {
+  ALGO_ROWBLOCK,  ///< 1D rows of C per rank, B broadcast to everyone
+  ALGO_25D,       ///< 2.5D: q x q x c grid with replicated Cannon
+  ALGO_RMA        ///< Row blocks; B panels fetched with MPI_Rget (vs. MPI_Bcast)
+};
+
 /**
  * @brief Configuration options parsed from command-line arguments.
  *
@@ -20,17 +42,45 @@ namespace a5 {
  * Default values ensure a valid state if parsing is incomplete.
  */
 struct Options {
-  int N;       ///< Matrix dimension (N x N matrices A, B, and C)
-  int iters;   ///< Number of iterations for timing benchmarks
+  int N;          ///< Matrix dimension (N x N matrices A, B, and C)
+  int iters;      ///< Timed iterations (--iters or --reps), also in bench.reps
+  bool shared_b;  ///< Keep one node-shared copy of B (MPI-3 windows)
+  Schedule sched; ///< Row assignment policy
+  DistKind dist;  ///< Static distribution scheme (with SCHEDULE_STATIC)
+  int block;      ///< Rows per block for DIST_CYCLIC
+  std::string weights_path; ///< Per-rank speeds for DIST_WEIGHTED (empty = measure)
+  Algorithm algo; ///< Multiplication algorithm
+  int rep;        ///< Replication factor c for ALGO_25D
+  bool tune;      ///< Autotune the kernel and rewrite the per-host cache (tune.h)
+  bool counters;  ///< Hardware counters around compute_local_rows (perf/counters.h)
+  bool rank_detail; ///< Log every rank's compute/wait line, not just the spread
+  std::string trace_path; ///< Chrome trace JSON of all ranks' phases (empty = off)
+  perf::BenchConfig bench; ///< Warm-up, outlier threshold, JSON/CSV output
   
-  Options() : N(0), iters(1) {}
+  Options() : N(0), iters(perf::BenchConfig().reps), shared_b(false), sched(SCHEDULE_STATIC),
+              dist(DIST_BLOCK), block(16), algo(ALGO_ROWBLOCK), rep(1), tune(false),
+              counters(false), rank_detail(false) {}
 };
 
 /**
  * @brief Parse command-line arguments into Options struct.
  *
  * Expects at least one positional argument: the matrix size N.
- * Optionally accepts --iters <k> to set the iteration count.
+ * Optionally accepts --iters <k> to set the iteration count,
+ * --shared-B to share one copy of B among the ranks of each node and
+ * --sched static|dynamic to choose the row assignment policy and
+ * --dist block|cyclic|weighted [--block b] [--weights file] to choose the
+ * static distribution. --dist other than block cannot be combined with
+ * --sched dynamic, and --weights requires --dist weighted. --algo
+ * rowblock|2.5d|rma [--rep c] selects the algorithm; 2.5d and rma
+ * exclude the row-block options (--shared-B, --sched, --dist). --tune
+ * searches kernel parameters before the run and saves them for this host.
+ * --counters reads hardware counters around the row-block kernel.
+ * --rank-detail logs every rank's compute and wait time (row-block only).
+ * --trace FILE writes a phase timeline of all ranks and threads (row-block
+ * only, see trace.h).
+ * --warmup, --outlier-k, --json and --csv set the harness; --reps is an
+ * alias of --iters.
  *
  * @param argc Argument count from main()
  * @param argv Argument vector from main()
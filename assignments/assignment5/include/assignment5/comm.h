@@ -0,0 +1,37 @@
+/**
+ * @file comm.h
+ * @brief Collectives for buffers larger than an int count.
+ *
+ * MPI counts are int, so a single MPI_Bcast moves at most INT_MAX
+ * elements; a replicated N x N matrix passes that at N = 46341.
+ * These wrappers split the transfer into int-sized pieces.
+ */
+
+#ifndef ASSIGNMENT5_COMM_H
+#define ASSIGNMENT5_COMM_H
+
+#include <mpi.h>
+#include <cstddef>
+
+namespace a5 {
+
+/**
+ * @brief Largest element count sent in one MPI call by bcast_large().
+ */
+std::size_t bcast_chunk_elements();
+
+/**
+ * @brief MPI_Bcast of `count` doubles, issued in chunks of bcast_chunk_elements().
+ *
+ * Collective over comm; every rank must pass the same count.
+ *
+ * @param buf   Buffer (source on root, destination elsewhere)
+ * @param count Number of doubles, may exceed INT_MAX
+ * @param root  Broadcasting rank
+ * @param comm  Communicator
+ */
+void bcast_large(double* buf, std::size_t count, int root, MPI_Comm comm);
+
+} // namespace a5
+
+#endif
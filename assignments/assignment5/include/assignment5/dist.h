@@ -1,17 +1,60 @@
 /**
  * @file dist.h
- * @brief Row-block distribution utilities for MPI GEMM.
+ * @brief Row distribution utilities for MPI GEMM.
  *
  * Implements a simple block distribution scheme that assigns contiguous
  * rows of an N x N matrix to P MPI ranks. Ranks with smaller indices
  * receive one extra row if N is not evenly divisible by P.
+ *
+ * Two static alternatives are provided for uneven work or uneven ranks:
+ * block-cyclic (blocks of b rows dealt round-robin) and weighted
+ * (contiguous blocks sized in proportion to a per-rank speed vector).
  */
 
 #ifndef ASSIGNMENT5_DIST_H
 #define ASSIGNMENT5_DIST_H
 
+#include <string>
+#include <vector>
+
 namespace a5 {
 
+/**
+ * @brief Static row distribution schemes.
+ */
+enum DistKind {
+  DIST_BLOCK,     ///< Equal contiguous blocks (row_block_partition)
+  DIST_CYCLIC,    ///< Blocks of `block` rows dealt round-robin
+  DIST_WEIGHTED   ///< Contiguous blocks proportional to rank speed
+};
+
+/**
+ * @brief A contiguous run of rows [offset, offset + count).
+ */
+struct RowSegment {
+  int offset;
+  int count;
+
+  RowSegment() : offset(0), count(0) {}
+  RowSegment(int o, int c) : offset(o), count(c) {}
+};
+
+/**
+ * @brief Complete description of a static row distribution.
+ *
+ * Identical on every rank once built, so any rank can answer ownership
+ * queries without communication.
+ */
+struct RowDistribution {
+  DistKind kind;
+  int N;                     ///< Rows
+  int P;                     ///< Ranks
+  int block;                 ///< Cyclic block size (DIST_CYCLIC)
+  std::vector<int> bounds;   ///< P + 1 row boundaries (DIST_WEIGHTED)
+
+  RowDistribution() : kind(DIST_BLOCK), N(0), P(1), block(1) {}
+};
+
 /**
  * @brief Compute the row range owned by a given rank.
  *
@@ -41,6 +84,82 @@ void row_block_partition(int N, int P, int rank, int& offset, int& count);
  */
 int owner_of_row(int N, int P, int row);
 
+/**
+ * @brief Owner of a row under block-cyclic distribution: (row / block) % P.
+ *
+ * @param N     Total number of rows
+ * @param P     Total number of ranks
+ * @param block Rows per block (>= 1)
+ * @param row   Global row index (0 <= row < N)
+ * @return Owning rank (0 if out of bounds)
+ */
+int owner_of_row_cyclic(int N, int P, int block, int row);
+
+/**
+ * @brief Number of rows a rank owns under block-cyclic distribution.
+ */
+int cyclic_row_count(int N, int P, int block, int rank);
+
+/**
+ * @brief Split N rows into P contiguous ranges proportional to weights.
+ *
+ * Largest-remainder apportionment: each rank gets floor(N * w / sum(w))
+ * rows and the leftover rows go to the largest fractional parts (lower
+ * rank first on ties). Non-positive or missing weights count as equal.
+ *
+ * @param N       Total number of rows
+ * @param weights One speed value per rank (size P)
+ * @param bounds  Output: P + 1 boundaries; rank r owns [bounds[r], bounds[r+1])
+ */
+void weighted_partition(int N, const std::vector<double>& weights, std::vector<int>& bounds);
+
+/**
+ * @brief Owner of a row given weighted boundaries (binary search).
+ *
+ * @param bounds Boundaries from weighted_partition()
+ * @param row    Global row index
+ * @return Owning rank (0 if out of bounds)
+ */
+int owner_of_row_weighted(const std::vector<int>& bounds, int row);
+
+/**
+ * @brief Build a distribution of N rows over P ranks.
+ *
+ * @param kind    Scheme to use
+ * @param N       Total number of rows
+ * @param P       Total number of ranks
+ * @param block   Block size for DIST_CYCLIC (clamped to >= 1)
+ * @param weights Per-rank speeds for DIST_WEIGHTED (ignored otherwise)
+ * @param d       Output distribution
+ */
+void make_distribution(DistKind kind, int N, int P, int block,
+                       const std::vector<double>& weights, RowDistribution& d);
+
+/**
+ * @brief Rank owning a row under any distribution.
+ */
+int dist_owner(const RowDistribution& d, int row);
+
+/**
+ * @brief Contiguous row runs owned by a rank, in increasing row order.
+ *
+ * @param d    Distribution
+ * @param rank Rank to query
+ * @param out  Output segments (cleared first)
+ */
+void dist_segments(const RowDistribution& d, int rank, std::vector<RowSegment>& out);
+
+/**
+ * @brief Read one positive weight per rank from a whitespace-separated file.
+ *
+ * @param path    File path
+ * @param P       Expected number of weights
+ * @param weights Output weights
+ * @param err     Error message on failure
+ * @return true on success
+ */
+bool load_weights(const std::string& path, int P, std::vector<double>& weights, std::string& err);
+
 } // namespace a5
 
 #endif
@@ -0,0 +1,88 @@
+/**
+ * @file gemm25d.h
+ * @brief Communication-avoiding 2.5D matrix multiplication.
+ *
+ * P = q * q * c ranks form a q x q x c grid. Layer 0 holds one block of A
+ * and B per rank; the blocks are replicated to the c layers, each layer
+ * runs q / c steps of Cannon's algorithm on its own slice of the inner
+ * dimension, and partial C blocks are summed back onto layer 0. Compared
+ * with 2D algorithms the words moved per rank drop by a factor of sqrt(c)
+ * at the price of c copies of A, B and C.
+ *
+ * The product is checked with Freivalds' algorithm on the C blocks of
+ * layer 0: rank (i, j) forms B(i, j) r_j, A(i, j) (B r)_j and C(i, j) r_j,
+ * and each is summed along grid row i (vector and tolerance from
+ * perf/freivalds.h), so every tile of the Cannon steps is covered.
+ */
+
+#ifndef ASSIGNMENT5_GEMM25D_H
+#define ASSIGNMENT5_GEMM25D_H
+
+#include <mpi.h>
+#include <vector>
+
+#include "perf/bench.h"
+
+namespace a5 {
+
+/**
+ * @brief Validate a 2.5D grid shape.
+ *
+ * @param P Number of ranks
+ * @param c Replication factor (number of layers)
+ * @param q Output: grid side, so that P == q * q * c
+ * @return true if q exists and is a multiple of c
+ */
+bool gemm25d_grid(int P, int c, int& q);
+
+/**
+ * @brief Words communicated per rank by each scheme (analytic model).
+ *
+ * @param N Matrix dimension
+ * @param P Number of ranks
+ * @param c Replication factor
+ * @param w1d  Output: 1D row-block with broadcast B, N^2
+ * @param w2d  Output: 2D (Cannon/SUMMA), 2 N^2 / sqrt(P)
+ * @param w25d Output: 2.5D, 2 N^2 / sqrt(cP) for the shifts, plus
+ *             3 N^2 c / P for replicating A, B and reducing C when c > 1
+ */
+void gemm25d_cost_model(int N, int P, int c, double& w1d, double& w2d, double& w25d);
+
+/**
+ * @brief Outcome of run_gemm25d(), valid on world rank 0.
+ */
+struct Gemm25dResult {
+  double c00, c0N1, cN10, cN1N1;  ///< Corner elements of C
+  double elapsed_s;               ///< Median time per timed iteration
+  double words_max;               ///< Measured words per rank per iteration (max over ranks)
+  double residual;                ///< Freivalds residual of the last iteration (every rank)
+  double verify_s;                ///< Time spent in the check
+  std::vector<double> samples;    ///< Time of each timed iteration (slowest rank)
+  perf::Stats stats;              ///< summarize() of the samples
+
+  Gemm25dResult();
+};
+
+/**
+ * @brief Multiply the standard A and B (see matrix.h) with the 2.5D algorithm.
+ *
+ * Collective over comm. Blocks are padded with zeros to q * ceil(N / q)
+ * so any N works. Each iteration includes replication, Cannon shifts and
+ * the final reduction; layer 0 reads its input blocks in place, so nothing
+ * is restored between iterations. Iterations run bench.warmup times
+ * untimed, then bench.reps times timed, each closed by a barrier. The C
+ * of the last iteration is then checked with the Freivalds vector of seed.
+ *
+ * @param comm  Communicator of P = q * q * c ranks (validated by the caller)
+ * @param N     Matrix dimension
+ * @param c     Replication factor
+ * @param bench Warm-up, repetitions and outlier settings
+ * @param seed  Freivalds seed, identical on all ranks
+ * @param out   Result (meaningful on rank 0 of comm)
+ */
+void run_gemm25d(MPI_Comm comm, int N, int c, const perf::BenchConfig& bench, unsigned int seed,
+                 Gemm25dResult& out);
+
+} // namespace a5
+
+#endif
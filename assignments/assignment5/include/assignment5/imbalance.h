@@ -0,0 +1,50 @@
+/**
+ * @file imbalance.h
+ * @brief Load-imbalance metrics over per-rank timings.
+ *
+ * Each rank times the compute part of an iteration and its wait at the
+ * barrier that ends it. Rank 0 reduces such per-rank values to their spread.
+ * The imbalance ratio max/avg is 1 under perfect balance. A ratio r means the
+ * iteration took r times as long as it would with the same work spread
+ * evenly, and the slowest rank is the one to look at.
+ */
+
+#ifndef ASSIGNMENT5_IMBALANCE_H
+#define ASSIGNMENT5_IMBALANCE_H
+
+#include <vector>
+
+namespace a5 {
+
+/**
+ * @brief Spread of one value over ranks.
+ */
+struct Spread {
+  double min;    ///< Smallest value
+  double avg;    ///< Mean value
+  double max;    ///< Largest value
+  int argmin;    ///< Rank with the smallest value (first if tied)
+  int argmax;    ///< Rank with the largest value (first if tied)
+  double ratio;  ///< max / avg (1 when avg is 0)
+
+  Spread();
+};
+
+/**
+ * @brief Spread of per-rank values, indexed by rank.
+ *
+ * @param v One value per rank (empty gives a zero Spread with ratio 1)
+ */
+Spread spread_of(const std::vector<double>& v);
+
+/**
+ * @brief Imbalance ratio max/avg from a maximum and a sum over P ranks.
+ *
+ * For values reduced with MPI_MAX and MPI_SUM, e.g. per iteration.
+ * @return 1 when the sum is not positive
+ */
+double imbalance_ratio(double max, double sum, int P);
+
+} // namespace a5
+
+#endif
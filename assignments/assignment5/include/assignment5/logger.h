@@ -4,6 +4,8 @@
  *
  * Provides INFO and ERROR logging functions that conditionally output
  * messages based on the caller's rank, simplifying MPI output coordination.
+ * Both write through perf's logger, which is asynchronous and tags lines
+ * with rank and thread once main() calls perf::log_open() (see perf/log.h).
  */
 
 #ifndef ASSIGNMENT5_LOGGER_H
@@ -16,7 +18,8 @@ namespace a5 {
 /**
  * @brief Log an informational message (rank 0 only).
  *
- * Only rank 0 will print the message to stdout. Other ranks silently ignore.
+ * Only rank 0 will print the message to stdout. Other ranks silently ignore,
+ * except that with the log open their message reaches their own log file.
  * Use this to avoid duplicated output when all ranks execute the same code.
  *
  * @param rank Current MPI rank
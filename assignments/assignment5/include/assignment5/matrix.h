@@ -28,12 +28,28 @@ namespace a5 {
 void init_B(std::vector<double>& B, int N);
 
 /**
- * @brief Compute local rows of C = A * B using the standard triple loop.
+ * @brief Fill caller-provided storage with B[k][j] = 1.0 / (j + 1).
+ *
+ * Same as init_B(std::vector<double>&, int) but writes into existing
+ * memory, e.g. a node-shared window (see nodeshare.h).
+ *
+ * @param B Pointer to at least N*N doubles (row-major)
+ * @param N Dimension of the square matrix
+ */
+void init_B(double* B, int N);
+
+/**
+ * @brief Compute local rows of C = A * B using a cache-blocked kernel.
  *
  * Each rank computes a subset of rows. The values of A are computed on the fly
  * (A[i][k] = i + 1) to save memory. Only the four boundary elements of C
  * (corners) are stored and returned to the caller.
  *
+ * When built with OpenMP the rows are split into blocks that are shared out
+ * among threads (OMP_NUM_THREADS), so one rank can use all cores of a node.
+ * Each corner has exactly one writing thread; the function returns only
+ * after all threads are done, so the caller may read them without locking.
+ *
  * @param N          Matrix dimension (N x N)
  * @param row_offset Global starting row index for this rank
  * @param row_count  Number of rows to compute locally
@@ -53,6 +69,117 @@ void compute_local_rows(
     double* cN10,
     double* cN1N1);
 
+/**
+ * @brief Compute local rows of C = A * B reading B through a raw pointer.
+ *
+ * Identical to the std::vector overload; used when B lives in memory not
+ * owned by a vector (for example a node-shared MPI window).
+ *
+ * @param B Pointer to the full N x N matrix B (row-major)
+ */
+void compute_local_rows(
+    int N,
+    int row_offset,
+    int row_count,
+    const double* B,
+    double* c00,
+    double* c0N1,
+    double* cN10,
+    double* cN1N1);
+
+/**
+ * @brief Compute local rows of C and, optionally, the product C * r.
+ *
+ * Same as the pointer overload; additionally, when r and Cr are both
+ * non-NULL, stores Cr[l] = sum_j C[row_offset + l][j] * r[j] for every
+ * local row l. The dot products reuse the row block while it is in
+ * cache, so this costs O(row_count * N) on top of the multiply and lets
+ * a Freivalds check (see verify.h) cover every element of C.
+ *
+ * @param r  Vector of N entries, or NULL
+ * @param Cr Output of row_count entries, or NULL
+ */
+void compute_local_rows(
+    int N,
+    int row_offset,
+    int row_count,
+    const double* B,
+    double* c00,
+    double* c0N1,
+    double* cN10,
+    double* cN1N1,
+    const double* r,
+    double* Cr);
+
+/**
+ * @brief Add one panel of rows of B to local rows of C (C += A * panel).
+ *
+ * Runs the blocked kernel of compute_local_rows() (same tiles, loop order
+ * and threads, see kernel_config()) on kc rows of B at a time, for
+ * variants that receive B in pieces such as the one-sided GEMM. A[i][k] =
+ * i + 1 does not depend on k, so the global index of the panel's rows is
+ * not needed.
+ *
+ * @param N          Matrix dimension
+ * @param row_offset Global index of the first local row
+ * @param row_count  Number of local rows
+ * @param kc         Rows in the panel
+ * @param panel      kc x N row-major rows of B
+ * @param C          row_count x N local rows of C, accumulated into
+ */
+void accumulate_panel_rows(
+    int N,
+    int row_offset,
+    int row_count,
+    int kc,
+    const double* panel,
+    double* C);
+
+/**
+ * @brief Order of the two cache-block loops around the row loop.
+ *
+ * Both keep the k terms of each C[i][j] in ascending order, so results
+ * are identical; they differ in which B panel stays hot longer.
+ */
+enum LoopOrder {
+  ORDER_JK,  ///< Column blocks outer, k blocks inner (a C row slice stays hot)
+  ORDER_KJ   ///< k blocks outer, column blocks inner (a B row panel stays hot)
+};
+
+/**
+ * @brief Tunable parameters of the blocked kernel (see tune.h).
+ */
+struct KernelConfig {
+  int block_rows;   ///< Rows per thread work unit
+  int block_k;      ///< Rows of the B panel
+  int block_j;      ///< Columns of the B panel
+  LoopOrder order;  ///< Cache-block loop order
+  int threads;      ///< OpenMP threads per rank (0 = runtime default)
+
+  /// Built-in defaults: 16 x 128 x 512, ORDER_JK, runtime thread count
+  KernelConfig();
+};
+
+/**
+ * @brief Select the kernel parameters used by compute_local_rows().
+ *
+ * Not thread-safe; call from the main thread between multiplies. A
+ * positive thread count is applied with omp_set_num_threads().
+ */
+void set_kernel_config(const KernelConfig& cfg);
+
+/**
+ * @brief Kernel parameters currently in use.
+ */
+const KernelConfig& kernel_config();
+
+/**
+ * @brief Number of threads compute_local_rows() will use per rank.
+ *
+ * @return omp_get_max_threads() when built with OpenMP, otherwise 1
+ */
+int compute_threads();
+
 /**
  * @brief Check if matrix B exceeds a memory threshold.
  *
@@ -0,0 +1,87 @@
+/**
+ * @file nodeshare.h
+ * @brief Node-local shared storage for matrix B via MPI-3 shared-memory windows.
+ *
+ * Instead of every rank holding its own copy of B after a world-wide
+ * broadcast, ranks on the same node map a single copy allocated with
+ * MPI_Win_allocate_shared. Only one rank per node (the node leader)
+ * takes part in the inter-node broadcast. Requires an MPI-3 library;
+ * shared_b_supported() reports whether the feature was compiled in.
+ */
+
+#ifndef ASSIGNMENT5_NODESHARE_H
+#define ASSIGNMENT5_NODESHARE_H
+
+#include <mpi.h>
+#include <cstddef>
+
+namespace a5 {
+
+/**
+ * @brief Communicators and window backing one node-shared copy of B.
+ *
+ * node_comm groups the ranks of one shared-memory node; leader_comm
+ * connects node rank 0 of every node and is MPI_COMM_NULL on all other
+ * ranks. World rank 0 is always node rank 0 and leader rank 0.
+ */
+struct SharedB {
+  MPI_Comm node_comm;    ///< Ranks sharing memory with this rank
+  MPI_Comm leader_comm;  ///< Node leaders only (MPI_COMM_NULL elsewhere)
+  MPI_Win  win;          ///< Shared window; memory is owned by node rank 0
+  double*  data;         ///< Node-local B, valid on every rank of the node
+  int node_rank;         ///< Rank within node_comm
+  int node_size;         ///< Number of ranks on this node
+  int node_count;        ///< Number of nodes (valid on leaders)
+
+  SharedB();
+};
+
+/**
+ * @brief Whether node-shared B is available (built against MPI >= 3).
+ */
+bool shared_b_supported();
+
+/**
+ * @brief Split comm into per-node and node-leader communicators.
+ *
+ * Collective over comm. Fills node_comm, leader_comm, node_rank,
+ * node_size and node_count. Returns false (and leaves sb untouched)
+ * when shared memory windows are not supported by the MPI library.
+ *
+ * @param comm Parent communicator (normally MPI_COMM_WORLD)
+ * @param sb   Output structure
+ * @return true on success
+ */
+bool shared_b_init(MPI_Comm comm, SharedB& sb);
+
+/**
+ * @brief Allocate count doubles once per node and map them on every rank.
+ *
+ * Collective over sb.node_comm. Node rank 0 contributes all memory; other
+ * ranks contribute none and obtain its base address via MPI_Win_shared_query.
+ *
+ * @param sb    Structure initialized by shared_b_init()
+ * @param count Number of doubles (N * N for B)
+ */
+void shared_b_allocate(SharedB& sb, std::size_t count);
+
+/**
+ * @brief Broadcast B from leader rank 0 to all node leaders, then publish it.
+ *
+ * Leaders exchange the data over leader_comm; a window fence on every
+ * node then makes the leader's stores visible to the other node ranks.
+ * Collective over the parent communicator.
+ *
+ * @param sb    Structure with allocated window
+ * @param count Number of doubles to broadcast
+ */
+void shared_b_broadcast(SharedB& sb, std::size_t count);
+
+/**
+ * @brief Release the window and communicators created for sb.
+ */
+void shared_b_free(SharedB& sb);
+
+} // namespace a5
+
+#endif
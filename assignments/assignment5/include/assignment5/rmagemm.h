@@ -0,0 +1,80 @@
+/**
+ * @file rmagemm.h
+ * @brief One-sided GEMM: ranks fetch row panels of B on demand.
+ *
+ * B is distributed by row block (see dist.h) and exposed through an
+ * MPI window. Each rank computes its row block of C by pulling B panel
+ * by panel with MPI_Rget, prefetching the next panel while the current
+ * one is multiplied. There is no collective in the compute loop, so a
+ * fast rank never waits for slow ones. Requires an MPI-3 library.
+ *
+ * A matching collective baseline (MPI_Bcast of B, then compute) is
+ * provided so both can be timed on the same N and P in one run. Both use
+ * the blocked kernel of matrix.h (the RMA variant panel by panel) and the
+ * harness of perf/bench.h, so they differ only in how B moves.
+ */
+
+#ifndef ASSIGNMENT5_RMAGEMM_H
+#define ASSIGNMENT5_RMAGEMM_H
+
+#include <mpi.h>
+#include <vector>
+
+#include "perf/bench.h"
+
+namespace a5 {
+
+/**
+ * @brief Timing and corners of one GEMM variant, valid on rank 0.
+ */
+struct GemmRunResult {
+  double c00, c0N1, cN10, cN1N1;  ///< Corner elements of C
+  double elapsed_s;               ///< Median time per timed iteration
+  double comm_s;                  ///< Mean time per timed iteration blocked on communication (max over ranks)
+  double residual;                ///< Freivalds residual of the last iteration (see verify.h)
+  std::vector<double> samples;    ///< Time of each timed iteration (slowest rank)
+  perf::Stats stats;              ///< summarize() of the samples
+
+  GemmRunResult();
+};
+
+/**
+ * @brief Whether the RMA variant is available (built against MPI >= 3).
+ */
+bool rma_gemm_supported();
+
+/**
+ * @brief Collective baseline: broadcast B from rank 0, then compute rows.
+ *
+ * Every iteration re-broadcasts B so that its cost is part of the timing,
+ * matching the per-iteration panel fetches of run_rma_gemm(). Iterations
+ * run bench.warmup times untimed, then bench.reps times timed, each closed
+ * by a barrier.
+ *
+ * @param comm  Communicator
+ * @param N     Matrix dimension
+ * @param bench Warm-up, repetitions and outlier settings
+ * @param seed  Freivalds seed, identical on all ranks
+ * @param out   Result (rank 0)
+ */
+void run_bcast_gemm(MPI_Comm comm, int N, const perf::BenchConfig& bench, unsigned int seed,
+                    GemmRunResult& out);
+
+/**
+ * @brief One-sided variant: fetch B panels with MPI_Rget, double-buffered.
+ *
+ * The compute loop has no collective; iterations are timed as in
+ * run_bcast_gemm(), with a barrier after each.
+ *
+ * @param comm  Communicator
+ * @param N     Matrix dimension
+ * @param bench Warm-up, repetitions and outlier settings
+ * @param seed  Freivalds seed, identical on all ranks
+ * @param out   Result (rank 0)
+ */
+void run_rma_gemm(MPI_Comm comm, int N, const perf::BenchConfig& bench, unsigned int seed,
+                  GemmRunResult& out);
+
+} // namespace a5
+
+#endif
@@ -0,0 +1,100 @@
+/**
+ * @file sched.h
+ * @brief Dynamic row scheduling for heterogeneous clusters.
+ *
+ * Instead of a fixed row block per rank, ranks repeatedly claim chunks of
+ * rows from a shared counter hosted on rank 0 (the coordinator). Claims use
+ * MPI-3 MPI_Fetch_and_op under a passive-target epoch, so the coordinator's
+ * CPU is never involved and it computes rows like everyone else. Each rank
+ * sizes its next claim from its own measured throughput, so fast ranks take
+ * larger chunks and the tail of an iteration is split finely.
+ */
+
+#ifndef ASSIGNMENT5_SCHED_H
+#define ASSIGNMENT5_SCHED_H
+
+#include <mpi.h>
+
+namespace a5 {
+
+/**
+ * @brief Size of the next chunk a rank should claim.
+ *
+ * Guided self-scheduling bounded by throughput: at most
+ * ceil(remaining / (2 * P)) rows, and at most the rows this rank can
+ * finish in quantum_s at its measured rate. Without a rate yet
+ * (rows_per_s <= 0) a probe chunk of min_rows is returned.
+ * The result is never below min(min_rows, remaining) nor above remaining.
+ *
+ * @param remaining  Rows not yet claimed (estimate)
+ * @param P          Number of ranks competing for rows
+ * @param rows_per_s Measured rate of this rank (rows per second), or 0
+ * @param quantum_s  Target wall time per chunk (seconds)
+ * @param min_rows   Smallest chunk worth a remote atomic
+ * @return Rows to claim (0 only if remaining <= 0)
+ */
+int adaptive_chunk_rows(int remaining, int P, double rows_per_s,
+                        double quantum_s, int min_rows);
+
+/**
+ * @brief State of one rank's view of the shared row counter.
+ */
+struct RowScheduler {
+  MPI_Win win;        ///< Window exposing the counter (memory on rank 0)
+  long* counter;      ///< Counter storage (non-null on rank 0 only)
+  int N;              ///< Rows per iteration
+  int P;              ///< Ranks in the communicator
+  int rank;           ///< Rank of the caller
+  long next_hint;     ///< Counter value after this rank's last claim
+  double rows_per_s;  ///< Smoothed throughput of this rank (0 = unknown)
+  double quantum_s;   ///< Target wall time per chunk
+
+  RowScheduler();
+};
+
+/**
+ * @brief Whether dynamic scheduling is available (built against MPI >= 3).
+ */
+bool row_scheduler_supported();
+
+/**
+ * @brief Create the shared counter; collective over comm.
+ *
+ * @param comm Communicator of the ranks sharing the rows
+ * @param N    Rows per iteration
+ * @param s    Output scheduler state
+ * @return false if MPI-3 atomics are not available
+ */
+bool row_scheduler_create(MPI_Comm comm, int N, RowScheduler& s);
+
+/**
+ * @brief Claim the next chunk of rows.
+ *
+ * @param s      Scheduler state
+ * @param offset Output: first global row of the chunk
+ * @param count  Output: number of rows in the chunk
+ * @return false when all rows of the current iteration are claimed
+ */
+bool row_scheduler_next(RowScheduler& s, int& offset, int& count);
+
+/**
+ * @brief Feed back the time a chunk took, updating the throughput estimate.
+ */
+void row_scheduler_record(RowScheduler& s, int rows, double seconds);
+
+/**
+ * @brief Reset the counter for the next iteration; collective over comm.
+ *
+ * Must be called after every rank has finished claiming (e.g. after the
+ * per-iteration barrier). Returns once the reset is visible to all ranks.
+ */
+void row_scheduler_reset(RowScheduler& s, MPI_Comm comm);
+
+/**
+ * @brief Release the window; collective over the creating communicator.
+ */
+void row_scheduler_free(RowScheduler& s);
+
+} // namespace a5
+
+#endif
@@ -0,0 +1,42 @@
+/**
+ * @file sysmem.h
+ * @brief Per-rank memory budgets agreed on by all ranks.
+ *
+ * A node may use perf::memory_budget_bytes() (a fraction of its available
+ * memory, see perf/sysmem.h), and ranks sharing a node split that budget. The
+ * per-rank budget is agreed on with a global minimum so that every rank
+ * takes the same accept/reject branch.
+ */
+
+#ifndef ASSIGNMENT5_SYSMEM_H
+#define ASSIGNMENT5_SYSMEM_H
+
+#include <mpi.h>
+#include <cstddef>
+
+namespace a5 {
+
+/**
+ * @brief Number of ranks of comm on this rank's shared-memory node.
+ *
+ * Collective over comm. Uses MPI_Comm_split_type, so it returns 1 when
+ * built against an MPI-2 library.
+ */
+int ranks_on_node(MPI_Comm comm);
+
+/**
+ * @brief Bytes one rank may allocate, agreed on by all ranks of comm.
+ *
+ * Collective over comm. With per_rank_copy the node budget is divided by
+ * the ranks on the node (each holds its own buffer); otherwise the node
+ * budget applies as a whole (one copy per node, as with --shared-B).
+ *
+ * @param comm          Communicator
+ * @param per_rank_copy Whether every rank allocates its own buffer
+ * @return Minimum of the budget over all ranks
+ */
+std::size_t agreed_memory_budget(MPI_Comm comm, bool per_rank_copy);
+
+} // namespace a5
+
+#endif
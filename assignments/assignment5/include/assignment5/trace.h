@@ -0,0 +1,65 @@
+/**
+ * @file trace.h
+ * @brief Merge the phase traces of all ranks into one timeline.
+ *
+ * Every rank records its phases with perf/trace.h on its own monotonic
+ * clock. Clocks of different nodes have unrelated origins, and even on one
+ * node nothing ties them to rank 0's. Before merging, rank 0 therefore
+ * estimates each rank's offset with a few ping-pongs: it notes its send time
+ * t0 and receive time t1, the rank replies with its clock tr, and
+ * tr - (t0 + t1) / 2 is the offset if both directions took equally long.
+ * The ping with the shortest round trip bounds that error best and is kept.
+ * The events are then gathered to rank 0 and shifted onto its clock.
+ */
+
+#ifndef ASSIGNMENT5_TRACE_H
+#define ASSIGNMENT5_TRACE_H
+
+#include <mpi.h>
+#include <string>
+#include <vector>
+
+#include "perf/trace.h"
+
+namespace a5 {
+
+/**
+ * @brief Clock offset from ping-pong timings (the round with the shortest round trip).
+ *
+ * @param t_send   Local send times
+ * @param t_remote Remote clock at the reply, one per round
+ * @param t_recv   Local receive times
+ * @return Remote clock minus local clock (0 without rounds)
+ */
+double clock_offset_from_pings(const std::vector<double>& t_send,
+                               const std::vector<double>& t_remote,
+                               const std::vector<double>& t_recv);
+
+/**
+ * @brief Flatten events for sending: three doubles (ts, ph, tid) each, names NUL-separated.
+ */
+void pack_trace(const std::vector<perf::TraceEvent>& events, std::vector<double>& nums,
+                std::string& names);
+
+/**
+ * @brief Append the events of pack_trace() output, with pid and ts shifted by -offset.
+ */
+void unpack_trace(const std::vector<double>& nums, const std::string& names, int pid,
+                  double offset, std::vector<perf::TraceEvent>& out);
+
+/**
+ * @brief Gather all ranks' events to rank 0 on rank 0's clock (collective).
+ *
+ * @param comm          Communicator
+ * @param local         This rank's events (perf::trace_stop())
+ * @param merged        Rank 0: the events of all ranks, sorted by time
+ * @param process_names Rank 0: "rank r (host)" per rank
+ * @param offsets       Rank 0: the estimated clock offset of each rank (seconds)
+ */
+void gather_trace(MPI_Comm comm, const std::vector<perf::TraceEvent>& local,
+                  std::vector<perf::TraceEvent>& merged, std::vector<std::string>& process_names,
+                  std::vector<double>& offsets);
+
+} // namespace a5
+
+#endif
@@ -0,0 +1,104 @@
+/**
+ * @file tune.h
+ * @brief Autotuning of the GEMM kernel with a per-host cache file.
+ *
+ * The search times compute_local_rows() on a sample problem and walks the
+ * parameters of KernelConfig one at a time (coordinate descent: thread
+ * count, panel width, panel depth, rows per work unit, loop order),
+ * keeping a change only when it is faster. The winner is written to a
+ * small key=value file named after the host, which later runs load at
+ * startup so production jobs use the tuned kernel without searching.
+ *
+ * Cache location: $A5_TUNE_DIR if set, else $HOME, else the working
+ * directory; file name .assignment5-tune-<host>. The file also records
+ * how many ranks shared the host during the search, because the best
+ * thread count depends on it.
+ */
+
+#ifndef ASSIGNMENT5_TUNE_H
+#define ASSIGNMENT5_TUNE_H
+
+#include <mpi.h>
+#include <string>
+
+#include "assignment5/matrix.h"
+
+namespace a5 {
+
+/**
+ * @brief Outcome of autotune_kernel().
+ */
+struct TuneResult {
+  KernelConfig best;   ///< Fastest configuration found
+  double gflops;       ///< Its rate on the sample problem
+  double base_gflops;  ///< Rate of the built-in defaults on the same problem
+  int evaluations;     ///< Configurations timed
+
+  TuneResult();
+};
+
+/**
+ * @brief Split comm into one communicator per host name.
+ *
+ * Collective over comm; MPI-1 only (compares perf::host_name() results,
+ * the same name the cache file uses). Rank 0 of each result is the lowest
+ * rank of comm on that host. Free the result with MPI_Comm_free.
+ */
+MPI_Comm split_by_host(MPI_Comm comm);
+
+/**
+ * @brief Cache file path for a host (see the file comment).
+ */
+std::string tune_cache_path(const std::string& host);
+
+/**
+ * @brief One-line description, e.g. "rows=16 k=128 j=512 order=jk threads=8".
+ */
+std::string format_kernel_config(const KernelConfig& cfg);
+
+/**
+ * @brief Read a cache file written by save_tune_cache().
+ *
+ * @param path   Cache file
+ * @param host   Expected host; a file written for another host is rejected
+ * @param cfg    Output configuration
+ * @param ranks  Output: ranks on the host during the search (0 if unknown)
+ * @param gflops Output: rate recorded when the file was written
+ * @param err    Reason on failure (missing file, wrong host, bad value)
+ * @return true if cfg was filled
+ */
+bool load_tune_cache(const std::string& path, const std::string& host,
+                     KernelConfig& cfg, int& ranks, double& gflops, std::string& err);
+
+/**
+ * @brief Write a configuration and its rate to a cache file.
+ *
+ * @return false (with err) if the file cannot be written
+ */
+bool save_tune_cache(const std::string& path, const std::string& host, int ranks,
+                     const KernelConfig& cfg, double gflops, std::string& err);
+
+/**
+ * @brief Time compute_local_rows() with cfg on rows x N of C (best of two).
+ *
+ * Leaves cfg active.
+ *
+ * @return GFLOPS
+ */
+double time_kernel(const KernelConfig& cfg, int N, int rows, const double* B);
+
+/**
+ * @brief Coordinate-descent search over KernelConfig; no MPI calls.
+ *
+ * Times a rows x N slice of C against an N x N B built internally. The
+ * best configuration is left active (set_kernel_config()).
+ *
+ * @param N    Sample dimension
+ * @param rows Sample rows of C
+ * @param out  Result
+ */
+void autotune_kernel(int N, int rows, TuneResult& out);
+
+} // namespace a5
+
+#endif
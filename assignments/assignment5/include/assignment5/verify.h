@@ -0,0 +1,76 @@
+/**
+ * @file verify.h
+ * @brief Freivalds randomized verification of the full product C = A * B.
+ *
+ * For a random vector r, C = A * B implies C r = A (B r). Both sides cost
+ * O(N^2) instead of the O(N^3) multiply. The vector r and the rounding
+ * tolerance come from perf/freivalds.h, which also states which errors
+ * stay below the tolerance (single terms at large N). The check
+ * is distributed: each rank forms B r for its own rows of B, the pieces are
+ * all-gathered, and each rank compares A (B r) with the C r produced by the
+ * compute kernel for the rows of C it computed.
+ *
+ * A is never stored: A[i][k] = i + 1, as in matrix.h.
+ */
+
+#ifndef ASSIGNMENT5_VERIFY_H
+#define ASSIGNMENT5_VERIFY_H
+
+#include <mpi.h>
+#include <vector>
+
+#include "assignment5/dist.h"
+
+namespace a5 {
+
+/**
+ * @brief Entries of B r and |B| r for a slice of kc rows of B (no MPI).
+ *
+ * @param B_rows kc x N row-major rows of B
+ * @param kc     Number of rows
+ * @param N      Matrix dimension
+ * @param r      Random vector (N entries, positive)
+ * @param Br     Output: kc entries of B r
+ * @param absBr  Output: kc entries of |B| r
+ */
+void freivalds_partial_Br(const double* B_rows, int kc, int N, const std::vector<double>& r,
+                          double* Br, double* absBr);
+
+/**
+ * @brief Largest relative residual |A(Br) - Cr|_i / (|A|(|B|r))_i over rows (no MPI).
+ *
+ * @param N     Matrix dimension
+ * @param rows  Rows of C to check
+ * @param Cr    C r indexed by global row (N entries; only listed rows are read)
+ * @param Br    Full B r (N entries)
+ * @param absBr Full |B| r (N entries)
+ * @return Maximum residual over the listed rows (0 if none)
+ */
+double freivalds_local_residual(int N, const std::vector<RowSegment>& rows,
+                                const std::vector<double>& Cr,
+                                const std::vector<double>& Br,
+                                const std::vector<double>& absBr);
+
+/**
+ * @brief Distributed Freivalds residual; collective over comm.
+ *
+ * The B rows held by the ranks must partition [0, N) in rank order (as
+ * row_block_partition() does); only their counts are exchanged.
+ *
+ * @param comm   Communicator
+ * @param N      Matrix dimension
+ * @param B_rows This rank's rows of B (kc x N, row-major)
+ * @param kc     Number of B rows held by this rank
+ * @param r      Random vector, identical on all ranks
+ * @param rows   Rows of C this rank computed
+ * @param Cr     C r indexed by global row (N entries)
+ * @return Maximum residual over all ranks (on every rank)
+ */
+double freivalds_residual(MPI_Comm comm, int N, const double* B_rows, int kc,
+                          const std::vector<double>& r,
+                          const std::vector<RowSegment>& rows,
+                          const std::vector<double>& Cr);
+
+} // namespace a5
+
+#endif
@@ -34,13 +34,28 @@ static bool parse_int(const char* s, int& out) {
 
 bool parse_cli(int argc, char** argv, Options& out, std::string& err) {
   if (argc < 2) {
-    err = "Usage: assignment5 <N> [--iters k]";
+    err = std::string("Usage: assignment5 <N> [--iters k] [--shared-B] [--sched static|dynamic] "
+          "[--dist block|cyclic|weighted] [--block b] [--weights file] "
+          "[--algo rowblock|2.5d|rma] [--rep c] [--tune] [--counters] [--rank-detail] "
+          "[--trace FILE] ") + perf::bench_usage();
     return false;
   }
   
   int i = 1;
   int N = 0;
-  int iters = 1;
+  perf::BenchConfig bench;
+  int iters = bench.reps;
+  bool shared_b = false;
+  Schedule sched = SCHEDULE_STATIC;
+  DistKind dist = DIST_BLOCK;
+  int block = 16;
+  std::string weights_path;
+  Algorithm algo = ALGO_ROWBLOCK;
+  int rep = 1;
+  bool tune = false;
+  bool counters = false;
+  bool rank_detail = false;
+  std::string trace_path;
   bool haveN = false;
   
   while (i < argc) {
@@ -48,13 +63,117 @@ bool parse_cli(int argc, char** argv, Options& out, std::string& err) {
     
     // Check for named options starting with "--"
     if (a[0] == '-' && a[1] == '-') {
-      if (std::strcmp(a, "--iters") == 0) {
+      // Harness options first: --warmup, --outlier-k, --json, --csv
+      const int consumed = std::strcmp(a, "--reps") == 0 ? 0
+                         : perf::parse_bench_option(argc, argv, i, bench, err);
+      if (consumed < 0) {
+        return false;
+      }
+      if (consumed > 0) {
+        continue;
+      }
+      if (std::strcmp(a, "--iters") == 0 || std::strcmp(a, "--reps") == 0) {
         if (i + 1 >= argc) {
-          err = "missing value for --iters";
+          err = std::string("missing value for ") + a;
           return false;
         }
         if (!parse_int(argv[i + 1], iters) || iters <= 0) {
-          err = "invalid --iters";
+          err = std::string("invalid ") + a;
+          return false;
+        }
+        i += 2;
+      } else if (std::strcmp(a, "--shared-B") == 0) {
+        shared_b = true;
+        ++i;
+      } else if (std::strcmp(a, "--tune") == 0) {
+        tune = true;
+        ++i;
+      } else if (std::strcmp(a, "--counters") == 0) {
+        counters = true;
+        ++i;
+      } else if (std::strcmp(a, "--rank-detail") == 0) {
+        rank_detail = true;
+        ++i;
+      } else if (std::strcmp(a, "--trace") == 0) {
+        if (i + 1 >= argc) {
+          err = "missing value for --trace";
+          return false;
+        }
+        trace_path = argv[i + 1];
+        i += 2;
+      } else if (std::strcmp(a, "--sched") == 0) {
+        if (i + 1 >= argc) {
+          err = "missing value for --sched";
+          return false;
+        }
+        const char* v = argv[i + 1];
+        if (std::strcmp(v, "static") == 0) {
+          sched = SCHEDULE_STATIC;
+        } else if (std::strcmp(v, "dynamic") == 0) {
+          sched = SCHEDULE_DYNAMIC;
+        } else {
+          err = "invalid --sched (expected static or dynamic)";
+          return false;
+        }
+        i += 2;
+      } else if (std::strcmp(a, "--dist") == 0) {
+        if (i + 1 >= argc) {
+          err = "missing value for --dist";
+          return false;
+        }
+        const char* v = argv[i + 1];
+        if (std::strcmp(v, "block") == 0) {
+          dist = DIST_BLOCK;
+        } else if (std::strcmp(v, "cyclic") == 0) {
+          dist = DIST_CYCLIC;
+        } else if (std::strcmp(v, "weighted") == 0) {
+          dist = DIST_WEIGHTED;
+        } else {
+          err = "invalid --dist (expected block, cyclic or weighted)";
+          return false;
+        }
+        i += 2;
+      } else if (std::strcmp(a, "--block") == 0) {
+        if (i + 1 >= argc) {
+          err = "missing value for --block";
+          return false;
+        }
+        if (!parse_int(argv[i + 1], block) || block <= 0) {
+          err = "invalid --block";
+          return false;
+        }
+        i += 2;
+      } else if (std::strcmp(a, "--weights") == 0) {
+        if (i + 1 >= argc) {
+          err = "missing value for --weights";
+          return false;
+        }
+        weights_path = argv[i + 1];
+        i += 2;
+      } else if (std::strcmp(a, "--algo") == 0) {
+        if (i + 1 >= argc) {
+          err = "missing value for --algo";
+          return false;
+        }
+        const char* v = argv[i + 1];
+        if (std::strcmp(v, "rowblock") == 0) {
+          algo = ALGO_ROWBLOCK;
+        } else if (std::strcmp(v, "2.5d") == 0) {
+          algo = ALGO_25D;
+        } else if (std::strcmp(v, "rma") == 0) {
+          algo = ALGO_RMA;
+        } else {
+          err = "invalid --algo (expected rowblock, 2.5d or rma)";
+          return false;
+        }
+        i += 2;
+      } else if (std::strcmp(a, "--rep") == 0) {
+        if (i + 1 >= argc) {
+          err = "missing value for --rep";
+          return false;
+        }
+        if (!parse_int(argv[i + 1], rep) || rep <= 0) {
+          err = "invalid --rep";
           return false;
         }
         i += 2;
@@ -82,8 +201,50 @@ bool parse_cli(int argc, char** argv, Options& out, std::string& err) {
     return false;
   }
   
+  if (sched == SCHEDULE_DYNAMIC && dist != DIST_BLOCK) {
+    err = "--dist cannot be combined with --sched dynamic";
+    return false;
+  }
+  if (!weights_path.empty() && dist != DIST_WEIGHTED) {
+    err = "--weights requires --dist weighted";
+    return false;
+  }
+  if (algo != ALGO_ROWBLOCK && (shared_b || sched != SCHEDULE_STATIC || dist != DIST_BLOCK)) {
+    err = "--algo 2.5d/rma cannot be combined with --shared-B, --sched or --dist";
+    return false;
+  }
+  if (rep != 1 && algo != ALGO_25D) {
+    err = "--rep requires --algo 2.5d";
+    return false;
+  }
+  if (counters && algo != ALGO_ROWBLOCK) {
+    err = "--counters requires --algo rowblock";
+    return false;
+  }
+  if (rank_detail && algo != ALGO_ROWBLOCK) {
+    err = "--rank-detail requires --algo rowblock";
+    return false;
+  }
+  if (!trace_path.empty() && algo != ALGO_ROWBLOCK) {
+    err = "--trace requires --algo rowblock";
+    return false;
+  }
+  
   out.N = N;
   out.iters = iters;
+  out.bench = bench;
+  out.bench.reps = iters;
+  out.shared_b = shared_b;
+  out.sched = sched;
+  out.dist = dist;
+  out.block = block;
+  out.weights_path = weights_path;
+  out.algo = algo;
+  out.rep = rep;
+  out.tune = tune;
+  out.counters = counters;
+  out.rank_detail = rank_detail;
+  out.trace_path = trace_path;
   return true;
 }
 
@@ -0,0 +1,27 @@
+/**
+ * @file comm.cpp
+ * @brief Implementation of the chunked broadcast.
+ */
+
+#include "assignment5/comm.h"
+
+
+namespace a5 {
+
+// 2^30 doubles (8 GiB) per call: well below INT_MAX, and chunks this
+// large keep the per-call overhead negligible
+static const std::size_t kBcastChunk = static_cast<std::size_t>(1) << 30;
+
+std::size_t bcast_chunk_elements() {
+  return kBcastChunk;
+}
+
+void bcast_large(double* buf, std::size_t count, int root, MPI_Comm comm) {
+  for (std::size_t done = 0; done < count; done += kBcastChunk) {
+    const std::size_t left = count - done;
+    const std::size_t part = (left < kBcastChunk) ? left : kBcastChunk;
+    MPI_Bcast(buf + done, static_cast<int>(part), MPI_DOUBLE, root, comm);
+  }
+}
+
+} // namespace a5
@@ -1,13 +1,18 @@
 /**
  * @file dist.cpp
- * @brief Implementation of row-block distribution functions.
+ * @brief Implementation of row distribution functions.
  *
  * Provides the logic for distributing rows across MPI ranks in a balanced
- * manner, ensuring each rank receives approximately N / P rows.
+ * manner, ensuring each rank receives approximately N / P rows, plus the
+ * block-cyclic and weighted variants.
  */
 
 #include "assignment5/dist.h"
 
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
 namespace a5 {
 
 void row_block_partition(int N, int P, int rank, int& offset, int& count) {
@@ -51,4 +56,157 @@ int owner_of_row(int N, int P, int row) {
   return rem + after / base;
 }
 
+int owner_of_row_cyclic(int N, int P, int block, int row) {
+  if (row < 0 || row >= N || P <= 0) {
+    return 0;
+  }
+  if (block < 1) block = 1;
+  return (row / block) % P;
+}
+
+int cyclic_row_count(int N, int P, int block, int rank) {
+  if (N <= 0 || P <= 0 || rank < 0 || rank >= P) {
+    return 0;
+  }
+  if (block < 1) block = 1;
+
+  // Full rounds of P blocks, then the blocks (and partial block) left over
+  const int round = block * P;
+  int count = (N / round) * block;
+  const int tail = N % round - rank * block;
+  if (tail > 0) {
+    count += (tail < block) ? tail : block;
+  }
+  return count;
+}
+
+void weighted_partition(int N, const std::vector<double>& weights, std::vector<int>& bounds) {
+  const int P = static_cast<int>(weights.size());
+  bounds.assign(P + 1, 0);
+  if (P == 0 || N <= 0) {
+    return;
+  }
+
+  double sum = 0.0;
+  bool valid = true;
+  for (int r = 0; r < P; ++r) {
+    if (!(weights[r] > 0.0)) {
+      valid = false;
+    }
+    sum += weights[r];
+  }
+
+  // Floor shares first, remembering fractional parts for the leftovers
+  std::vector<int> counts(P, 0);
+  std::vector<std::pair<double, int> > frac(P);
+  int assigned = 0;
+  for (int r = 0; r < P; ++r) {
+    const double share = valid ? static_cast<double>(N) * weights[r] / sum
+                               : static_cast<double>(N) / P;
+    counts[r] = static_cast<int>(share);
+    assigned += counts[r];
+    // Negated so that an ascending sort puts the largest remainder first
+    frac[r] = std::make_pair(-(share - counts[r]), r);
+  }
+  std::sort(frac.begin(), frac.end());
+  for (int i = 0; assigned < N; i = (i + 1) % P) {
+    ++counts[frac[i].second];
+    ++assigned;
+  }
+
+  for (int r = 0; r < P; ++r) {
+    bounds[r + 1] = bounds[r] + counts[r];
+  }
+}
+
+int owner_of_row_weighted(const std::vector<int>& bounds, int row) {
+  if (bounds.size() < 2 || row < 0 || row >= bounds.back()) {
+    return 0;
+  }
+  // First boundary strictly greater than row closes the owner's range;
+  // empty ranges share a boundary and are skipped by upper_bound
+  const std::vector<int>::const_iterator it =
+      std::upper_bound(bounds.begin(), bounds.end(), row);
+  return static_cast<int>(it - bounds.begin()) - 1;
+}
+
+void make_distribution(DistKind kind, int N, int P, int block,
+                       const std::vector<double>& weights, RowDistribution& d) {
+  d.kind = kind;
+  d.N = N;
+  d.P = (P > 0) ? P : 1;
+  d.block = (block > 0) ? block : 1;
+  d.bounds.clear();
+  if (kind == DIST_WEIGHTED) {
+    std::vector<double> w(weights);
+    w.resize(d.P, 0.0);
+    weighted_partition(N, w, d.bounds);
+  }
+}
+
+int dist_owner(const RowDistribution& d, int row) {
+  switch (d.kind) {
+    case DIST_CYCLIC:
+      return owner_of_row_cyclic(d.N, d.P, d.block, row);
+    case DIST_WEIGHTED:
+      return owner_of_row_weighted(d.bounds, row);
+    default:
+      return owner_of_row(d.N, d.P, row);
+  }
+}
+
+void dist_segments(const RowDistribution& d, int rank, std::vector<RowSegment>& out) {
+  out.clear();
+  if (rank < 0 || rank >= d.P) {
+    return;
+  }
+  if (d.kind == DIST_CYCLIC) {
+    for (int start = rank * d.block; start < d.N; start += d.block * d.P) {
+      const int count = (d.N - start < d.block) ? d.N - start : d.block;
+      out.push_back(RowSegment(start, count));
+    }
+    return;
+  }
+
+  int offset = 0;
+  int count = 0;
+  if (d.kind == DIST_WEIGHTED) {
+    offset = d.bounds[rank];
+    count = d.bounds[rank + 1] - d.bounds[rank];
+  } else {
+    row_block_partition(d.N, d.P, rank, offset, count);
+  }
+  if (count > 0) {
+    out.push_back(RowSegment(offset, count));
+  }
+}
+
+bool load_weights(const std::string& path, int P, std::vector<double>& weights, std::string& err) {
+  std::ifstream in(path.c_str());
+  if (!in) {
+    err = "cannot open weights file: " + path;
+    return false;
+  }
+  weights.clear();
+  double w = 0.0;
+  while (in >> w) {
+    if (!(w > 0.0)) {
+      err = "weights must be positive";
+      return false;
+    }
+    weights.push_back(w);
+  }
+  if (!in.eof()) {
+    err = "malformed weights file: " + path;
+    return false;
+  }
+  if (static_cast<int>(weights.size()) != P) {
+    std::ostringstream oss;
+    oss << "weights file has " << weights.size() << " values, expected " << P;
+    err = oss.str();
+    return false;
+  }
+  return true;
+}
+
 } // namespace a5
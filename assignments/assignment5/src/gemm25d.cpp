@@ -0,0 +1,325 @@
+/**
+ * @file gemm25d.cpp
+ * @brief Implementation of the 2.5D (replicated Cannon) GEMM.
+ *
+ * Rank r of the parent communicator sits at layer k = r / (q * q), row
+ * i = (r % (q * q)) / q and column j = r % q. Two sub-communicators are
+ * used: the layer (all ranks with the same k, ranked i * q + j) for the
+ * Cannon shifts, and the depth fiber (all ranks with the same i, j, ranked
+ * by k) for replication and reduction. Only MPI-1 calls plus MPI_IN_PLACE
+ * are needed. The Freivalds check adds a third, the grid rows of layer 0.
+ */
+
+#include "assignment5/gemm25d.h"
+#include "perf/bench.h"
+#include "perf/freivalds.h"
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace a5 {
+
+Gemm25dResult::Gemm25dResult()
+  : c00(0.0), c0N1(0.0), cN10(0.0), cN1N1(0.0), elapsed_s(0.0), words_max(0.0),
+    residual(0.0), verify_s(0.0) {}
+
+bool gemm25d_grid(int P, int c, int& q) {
+  q = 0;
+  if (P <= 0 || c <= 0 || P % c != 0) {
+    return false;
+  }
+  const int layer = P / c;
+  int s = static_cast<int>(std::sqrt(static_cast<double>(layer)) + 0.5);
+  if (s * s != layer || s % c != 0) {
+    return false;
+  }
+  q = s;
+  return true;
+}
+
+void gemm25d_cost_model(int N, int P, int c, double& w1d, double& w2d, double& w25d) {
+  const double n2 = static_cast<double>(N) * static_cast<double>(N);
+  const double p = static_cast<double>(P);
+  const double cc = static_cast<double>(c);
+  w1d = n2;
+  w2d = 2.0 * n2 / std::sqrt(p);
+  w25d = 2.0 * n2 / std::sqrt(cc * p);
+  if (c > 1) {
+    w25d += 3.0 * n2 * cc / p;  // Replicate A and B, reduce C
+  }
+}
+
+/**
+ * @brief Fill the (bi, bj) block of A and B, zero-padded beyond row/col N.
+ *
+ * A[r][k] = r + 1 and B[k][col] = 1 / (col + 1), as in matrix.h.
+ */
+static void init_blocks(int N, int nb, int bi, int bj, double* A, double* B) {
+  for (int r = 0; r < nb; ++r) {
+    const int gr = bi * nb + r;
+    for (int x = 0; x < nb; ++x) {
+      const int gc = bj * nb + x;
+      const bool inside = gr < N && gc < N;
+      const std::size_t idx = static_cast<std::size_t>(r) * nb + x;
+      A[idx] = inside ? static_cast<double>(gr + 1) : 0.0;
+      B[idx] = inside ? 1.0 / static_cast<double>(gc + 1) : 0.0;
+    }
+  }
+}
+
+/**
+ * @brief C += A * B for nb x nb row-major blocks (i-k-j, threaded over rows).
+ */
+static void block_multiply_add(int nb, const double* A, const double* B, double* C) {
+#if defined(_OPENMP)
+  #pragma omp parallel for schedule(static)
+#endif
+  for (int i = 0; i < nb; ++i) {
+    double* c_row = C + static_cast<std::size_t>(i) * nb;
+    const double* a_row = A + static_cast<std::size_t>(i) * nb;
+    for (int k = 0; k < nb; ++k) {
+      const double a_ik = a_row[k];
+      const double* b_row = B + static_cast<std::size_t>(k) * nb;
+      for (int j = 0; j < nb; ++j) {
+        c_row[j] += a_ik * b_row[j];
+      }
+    }
+  }
+}
+
+/**
+ * @brief Send the block at cur to dst and receive the block of src into work.
+ *
+ * cur is either work itself (shifted in place) or a read-only input block,
+ * which is then never written, so the inputs need no per-iteration restore.
+ * No-op when the shift is zero (dst is ourselves). Adds the received
+ * words to *words.
+ *
+ * @return The block now held: work, or cur for a zero shift
+ */
+static const double* shift_block(const double* cur, std::vector<double>& work, int dst, int src,
+                                 int self, MPI_Comm comm, double* words) {
+  if (dst == self) {
+    return cur;
+  }
+  const int count = static_cast<int>(work.size());
+  if (cur == &work[0]) {
+    MPI_Sendrecv_replace(&work[0], count, MPI_DOUBLE, dst, 0, src, 0, comm, MPI_STATUS_IGNORE);
+  } else {
+    MPI_Sendrecv(const_cast<double*>(cur), count, MPI_DOUBLE, dst, 0,
+                 &work[0], count, MPI_DOUBLE, src, 0, comm, MPI_STATUS_IGNORE);
+  }
+  *words += static_cast<double>(work.size());
+  return &work[0];
+}
+
+/**
+ * @brief Freivalds residual of the layer-0 C blocks; collective over row_comm.
+ *
+ * Rank (i, j) sums B(i, j) r_j and |B(i, j)| r_j along grid row i to get
+ * block i of B r and |B| r, and swaps it with its transpose (j, i) for block
+ * j. A(i, j) (B r)_j, |A(i, j)| (|B| r)_j and C(i, j) r_j summed along the
+ * row then give the residual of the block's rows, as in verify.h. Padding
+ * rows and columns (beyond N) are zero in A, B and r and are not compared.
+ *
+ * @return Largest residual over this grid row's rows of C
+ */
+static double freivalds_block_row(int N, int nb, int q, int i, int j,
+                                  const std::vector<double>& A, const std::vector<double>& B,
+                                  const std::vector<double>& C, const std::vector<double>& r,
+                                  MPI_Comm layer_comm, MPI_Comm row_comm) {
+  // r restricted to block column j, zero beyond N
+  std::vector<double> rj(nb, 0.0);
+  for (int y = 0; y < nb && j * nb + y < N; ++y) {
+    rj[y] = r[j * nb + y];
+  }
+
+  // [B r | |B| r] for block row i, then for block row j from rank (j, i)
+  std::vector<double> part(2 * static_cast<std::size_t>(nb));
+  for (int x = 0; x < nb; ++x) {
+    const double* b_row = &B[static_cast<std::size_t>(x) * nb];
+    double s = 0.0;
+    double a = 0.0;
+    for (int y = 0; y < nb; ++y) {
+      s += b_row[y] * rj[y];
+      a += std::fabs(b_row[y]) * rj[y];
+    }
+    part[x] = s;
+    part[nb + x] = a;
+  }
+  std::vector<double> br(part.size());
+  MPI_Allreduce(&part[0], &br[0], 2 * nb, MPI_DOUBLE, MPI_SUM, row_comm);
+  if (i != j) {
+    MPI_Sendrecv_replace(&br[0], 2 * nb, MPI_DOUBLE, j * q + i, 0, j * q + i, 0,
+                         layer_comm, MPI_STATUS_IGNORE);
+  }
+
+  // [A (B r) | |A| (|B| r) | C r] for block row i
+  std::vector<double> rows(3 * static_cast<std::size_t>(nb));
+  for (int x = 0; x < nb; ++x) {
+    const double* a_row = &A[static_cast<std::size_t>(x) * nb];
+    const double* c_row = &C[static_cast<std::size_t>(x) * nb];
+    double ab = 0.0;
+    double scale = 0.0;
+    double cr = 0.0;
+    for (int y = 0; y < nb; ++y) {
+      ab += a_row[y] * br[y];
+      scale += std::fabs(a_row[y]) * br[nb + y];
+      cr += c_row[y] * rj[y];
+    }
+    rows[x] = ab;
+    rows[nb + x] = scale;
+    rows[2 * nb + x] = cr;
+  }
+  std::vector<double> sums(rows.size());
+  MPI_Allreduce(&rows[0], &sums[0], 3 * nb, MPI_DOUBLE, MPI_SUM, row_comm);
+
+  double worst = 0.0;
+  for (int x = 0; x < nb && i * nb + x < N; ++x) {
+    const double scale = sums[nb + x];
+    const double diff = std::fabs(sums[x] - sums[2 * nb + x]);
+    const double rel = (scale > 0.0) ? diff / scale : diff;
+    // Written so that NaN residuals count as failures
+    if (!(rel <= worst)) {
+      worst = (rel == rel) ? rel : HUGE_VAL;
+    }
+  }
+  return worst;
+}
+
+static int wrap(int v, int q) {
+  const int m = v % q;
+  return (m < 0) ? m + q : m;
+}
+
+void run_gemm25d(MPI_Comm comm, int N, int c, const perf::BenchConfig& bench, unsigned int seed,
+                 Gemm25dResult& out) {
+  int rank = 0;
+  int P = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &P);
+  int q = 1;
+  gemm25d_grid(P, c, q);
+
+  const int k = rank / (q * q);
+  const int i = (rank % (q * q)) / q;
+  const int j = rank % q;
+  const int s = q / c;               // Cannon steps per layer
+  const int nb = (N + q - 1) / q;    // Padded block size
+  const std::size_t blk = static_cast<std::size_t>(nb) * static_cast<std::size_t>(nb);
+
+  MPI_Comm layer_comm;
+  MPI_Comm depth_comm;
+  MPI_Comm_split(comm, k, i * q + j, &layer_comm);
+  MPI_Comm_split(comm, i * q + j, k, &depth_comm);
+  const int self = i * q + j;
+
+  // Inputs live on layer 0 only and are never written; A, B, C are the
+  // working blocks
+  std::vector<double> A0;
+  std::vector<double> B0;
+  if (k == 0) {
+    A0.resize(blk);
+    B0.resize(blk);
+    init_blocks(N, nb, i, j, &A0[0], &B0[0]);
+  }
+  std::vector<double> A(blk);
+  std::vector<double> B(blk);
+  std::vector<double> C(blk);
+
+  // Skew: this layer starts Cannon at inner block index i + j + k * s
+  const int skew = k * s;
+  const int a_dst = i * q + wrap(j - i - skew, q);
+  const int a_src = i * q + wrap(j + i + skew, q);
+  const int b_dst = wrap(i - j - skew, q) * q + j;
+  const int b_src = wrap(i + j + skew, q) * q + j;
+  const int left = i * q + wrap(j - 1, q);
+  const int right = i * q + wrap(j + 1, q);
+  const int up = wrap(i - 1, q) * q + j;
+  const int down = wrap(i + 1, q) * q + j;
+
+  // Layer 0 starts each iteration from A0 / B0 directly, the other layers
+  // from the replicated copies in A / B
+  double* const a_in = (k == 0) ? &A0[0] : &A[0];
+  double* const b_in = (k == 0) ? &B0[0] : &B[0];
+
+  double words = 0.0;
+  perf::Sampler sampler(bench);
+  MPI_Barrier(comm);
+  while (sampler.next()) {
+    words = 0.0;
+    // Replicate A and B along the depth fiber
+    if (c > 1) {
+      MPI_Bcast(a_in, static_cast<int>(blk), MPI_DOUBLE, 0, depth_comm);
+      MPI_Bcast(b_in, static_cast<int>(blk), MPI_DOUBLE, 0, depth_comm);
+      if (k != 0) {
+        words += 2.0 * static_cast<double>(blk);
+      }
+    }
+
+    const double* a_cur = shift_block(a_in, A, a_dst, a_src, self, layer_comm, &words);
+    const double* b_cur = shift_block(b_in, B, b_dst, b_src, self, layer_comm, &words);
+
+    C.assign(blk, 0.0);
+    for (int step = 0; step < s; ++step) {
+      block_multiply_add(nb, a_cur, b_cur, &C[0]);
+      if (step + 1 < s) {
+        a_cur = shift_block(a_cur, A, left, right, self, layer_comm, &words);
+        b_cur = shift_block(b_cur, B, up, down, self, layer_comm, &words);
+      }
+    }
+
+    // Sum the c partial products onto layer 0
+    if (c > 1) {
+      if (k == 0) {
+        MPI_Reduce(MPI_IN_PLACE, &C[0], static_cast<int>(blk), MPI_DOUBLE, MPI_SUM, 0, depth_comm);
+      } else {
+        MPI_Reduce(&C[0], 0, static_cast<int>(blk), MPI_DOUBLE, MPI_SUM, 0, depth_comm);
+        words += static_cast<double>(blk);
+      }
+    }
+    MPI_Barrier(comm);
+  }
+  out.samples = sampler.samples();
+  out.stats = sampler.stats();
+  out.elapsed_s = out.stats.median;
+
+  // Check all of C on layer 0; the other layers contribute a zero residual
+  const double tv = perf::now_seconds();
+  MPI_Comm row_comm;
+  MPI_Comm_split(comm, (k == 0) ? i : MPI_UNDEFINED, j, &row_comm);
+  double residual = 0.0;
+  if (k == 0) {
+    std::vector<double> r;
+    perf::freivalds_vector(seed, N, r);
+    residual = freivalds_block_row(N, nb, q, i, j, A0, B0, C, r, layer_comm, row_comm);
+    MPI_Comm_free(&row_comm);
+  }
+  MPI_Allreduce(&residual, &out.residual, 1, MPI_DOUBLE, MPI_MAX, comm);
+  out.verify_s = perf::now_seconds() - tv;
+
+  // Corners: the layer-0 owner of each block contributes, everyone else adds 0
+  double local[4] = {0.0, 0.0, 0.0, 0.0};
+  if (k == 0 && N > 0) {
+    const int rows[4] = {0, 0, N - 1, N - 1};
+    const int cols[4] = {0, N - 1, 0, N - 1};
+    for (int x = 0; x < 4; ++x) {
+      if (rows[x] / nb == i && cols[x] / nb == j) {
+        local[x] = C[static_cast<std::size_t>(rows[x] % nb) * nb + cols[x] % nb];
+      }
+    }
+  }
+  double global[4] = {0.0, 0.0, 0.0, 0.0};
+  MPI_Reduce(local, global, 4, MPI_DOUBLE, MPI_SUM, 0, comm);
+  MPI_Reduce(&words, &out.words_max, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+  out.c00 = global[0];
+  out.c0N1 = global[1];
+  out.cN10 = global[2];
+  out.cN1N1 = global[3];
+
+  MPI_Comm_free(&layer_comm);
+  MPI_Comm_free(&depth_comm);
+}
+
+} // namespace a5
@@ -0,0 +1,44 @@
+/**
+ * @file imbalance.cpp
+ * @brief Spread and imbalance ratio of per-rank timings.
+ */
+
+#include "assignment5/imbalance.h"
+
+#include <cstddef>
+
+namespace a5 {
+
+Spread::Spread() : min(0.0), avg(0.0), max(0.0), argmin(0), argmax(0), ratio(1.0) {}
+
+Spread spread_of(const std::vector<double>& v) {
+  Spread s;
+  if (v.empty()) {
+    return s;
+  }
+  double sum = 0.0;
+  s.min = s.max = v[0];
+  for (std::size_t r = 0; r < v.size(); ++r) {
+    sum += v[r];
+    if (v[r] < s.min) {
+      s.min = v[r];
+      s.argmin = static_cast<int>(r);
+    }
+    if (v[r] > s.max) {
+      s.max = v[r];
+      s.argmax = static_cast<int>(r);
+    }
+  }
+  s.avg = sum / static_cast<double>(v.size());
+  s.ratio = imbalance_ratio(s.max, sum, static_cast<int>(v.size()));
+  return s;
+}
+
+double imbalance_ratio(double max, double sum, int P) {
+  if (!(sum > 0.0) || P <= 0) {
+    return 1.0;
+  }
+  return max / (sum / static_cast<double>(P));
+}
+
+} // namespace a5
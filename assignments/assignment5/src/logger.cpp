@@ -2,24 +2,25 @@
  * @file logger.cpp
  * @brief Implementation of rank-aware logging functions.
  *
- * Simple wrappers around cout/cerr that filter output based on MPI rank,
+ * Thin wrappers around perf::log_write that filter output based on MPI rank,
  * avoiding duplicated messages in distributed programs.
  */
 
 #include "assignment5/logger.h"
-#include <iostream>
+#include "perf/log.h"
 
 namespace a5 {
 
 void log_info_root(int rank, const std::string& msg) {
-  if (rank == 0) {
-    std::cout << "[INFO] " << msg << std::endl;
+  // With the log open, LogConfig::console keeps non-root ranks off stdout
+  if (rank == 0 || perf::log_is_open()) {
+    perf::log_write(perf::LOG_INFO, msg);
   }
 }
 
 void log_error_all(int, const std::string& msg) {
   // All ranks log errors; rank parameter kept for API symmetry
-  std::cerr << "[ERROR] " << msg << std::endl;
+  perf::log_write(perf::LOG_ERROR, msg);
 }
 
 } // namespace a5
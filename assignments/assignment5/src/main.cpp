@@ -5,21 +5,70 @@
  * Implements a parallel dense matrix multiplication C = A * B using MPI
  * with a simple row-block distribution. Matrix B is broadcast to all ranks,
  * and each rank computes its assigned rows of C. Only four boundary elements
- * are collected for verification.
+ * are collected for verification. With --shared-B, B is stored once per
+ * node in an MPI-3 shared-memory window and broadcast only between nodes.
+ * With --sched dynamic, ranks claim row chunks from a shared counter instead
+ * of computing a fixed block, which balances heterogeneous nodes. Static
+ * alternatives are block-cyclic rows (--dist cyclic) and blocks sized by
+ * per-rank speed (--dist weighted). --algo 2.5d switches to the
+ * communication-avoiding 2.5D algorithm on a q x q x c grid (--rep c);
+ * --algo rma fetches B panels one-sidedly and is timed against MPI_Bcast.
  *
- * Usage: mpirun -np <P> assignment5 <N> [--iters k]
+ * Usage: mpirun -np <P> assignment5 <N> [--iters k] [--shared-B]
+ *                                       [--sched static|dynamic]
+ *                                       [--dist block|cyclic|weighted]
+ *                                       [--block b] [--weights file]
+ *                                       [--algo rowblock|2.5d|rma] [--rep c]
+ *                                       [--tune] [--counters] [--rank-detail]
+ *                                       [--trace FILE]
+ *                                       [--warmup W] [--outlier-k K]
+ *                                       [--json FILE] [--csv FILE] [--log FILE]
+ *
+ * Kernel parameters come from the per-host autotune cache when one exists
+ * (see tune.h); --tune runs the search first and rewrites the cache.
+ * Rates are reported against the job's roofline, built from the per-host
+ * ceilings that perf-roofline caches (see perf/roofline.h). --counters
+ * sums hardware counters of every rank's compute_local_rows calls
+ * (see perf/counters.h). Row-block iterations are timed one by one with the
+ * shared harness (perf/bench.h) after --warmup untimed ones, and reported as
+ * median and spread. Each rank's compute time and barrier wait are reduced
+ * to min/avg/max and an imbalance ratio at rank 0 (--rank-detail adds one
+ * line per rank; see imbalance.h). Logging is asynchronous (perf/log.h);
+ * --log FILE gives every rank a FILE.<rank> with per-iteration compute and
+ * wait times. --trace FILE records the phases of every rank and thread
+ * (init_B, broadcast, compute, tile, barrier, gather, verify) and writes one
+ * Chrome trace JSON on rank 0's clock (see trace.h).
  */
 
 #include <mpi.h>
 #include <vector>
 #include <string>
 #include <sstream>
+#include <climits>
 #include <cstddef>
+#include <cstring>
+#include <ctime>
 
 #include "assignment5/cli.h"
+#include "assignment5/comm.h"
 #include "assignment5/logger.h"
 #include "assignment5/dist.h"
+#include "assignment5/gemm25d.h"
+#include "assignment5/imbalance.h"
 #include "assignment5/matrix.h"
+#include "assignment5/nodeshare.h"
+#include "assignment5/rmagemm.h"
+#include "assignment5/sched.h"
+#include "assignment5/sysmem.h"
+#include "assignment5/trace.h"
+#include "assignment5/tune.h"
+#include "assignment5/verify.h"
+#include "perf/bench.h"
+#include "perf/counters.h"
+#include "perf/freivalds.h"
+#include "perf/log.h"
+#include "perf/roofline.h"
+#include "perf/trace.h"
 
 /**
  * @brief Send a scalar value to rank 0 if this rank owns it.
@@ -93,6 +142,10 @@ static void log_boundary_values(
   }
 }
 
+/// Roofline of the whole job, set on rank 0 by setup_roofline() before any timing
+static perf::Ceiling g_job_ceiling;
+static bool g_have_ceiling = false;
+
 /**
  * @brief Log performance metrics (rank 0 only).
  *
@@ -118,11 +171,637 @@ static void log_performance(int rank, int N, double elapsed_s) {
         << " flops=" << flops
         << " gflops=" << gflops;
     a5::log_info_root(rank, oss.str());
+    if (g_have_ceiling) {
+      // Compulsory traffic: A and B read, C written once (3*N^2 doubles)
+      const double bytes = 3.0 * static_cast<double>(N) * static_cast<double>(N) * sizeof(double);
+      a5::log_info_root(rank, perf::format_roofline(
+          g_job_ceiling, perf::roofline_point(g_job_ceiling, flops, bytes, elapsed_s)));
+    }
+  }
+}
+
+/**
+ * @brief Report an allocation rejected by the RAM-derived memory budget.
+ *
+ * @param rank   Current rank
+ * @param what   Name of the data structure
+ * @param bytes  Bytes it would need per rank
+ * @param budget Agreed per-rank budget (see sysmem.h)
+ */
+static void log_memory_guard(int rank, const char* what, std::size_t bytes, std::size_t budget) {
+  std::ostringstream oss;
+  oss << "N too large for " << what << " (memory guard: need " << bytes
+      << " bytes per rank, budget " << budget << ")";
+  a5::log_error_all(rank, oss.str());
+}
+
+// Rows timed per rank when --dist weighted measures speeds at startup
+static const int kCalibrationRows = 32;
+
+/**
+ * @brief Measure this rank's throughput on the first rows of C.
+ *
+ * Runs the real kernel (with this rank's threads) twice over a few rows
+ * and keeps the faster run, so one-off page faults do not skew the result.
+ *
+ * @param N Matrix dimension
+ * @param B Distributed matrix B
+ * @return Rows per second (> 0)
+ */
+static double measure_row_rate(int N, const double* B) {
+  const int rows = (N < kCalibrationRows) ? N : kCalibrationRows;
+  double best = 0.0;
+  for (int rep = 0; rep < 2; ++rep) {
+    const double t0 = MPI_Wtime();
+    a5::compute_local_rows(N, 0, rows, B, 0, 0, 0, 0);
+    const double dt = MPI_Wtime() - t0;
+    if (rep == 0 || dt < best) {
+      best = dt;
+    }
+  }
+  return (best > 0.0) ? rows / best : 1.0;
+}
+
+/**
+ * @brief Obtain per-rank speeds for weighted distribution.
+ *
+ * Collective. Rank 0 reads the weights file and broadcasts it; without a
+ * file every rank measures itself and the rates are all-gathered.
+ *
+ * @param opt     Parsed options
+ * @param rank    Current rank
+ * @param N       Matrix dimension
+ * @param size    Number of ranks
+ * @param B       Distributed matrix B (for measuring)
+ * @param weights Output: one weight per rank, identical on all ranks
+ * @param err     Error message (rank 0) on failure
+ * @return false (on every rank) if the weights file is invalid
+ */
+static bool gather_weights(const a5::Options& opt, int rank, int N, int size, const double* B,
+                           std::vector<double>& weights, std::string& err) {
+  weights.assign(size, 1.0);
+  if (opt.weights_path.empty()) {
+    double rate = measure_row_rate(N, B);
+    MPI_Allgather(&rate, 1, MPI_DOUBLE, &weights[0], 1, MPI_DOUBLE, MPI_COMM_WORLD);
+    return true;
+  }
+  
+  int ok = 1;
+  if (rank == 0) {
+    ok = a5::load_weights(opt.weights_path, size, weights, err) ? 1 : 0;
+  }
+  MPI_Bcast(&ok, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  if (!ok) {
+    return false;
+  }
+  MPI_Bcast(&weights[0], size, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+  return true;
+}
+
+/**
+ * @brief Pick a Freivalds seed on rank 0 and share it with all ranks.
+ *
+ * Time-based so repeated runs test different vectors; the seed is logged
+ * so a failing check can be reproduced.
+ */
+static unsigned int broadcast_freivalds_seed(int rank) {
+  unsigned int seed = 0;
+  if (rank == 0) {
+    seed = static_cast<unsigned int>(std::time(0)) * 2654435761u + 1u;
+  }
+  MPI_Bcast(&seed, 1, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
+  return seed;
+}
+
+/**
+ * @brief Log the outcome of the Freivalds check (rank 0 only).
+ *
+ * @param rank     Current rank
+ * @param N        Matrix dimension
+ * @param seed     Seed of the random vector
+ * @param residual Largest relative residual over all rows
+ * @param verify_s Time spent in the check (seconds), or < 0 if not measured
+ * @return true if the residual is within tolerance (on every rank)
+ */
+static bool log_verification(int rank, int N, unsigned int seed, double residual, double verify_s) {
+  const double tol = perf::freivalds_tolerance(N);
+  const bool ok = residual <= tol;
+  if (rank == 0) {
+    std::ostringstream oss;
+    oss << "verify=freivalds seed=" << seed << " residual=" << residual << " tol=" << tol;
+    if (verify_s >= 0.0) {
+      oss.setf(std::ios::fixed);
+      oss.precision(3);
+      oss << " verify_ms=" << verify_s * 1000.0;
+    }
+    oss << " status=" << (ok ? "ok" : "FAILED");
+    if (ok) {
+      a5::log_info_root(rank, oss.str());
+    } else {
+      a5::log_error_all(rank, oss.str());
+    }
+  }
+  return ok;
+}
+
+/**
+ * @brief Parameters of a JSON/CSV result: "N=... ranks=... threads=..."
+ *        followed by " algo=..." unless algo is NULL (the row-block runs).
+ */
+static std::string bench_params(int size, int N, const char* algo) {
+  std::ostringstream params;
+  params << "N=" << N << " ranks=" << size << " threads=" << a5::compute_threads();
+  if (algo) {
+    params << " algo=" << algo;
+  }
+  return params.str();
+}
+
+/**
+ * @brief Write a report as JSON/CSV as set by the harness options (rank 0 only).
+ */
+static void write_bench(int rank, const a5::Options& opt, const perf::BenchReport& report) {
+  std::string err;
+  if (rank == 0 && !report.write(opt.bench, err)) {
+    a5::log_error_all(rank, err);
+  }
+}
+
+/**
+ * @brief Log the iteration statistics and write them as JSON/CSV (rank 0 only).
+ *
+ * @param rank    Current rank
+ * @param size    Number of ranks
+ * @param N       Matrix dimension
+ * @param opt     Options (harness settings)
+ * @param algo    Algorithm tag of the result, or NULL for row-block runs
+ * @param samples Rank 0's time of each timed iteration (seconds)
+ * @param stats   summarize() of the samples
+ */
+static void log_bench(int rank, int size, int N, const a5::Options& opt, const char* algo,
+                      const std::vector<double>& samples, const perf::Stats& stats) {
+  if (rank != 0) {
+    return;
+  }
+  a5::log_info_root(rank, perf::format_stats(stats));
+  perf::BenchReport report("assignment5");
+  report.add(bench_params(size, N, algo), samples, stats);
+  write_bench(rank, opt, report);
+}
+
+/**
+ * @brief Open hardware counters for this rank's compute threads.
+ *
+ * Every rank opens its own; rank 0 reports why counting is unavailable.
+ *
+ * @param rank Current rank
+ * @param ctr  Counter set to open
+ */
+static void open_counters(int rank, perf::CounterSet& ctr) {
+  std::string err;
+  if (!ctr.open(a5::compute_threads(), err)) {
+    a5::log_info_root(rank, "counters unavailable: " + err);
+  } else if (!err.empty()) {
+    a5::log_info_root(rank, "counters not supported: " + err);
+  }
+}
+
+/**
+ * @brief Log hardware counters summed over all ranks (rank 0 only).
+ *
+ * Rank 0's per-thread counts are logged first. A counter is reported only
+ * if it was available on every rank. Collective over MPI_COMM_WORLD.
+ *
+ * @param rank Current rank
+ * @param ctr  This rank's counters (may be closed)
+ */
+static void log_counters(int rank, const perf::CounterSet& ctr) {
+  const perf::CounterValues mine = ctr.is_open() ? ctr.read_total() : perf::CounterValues();
+  double local[2 * perf::COUNTER_KINDS + 1];
+  double global[2 * perf::COUNTER_KINDS + 1];
+  for (int k = 0; k < perf::COUNTER_KINDS; ++k) {
+    local[k] = mine.value[k];
+    local[perf::COUNTER_KINDS + k] = mine.valid[k] ? 0.0 : 1.0;  // count of ranks without it
+  }
+  local[2 * perf::COUNTER_KINDS] = mine.multiplexed ? 1.0 : 0.0;
+  MPI_Reduce(local, global, 2 * perf::COUNTER_KINDS + 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  if (rank != 0) {
+    return;
+  }
+  for (int t = 0; ctr.is_open() && t < ctr.threads(); ++t) {
+    std::ostringstream oss;
+    oss << "counters rank=0 thread=" << t << " " << perf::format_counters(ctr.read_thread(t));
+    a5::log_info_root(rank, oss.str());
   }
+  perf::CounterValues total;
+  bool any = false;
+  for (int k = 0; k < perf::COUNTER_KINDS; ++k) {
+    total.value[k] = global[k];
+    total.valid[k] = (global[perf::COUNTER_KINDS + k] == 0.0);
+    any = any || total.valid[k];
+  }
+  total.multiplexed = (global[2 * perf::COUNTER_KINDS] > 0.0);
+  if (!any) {
+    a5::log_info_root(rank, "counters: unavailable on some ranks");
+    return;
+  }
+  a5::log_info_root(rank, "counters: " + perf::format_counters(total));
+}
+
+/**
+ * @brief Stop tracing and write the merged trace of all ranks (collective).
+ *
+ * @param rank Current rank
+ * @param path Chrome trace JSON file, written by rank 0
+ */
+static void write_trace(int rank, const std::string& path) {
+  std::vector<perf::TraceEvent> local;
+  unsigned long dropped = perf::trace_stop(local);
+  unsigned long dropped_all = 0;
+  MPI_Reduce(&dropped, &dropped_all, 1, MPI_UNSIGNED_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+  
+  std::vector<perf::TraceEvent> merged;
+  std::vector<std::string> names;
+  std::vector<double> offsets;
+  a5::gather_trace(MPI_COMM_WORLD, local, merged, names, offsets);
+  if (rank != 0) {
+    return;
+  }
+  double max_offset = 0.0;
+  for (std::size_t r = 0; r < offsets.size(); ++r) {
+    const double a = (offsets[r] < 0.0) ? -offsets[r] : offsets[r];
+    max_offset = (a > max_offset) ? a : max_offset;
+  }
+  std::string err;
+  if (!perf::write_chrome_trace(path, merged, names, err)) {
+    a5::log_error_all(rank, err);
+    return;
+  }
+  std::ostringstream oss;
+  oss.setf(std::ios::fixed);
+  oss.precision(3);
+  oss << "trace: file=" << path << " events=" << merged.size() << " dropped=" << dropped_all
+      << " max_clock_offset_ms=" << max_offset * 1000.0;
+  a5::log_info_root(rank, oss.str());
+}
+
+/**
+ * @brief Report compute and wait time over ranks and the load imbalance.
+ *
+ * Every rank passes its compute time and its wait at the closing barrier for
+ * each timed iteration. Rank 0 logs their min/avg/max per iteration, the
+ * imbalance ratio max/avg of the compute time with the slowest rank and its
+ * host, and the worst single iteration. With detail it also logs one line
+ * per rank. Collective over MPI_COMM_WORLD.
+ *
+ * @param rank      Current rank
+ * @param size      Number of ranks
+ * @param rows      Rows this rank computed over the timed iterations
+ * @param compute_s This rank's compute time per timed iteration (seconds)
+ * @param wait_s    This rank's barrier wait per timed iteration (seconds)
+ * @param detail    Log every rank's line (--rank-detail)
+ */
+static void log_rank_timing(int rank, int size, double rows,
+                            const std::vector<double>& compute_s,
+                            const std::vector<double>& wait_s, bool detail) {
+  const int iters = static_cast<int>(compute_s.size());
+  double local[3] = {rows, 0.0, 0.0};
+  for (int i = 0; i < iters; ++i) {
+    local[1] += compute_s[i];
+    local[2] += wait_s[i];
+  }
+  std::vector<double> all(rank == 0 ? static_cast<std::size_t>(size) * 3 : 3);
+  MPI_Gather(local, 3, MPI_DOUBLE, &all[0], 3, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+  
+  // Per-iteration maximum and sum of the compute time, for the worst iteration
+  std::vector<double> it_max(rank == 0 ? iters : 1);
+  std::vector<double> it_sum(rank == 0 ? iters : 1);
+  MPI_Reduce(const_cast<double*>(&compute_s[0]), &it_max[0], iters, MPI_DOUBLE, MPI_MAX, 0,
+             MPI_COMM_WORLD);
+  MPI_Reduce(const_cast<double*>(&compute_s[0]), &it_sum[0], iters, MPI_DOUBLE, MPI_SUM, 0,
+             MPI_COMM_WORLD);
+  
+  // Host names, to point at the slow node
+  char name[MPI_MAX_PROCESSOR_NAME];
+  int name_len = 0;
+  std::memset(name, 0, sizeof(name));
+  MPI_Get_processor_name(name, &name_len);
+  std::vector<char> names(rank == 0 ? static_cast<std::size_t>(size) * MPI_MAX_PROCESSOR_NAME : 1);
+  MPI_Gather(name, MPI_MAX_PROCESSOR_NAME, MPI_CHAR, &names[0], MPI_MAX_PROCESSOR_NAME, MPI_CHAR,
+             0, MPI_COMM_WORLD);
+  if (rank != 0) {
+    return;
+  }
+  
+  // Per-iteration means of every rank
+  const double per_iter = 1.0 / static_cast<double>(iters);
+  std::vector<double> compute(static_cast<std::size_t>(size));
+  std::vector<double> wait(static_cast<std::size_t>(size));
+  for (int r = 0; r < size; ++r) {
+    compute[r] = all[3 * r + 1] * per_iter;
+    wait[r] = all[3 * r + 2] * per_iter;
+  }
+  const a5::Spread c = a5::spread_of(compute);
+  const a5::Spread w = a5::spread_of(wait);
+  int worst = 0;
+  double worst_ratio = 0.0;
+  for (int i = 0; i < iters; ++i) {
+    const double ratio = a5::imbalance_ratio(it_max[i], it_sum[i], size);
+    if (ratio > worst_ratio) {
+      worst_ratio = ratio;
+      worst = i;
+    }
+  }
+  
+  std::ostringstream oss;
+  oss.setf(std::ios::fixed);
+  oss.precision(3);
+  oss << "timing: per iteration over " << size << " ranks"
+      << " compute_ms min=" << c.min * 1000.0 << " avg=" << c.avg * 1000.0
+      << " max=" << c.max * 1000.0
+      << " wait_ms min=" << w.min * 1000.0 << " avg=" << w.avg * 1000.0
+      << " max=" << w.max * 1000.0;
+  a5::log_info_root(rank, oss.str());
+  oss.str("");
+  oss << "imbalance: ratio=" << c.ratio << " (max/avg compute)"
+      << " slowest=rank " << c.argmax << " (" << &names[c.argmax * MPI_MAX_PROCESSOR_NAME] << ")"
+      << " fastest=rank " << c.argmin << " (" << &names[c.argmin * MPI_MAX_PROCESSOR_NAME] << ")"
+      << " worst_iter=" << worst << " worst_iter_ratio=" << worst_ratio;
+  a5::log_info_root(rank, oss.str());
+  
+  if (detail) {
+    for (int r = 0; r < size; ++r) {
+      oss.str("");
+      oss << "rank=" << r << " host=" << &names[r * MPI_MAX_PROCESSOR_NAME]
+          << " rows=" << static_cast<long>(all[3 * r] * per_iter + 0.5)
+          << " compute_ms=" << compute[r] * 1000.0
+          << " wait_ms=" << wait[r] * 1000.0;
+      a5::log_info_root(rank, oss.str());
+    }
+  }
+}
+
+/**
+ * @brief Run and report the 2.5D algorithm (--algo 2.5d).
+ *
+ * Validates the grid shape and memory, runs run_gemm25d() and logs the
+ * Freivalds check, corners, timing (harness statistics and JSON/CSV with
+ * algo=2.5d) and a words-per-rank comparison with the 1D and 2D schemes.
+ * Collective over MPI_COMM_WORLD.
+ *
+ * @param rank Current rank
+ * @param size Number of ranks
+ * @param opt  Parsed options
+ * @return Process exit code
+ */
+static int run_25d_mode(int rank, int size, const a5::Options& opt) {
+  const int N = opt.N;
+  const int c = opt.rep;
+  int q = 0;
+  if (!a5::gemm25d_grid(size, c, q)) {
+    if (rank == 0) {
+      std::ostringstream oss;
+      oss << "--algo 2.5d needs P = q*q*c with q a multiple of c (P=" << size << " c=" << c << ")";
+      a5::log_error_all(rank, oss.str());
+    }
+    return 1;
+  }
+  
+  // Layer-0 ranks hold five nb x nb blocks (inputs, working A/B, C); a
+  // block is moved by single MPI calls, so it must also fit an int count
+  const std::size_t nb = static_cast<std::size_t>((N + q - 1) / q);
+  const std::size_t budget = a5::agreed_memory_budget(MPI_COMM_WORLD, true);
+  if (nb * nb > static_cast<std::size_t>(INT_MAX)) {
+    if (rank == 0) {
+      a5::log_error_all(rank, "N too large for 2.5D blocks (block exceeds INT_MAX elements)");
+    }
+    return 2;
+  }
+  if (5 * nb * nb * sizeof(double) > budget) {
+    if (rank == 0) {
+      log_memory_guard(rank, "2.5D blocks", 5 * nb * nb * sizeof(double), budget);
+    }
+    return 2;
+  }
+  
+  {
+    std::ostringstream oss;
+    oss << "N=" << N << " iters=" << opt.iters << " ranks=" << size
+        << " threads=" << a5::compute_threads() << " algo=2.5d grid=" << q << "x" << q << "x" << c
+        << " block=" << nb;
+    a5::log_info_root(rank, oss.str());
+  }
+  
+  a5::Gemm25dResult res;
+  const unsigned int seed = broadcast_freivalds_seed(rank);
+  a5::run_gemm25d(MPI_COMM_WORLD, N, c, opt.bench, seed, res);
+  
+  if (rank == 0) {
+    double w1d = 0.0, w2d = 0.0, w25d = 0.0;
+    a5::gemm25d_cost_model(N, size, c, w1d, w2d, w25d);
+    std::ostringstream oss;
+    oss.setf(std::ios::fixed);
+    oss.precision(0);
+    oss << "words/rank: 1d=" << w1d << " 2d=" << w2d
+        << " 2.5d_model=" << w25d << " 2.5d_measured=" << res.words_max;
+    a5::log_info_root(rank, oss.str());
+  }
+  const bool verified = log_verification(rank, N, seed, res.residual, res.verify_s);
+  log_boundary_values(rank, N, res.c00, res.c0N1, res.cN10, res.cN1N1);
+  log_performance(rank, N, res.elapsed_s);
+  log_bench(rank, size, N, opt, "2.5d", res.samples, res.stats);
+  a5::log_info_root(rank, "assignment5 done");
+  return verified ? 0 : 3;
+}
+
+/**
+ * @brief Run the collective baseline and the one-sided variant (--algo rma).
+ *
+ * Both variants run the same blocked kernel with the same N, P, warm-up
+ * and repetitions; each timing includes moving B (broadcast or panel
+ * fetches). Medians are compared, both results go to JSON/CSV, and corners
+ * and GFLOPS are reported for the RMA run. Collective over MPI_COMM_WORLD.
+ *
+ * @param rank Current rank
+ * @param size Number of ranks
+ * @param opt  Parsed options
+ * @return Process exit code
+ */
+static int run_rma_mode(int rank, int size, const a5::Options& opt) {
+  const int N = opt.N;
+  if (!a5::rma_gemm_supported()) {
+    if (rank == 0) {
+      a5::log_error_all(rank, "--algo rma requires an MPI-3 library");
+    }
+    return 1;
+  }
+  // The baseline holds a full copy of B on every rank
+  const std::size_t budget = a5::agreed_memory_budget(MPI_COMM_WORLD, true);
+  if (a5::exceeds_memory_budget_for_B(N, budget)) {
+    if (rank == 0) {
+      log_memory_guard(rank, "B", 8 * static_cast<std::size_t>(N) * static_cast<std::size_t>(N),
+                       budget);
+    }
+    return 2;
+  }
+  
+  {
+    std::ostringstream oss;
+    oss << "N=" << N << " iters=" << opt.iters << " ranks=" << size
+        << " threads=" << a5::compute_threads() << " algo=rma dist=row-block";
+    a5::log_info_root(rank, oss.str());
+  }
+  
+  a5::GemmRunResult bcast;
+  a5::GemmRunResult rma;
+  const unsigned int seed = broadcast_freivalds_seed(rank);
+  a5::run_bcast_gemm(MPI_COMM_WORLD, N, opt.bench, seed, bcast);
+  a5::run_rma_gemm(MPI_COMM_WORLD, N, opt.bench, seed, rma);
+  
+  if (rank == 0) {
+    std::ostringstream oss;
+    oss.setf(std::ios::fixed);
+    oss.precision(3);
+    oss << "bcast: elapsed_ms=" << bcast.elapsed_s * 1000.0
+        << " ci95_ms=" << bcast.stats.ci95 * 1000.0
+        << " comm_ms=" << bcast.comm_s * 1000.0
+        << " | rma: elapsed_ms=" << rma.elapsed_s * 1000.0
+        << " ci95_ms=" << rma.stats.ci95 * 1000.0
+        << " wait_ms=" << rma.comm_s * 1000.0
+        << " speedup=" << ((rma.elapsed_s > 0.0) ? bcast.elapsed_s / rma.elapsed_s : 0.0);
+    a5::log_info_root(rank, oss.str());
+    a5::log_info_root(rank, "bcast " + perf::format_stats(bcast.stats));
+    a5::log_info_root(rank, "rma " + perf::format_stats(rma.stats));
+    perf::BenchReport report("assignment5");
+    report.add(bench_params(size, N, "bcast"), bcast.samples, bcast.stats);
+    report.add(bench_params(size, N, "rma"), rma.samples, rma.stats);
+    write_bench(rank, opt, report);
+  }
+  // Both variants are checked; the worse residual is reported
+  const double residual = (bcast.residual > rma.residual) ? bcast.residual : rma.residual;
+  const bool verified = log_verification(rank, N, seed, residual, -1.0);
+  log_boundary_values(rank, N, rma.c00, rma.c0N1, rma.cN10, rma.cN1N1);
+  log_performance(rank, N, rma.elapsed_s);
+  a5::log_info_root(rank, "assignment5 done");
+  return verified ? 0 : 3;
+}
+
+// Autotune sample: rows x N slice of C with N capped, about 0.1 GFLOP
+static const int kTuneSampleN = 1024;
+static const int kTuneSampleRows = 64;
+
+/**
+ * @brief Select kernel parameters: autotune (--tune) or load the host cache.
+ *
+ * With --tune all ranks search at the same time, so timings include the
+ * contention of a full node; each host then adopts and saves the result
+ * of its lowest rank. Without it, a cache written with a different number
+ * of ranks per host keeps its block sizes but not its thread count.
+ * Collective over MPI_COMM_WORLD.
+ *
+ * @param rank Current rank
+ * @param N    Matrix dimension of the run
+ * @param tune Whether to search
+ */
+static void configure_kernel(int rank, int N, bool tune) {
+  const std::string host = perf::host_name();
+  const std::string path = a5::tune_cache_path(host);
+  MPI_Comm host_comm = a5::split_by_host(MPI_COMM_WORLD);
+  int host_rank = 0;
+  int host_size = 1;
+  MPI_Comm_rank(host_comm, &host_rank);
+  MPI_Comm_size(host_comm, &host_size);
+  
+  if (tune) {
+    const int ns = (N < kTuneSampleN) ? N : kTuneSampleN;
+    const int rows = (ns < kTuneSampleRows) ? ns : kTuneSampleRows;
+    a5::TuneResult res;
+    a5::autotune_kernel(ns, rows, res);
+    
+    int packed[5] = {res.best.block_rows, res.best.block_k, res.best.block_j,
+                     static_cast<int>(res.best.order), res.best.threads};
+    double rates[2] = {res.base_gflops, res.gflops};
+    MPI_Bcast(packed, 5, MPI_INT, 0, host_comm);
+    MPI_Bcast(rates, 2, MPI_DOUBLE, 0, host_comm);
+    a5::KernelConfig cfg;
+    cfg.block_rows = packed[0];
+    cfg.block_k = packed[1];
+    cfg.block_j = packed[2];
+    cfg.order = (packed[3] == static_cast<int>(a5::ORDER_KJ)) ? a5::ORDER_KJ : a5::ORDER_JK;
+    cfg.threads = packed[4];
+    a5::set_kernel_config(cfg);
+    
+    std::string err;
+    if (host_rank == 0 && !a5::save_tune_cache(path, host, host_size, cfg, rates[1], err)) {
+      a5::log_error_all(rank, err);
+    }
+    std::ostringstream oss;
+    oss.setf(std::ios::fixed);
+    oss.precision(2);
+    oss << "tune: host=" << host << " sample=" << rows << "x" << ns
+        << " evaluations=" << res.evaluations
+        << " default_gflops=" << rates[0] << " tuned_gflops=" << rates[1]
+        << " kernel=" << a5::format_kernel_config(cfg) << " cache=" << path;
+    a5::log_info_root(rank, oss.str());
+  } else {
+    a5::KernelConfig cfg;
+    int tuned_ranks = 0;
+    double gflops = 0.0;
+    std::string err;
+    if (a5::load_tune_cache(path, host, cfg, tuned_ranks, gflops, err)) {
+      if (tuned_ranks != host_size) {
+        cfg.threads = 0;
+      }
+      a5::set_kernel_config(cfg);
+      a5::log_info_root(rank, "kernel=tuned " + a5::format_kernel_config(cfg) + " cache=" + path);
+    } else {
+      a5::log_info_root(rank, "kernel=default " + a5::format_kernel_config(a5::kernel_config()));
+    }
+  }
+  MPI_Comm_free(&host_comm);
+}
+
+/**
+ * @brief Build the job's roofline from rank 0's host ceilings.
+ *
+ * The compute ceiling is the single-thread multiply-add rate times all
+ * workers (ranks x threads); the bandwidth ceiling is the host's STREAM
+ * triad rate times the number of hosts, assuming identical nodes. The
+ * ceilings are only loaded, never measured here: a measurement would run
+ * while the other ranks on the host spin in MPI, so `perf-roofline` is run
+ * once per host instead. Collective over MPI_COMM_WORLD.
+ *
+ * @param rank Current rank
+ * @param size Number of ranks
+ */
+static void setup_roofline(int rank, int size) {
+  MPI_Comm host_comm = a5::split_by_host(MPI_COMM_WORLD);
+  int host_rank = 0;
+  MPI_Comm_rank(host_comm, &host_rank);
+  MPI_Comm_free(&host_comm);
+  int leader = (host_rank == 0) ? 1 : 0;
+  int hosts = 1;
+  MPI_Allreduce(&leader, &hosts, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+  if (rank != 0) {
+    return;
+  }
+  const std::string host = perf::host_name();
+  perf::Roofline roof;
+  std::string err;
+  if (!perf::load_roofline(perf::roofline_cache_path(host), host, roof, err)) {
+    a5::log_info_root(rank, "roofline: unavailable (" + err + "; run perf-roofline once per host)");
+    return;
+  }
+  g_job_ceiling = perf::Ceiling(
+      roof.fma_gflops_serial * static_cast<double>(size) * a5::compute_threads(),
+      roof.stream.triad_gbs * static_cast<double>(hosts));
+  g_have_ceiling = true;
 }
 
 int main(int argc, char** argv) {
-  MPI_Init(&argc, &argv);
+  // Only the main thread calls MPI; OpenMP threads run inside compute_local_rows
+  int thread_level = MPI_THREAD_SINGLE;
+  MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &thread_level);
   
   int rank = 0;
   int size = 1;
@@ -143,66 +822,273 @@ int main(int argc, char** argv) {
   const int N = opt.N;
   const int iters = opt.iters;
   
+  // Asynchronous logging from here on; --log FILE gives each rank FILE.<rank>
+  perf::LogConfig log_cfg;
+  log_cfg.rank = rank;
+  log_cfg.ranks = size;
+  log_cfg.console = (rank == 0);
+  log_cfg.path = opt.bench.log_path;
+  if (!perf::log_open(log_cfg, err)) {
+    a5::log_error_all(rank, err);
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+  
   a5::log_info_root(rank, "assignment5 start");
+  configure_kernel(rank, N, opt.tune);
+  setup_roofline(rank, size);
+  if (thread_level < MPI_THREAD_FUNNELED && a5::compute_threads() > 1) {
+    a5::log_info_root(rank, "warning: MPI library does not provide MPI_THREAD_FUNNELED");
+  }
+  
+  if (opt.algo != a5::ALGO_ROWBLOCK) {
+    const int rc = (opt.algo == a5::ALGO_25D) ? run_25d_mode(rank, size, opt)
+                                              : run_rma_mode(rank, size, opt);
+    perf::log_close();
+    MPI_Finalize();
+    return rc;
+  }
+  
+  // Optional node-shared B: one copy per node instead of one per rank
+  a5::SharedB shared;
+  bool use_shared = false;
+  if (opt.shared_b) {
+    use_shared = a5::shared_b_init(MPI_COMM_WORLD, shared);
+    if (!use_shared) {
+      a5::log_info_root(rank, "--shared-B requires MPI-3; falling back to replicated B");
+    }
+  }
+  
+  // Optional dynamic row scheduling through a shared counter on rank 0
+  a5::RowScheduler sched;
+  bool use_dynamic = false;
+  if (opt.sched == a5::SCHEDULE_DYNAMIC) {
+    use_dynamic = a5::row_scheduler_create(MPI_COMM_WORLD, N, sched);
+    if (!use_dynamic) {
+      a5::log_info_root(rank, "--sched dynamic requires MPI-3; falling back to static row blocks");
+    }
+  }
+  
   {
     std::ostringstream oss;
-    oss << "N=" << N << " iters=" << iters << " ranks=" << size << " dist=row-block";
+    const int threads = a5::compute_threads();
+    oss << "N=" << N << " iters=" << iters << " ranks=" << size << " threads=" << threads
+        << " workers=" << size * threads
+        << " dist=";
+    if (use_dynamic) {
+      oss << "dynamic";
+    } else if (opt.dist == a5::DIST_CYCLIC) {
+      oss << "block-cyclic block=" << opt.block;
+    } else if (opt.dist == a5::DIST_WEIGHTED) {
+      oss << "weighted weights=" << (opt.weights_path.empty() ? "measured" : opt.weights_path);
+    } else {
+      oss << "row-block";
+    }
+    if (use_shared) {
+      oss << " B=node-shared nodes=" << shared.node_count;
+    } else {
+      oss << " B=replicated";
+    }
     a5::log_info_root(rank, oss.str());
   }
   
-  // Guard against excessive memory allocation for B (1 GiB limit)
-  const std::size_t memory_limit = static_cast<std::size_t>(1) << 30;
-  if (a5::exceeds_memory_budget_for_B(N, memory_limit)) {
+  // Guard against excessive memory allocation for B. A replicated B is
+  // held by every rank, so the node's RAM budget is split among its ranks;
+  // a node-shared B is one copy per node. The budget is the minimum over
+  // ranks so that every rank takes the same branch.
+  const std::size_t budget = a5::agreed_memory_budget(MPI_COMM_WORLD, !use_shared);
+  if (a5::exceeds_memory_budget_for_B(N, budget)) {
     if (rank == 0) {
-      a5::log_error_all(rank, "N too large for B (memory guard)");
+      log_memory_guard(rank, "B", 8 * static_cast<std::size_t>(N) * static_cast<std::size_t>(N),
+                       budget);
+    }
+    if (use_dynamic) {
+      a5::row_scheduler_free(sched);
     }
+    if (use_shared) {
+      a5::shared_b_free(shared);
+    }
+    perf::log_close();
     MPI_Finalize();
     return 2;
   }
   
-  // Allocate and initialize matrix B (rank 0), then broadcast to all
-  std::vector<double> B;
+  // Phase timeline from here on (--trace); merged and written after verification
+  if (!opt.trace_path.empty()) {
+    perf::trace_start(rank);
+  }
+  
+  // Allocate and initialize matrix B (rank 0), then distribute it: either a
+  // world-wide broadcast into per-rank copies, or a broadcast among node
+  // leaders into one shared window per node
+  std::vector<double> B_replicated;
+  const double* B = 0;
   const std::size_t B_size = static_cast<std::size_t>(N) * static_cast<std::size_t>(N);
-  B.resize(B_size);
-  if (rank == 0) {
-    a5::init_B(B, N);
+  if (use_shared) {
+    a5::shared_b_allocate(shared, B_size);
+    if (rank == 0) {
+      perf::TraceScope phase("init_B");
+      a5::init_B(shared.data, N);
+    }
+    perf::TraceScope phase("broadcast");
+    a5::shared_b_broadcast(shared, B_size);
+    B = shared.data;
+  } else {
+    B_replicated.resize(B_size);
+    if (rank == 0) {
+      perf::TraceScope phase("init_B");
+      a5::init_B(B_replicated, N);
+    }
+    perf::TraceScope phase("broadcast");
+    a5::bcast_large(&B_replicated[0], B_replicated.size(), 0, MPI_COMM_WORLD);
+    B = &B_replicated[0];
   }
-  MPI_Bcast(&B[0], static_cast<int>(B.size()), MPI_DOUBLE, 0, MPI_COMM_WORLD);
   
-  // Compute row partition for this rank
-  int row_offset = 0;
-  int row_count = 0;
-  a5::row_block_partition(N, size, rank, row_offset, row_count);
+  // Compute the static row distribution; every rank builds the same one
+  std::vector<double> weights;
+  if (!use_dynamic && opt.dist == a5::DIST_WEIGHTED) {
+    perf::TraceScope phase("weights");
+    if (!gather_weights(opt, rank, N, size, B, weights, err)) {
+      if (rank == 0) {
+        a5::log_error_all(rank, err);
+      }
+      if (use_shared) {
+        a5::shared_b_free(shared);
+      }
+      perf::log_close();
+      MPI_Finalize();
+      return 1;
+    }
+  }
+  a5::RowDistribution dist;
+  a5::make_distribution(use_dynamic ? a5::DIST_BLOCK : opt.dist, N, size, opt.block, weights, dist);
+  std::vector<a5::RowSegment> segments;
+  a5::dist_segments(dist, rank, segments);
   
   // Determine which ranks own the boundary rows
-  const int owner_row0 = a5::owner_of_row(N, size, 0);
-  const int owner_rowN = a5::owner_of_row(N, size, N - 1);
+  const int owner_row0 = a5::dist_owner(dist, 0);
+  const int owner_rowN = a5::dist_owner(dist, N - 1);
   
   // Storage for boundary elements
   double c00 = 0.0, c0N1 = 0.0, cN10 = 0.0, cN1N1 = 0.0;
   
-  // Timing loop: compute C = A * B for 'iters' iterations
+  // Freivalds check of the last iteration: the kernel also produces C * r
+  // for every row it computes, indexed by global row
+  const unsigned int seed = broadcast_freivalds_seed(rank);
+  std::vector<double> r;
+  perf::freivalds_vector(seed, N, r);
+  std::vector<double> Cr(static_cast<std::size_t>(N), 0.0);
+  std::vector<a5::RowSegment> checked;
+  
+  // Hardware counters accumulate over the kernel calls of all iterations
+  perf::CounterSet ctr;
+  if (opt.counters) {
+    open_counters(rank, ctr);
+  }
+  
+  // Timing loop: 'warmup' untimed iterations, then 'iters' timed ones, each
+  // closed by a barrier so that a sample is the time of the slowest rank
+  const int warmup = opt.bench.warmup;
+  std::vector<double> samples;
+  std::vector<double> compute_s;
+  std::vector<double> wait_s;
+  double rows_done = 0.0;
   MPI_Barrier(MPI_COMM_WORLD);
-  double t_start = MPI_Wtime();
-  
-  for (int iter = 0; iter < iters; ++iter) {
-    // Set up pointers for boundary elements (NULL if not owned)
-    double* p_c00   = (rank == owner_row0) ? &c00   : static_cast<double*>(0);
-    double* p_c0N1  = (rank == owner_row0) ? &c0N1  : static_cast<double*>(0);
-    double* p_cN10  = (rank == owner_rowN) ? &cN10  : static_cast<double*>(0);
-    double* p_cN1N1 = (rank == owner_rowN) ? &cN1N1 : static_cast<double*>(0);
-    
-    a5::compute_local_rows(N, row_offset, row_count, B,
-                           p_c00, p_c0N1, p_cN10, p_cN1N1);
+  
+  for (int iter = 0; iter < warmup + iters; ++iter) {
+    if (iter == warmup) {
+      // Row counts and counters cover the timed iterations only
+      rows_done = 0.0;
+      ctr.reset();
+    }
+    perf::trace_begin(iter < warmup ? "warm-up" : "iteration");
+    perf::trace_begin("compute");
+    const double t_iter = perf::now_seconds();
+    const bool last = (iter == warmup + iters - 1);
+    const double* r_last = last ? &r[0] : static_cast<const double*>(0);
+    if (use_dynamic) {
+      // Any rank may claim row 0 or N-1; clear so only this iteration's
+      // owner contributes to the reduction below
+      c00 = c0N1 = cN10 = cN1N1 = 0.0;
+      int chunk_offset = 0;
+      int chunk_count = 0;
+      while (a5::row_scheduler_next(sched, chunk_offset, chunk_count)) {
+        const double t_chunk = perf::now_seconds();
+        ctr.start();
+        a5::compute_local_rows(N, chunk_offset, chunk_count, B,
+                               &c00, &c0N1, &cN10, &cN1N1,
+                               r_last, last ? &Cr[chunk_offset] : static_cast<double*>(0));
+        ctr.stop();
+        if (last) {
+          checked.push_back(a5::RowSegment(chunk_offset, chunk_count));
+        }
+        a5::row_scheduler_record(sched, chunk_count, perf::now_seconds() - t_chunk);
+        rows_done += chunk_count;
+      }
+    } else {
+      // Set up pointers for boundary elements (NULL if not owned)
+      double* p_c00   = (rank == owner_row0) ? &c00   : static_cast<double*>(0);
+      double* p_c0N1  = (rank == owner_row0) ? &c0N1  : static_cast<double*>(0);
+      double* p_cN10  = (rank == owner_rowN) ? &cN10  : static_cast<double*>(0);
+      double* p_cN1N1 = (rank == owner_rowN) ? &cN1N1 : static_cast<double*>(0);
+      
+      for (std::size_t seg = 0; seg < segments.size(); ++seg) {
+        ctr.start();
+        a5::compute_local_rows(N, segments[seg].offset, segments[seg].count, B,
+                               p_c00, p_c0N1, p_cN10, p_cN1N1,
+                               r_last, last ? &Cr[segments[seg].offset] : static_cast<double*>(0));
+        ctr.stop();
+        rows_done += segments[seg].count;
+      }
+      if (last) {
+        checked = segments;
+      }
+    }
+    const double t_work = perf::now_seconds();
+    perf::trace_end("compute");
     
+    perf::trace_begin("barrier");
     MPI_Barrier(MPI_COMM_WORLD);
+    const double t_sync = perf::now_seconds();
+    perf::trace_end("barrier");
+    perf::trace_end(iter < warmup ? "warm-up" : "iteration");
+    if (iter >= warmup) {
+      samples.push_back(t_sync - t_iter);
+      compute_s.push_back(t_work - t_iter);
+      wait_s.push_back(t_sync - t_work);
+    }
+    // Per-rank progress for the --log files, after the sample is taken
+    perf::log_printf(perf::LOG_DEBUG, "iter=%d%s compute_s=%.6f wait_s=%.6f", iter,
+                     iter < warmup ? " (warm-up)" : "", t_work - t_iter, t_sync - t_work);
+    // The counter reset has its own barrier; it runs between samples so
+    // that it is not part of either
+    if (use_dynamic) {
+      perf::TraceScope phase("sched_reset");
+      a5::row_scheduler_reset(sched, MPI_COMM_WORLD);
+    }
   }
   
-  double t_end = MPI_Wtime();
-  const double elapsed_s = (t_end - t_start) / (iters > 0 ? iters : 1);
+  const perf::Stats stats = perf::summarize(samples, opt.bench.outlier_k);
+  const double elapsed_s = stats.median;
   
   // Collect boundary elements at rank 0
-  if (rank != 0) {
+  perf::trace_begin("gather");
+  if (use_dynamic) {
+    // Exactly one rank computed each corner in the last iteration; the
+    // others hold zeros, so a sum delivers the owner's values
+    double local[4];
+    double global[4];
+    local[0] = c00;
+    local[1] = c0N1;
+    local[2] = cN10;
+    local[3] = cN1N1;
+    MPI_Reduce(local, global, 4, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    if (rank == 0) {
+      c00 = global[0];
+      c0N1 = global[1];
+      cN10 = global[2];
+      cN1N1 = global[3];
+    }
+  } else if (rank != 0) {
     // Non-root ranks send their owned boundary elements
     if (rank == owner_row0) {
       send_scalar_if_owner(rank, owner_row0, c00, 101);
@@ -217,11 +1103,40 @@ int main(int argc, char** argv) {
     receive_boundary_elements(owner_row0, owner_rowN, c00, c0N1, cN10, cN1N1);
   }
   
+  log_rank_timing(rank, size, rows_done, compute_s, wait_s, opt.rank_detail);
+  perf::trace_end("gather");
+  
+  // Verify all of C: each rank contributes B r for its row block of B
+  int k0 = 0;
+  int kc = 0;
+  a5::row_block_partition(N, size, rank, k0, kc);
+  perf::trace_begin("verify");
+  const double t_verify = MPI_Wtime();
+  const double residual = a5::freivalds_residual(
+      MPI_COMM_WORLD, N, B + static_cast<std::size_t>(k0) * static_cast<std::size_t>(N), kc,
+      r, checked, Cr);
+  const bool verified = log_verification(rank, N, seed, residual, MPI_Wtime() - t_verify);
+  perf::trace_end("verify");
+  if (!opt.trace_path.empty()) {
+    write_trace(rank, opt.trace_path);
+  }
+  
   // Log results (rank 0 only)
   log_boundary_values(rank, N, c00, c0N1, cN10, cN1N1);
   log_performance(rank, N, elapsed_s);
+  log_bench(rank, size, N, opt, 0, samples, stats);
+  if (opt.counters) {
+    log_counters(rank, ctr);
+  }
   a5::log_info_root(rank, "assignment5 done");
   
+  if (use_dynamic) {
+    a5::row_scheduler_free(sched);
+  }
+  if (use_shared) {
+    a5::shared_b_free(shared);
+  }
+  perf::log_close();
   MPI_Finalize();
-  return 0;
+  return verified ? 0 : 3;
 }
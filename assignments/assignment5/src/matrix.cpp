@@ -2,20 +2,58 @@
  * @file matrix.cpp
  * @brief Implementation of matrix operations for distributed GEMM.
  *
- * Provides initialization of matrix B and the core GEMM triple loop.
- * Matrix A is computed on-the-fly to save memory. Only boundary elements
- * of C are extracted for verification purposes.
+ * Provides initialization of matrix B and the core GEMM kernel: a cache-
+ * blocked i-k-j loop nest, threaded over row blocks with OpenMP when
+ * available. Matrix A is computed on-the-fly to save memory. Only boundary
+ * elements of C are extracted for verification purposes.
  */
 
 #include "assignment5/matrix.h"
 #include <cstddef>
 
+#include "perf/trace.h"
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
 namespace a5 {
 
+// Default tile sizes: rows per thread work unit, and the k x j panel of B
+// (128 x 512 doubles = 512 KiB) reused across the rows of a block. The
+// autotuner (tune.h) may replace them per host.
+static const int kBlockRows = 16;
+static const int kBlockK = 128;
+static const int kBlockJ = 512;
+
+KernelConfig::KernelConfig()
+  : block_rows(kBlockRows), block_k(kBlockK), block_j(kBlockJ), order(ORDER_JK), threads(0) {}
+
+// Active configuration, read by every compute_local_rows() call
+static KernelConfig g_kernel;
+
+void set_kernel_config(const KernelConfig& cfg) {
+  g_kernel = cfg;
+#if defined(_OPENMP)
+  if (cfg.threads > 0) {
+    omp_set_num_threads(cfg.threads);
+  }
+#endif
+}
+
+const KernelConfig& kernel_config() {
+  return g_kernel;
+}
+
 void init_B(std::vector<double>& B, int N) {
   const std::size_t total = static_cast<std::size_t>(N) * static_cast<std::size_t>(N);
   B.assign(total, 0.0);
-  
+  if (total > 0) {
+    init_B(&B[0], N);
+  }
+}
+
+void init_B(double* B, int N) {
   // Fill B with B[k][j] = 1.0 / (j + 1)
   for (int k = 0; k < N; ++k) {
     const std::size_t row_start = static_cast<std::size_t>(k) * static_cast<std::size_t>(N);
@@ -28,40 +66,171 @@ void init_B(std::vector<double>& B, int N) {
 void compute_local_rows(
     int N, int row_offset, int row_count, const std::vector<double>& B,
     double* c00, double* c0N1, double* cN10, double* cN1N1) {
+  compute_local_rows(N, row_offset, row_count, B.empty() ? static_cast<const double*>(0) : &B[0],
+                     c00, c0N1, cN10, cN1N1);
+}
+
+/**
+ * @brief acc[r][j] += A[i0 + r][k] * B[k][j] over one k x j tile of B.
+ */
+static void multiply_tile(int N, int i0, int rows, const double* B, double* acc,
+                          int kk, int k_end, int jj, int j_end) {
+  const std::size_t n = static_cast<std::size_t>(N);
+  for (int r = 0; r < rows; ++r) {
+    // A[i][k] = (i + 1) is computed on the fly
+    const double a_ik = static_cast<double>(i0 + r + 1);
+    double* c_row = acc + static_cast<std::size_t>(r) * n;
+    for (int k = kk; k < k_end; ++k) {
+      const double* b_row = B + static_cast<std::size_t>(k) * n;
+      for (int j = jj; j < j_end; ++j) {
+        c_row[j] += a_ik * b_row[j];
+      }
+    }
+  }
+}
+
+/**
+ * @brief acc += A[i0 .. i0 + rows) * B over the first kc rows of B.
+ *
+ * Blocked i-k-j kernel: for each (j, k) tile of B the rows of the block
+ * stream through the same block_k x block_j panel while it is in cache.
+ * Every C[i][j] still accumulates its k terms in ascending order.
+ */
+static void add_row_block(int N, int i0, int rows, int kc, const double* B, double* acc,
+                          const KernelConfig& cfg) {
+  const int bk = cfg.block_k;
+  const int bj = cfg.block_j;
   
-  // Iterate over each local row
-  for (int li = 0; li < row_count; ++li) {
-    const int i_glob = row_offset + li;  // Global row index
+  if (cfg.order == ORDER_KJ) {
+    for (int kk = 0; kk < kc; kk += bk) {
+      const int k_end = (kk + bk < kc) ? kk + bk : kc;
+      for (int jj = 0; jj < N; jj += bj) {
+        const int j_end = (jj + bj < N) ? jj + bj : N;
+        multiply_tile(N, i0, rows, B, acc, kk, k_end, jj, j_end);
+      }
+    }
+    return;
+  }
+  for (int jj = 0; jj < N; jj += bj) {
+    const int j_end = (jj + bj < N) ? jj + bj : N;
+    for (int kk = 0; kk < kc; kk += bk) {
+      const int k_end = (kk + bk < kc) ? kk + bk : kc;
+      multiply_tile(N, i0, rows, B, acc, kk, k_end, jj, j_end);
+    }
+  }
+}
+
+/**
+ * @brief Compute rows [i0, i0 + rows) of C into acc (rows x N, row-major).
+ *
+ * The results are bitwise identical to the reference triple loop, since
+ * add_row_block() keeps the k terms of each element in ascending order.
+ */
+static void compute_row_block(int N, int i0, int rows, const double* B, double* acc,
+                              const KernelConfig& cfg) {
+  const std::size_t n = static_cast<std::size_t>(N);
+  for (std::size_t x = 0; x < static_cast<std::size_t>(rows) * n; ++x) {
+    acc[x] = 0.0;
+  }
+  add_row_block(N, i0, rows, N, B, acc, cfg);
+}
+
+void accumulate_panel_rows(int N, int row_offset, int row_count, int kc,
+                           const double* panel, double* C) {
+  if (N <= 0 || row_count <= 0 || kc <= 0) {
+    return;
+  }
+  const KernelConfig cfg = g_kernel;
+  const int block_rows = cfg.block_rows;
+  const int blocks = (row_count + block_rows - 1) / block_rows;
+  const std::size_t n = static_cast<std::size_t>(N);
+  
+  // Row blocks of C are disjoint, so threads write without conflicts
+#if defined(_OPENMP)
+  #pragma omp parallel for schedule(static)
+#endif
+  for (int blk = 0; blk < blocks; ++blk) {
+    const int li0 = blk * block_rows;
+    const int rows = (li0 + block_rows < row_count) ? block_rows : row_count - li0;
+    add_row_block(N, row_offset + li0, rows, kc, panel, C + static_cast<std::size_t>(li0) * n, cfg);
+  }
+}
+
+void compute_local_rows(
+    int N, int row_offset, int row_count, const double* B,
+    double* c00, double* c0N1, double* cN10, double* cN1N1) {
+  compute_local_rows(N, row_offset, row_count, B, c00, c0N1, cN10, cN1N1, 0, 0);
+}
+
+void compute_local_rows(
+    int N, int row_offset, int row_count, const double* B,
+    double* c00, double* c0N1, double* cN10, double* cN1N1,
+    const double* r, double* Cr) {
+  
+  if (N <= 0 || row_count <= 0) {
+    return;
+  }
+  const KernelConfig cfg = g_kernel;
+  const int block_rows = cfg.block_rows;
+  const int blocks = (row_count + block_rows - 1) / block_rows;
+  const std::size_t n = static_cast<std::size_t>(N);
+  
+  // Row blocks are independent: each thread keeps a private accumulator.
+  // Corner writes are race-free by construction: a global row lives in
+  // exactly one block and each block is processed by exactly one thread,
+  // so every corner pointer has a single writer; the implicit barrier at
+  // the end of the parallel region publishes the values to the caller.
+#if defined(_OPENMP)
+  #pragma omp parallel
+#endif
+  {
+    std::vector<double> acc(static_cast<std::size_t>(block_rows) * n);
     
-    // Compute each element in this row: C[i_glob][j] = sum_k A[i_glob][k] * B[k][j]
-    for (int j = 0; j < N; ++j) {
-      double sum = 0.0;
+#if defined(_OPENMP)
+    #pragma omp for schedule(static)
+#endif
+    for (int blk = 0; blk < blocks; ++blk) {
+      const int li0 = blk * block_rows;
+      const int rows = (li0 + block_rows < row_count) ? block_rows : row_count - li0;
+      const int i0 = row_offset + li0;  // Global index of the block's first row
+      perf::TraceScope tile("tile");
+      compute_row_block(N, i0, rows, B, &acc[0], cfg);
       
-      // Triple loop: C = A * B, with A[i][k] = (i + 1) computed on-the-fly
-      for (int k = 0; k < N; ++k) {
-        const std::size_t idx_B = static_cast<std::size_t>(k) * static_cast<std::size_t>(N)
-                                + static_cast<std::size_t>(j);
-        const double a_ik = static_cast<double>(i_glob + 1);
-        sum += a_ik * B[idx_B];
+      // Optional C * r for the Freivalds check, one entry per row
+      if (r && Cr) {
+        for (int rr = 0; rr < rows; ++rr) {
+          const double* c_row = &acc[static_cast<std::size_t>(rr) * n];
+          double dot = 0.0;
+          for (int j = 0; j < N; ++j) {
+            dot += c_row[j] * r[j];
+          }
+          Cr[li0 + rr] = dot;
+        }
       }
       
-      // Store boundary elements if this rank owns them
-      if (i_glob == 0 && j == 0 && c00) {
-        *c00 = sum;
-      }
-      if (i_glob == 0 && j == N - 1 && c0N1) {
-        *c0N1 = sum;
+      // Store boundary elements if this block holds row 0 or row N-1
+      if (i0 == 0) {
+        if (c00)  *c00  = acc[0];
+        if (c0N1) *c0N1 = acc[n - 1];
       }
-      if (i_glob == N - 1 && j == 0 && cN10) {
-        *cN10 = sum;
-      }
-      if (i_glob == N - 1 && j == N - 1 && cN1N1) {
-        *cN1N1 = sum;
+      if (i0 <= N - 1 && N - 1 < i0 + rows) {
+        const double* last = &acc[static_cast<std::size_t>(N - 1 - i0) * n];
+        if (cN10)  *cN10  = last[0];
+        if (cN1N1) *cN1N1 = last[n - 1];
       }
     }
   }
 }
 
+int compute_threads() {
+#if defined(_OPENMP)
+  const int t = omp_get_max_threads();
+  return (t > 0) ? t : 1;
+#else
+  return 1;
+#endif
+}
+
 bool exceeds_memory_budget_for_B(int N, std::size_t threshold_bytes) {
   // Compute required memory for N x N doubles (8 bytes each)
   // Use size_t to avoid overflow for large N
@@ -0,0 +1,244 @@
+/**
+ * @file rmagemm.cpp
+ * @brief Implementation of the one-sided (MPI_Rget) GEMM and its baseline.
+ *
+ * Panels are visited starting with the caller's own B rows and then the
+ * blocks of ranks rank+1, rank+2, ... so that at any moment different
+ * ranks read from different targets instead of all hitting rank 0.
+ * Both variants time each iteration with perf::Sampler, closed by a
+ * barrier so that rank 0's sample is the slowest rank's time.
+ */
+
+#include "assignment5/rmagemm.h"
+#include "assignment5/comm.h"
+#include "assignment5/dist.h"
+#include "assignment5/matrix.h"
+#include "assignment5/verify.h"
+#include "perf/bench.h"
+#include "perf/freivalds.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace a5 {
+
+#if defined(MPI_VERSION) && MPI_VERSION >= 3
+#define A5_HAVE_RGET 1
+#else
+#define A5_HAVE_RGET 0
+#endif
+
+// Rows of B per fetched panel; 64 rows of N = 8192 doubles is 4 MiB
+static const int kPanelRows = 64;
+
+GemmRunResult::GemmRunResult()
+  : c00(0.0), c0N1(0.0), cN10(0.0), cN1N1(0.0), elapsed_s(0.0), comm_s(0.0),
+    residual(0.0) {}
+
+bool rma_gemm_supported() {
+  return A5_HAVE_RGET != 0;
+}
+
+/**
+ * @brief Collect corners (sum; non-owners contribute zero) and the
+ *        slowest rank's communication time at rank 0, and summarize the
+ *        timed iterations.
+ */
+static void finish_result(MPI_Comm comm, const double corners[4], double comm_s,
+                          const perf::Sampler& sampler, GemmRunResult& out) {
+  double local[4];
+  double global[4] = {0.0, 0.0, 0.0, 0.0};
+  for (int x = 0; x < 4; ++x) {
+    local[x] = corners[x];
+  }
+  MPI_Reduce(local, global, 4, MPI_DOUBLE, MPI_SUM, 0, comm);
+  MPI_Reduce(&comm_s, &out.comm_s, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+  out.c00 = global[0];
+  out.c0N1 = global[1];
+  out.cN10 = global[2];
+  out.cN1N1 = global[3];
+  out.samples = sampler.samples();
+  out.stats = sampler.stats();
+  out.elapsed_s = out.stats.median;
+}
+
+void run_bcast_gemm(MPI_Comm comm, int N, const perf::BenchConfig& bench, unsigned int seed,
+                    GemmRunResult& out) {
+  int rank = 0;
+  int P = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &P);
+  int row_offset = 0;
+  int row_count = 0;
+  row_block_partition(N, P, rank, row_offset, row_count);
+
+  // The broadcast never writes the root's copy, so B is initialized once
+  std::vector<double> B;
+  if (rank == 0) {
+    init_B(B, N);
+  } else {
+    B.resize(static_cast<std::size_t>(N) * static_cast<std::size_t>(N));
+  }
+  double corners[4] = {0.0, 0.0, 0.0, 0.0};
+  double comm_s = 0.0;
+  std::vector<double> r;
+  perf::freivalds_vector(seed, N, r);
+  std::vector<double> Cr(static_cast<std::size_t>(N) + 1, 0.0);
+
+  const int runs = bench.warmup + bench.reps;
+  int run = 0;
+  perf::Sampler sampler(bench);
+  MPI_Barrier(comm);
+  while (sampler.next()) {
+    const bool last = (++run == runs);
+    const double tb = MPI_Wtime();
+    bcast_large(&B[0], B.size(), 0, comm);
+    if (!sampler.warming_up()) {
+      comm_s += MPI_Wtime() - tb;
+    }
+    compute_local_rows(N, row_offset, row_count, &B[0],
+                       &corners[0], &corners[1], &corners[2], &corners[3],
+                       last ? &r[0] : static_cast<const double*>(0),
+                       last ? &Cr[row_offset] : static_cast<double*>(0));
+    MPI_Barrier(comm);
+  }
+
+  const std::vector<RowSegment> rows(1, RowSegment(row_offset, row_count));
+  out.residual = freivalds_residual(comm, N, &B[static_cast<std::size_t>(row_offset) * N],
+                                    row_count, r, rows, Cr);
+  finish_result(comm, corners, comm_s / (bench.reps > 0 ? bench.reps : 1), sampler, out);
+}
+
+#if A5_HAVE_RGET
+
+/**
+ * @brief One fetch unit: `rows` rows of B from local row `first` of `owner`.
+ */
+struct Panel {
+  int owner;
+  int first;   // Row index within the owner's block
+  int rows;
+};
+
+void run_rma_gemm(MPI_Comm comm, int N, const perf::BenchConfig& bench, unsigned int seed,
+                  GemmRunResult& out) {
+  int rank = 0;
+  int P = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &P);
+  const std::size_t n = static_cast<std::size_t>(N);
+  int row_offset = 0;
+  int row_count = 0;
+  row_block_partition(N, P, rank, row_offset, row_count);
+
+  // Each rank allocates, initializes and exposes its own rows of B;
+  // window-allocated memory lets the library register it for RDMA
+  MPI_Win win;
+  void* base = 0;
+  MPI_Win_allocate(static_cast<MPI_Aint>(static_cast<std::size_t>(row_count) * n * sizeof(double)),
+                   static_cast<int>(sizeof(double)), MPI_INFO_NULL, comm, &base, &win);
+  double* B_local = static_cast<double*>(base);
+  for (int r = 0; r < row_count; ++r) {
+    for (int j = 0; j < N; ++j) {
+      B_local[static_cast<std::size_t>(r) * n + j] = 1.0 / static_cast<double>(j + 1);
+    }
+  }
+
+  // Panel order: own block first, then the following ranks cyclically
+  std::vector<Panel> panels;
+  for (int o = 0; o < P; ++o) {
+    const int owner = (rank + o) % P;
+    int off = 0;
+    int cnt = 0;
+    row_block_partition(N, P, owner, off, cnt);
+    for (int first = 0; first < cnt; first += kPanelRows) {
+      Panel p;
+      p.owner = owner;
+      p.first = first;
+      p.rows = (cnt - first < kPanelRows) ? cnt - first : kPanelRows;
+      panels.push_back(p);
+    }
+  }
+  std::vector<double> buf[2];
+  buf[0].resize(static_cast<std::size_t>(kPanelRows) * n);
+  buf[1].resize(static_cast<std::size_t>(kPanelRows) * n);
+  std::vector<double> C(static_cast<std::size_t>(row_count) * n + 1);
+  double comm_s = 0.0;
+
+  MPI_Win_lock_all(0, win);
+  perf::Sampler sampler(bench);
+  MPI_Barrier(comm);
+  while (sampler.next()) {
+    const bool timed = !sampler.warming_up();
+    C.assign(C.size(), 0.0);
+    MPI_Request req[2] = {MPI_REQUEST_NULL, MPI_REQUEST_NULL};
+    const double* src[2] = {0, 0};
+
+    // Start panel p into buffer p % 2; own rows are read in place
+    for (std::size_t p = 0; p <= panels.size(); ++p) {
+      if (p < panels.size()) {
+        const Panel& pn = panels[p];
+        const int slot = static_cast<int>(p % 2);
+        if (pn.owner == rank) {
+          src[slot] = &B_local[static_cast<std::size_t>(pn.first) * n];
+        } else {
+          MPI_Rget(&buf[slot][0], static_cast<int>(pn.rows * n), MPI_DOUBLE, pn.owner,
+                   static_cast<MPI_Aint>(pn.first) * static_cast<MPI_Aint>(N),
+                   static_cast<int>(pn.rows * n), MPI_DOUBLE, win, &req[slot]);
+          src[slot] = &buf[slot][0];
+        }
+      }
+      // Multiply the previous panel while the one just issued is in flight
+      if (p > 0) {
+        const std::size_t cur = p - 1;
+        const int slot = static_cast<int>(cur % 2);
+        const double tw = MPI_Wtime();
+        MPI_Wait(&req[slot], MPI_STATUS_IGNORE);
+        if (timed) {
+          comm_s += MPI_Wtime() - tw;
+        }
+        accumulate_panel_rows(N, row_offset, row_count, panels[cur].rows, src[slot], &C[0]);
+      }
+    }
+    MPI_Barrier(comm);
+  }
+  MPI_Win_unlock_all(win);
+
+  // Freivalds check of the last iteration against the local B rows
+  std::vector<double> r;
+  perf::freivalds_vector(seed, N, r);
+  std::vector<double> Cr(static_cast<std::size_t>(N) + 1, 0.0);
+  for (int i = 0; i < row_count; ++i) {
+    const double* c_row = &C[static_cast<std::size_t>(i) * n];
+    double dot = 0.0;
+    for (int j = 0; j < N; ++j) {
+      dot += c_row[j] * r[j];
+    }
+    Cr[row_offset + i] = dot;
+  }
+  const std::vector<RowSegment> rows(1, RowSegment(row_offset, row_count));
+  out.residual = freivalds_residual(comm, N, B_local, row_count, r, rows, Cr);
+  MPI_Win_free(&win);
+
+  double corners[4] = {0.0, 0.0, 0.0, 0.0};
+  if (row_count > 0) {
+    if (row_offset == 0) {
+      corners[0] = C[0];
+      corners[1] = C[n - 1];
+    }
+    if (row_offset <= N - 1 && N - 1 < row_offset + row_count) {
+      const double* last = &C[static_cast<std::size_t>(N - 1 - row_offset) * n];
+      corners[2] = last[0];
+      corners[3] = last[n - 1];
+    }
+  }
+  finish_result(comm, corners, comm_s / (bench.reps > 0 ? bench.reps : 1), sampler, out);
+}
+
+#else
+
+void run_rma_gemm(MPI_Comm, int, const perf::BenchConfig&, unsigned int, GemmRunResult&) {}
+
+#endif
+
+} // namespace a5
@@ -0,0 +1,139 @@
+/**
+ * @file sched.cpp
+ * @brief Implementation of the shared-counter row scheduler.
+ *
+ * The counter is a single MPI_LONG in a window on rank 0. All ranks hold a
+ * shared passive-target lock for the scheduler's lifetime and advance the
+ * counter with MPI_Fetch_and_op(MPI_SUM); the returned old value is the
+ * first row of the claimed chunk. Built against MPI < 3 the scheduler
+ * reports itself unsupported and the caller keeps the static partition.
+ */
+
+#include "assignment5/sched.h"
+
+namespace a5 {
+
+#if defined(MPI_VERSION) && MPI_VERSION >= 3
+#define A5_HAVE_RMA_ATOMICS 1
+#else
+#define A5_HAVE_RMA_ATOMICS 0
+#endif
+
+// Weight of the newest chunk in the exponential moving average of the rate
+static const double kRateSmoothing = 0.5;
+
+// Default target duration of one chunk; long enough to amortize the atomic
+static const double kDefaultQuantum = 0.01;
+
+int adaptive_chunk_rows(int remaining, int P, double rows_per_s,
+                        double quantum_s, int min_rows) {
+  if (remaining <= 0) {
+    return 0;
+  }
+  if (P < 1) P = 1;
+  if (min_rows < 1) min_rows = 1;
+
+  // Guided bound: leave enough work for every rank to take two more chunks
+  const int guided = (remaining + 2 * P - 1) / (2 * P);
+  int chunk = min_rows;
+  if (rows_per_s > 0.0 && quantum_s > 0.0) {
+    const double by_rate = rows_per_s * quantum_s;
+    chunk = (by_rate > static_cast<double>(remaining)) ? remaining : static_cast<int>(by_rate);
+    if (chunk > guided) chunk = guided;
+  }
+  if (chunk < min_rows) chunk = min_rows;
+  if (chunk > remaining) chunk = remaining;
+  return chunk;
+}
+
+RowScheduler::RowScheduler()
+  : win(MPI_WIN_NULL), counter(0), N(0), P(1), rank(0), next_hint(0),
+    rows_per_s(0.0), quantum_s(kDefaultQuantum) {}
+
+bool row_scheduler_supported() {
+  return A5_HAVE_RMA_ATOMICS != 0;
+}
+
+void row_scheduler_record(RowScheduler& s, int rows, double seconds) {
+  if (rows <= 0 || seconds <= 0.0) {
+    return;
+  }
+  const double rate = static_cast<double>(rows) / seconds;
+  s.rows_per_s = (s.rows_per_s > 0.0)
+      ? kRateSmoothing * rate + (1.0 - kRateSmoothing) * s.rows_per_s
+      : rate;
+}
+
+#if A5_HAVE_RMA_ATOMICS
+
+// Smallest chunk; keeps the tail fine-grained without one atomic per row
+static const int kMinChunkRows = 4;
+
+bool row_scheduler_create(MPI_Comm comm, int N, RowScheduler& s) {
+  MPI_Comm_rank(comm, &s.rank);
+  MPI_Comm_size(comm, &s.P);
+  s.N = N;
+  s.next_hint = 0;
+
+  const MPI_Aint bytes = (s.rank == 0) ? static_cast<MPI_Aint>(sizeof(long)) : 0;
+  void* base = 0;
+  MPI_Win_allocate(bytes, static_cast<int>(sizeof(long)), MPI_INFO_NULL, comm, &base, &s.win);
+  s.counter = (s.rank == 0) ? static_cast<long*>(base) : 0;
+  if (s.counter) {
+    *s.counter = 0;
+  }
+  MPI_Barrier(comm);
+  MPI_Win_lock_all(0, s.win);
+  return true;
+}
+
+bool row_scheduler_next(RowScheduler& s, int& offset, int& count) {
+  const long remaining_hint = static_cast<long>(s.N) - s.next_hint;
+  const int want = adaptive_chunk_rows(remaining_hint > 0 ? static_cast<int>(remaining_hint) : 1,
+                                       s.P, s.rows_per_s, s.quantum_s, kMinChunkRows);
+
+  long add = want;
+  long old = 0;
+  MPI_Fetch_and_op(&add, &old, MPI_LONG, 0, 0, MPI_SUM, s.win);
+  MPI_Win_flush(0, s.win);
+
+  if (old >= s.N) {
+    s.next_hint = s.N;
+    return false;
+  }
+  const long end = (old + add < s.N) ? old + add : s.N;
+  offset = static_cast<int>(old);
+  count = static_cast<int>(end - old);
+  s.next_hint = old + add;
+  return true;
+}
+
+void row_scheduler_reset(RowScheduler& s, MPI_Comm comm) {
+  if (s.rank == 0) {
+    long zero = 0;
+    long old = 0;
+    MPI_Fetch_and_op(&zero, &old, MPI_LONG, 0, 0, MPI_REPLACE, s.win);
+    MPI_Win_flush(0, s.win);
+  }
+  s.next_hint = 0;
+  MPI_Barrier(comm);
+}
+
+void row_scheduler_free(RowScheduler& s) {
+  if (s.win != MPI_WIN_NULL) {
+    MPI_Win_unlock_all(s.win);
+    MPI_Win_free(&s.win);
+  }
+  s.counter = 0;
+}
+
+#else
+
+bool row_scheduler_create(MPI_Comm, int, RowScheduler&) { return false; }
+bool row_scheduler_next(RowScheduler&, int&, int&) { return false; }
+void row_scheduler_reset(RowScheduler&, MPI_Comm) {}
+void row_scheduler_free(RowScheduler&) {}
+
+#endif
+
+} // namespace a5
@@ -0,0 +1,39 @@
+/**
+ * @file sysmem.cpp
+ * @brief Per-rank memory budget agreed on by all ranks.
+ */
+
+#include "assignment5/sysmem.h"
+
+#include "perf/sysmem.h"
+
+namespace a5 {
+
+int ranks_on_node(MPI_Comm comm) {
+#if defined(MPI_VERSION) && MPI_VERSION >= 3
+  MPI_Comm node_comm;
+  MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node_comm);
+  int n = 1;
+  MPI_Comm_size(node_comm, &n);
+  MPI_Comm_free(&node_comm);
+  return n;
+#else
+  (void)comm;
+  return 1;
+#endif
+}
+
+std::size_t agreed_memory_budget(MPI_Comm comm, bool per_rank_copy) {
+  std::size_t budget = perf::memory_budget_bytes();
+  if (per_rank_copy) {
+    budget /= static_cast<std::size_t>(ranks_on_node(comm));
+  }
+  // Reduced as double: MPI-2 has no portable size_t datatype, and byte
+  // counts are exact in a double up to 2^53
+  double local = static_cast<double>(budget);
+  double global = local;
+  MPI_Allreduce(&local, &global, 1, MPI_DOUBLE, MPI_MIN, comm);
+  return static_cast<std::size_t>(global);
+}
+
+} // namespace a5
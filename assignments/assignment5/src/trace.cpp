@@ -0,0 +1,171 @@
+/**
+ * @file trace.cpp
+ * @brief Clock offset estimation and gathering of per-rank phase traces.
+ */
+
+#include "assignment5/trace.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <sstream>
+
+#include "perf/bench.h"
+
+namespace a5 {
+
+// Ping-pong rounds per rank; the shortest round trip is kept
+static const int kClockRounds = 8;
+static const int kTagPing = 301;
+static const int kTagPong = 302;
+
+double clock_offset_from_pings(const std::vector<double>& t_send,
+                               const std::vector<double>& t_remote,
+                               const std::vector<double>& t_recv) {
+  double offset = 0.0;
+  double best_rtt = 0.0;
+  for (std::size_t i = 0; i < t_send.size() && i < t_remote.size() && i < t_recv.size(); ++i) {
+    const double rtt = t_recv[i] - t_send[i];
+    if (i == 0 || rtt < best_rtt) {
+      best_rtt = rtt;
+      offset = t_remote[i] - 0.5 * (t_send[i] + t_recv[i]);
+    }
+  }
+  return offset;
+}
+
+void pack_trace(const std::vector<perf::TraceEvent>& events, std::vector<double>& nums,
+                std::string& names) {
+  nums.clear();
+  names.clear();
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    nums.push_back(events[i].ts);
+    nums.push_back(static_cast<double>(events[i].ph));
+    nums.push_back(static_cast<double>(events[i].tid));
+    names += events[i].name;
+    names += '\0';
+  }
+}
+
+void unpack_trace(const std::vector<double>& nums, const std::string& names, int pid,
+                  double offset, std::vector<perf::TraceEvent>& out) {
+  std::size_t pos = 0;
+  for (std::size_t i = 0; i + 2 < nums.size(); i += 3) {
+    perf::TraceEvent e;
+    e.ts = nums[i] - offset;
+    e.ph = static_cast<char>(nums[i + 1]);
+    e.tid = static_cast<int>(nums[i + 2]);
+    e.pid = pid;
+    const std::size_t end = names.find('\0', pos);
+    e.name = names.substr(pos, (end == std::string::npos) ? std::string::npos : end - pos);
+    pos = (end == std::string::npos) ? names.size() : end + 1;
+    out.push_back(e);
+  }
+}
+
+/**
+ * @brief Offsets of every rank's clock against rank 0's (rank 0 gets them).
+ *
+ * Ranks are pinged one after the other so that no two round trips compete.
+ */
+static void estimate_offsets(MPI_Comm comm, int rank, int size, std::vector<double>& offsets) {
+  offsets.assign(static_cast<std::size_t>(size), 0.0);
+  for (int r = 1; r < size; ++r) {
+    if (rank == 0) {
+      std::vector<double> t_send(kClockRounds);
+      std::vector<double> t_remote(kClockRounds);
+      std::vector<double> t_recv(kClockRounds);
+      for (int k = 0; k < kClockRounds; ++k) {
+        t_send[k] = perf::now_seconds();
+        MPI_Send(0, 0, MPI_DOUBLE, r, kTagPing, comm);
+        MPI_Recv(&t_remote[k], 1, MPI_DOUBLE, r, kTagPong, comm, MPI_STATUS_IGNORE);
+        t_recv[k] = perf::now_seconds();
+      }
+      offsets[r] = clock_offset_from_pings(t_send, t_remote, t_recv);
+    } else if (rank == r) {
+      for (int k = 0; k < kClockRounds; ++k) {
+        MPI_Recv(0, 0, MPI_DOUBLE, 0, kTagPing, comm, MPI_STATUS_IGNORE);
+        double now = perf::now_seconds();
+        MPI_Send(&now, 1, MPI_DOUBLE, 0, kTagPong, comm);
+      }
+    }
+  }
+}
+
+static bool earlier(const perf::TraceEvent& a, const perf::TraceEvent& b) {
+  return a.ts < b.ts;
+}
+
+void gather_trace(MPI_Comm comm, const std::vector<perf::TraceEvent>& local,
+                  std::vector<perf::TraceEvent>& merged, std::vector<std::string>& process_names,
+                  std::vector<double>& offsets) {
+  int rank = 0;
+  int size = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+  estimate_offsets(comm, rank, size, offsets);
+
+  std::vector<double> nums;
+  std::string names;
+  pack_trace(local, nums, names);
+
+  // Host names, to label each rank's process in the viewer
+  char host[MPI_MAX_PROCESSOR_NAME];
+  int host_len = 0;
+  std::memset(host, 0, sizeof(host));
+  MPI_Get_processor_name(host, &host_len);
+
+  const int root = (rank == 0);
+  int counts[2] = {static_cast<int>(nums.size()), static_cast<int>(names.size())};
+  std::vector<int> all_counts(root ? static_cast<std::size_t>(size) * 2 : 2);
+  MPI_Gather(counts, 2, MPI_INT, &all_counts[0], 2, MPI_INT, 0, comm);
+  std::vector<char> hosts(root ? static_cast<std::size_t>(size) * MPI_MAX_PROCESSOR_NAME : 1);
+  MPI_Gather(host, MPI_MAX_PROCESSOR_NAME, MPI_CHAR, &hosts[0], MPI_MAX_PROCESSOR_NAME, MPI_CHAR,
+             0, comm);
+
+  std::vector<int> num_counts(root ? size : 1, 0);
+  std::vector<int> num_displs(root ? size : 1, 0);
+  std::vector<int> name_counts(root ? size : 1, 0);
+  std::vector<int> name_displs(root ? size : 1, 0);
+  int num_total = 0;
+  int name_total = 0;
+  if (root) {
+    for (int r = 0; r < size; ++r) {
+      num_counts[r] = all_counts[2 * r];
+      name_counts[r] = all_counts[2 * r + 1];
+      num_displs[r] = num_total;
+      name_displs[r] = name_total;
+      num_total += num_counts[r];
+      name_total += name_counts[r];
+    }
+  }
+  std::vector<double> all_nums(num_total > 0 ? num_total : 1);
+  std::vector<char> all_names(name_total > 0 ? name_total : 1);
+  double dummy_num = 0.0;
+  char dummy_name = 0;
+  MPI_Gatherv(nums.empty() ? &dummy_num : &nums[0], counts[0], MPI_DOUBLE,
+              &all_nums[0], &num_counts[0], &num_displs[0], MPI_DOUBLE, 0, comm);
+  MPI_Gatherv(names.empty() ? &dummy_name : &names[0], counts[1], MPI_CHAR,
+              &all_names[0], &name_counts[0], &name_displs[0], MPI_CHAR, 0, comm);
+  if (!root) {
+    return;
+  }
+
+  merged.clear();
+  process_names.clear();
+  for (int r = 0; r < size; ++r) {
+    const std::vector<double> rank_nums(all_nums.begin() + num_displs[r],
+                                        all_nums.begin() + num_displs[r] + num_counts[r]);
+    const std::string rank_names(all_names.begin() + name_displs[r],
+                                 all_names.begin() + name_displs[r] + name_counts[r]);
+    unpack_trace(rank_nums, rank_names, r, offsets[r], merged);
+    std::ostringstream oss;
+    oss << "rank " << r << " (" << &hosts[static_cast<std::size_t>(r) * MPI_MAX_PROCESSOR_NAME]
+        << ")";
+    process_names.push_back(oss.str());
+  }
+  // Stable: each rank's own order survives equal times
+  std::stable_sort(merged.begin(), merged.end(), earlier);
+}
+
+} // namespace a5
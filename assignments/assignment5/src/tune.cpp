@@ -0,0 +1,244 @@
+/**
+ * @file tune.cpp
+ * @brief Implementation of the kernel autotuner and its cache file.
+ *
+ * Candidate values are small fixed lists; the search costs a few dozen
+ * sample multiplies. Timings use MPI_Wtime, which needs no communicator.
+ */
+
+#include "assignment5/tune.h"
+#include "perf/roofline.h"
+
+#include <mpi.h>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+namespace a5 {
+
+// Candidate values per parameter, searched in this order
+static const int kRowsCandidates[] = {4, 8, 16, 32, 64};
+static const int kKCandidates[] = {32, 64, 128, 256, 512};
+static const int kJCandidates[] = {128, 256, 512, 1024, 2048};
+// Full passes of coordinate descent; a second pass rarely changes anything
+static const int kTunePasses = 2;
+
+TuneResult::TuneResult() : gflops(0.0), base_gflops(0.0), evaluations(0) {}
+
+MPI_Comm split_by_host(MPI_Comm comm) {
+  int rank = 0;
+  int P = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &P);
+  char name[256];
+  std::memset(name, 0, sizeof(name));
+  std::strncpy(name, perf::host_name().c_str(), sizeof(name) - 1);
+  std::vector<char> all(static_cast<std::size_t>(P) * sizeof(name));
+  MPI_Allgather(name, static_cast<int>(sizeof(name)), MPI_CHAR,
+                &all[0], static_cast<int>(sizeof(name)), MPI_CHAR, comm);
+  // Color: lowest rank with the same name
+  int color = rank;
+  for (int p = 0; p < P; ++p) {
+    if (std::strncmp(name, &all[static_cast<std::size_t>(p) * sizeof(name)], sizeof(name)) == 0) {
+      color = p;
+      break;
+    }
+  }
+  MPI_Comm host_comm;
+  MPI_Comm_split(comm, color, rank, &host_comm);
+  return host_comm;
+}
+
+std::string tune_cache_path(const std::string& host) {
+  const char* dir = std::getenv("A5_TUNE_DIR");
+  if (!dir || !*dir) {
+    dir = std::getenv("HOME");
+  }
+  std::string path = (dir && *dir) ? std::string(dir) + "/" : std::string();
+  return path + ".assignment5-tune-" + host;
+}
+
+std::string format_kernel_config(const KernelConfig& cfg) {
+  std::ostringstream oss;
+  oss << "rows=" << cfg.block_rows << " k=" << cfg.block_k << " j=" << cfg.block_j
+      << " order=" << (cfg.order == ORDER_KJ ? "kj" : "jk") << " threads=";
+  if (cfg.threads > 0) {
+    oss << cfg.threads;
+  } else {
+    oss << "default";
+  }
+  return oss.str();
+}
+
+bool load_tune_cache(const std::string& path, const std::string& host,
+                     KernelConfig& cfg, int& ranks, double& gflops, std::string& err) {
+  std::ifstream in(path.c_str());
+  if (!in) {
+    err = "no tune cache at " + path;
+    return false;
+  }
+  KernelConfig c;
+  std::string file_host;
+  ranks = 0;
+  gflops = 0.0;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    const std::string::size_type eq = line.find('=');
+    if (eq == std::string::npos) {
+      err = "malformed line in " + path + ": " + line;
+      return false;
+    }
+    const std::string key = line.substr(0, eq);
+    const std::string val = line.substr(eq + 1);
+    const int iv = std::atoi(val.c_str());
+    if (key == "host") {
+      file_host = val;
+    } else if (key == "block_rows") {
+      c.block_rows = iv;
+    } else if (key == "block_k") {
+      c.block_k = iv;
+    } else if (key == "block_j") {
+      c.block_j = iv;
+    } else if (key == "order") {
+      c.order = (val == "kj") ? ORDER_KJ : ORDER_JK;
+    } else if (key == "threads") {
+      c.threads = iv;
+    } else if (key == "ranks") {
+      ranks = iv;
+    } else if (key == "gflops") {
+      gflops = std::atof(val.c_str());
+    }
+    // Unknown keys are ignored so newer files stay readable
+  }
+  if (file_host != host) {
+    err = path + " was tuned for host '" + file_host + "'";
+    return false;
+  }
+  if (c.block_rows <= 0 || c.block_k <= 0 || c.block_j <= 0 || c.threads < 0) {
+    err = "invalid values in " + path;
+    return false;
+  }
+  cfg = c;
+  return true;
+}
+
+bool save_tune_cache(const std::string& path, const std::string& host, int ranks,
+                     const KernelConfig& cfg, double gflops, std::string& err) {
+  std::ofstream out(path.c_str());
+  if (!out) {
+    err = "cannot write tune cache " + path;
+    return false;
+  }
+  out << "# assignment5 kernel autotune cache (written by --tune)\n"
+      << "host=" << host << "\n"
+      << "ranks=" << ranks << "\n"
+      << "block_rows=" << cfg.block_rows << "\n"
+      << "block_k=" << cfg.block_k << "\n"
+      << "block_j=" << cfg.block_j << "\n"
+      << "order=" << (cfg.order == ORDER_KJ ? "kj" : "jk") << "\n"
+      << "threads=" << cfg.threads << "\n"
+      << "gflops=" << gflops << "\n";
+  out.flush();
+  if (!out) {
+    err = "write failed for " + path;
+    return false;
+  }
+  return true;
+}
+
+double time_kernel(const KernelConfig& cfg, int N, int rows, const double* B) {
+  set_kernel_config(cfg);
+  double best = 0.0;
+  for (int rep = 0; rep < 2; ++rep) {
+    const double t0 = MPI_Wtime();
+    compute_local_rows(N, 0, rows, B, 0, 0, 0, 0);
+    const double dt = MPI_Wtime() - t0;
+    if (rep == 0 || dt < best) {
+      best = dt;
+    }
+  }
+  const double flops = 2.0 * static_cast<double>(rows) * static_cast<double>(N)
+                           * static_cast<double>(N);
+  return (best > 0.0) ? flops / (best * 1e9) : 0.0;
+}
+
+/**
+ * @brief Try each value for one parameter, keeping the fastest.
+ *
+ * @param field  Member of cfg being tuned
+ * @param values Candidates
+ * @param count  Number of candidates
+ */
+static void tune_parameter(KernelConfig& cfg, int KernelConfig::*field,
+                           const int* values, int count, int N, int rows,
+                           const double* B, TuneResult& out) {
+  for (int v = 0; v < count; ++v) {
+    if (cfg.*field == values[v]) {
+      continue;
+    }
+    KernelConfig trial = cfg;
+    trial.*field = values[v];
+    const double g = time_kernel(trial, N, rows, B);
+    ++out.evaluations;
+    if (g > out.gflops) {
+      out.gflops = g;
+      cfg = trial;
+    }
+  }
+}
+
+void autotune_kernel(int N, int rows, TuneResult& out) {
+  out = TuneResult();
+  std::vector<double> B;
+  init_B(B, N);
+  const double* b = B.empty() ? static_cast<const double*>(0) : &B[0];
+
+  // Thread counts: the runtime default, then halvings down to 1
+  std::vector<int> thread_values;
+#if defined(_OPENMP)
+  for (int t = omp_get_max_threads(); t >= 1; t /= 2) {
+    thread_values.push_back(t);
+  }
+#else
+  thread_values.push_back(1);
+#endif
+
+  KernelConfig cfg;
+  cfg.threads = thread_values[0];
+  out.base_gflops = time_kernel(cfg, N, rows, b);
+  out.gflops = out.base_gflops;
+  out.evaluations = 1;
+
+  for (int pass = 0; pass < kTunePasses; ++pass) {
+    tune_parameter(cfg, &KernelConfig::threads, &thread_values[0],
+                   static_cast<int>(thread_values.size()), N, rows, b, out);
+    tune_parameter(cfg, &KernelConfig::block_j, kJCandidates,
+                   static_cast<int>(sizeof(kJCandidates) / sizeof(kJCandidates[0])), N, rows, b, out);
+    tune_parameter(cfg, &KernelConfig::block_k, kKCandidates,
+                   static_cast<int>(sizeof(kKCandidates) / sizeof(kKCandidates[0])), N, rows, b, out);
+    tune_parameter(cfg, &KernelConfig::block_rows, kRowsCandidates,
+                   static_cast<int>(sizeof(kRowsCandidates) / sizeof(kRowsCandidates[0])), N, rows, b, out);
+    KernelConfig flip = cfg;
+    flip.order = (cfg.order == ORDER_JK) ? ORDER_KJ : ORDER_JK;
+    const double g = time_kernel(flip, N, rows, b);
+    ++out.evaluations;
+    if (g > out.gflops) {
+      out.gflops = g;
+      cfg = flip;
+    }
+  }
+  out.best = cfg;
+  set_kernel_config(cfg);
+}
+
+} // namespace a5
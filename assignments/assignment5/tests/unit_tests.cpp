@@ -2,15 +2,28 @@
  * @file unit_tests.cpp
  * @brief Unit tests for assignment5 distribution and matrix functions.
  *
- * Tests the row-block partitioning logic to ensure correct distribution
- * of rows across MPI ranks. Uses the Unity test framework.
+ * Tests the row partitioning logic (block, block-cyclic, weighted) to
+ * ensure correct distribution of rows across MPI ranks. Uses the Unity test framework.
  */
 
+#include "assignment5/comm.h"
 #include "assignment5/dist.h"
+#include "assignment5/gemm25d.h"
+#include "assignment5/imbalance.h"
 #include "assignment5/matrix.h"
+#include "assignment5/sched.h"
+#include "assignment5/trace.h"
+#include "assignment5/tune.h"
+#include "assignment5/verify.h"
+#include "perf/freivalds.h"
+#include "perf/sysmem.h"
 extern "C" {
 #include "vendor/unity/unity.h"
 }
+#include <climits>
+#include <cstdio>
+#include <cstddef>
+#include <string>
 #include <vector>
 
 /**
@@ -51,10 +64,371 @@ static void test_owner_of_row() {
   UnityAssertEqualInt(2, a5::owner_of_row(10, 3, 9), "row9 owner");
 }
 
+/**
+ * @brief Test corner elements from the blocked kernel against the closed form.
+ *
+ * The default tiles are larger than N=37 in k and j, so the test selects
+ * 8 x 5 x 7 blocks, none of which divides N: the last row, k and j block
+ * of each is partial, in both loop orders. C[i][j] = N * (i + 1) / (j + 1);
+ * values are compared after scaling to integers (exact for this N).
+ */
+static void test_compute_local_rows_corners() {
+  const int N = 37;
+  std::vector<double> B;
+  a5::init_B(B, N);
+  const a5::KernelConfig saved = a5::kernel_config();
+  a5::KernelConfig cfg;
+  cfg.block_rows = 8;
+  cfg.block_k = 5;
+  cfg.block_j = 7;
+  for (int o = 0; o < 2; ++o) {
+    cfg.order = (o == 0) ? a5::ORDER_JK : a5::ORDER_KJ;
+    a5::set_kernel_config(cfg);
+    double c00 = 0.0, c0N1 = 0.0, cN10 = 0.0, cN1N1 = 0.0;
+    a5::compute_local_rows(N, 0, N, B, &c00, &c0N1, &cN10, &cN1N1);
+    UnityAssertEqualInt(37, static_cast<int>(c00 + 0.5), "C[0][0]");
+    UnityAssertEqualInt(1000, static_cast<int>(c0N1 * 1000.0 + 0.5), "C[0][N-1]");
+    UnityAssertEqualInt(1369, static_cast<int>(cN10 + 0.5), "C[N-1][0]");
+    UnityAssertEqualInt(37, static_cast<int>(cN1N1 + 0.5), "C[N-1][N-1]");
+  }
+
+  // A block in the middle owns no corners and must leave them untouched
+  double untouched = -1.0;
+  a5::compute_local_rows(N, 5, 20, B, &untouched, &untouched, &untouched, &untouched);
+  UnityAssertEqualInt(-1, static_cast<int>(untouched), "no corner outside rows");
+  a5::set_kernel_config(saved);
+}
+
+/**
+ * @brief Test block-cyclic ownership and row counts with N=10, P=3, b=2.
+ *
+ * Blocks [0,1] [2,3] [4,5] [6,7] [8,9] go to ranks 0 1 2 0 1.
+ */
+static void test_block_cyclic() {
+  UnityAssertEqualInt(0, a5::owner_of_row_cyclic(10, 3, 2, 1), "row 1");
+  UnityAssertEqualInt(2, a5::owner_of_row_cyclic(10, 3, 2, 5), "row 5");
+  UnityAssertEqualInt(0, a5::owner_of_row_cyclic(10, 3, 2, 6), "row 6");
+  UnityAssertEqualInt(1, a5::owner_of_row_cyclic(10, 3, 2, 9), "row 9");
+  UnityAssertEqualInt(4, a5::cyclic_row_count(10, 3, 2, 0), "rank 0 count");
+  UnityAssertEqualInt(4, a5::cyclic_row_count(10, 3, 2, 1), "rank 1 count");
+  UnityAssertEqualInt(2, a5::cyclic_row_count(10, 3, 2, 2), "rank 2 count");
+
+  a5::RowDistribution d;
+  a5::make_distribution(a5::DIST_CYCLIC, 10, 3, 2, std::vector<double>(), d);
+  std::vector<a5::RowSegment> segs;
+  a5::dist_segments(d, 1, segs);
+  UnityAssertEqualInt(2, static_cast<int>(segs.size()), "rank 1 segments");
+  UnityAssertEqualInt(8, segs[1].offset, "rank 1 second offset");
+  UnityAssertEqualInt(2, segs[1].count, "rank 1 second count");
+}
+
+/**
+ * @brief Test weighted partitioning with speeds 1:2:1 and N=10.
+ *
+ * Shares are 2.5, 5, 2.5; the leftover row goes to rank 0 (ties broken by
+ * lower rank), giving ranges [0,3) [3,8) [8,10).
+ */
+static void test_weighted_partition() {
+  std::vector<double> w;
+  w.push_back(1.0);
+  w.push_back(2.0);
+  w.push_back(1.0);
+  std::vector<int> bounds;
+  a5::weighted_partition(10, w, bounds);
+  UnityAssertEqualInt(4, static_cast<int>(bounds.size()), "bounds size");
+  UnityAssertEqualInt(3, bounds[1], "rank 0 end");
+  UnityAssertEqualInt(8, bounds[2], "rank 1 end");
+  UnityAssertEqualInt(10, bounds[3], "rank 2 end");
+  UnityAssertEqualInt(0, a5::owner_of_row_weighted(bounds, 2), "row 2");
+  UnityAssertEqualInt(1, a5::owner_of_row_weighted(bounds, 3), "row 3");
+  UnityAssertEqualInt(2, a5::owner_of_row_weighted(bounds, 9), "row 9");
+
+  // A very slow rank may receive no rows; ownership must skip it
+  w[1] = 1e-9;
+  a5::weighted_partition(4, w, bounds);
+  UnityAssertEqualInt(0, bounds[2] - bounds[1], "slow rank empty");
+  UnityAssertEqualInt(2, a5::owner_of_row_weighted(bounds, bounds[2]), "owner after empty");
+}
+
+/**
+ * @brief Test the dynamic scheduler's chunk-size policy.
+ *
+ * Without a rate a probe chunk is returned; with a rate the chunk follows
+ * rate * quantum but is capped by the guided bound ceil(remaining / 2P)
+ * and never drops below the minimum (unless fewer rows remain).
+ */
+static void test_adaptive_chunk_rows() {
+  UnityAssertEqualInt(0, a5::adaptive_chunk_rows(0, 4, 100.0, 0.01, 4), "nothing left");
+  UnityAssertEqualInt(4, a5::adaptive_chunk_rows(1000, 4, 0.0, 0.01, 4), "probe chunk");
+  UnityAssertEqualInt(50, a5::adaptive_chunk_rows(1000, 4, 5000.0, 0.01, 4), "rate bound");
+  UnityAssertEqualInt(125, a5::adaptive_chunk_rows(1000, 4, 1e9, 0.01, 4), "guided bound");
+  UnityAssertEqualInt(4, a5::adaptive_chunk_rows(1000, 4, 10.0, 0.01, 4), "minimum");
+  UnityAssertEqualInt(3, a5::adaptive_chunk_rows(3, 4, 1e9, 0.01, 4), "tail");
+}
+
+/**
+ * @brief Test 2.5D grid validation and the words-per-rank model.
+ *
+ * P = q^2 c with q a multiple of c: 8 = 2^2 * 2 and 32 = 4^2 * 2 are valid,
+ * 16 with c = 4 (q = 2) and 12 (not q^2 c) are not. With c = 1 the model
+ * equals the 2D cost.
+ */
+static void test_gemm25d_grid() {
+  int q = 0;
+  UnityAssertEqualInt(1, a5::gemm25d_grid(8, 2, q) ? 1 : 0, "P=8 c=2 valid");
+  UnityAssertEqualInt(2, q, "P=8 c=2 q");
+  UnityAssertEqualInt(1, a5::gemm25d_grid(32, 2, q) ? 1 : 0, "P=32 c=2 valid");
+  UnityAssertEqualInt(4, q, "P=32 c=2 q");
+  UnityAssertEqualInt(0, a5::gemm25d_grid(16, 4, q) ? 1 : 0, "q not multiple of c");
+  UnityAssertEqualInt(0, a5::gemm25d_grid(12, 1, q) ? 1 : 0, "not a square");
+
+  double w1d = 0.0, w2d = 0.0, w25d = 0.0;
+  a5::gemm25d_cost_model(1000, 16, 1, w1d, w2d, w25d);
+  UnityAssertEqualInt(1000000, static_cast<int>(w1d), "1d words");
+  UnityAssertEqualInt(500000, static_cast<int>(w2d), "2d words");
+  UnityAssertEqualInt(500000, static_cast<int>(w25d), "2.5d with c=1");
+}
+
+/**
+ * @brief Test the Freivalds check on kernel output, then on a corrupted row.
+ *
+ * The kernel's C * r must agree with A (B r) for every row; perturbing one
+ * interior entry of C r by one element's worth must exceed the tolerance.
+ */
+static void test_freivalds_detects_error() {
+  const int N = 37;
+  std::vector<double> B;
+  a5::init_B(B, N);
+  std::vector<double> r;
+  perf::freivalds_vector(12345u, N, r);
+
+  std::vector<double> Cr(N, 0.0);
+  a5::compute_local_rows(N, 0, N, &B[0], 0, 0, 0, 0, &r[0], &Cr[0]);
+  std::vector<double> Br(N);
+  std::vector<double> absBr(N);
+  a5::freivalds_partial_Br(&B[0], N, N, r, &Br[0], &absBr[0]);
+
+  const std::vector<a5::RowSegment> rows(1, a5::RowSegment(0, N));
+  const double ok = a5::freivalds_local_residual(N, rows, Cr, Br, absBr);
+  UnityAssertEqualInt(1, ok <= perf::freivalds_tolerance(N) ? 1 : 0, "correct C passes");
+
+  // C[20][7] off by its own value: C r changes by C[20][7] * r[7]
+  Cr[20] += (N * 21.0 / 8.0) * r[7];
+  const double bad = a5::freivalds_local_residual(N, rows, Cr, Br, absBr);
+  UnityAssertEqualInt(0, bad <= perf::freivalds_tolerance(N) ? 1 : 0, "wrong element fails");
+}
+
+/**
+ * @brief Test the RAM-derived budget and the broadcast chunk size.
+ *
+ * The budget replaces the fixed 1 GiB guard, so it must be positive and no
+ * larger than what the node reports; chunks must fit an MPI int count.
+ */
+static void test_memory_budget() {
+  const std::size_t avail = perf::available_memory_bytes();
+  const std::size_t budget = perf::memory_budget_bytes();
+  UnityAssertEqualInt(1, budget > 0 ? 1 : 0, "budget positive");
+  UnityAssertEqualInt(1, (avail == 0 || budget <= avail) ? 1 : 0, "budget within available");
+  UnityAssertEqualInt(1, a5::bcast_chunk_elements() <= static_cast<std::size_t>(INT_MAX) ? 1 : 0,
+                      "chunk fits int");
+  // A 46341^2 matrix no longer trips the budget check by itself
+  UnityAssertEqualInt(0, a5::exceeds_memory_budget_for_B(46341, static_cast<std::size_t>(-1)) ? 1 : 0,
+                      "size_t byte count");
+}
+
+/**
+ * @brief Every kernel configuration gives bitwise the same C * r.
+ *
+ * Block sizes that do not divide N and both loop orders only change the
+ * traversal, never the order of the k terms of an element.
+ */
+static void test_kernel_configs_agree() {
+  const int N = 45;
+  std::vector<double> B;
+  a5::init_B(B, N);
+  std::vector<double> r(N, 1.0);
+  for (int j = 0; j < N; ++j) {
+    r[j] = 1.0 / (j + 3.0);
+  }
+  const a5::KernelConfig saved = a5::kernel_config();
+  std::vector<double> ref(N);
+  a5::set_kernel_config(a5::KernelConfig());
+  a5::compute_local_rows(N, 0, N, &B[0], 0, 0, 0, 0, &r[0], &ref[0]);
+
+  a5::KernelConfig cfg;
+  cfg.block_rows = 7;
+  cfg.block_k = 10;
+  cfg.block_j = 13;
+  for (int o = 0; o < 2; ++o) {
+    cfg.order = (o == 0) ? a5::ORDER_JK : a5::ORDER_KJ;
+    a5::set_kernel_config(cfg);
+    std::vector<double> got(N);
+    a5::compute_local_rows(N, 0, N, &B[0], 0, 0, 0, 0, &r[0], &got[0]);
+    int same = 1;
+    for (int i = 0; i < N; ++i) {
+      same &= (got[i] == ref[i]) ? 1 : 0;
+    }
+    UnityAssertEqualInt(1, same, "config changes results");
+  }
+  a5::set_kernel_config(saved);
+}
+
+/**
+ * @brief Panels of B added in ascending order give the C of compute_local_rows().
+ *
+ * Panels of 7 rows (the last one partial) run through the blocked kernel
+ * with 8 x 5 x 7 tiles; C * r is compared bitwise.
+ */
+static void test_accumulate_panel_rows() {
+  const int N = 37;
+  const int row0 = 3;
+  const int rows = 20;
+  std::vector<double> B;
+  a5::init_B(B, N);
+  std::vector<double> r(N);
+  for (int j = 0; j < N; ++j) {
+    r[j] = 1.0 / (j + 2.0);
+  }
+  const a5::KernelConfig saved = a5::kernel_config();
+  a5::KernelConfig cfg;
+  cfg.block_rows = 8;
+  cfg.block_k = 5;
+  cfg.block_j = 7;
+  a5::set_kernel_config(cfg);
+  std::vector<double> ref(rows);
+  a5::compute_local_rows(N, row0, rows, &B[0], 0, 0, 0, 0, &r[0], &ref[0]);
+
+  std::vector<double> C(static_cast<std::size_t>(rows) * N, 0.0);
+  for (int k0 = 0; k0 < N; k0 += 7) {
+    const int kc = (k0 + 7 < N) ? 7 : N - k0;
+    a5::accumulate_panel_rows(N, row0, rows, kc, &B[static_cast<std::size_t>(k0) * N], &C[0]);
+  }
+  int same = 1;
+  for (int i = 0; i < rows; ++i) {
+    double dot = 0.0;
+    for (int j = 0; j < N; ++j) {
+      dot += C[static_cast<std::size_t>(i) * N + j] * r[j];
+    }
+    same &= (dot == ref[i]) ? 1 : 0;
+  }
+  UnityAssertEqualInt(1, same, "panels change results");
+  a5::set_kernel_config(saved);
+}
+
+/**
+ * @brief A saved tune cache loads back for its host and is refused for another.
+ */
+static void test_tune_cache_roundtrip() {
+  const std::string path = "a5_tune_cache_test.txt";
+  a5::KernelConfig cfg;
+  cfg.block_rows = 32;
+  cfg.block_k = 64;
+  cfg.block_j = 1024;
+  cfg.order = a5::ORDER_KJ;
+  cfg.threads = 3;
+  std::string err;
+  UnityAssertEqualInt(1, a5::save_tune_cache(path, "nodeA", 4, cfg, 12.5, err) ? 1 : 0, "save");
+
+  a5::KernelConfig got;
+  int ranks = 0;
+  double gflops = 0.0;
+  UnityAssertEqualInt(1, a5::load_tune_cache(path, "nodeA", got, ranks, gflops, err) ? 1 : 0, "load");
+  UnityAssertEqualInt(32, got.block_rows, "block_rows");
+  UnityAssertEqualInt(64, got.block_k, "block_k");
+  UnityAssertEqualInt(1024, got.block_j, "block_j");
+  UnityAssertEqualInt(static_cast<int>(a5::ORDER_KJ), static_cast<int>(got.order), "order");
+  UnityAssertEqualInt(3, got.threads, "threads");
+  UnityAssertEqualInt(4, ranks, "ranks");
+  UnityAssertEqualInt(0, a5::load_tune_cache(path, "nodeB", got, ranks, gflops, err) ? 1 : 0,
+                      "other host rejected");
+  std::remove(path.c_str());
+}
+
+/**
+ * @brief Test the spread and imbalance ratio of per-rank times.
+ *
+ * Times {2, 4, 6, 4} ms: avg 4, slowest rank 2, ratio 1.5. Ties keep the
+ * first rank, and all-zero times count as balanced.
+ */
+static void test_spread_of() {
+  std::vector<double> t;
+  t.push_back(0.002);
+  t.push_back(0.004);
+  t.push_back(0.006);
+  t.push_back(0.004);
+  const a5::Spread s = a5::spread_of(t);
+  UnityAssertEqualInt(2000, static_cast<int>(s.min * 1e6 + 0.5), "min");
+  UnityAssertEqualInt(4000, static_cast<int>(s.avg * 1e6 + 0.5), "avg");
+  UnityAssertEqualInt(6000, static_cast<int>(s.max * 1e6 + 0.5), "max");
+  UnityAssertEqualInt(0, s.argmin, "argmin");
+  UnityAssertEqualInt(2, s.argmax, "argmax");
+  UnityAssertEqualInt(1500, static_cast<int>(s.ratio * 1000.0 + 0.5), "ratio");
+  UnityAssertEqualInt(1500, static_cast<int>(a5::imbalance_ratio(0.006, 0.016, 4) * 1000.0 + 0.5),
+                      "ratio from max and sum");
+
+  const a5::Spread zero = a5::spread_of(std::vector<double>(3, 0.0));
+  UnityAssertEqualInt(1000, static_cast<int>(zero.ratio * 1000.0 + 0.5), "zero times balanced");
+  UnityAssertEqualInt(0, zero.argmax, "tie keeps first rank");
+}
+
+/**
+ * @brief The clock offset comes from the ping with the shortest round trip,
+ * and packed events unpack unchanged apart from pid and the offset.
+ */
+static void test_trace_merge() {
+  std::vector<double> send;
+  std::vector<double> remote;
+  std::vector<double> recv;
+  send.push_back(10.0);  // round trip 4: offset 100.5 - 12 = 88.5
+  remote.push_back(100.5);
+  recv.push_back(14.0);
+  send.push_back(20.0);  // round trip 1: offset 110.0 - 20.5 = 89.5
+  remote.push_back(110.0);
+  recv.push_back(21.0);
+  UnityAssertEqualInt(89500, static_cast<int>(a5::clock_offset_from_pings(send, remote, recv) *
+                                              1000.0 + 0.5), "shortest round trip wins");
+  UnityAssertEqualInt(0, static_cast<int>(a5::clock_offset_from_pings(
+                             std::vector<double>(), remote, recv)), "no rounds");
+
+  std::vector<perf::TraceEvent> events(2);
+  events[0].name = "broadcast";
+  events[0].ph = 'B';
+  events[0].ts = 5.0;
+  events[0].tid = 0;
+  events[1].name = "tile";
+  events[1].ph = 'E';
+  events[1].ts = 7.5;
+  events[1].tid = 3;
+  std::vector<double> nums;
+  std::string names;
+  a5::pack_trace(events, nums, names);
+  std::vector<perf::TraceEvent> out;
+  a5::unpack_trace(nums, names, 2, 1.0, out);
+  UnityAssertEqualInt(2, static_cast<int>(out.size()), "event count");
+  UnityAssertEqualInt(1, out[0].name == "broadcast" && out[1].name == "tile", "names");
+  UnityAssertEqualInt('B', out[0].ph, "begin");
+  UnityAssertEqualInt('E', out[1].ph, "end");
+  UnityAssertEqualInt(3, out[1].tid, "tid");
+  UnityAssertEqualInt(2, out[1].pid, "pid is the source rank");
+  UnityAssertEqualInt(6500, static_cast<int>(out[1].ts * 1000.0 + 0.5), "shifted by offset");
+}
+
 int main() {
   UnityBegin("assignment5");
   RUN_TEST(test_row_block_partition_basic, "row_block_partition_basic");
   RUN_TEST(test_owner_of_row, "owner_of_row");
+  RUN_TEST(test_compute_local_rows_corners, "compute_local_rows_corners");
+  RUN_TEST(test_block_cyclic, "block_cyclic");
+  RUN_TEST(test_weighted_partition, "weighted_partition");
+  RUN_TEST(test_adaptive_chunk_rows, "adaptive_chunk_rows");
+  RUN_TEST(test_gemm25d_grid, "gemm25d_grid");
+  RUN_TEST(test_freivalds_detects_error, "freivalds_detects_error");
+  RUN_TEST(test_memory_budget, "memory_budget");
+  RUN_TEST(test_kernel_configs_agree, "kernel_configs_agree");
+  RUN_TEST(test_accumulate_panel_rows, "accumulate_panel_rows");
+  RUN_TEST(test_tune_cache_roundtrip, "tune_cache_roundtrip");
+  RUN_TEST(test_spread_of, "spread_of");
+  RUN_TEST(test_trace_merge, "trace_merge");
   UnityEnd();
   return 0;
 }
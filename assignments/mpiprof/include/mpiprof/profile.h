@@ -0,0 +1,129 @@
+/**
+ * @file profile.h
+ * @brief Per-rank MPI call statistics and the summary printed at MPI_Finalize.
+ *
+ * The PMPI wrappers (wrappers.cpp) intercept the MPI functions the drivers
+ * use: each call is timed and its bytes counted in the calling rank's
+ * RankProfile. Point-to-point sends and one-sided puts and accumulates are
+ * also counted per destination, one-sided gets per target, which gives the
+ * communication matrix. At MPI_Finalize rank 0 gathers every rank's profile and prints:
+ *  - one line per function: calls, bytes and time summed over ranks, the
+ *    slowest rank's time and the share of the run's wall time;
+ *  - the bytes and message matrices, row = sender, column = receiver (the
+ *    heaviest pairs instead for more than kMatrixRanks ranks).
+ *
+ * This file has no MPI dependency, so the statistics and the report are
+ * unit-tested without an MPI run.
+ */
+
+#ifndef MPIPROF_PROFILE_H
+#define MPIPROF_PROFILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace mpiprof {
+
+/// Intercepted functions.
+enum Function {
+  FN_SEND,
+  FN_RECV,
+  FN_ISEND,
+  FN_IRECV,
+  FN_SENDRECV,
+  FN_SENDRECV_REPLACE,
+  FN_WAIT,
+  FN_WAITALL,
+  FN_BARRIER,
+  FN_BCAST,
+  FN_REDUCE,
+  FN_ALLREDUCE,
+  FN_GATHER,
+  FN_GATHERV,
+  FN_SCATTER,
+  FN_ALLGATHER,
+  FN_ALLGATHERV,
+  FN_ALLTOALL,
+  FN_PUT,
+  FN_GET,
+  FN_ACCUMULATE,
+  FN_RGET,
+  FN_FETCH_AND_OP,
+  FN_WIN_FENCE,
+  FN_WIN_POST,
+  FN_WIN_START,
+  FN_WIN_COMPLETE,
+  FN_WIN_WAIT,
+  FN_WIN_LOCK,
+  FN_WIN_UNLOCK,
+  FN_WIN_FLUSH,
+  FN_WIN_LOCK_ALL,
+  FN_WIN_UNLOCK_ALL,
+  FN_COUNT
+};
+
+/// Largest job whose matrices are printed in full.
+const int kMatrixRanks = 16;
+
+/// MPI name of a function, e.g. "MPI_Bcast".
+const char* function_name(int f);
+
+/**
+ * @brief Calls, bytes and time of one function (doubles: no 64-bit ints in C++98).
+ */
+struct Counter {
+  double calls;
+  double bytes;    ///< Bytes passed to the calls on this rank (send or receive buffer)
+  double seconds;  ///< Time inside the calls
+
+  Counter();
+};
+
+/**
+ * @brief Statistics of one rank.
+ */
+struct RankProfile {
+  std::vector<Counter> functions;  ///< Indexed by Function
+  std::vector<double> sent_bytes;  ///< Bytes sent or put to each world rank
+  std::vector<double> sent_msgs;   ///< Messages sent or put to each world rank
+  std::vector<double> got_bytes;   ///< Bytes read one-sidedly from each world rank
+  std::vector<double> got_msgs;    ///< One-sided reads from each world rank
+  double wall_s;                   ///< MPI_Init to MPI_Finalize
+
+  explicit RankProfile(int ranks = 0);
+
+  /// Count one call of f.
+  void record(int f, double bytes, double seconds);
+
+  /// Count a message from this rank to peer (ignored outside [0, ranks)).
+  void record_send(int peer, double bytes);
+
+  /// Count a one-sided read from peer (ignored outside [0, ranks)).
+  void record_get(int peer, double bytes);
+
+  /// Flatten to packed_size(ranks) doubles, for one MPI_Gather.
+  void pack(std::vector<double>& out) const;
+
+  /// Inverse of pack(); false if the size does not match.
+  bool unpack(const double* in, std::size_t n, int ranks);
+
+  /// Length of pack() output for a job of the given size.
+  static std::size_t packed_size(int ranks);
+};
+
+/**
+ * @brief "0", "512", "4.0K", "1.5M", "2.0G" (binary units).
+ */
+std::string format_bytes(double bytes);
+
+/**
+ * @brief The summary of all ranks' profiles (indexed by rank), one line per row.
+ *
+ * Every line starts with "mpiprof: ". Functions never called are left out.
+ */
+std::string format_report(const std::vector<RankProfile>& ranks);
+
+} // namespace mpiprof
+
+#endif
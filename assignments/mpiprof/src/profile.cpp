@@ -0,0 +1,269 @@
+/**
+ * @file profile.cpp
+ * @brief Accumulation, packing and formatting of the MPI profile.
+ */
+
+#include "mpiprof/profile.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <sstream>
+
+namespace mpiprof {
+
+static const char* const kNames[FN_COUNT] = {
+  "MPI_Send", "MPI_Recv", "MPI_Isend", "MPI_Irecv", "MPI_Sendrecv", "MPI_Sendrecv_replace",
+  "MPI_Wait", "MPI_Waitall", "MPI_Barrier", "MPI_Bcast", "MPI_Reduce", "MPI_Allreduce",
+  "MPI_Gather", "MPI_Gatherv", "MPI_Scatter", "MPI_Allgather", "MPI_Allgatherv",
+  "MPI_Alltoall", "MPI_Put", "MPI_Get", "MPI_Accumulate", "MPI_Rget", "MPI_Fetch_and_op",
+  "MPI_Win_fence", "MPI_Win_post", "MPI_Win_start", "MPI_Win_complete", "MPI_Win_wait",
+  "MPI_Win_lock", "MPI_Win_unlock", "MPI_Win_flush", "MPI_Win_lock_all", "MPI_Win_unlock_all"
+};
+
+const char* function_name(int f) {
+  return (f >= 0 && f < FN_COUNT) ? kNames[f] : "?";
+}
+
+Counter::Counter() : calls(0.0), bytes(0.0), seconds(0.0) {}
+
+RankProfile::RankProfile(int ranks)
+    : functions(FN_COUNT),
+      sent_bytes(ranks > 0 ? ranks : 0, 0.0),
+      sent_msgs(ranks > 0 ? ranks : 0, 0.0),
+      got_bytes(ranks > 0 ? ranks : 0, 0.0),
+      got_msgs(ranks > 0 ? ranks : 0, 0.0),
+      wall_s(0.0) {}
+
+void RankProfile::record(int f, double bytes, double seconds) {
+  if (f < 0 || f >= FN_COUNT) {
+    return;
+  }
+  Counter& c = functions[f];
+  c.calls += 1.0;
+  c.bytes += bytes;
+  c.seconds += seconds;
+}
+
+void RankProfile::record_send(int peer, double bytes) {
+  if (peer >= 0 && peer < static_cast<int>(sent_bytes.size())) {
+    sent_bytes[peer] += bytes;
+    sent_msgs[peer] += 1.0;
+  }
+}
+
+void RankProfile::record_get(int peer, double bytes) {
+  if (peer >= 0 && peer < static_cast<int>(got_bytes.size())) {
+    got_bytes[peer] += bytes;
+    got_msgs[peer] += 1.0;
+  }
+}
+
+std::size_t RankProfile::packed_size(int ranks) {
+  return 3 * static_cast<std::size_t>(FN_COUNT) + 1 + 4 * static_cast<std::size_t>(ranks);
+}
+
+void RankProfile::pack(std::vector<double>& out) const {
+  out.clear();
+  for (int f = 0; f < FN_COUNT; ++f) {
+    out.push_back(functions[f].calls);
+    out.push_back(functions[f].bytes);
+    out.push_back(functions[f].seconds);
+  }
+  out.push_back(wall_s);
+  out.insert(out.end(), sent_bytes.begin(), sent_bytes.end());
+  out.insert(out.end(), sent_msgs.begin(), sent_msgs.end());
+  out.insert(out.end(), got_bytes.begin(), got_bytes.end());
+  out.insert(out.end(), got_msgs.begin(), got_msgs.end());
+}
+
+bool RankProfile::unpack(const double* in, std::size_t n, int ranks) {
+  if (ranks < 0 || n != packed_size(ranks)) {
+    return false;
+  }
+  *this = RankProfile(ranks);
+  for (int f = 0; f < FN_COUNT; ++f) {
+    functions[f].calls = *in++;
+    functions[f].bytes = *in++;
+    functions[f].seconds = *in++;
+  }
+  wall_s = *in++;
+  std::vector<double>* parts[4] = {&sent_bytes, &sent_msgs, &got_bytes, &got_msgs};
+  for (int p = 0; p < 4; ++p) {
+    std::copy(in, in + ranks, parts[p]->begin());
+    in += ranks;
+  }
+  return true;
+}
+
+std::string format_bytes(double bytes) {
+  static const char* const kUnits = "KMGTP";
+  char buf[32];
+  if (bytes < 1024.0) {
+    std::sprintf(buf, "%.0f", bytes);
+    return buf;
+  }
+  int u = -1;
+  while (bytes >= 1024.0 && u < 4) {
+    bytes /= 1024.0;
+    ++u;
+  }
+  std::sprintf(buf, "%.1f%c", bytes, kUnits[u]);
+  return buf;
+}
+
+namespace {
+
+struct FunctionTotal {
+  int f;
+  Counter sum;
+  double max_seconds;
+};
+
+bool slower(const FunctionTotal& a, const FunctionTotal& b) {
+  return a.sum.seconds > b.sum.seconds;
+}
+
+struct Pair {
+  int from;
+  int to;
+  double bytes;
+  double msgs;
+};
+
+bool heavier(const Pair& a, const Pair& b) {
+  return a.bytes > b.bytes;
+}
+
+std::string fixed(double v, int precision) {
+  char buf[48];
+  std::sprintf(buf, "%.*f", precision, v);
+  return buf;
+}
+
+std::string pad(const std::string& s, std::size_t width) {
+  return (s.size() >= width) ? s : std::string(width - s.size(), ' ') + s;
+}
+
+// One matrix, row = sender; bytes or message counts
+void format_matrix(std::ostringstream& oss, const std::vector<std::vector<double> >& m,
+                   bool bytes) {
+  const int P = static_cast<int>(m.size());
+  oss << "mpiprof: " << pad("", 6);
+  for (int j = 0; j < P; ++j) {
+    std::ostringstream h;
+    h << "r" << j;
+    oss << pad(h.str(), 8);
+  }
+  oss << "\n";
+  for (int i = 0; i < P; ++i) {
+    std::ostringstream h;
+    h << "r" << i;
+    oss << "mpiprof: " << pad(h.str(), 6);
+    for (int j = 0; j < P; ++j) {
+      oss << pad(bytes ? format_bytes(m[i][j]) : fixed(m[i][j], 0), 8);
+    }
+    oss << "\n";
+  }
+}
+
+} // namespace
+
+std::string format_report(const std::vector<RankProfile>& ranks) {
+  const int P = static_cast<int>(ranks.size());
+  std::ostringstream oss;
+  double wall_sum = 0.0;
+  double wall_max = 0.0;
+  double mpi_sum = 0.0;
+  std::vector<FunctionTotal> totals;
+  for (int f = 0; f < FN_COUNT; ++f) {
+    FunctionTotal t;
+    t.f = f;
+    t.max_seconds = 0.0;
+    for (int r = 0; r < P; ++r) {
+      const Counter& c = ranks[r].functions[f];
+      t.sum.calls += c.calls;
+      t.sum.bytes += c.bytes;
+      t.sum.seconds += c.seconds;
+      t.max_seconds = std::max(t.max_seconds, c.seconds);
+    }
+    mpi_sum += t.sum.seconds;
+    if (t.sum.calls > 0.0) {
+      totals.push_back(t);
+    }
+  }
+  for (int r = 0; r < P; ++r) {
+    wall_sum += ranks[r].wall_s;
+    wall_max = std::max(wall_max, ranks[r].wall_s);
+  }
+  std::stable_sort(totals.begin(), totals.end(), slower);
+
+  const double pct = (wall_sum > 0.0) ? 100.0 / wall_sum : 0.0;
+  oss << "mpiprof: ranks=" << P << " wall_s=" << fixed(wall_max, 3)
+      << " mpi_s=" << fixed(mpi_sum, 3) << " (summed over ranks) mpi_pct="
+      << fixed(mpi_sum * pct, 1) << "%\n";
+  std::string header = "function";
+  header.resize(21, ' ');
+  oss << "mpiprof: " << header << pad("calls", 10)
+      << pad("bytes", 10) << pad("time_s", 11) << pad("max_rank_s", 11) << pad("wall%", 8) << "\n";
+  for (std::size_t i = 0; i < totals.size(); ++i) {
+    const FunctionTotal& t = totals[i];
+    std::string name = function_name(t.f);
+    name.resize(21, ' ');
+    oss << "mpiprof: " << name << pad(fixed(t.sum.calls, 0), 10)
+        << pad(format_bytes(t.sum.bytes), 10) << pad(fixed(t.sum.seconds, 6), 11)
+        << pad(fixed(t.max_seconds, 6), 11) << pad(fixed(t.sum.seconds * pct, 1), 8) << "\n";
+  }
+
+  // Sender x receiver: sends and puts by the sender, gets by the reader
+  std::vector<std::vector<double> > bytes(P, std::vector<double>(P, 0.0));
+  std::vector<std::vector<double> > msgs(P, std::vector<double>(P, 0.0));
+  bool any = false;
+  for (int i = 0; i < P; ++i) {
+    for (int j = 0; j < P && j < static_cast<int>(ranks[i].sent_bytes.size()); ++j) {
+      bytes[i][j] += ranks[i].sent_bytes[j];
+      msgs[i][j] += ranks[i].sent_msgs[j];
+      bytes[j][i] += ranks[i].got_bytes[j];
+      msgs[j][i] += ranks[i].got_msgs[j];
+    }
+  }
+  for (int i = 0; i < P && !any; ++i) {
+    for (int j = 0; j < P; ++j) {
+      any = any || msgs[i][j] > 0.0;
+    }
+  }
+  if (!any) {
+    oss << "mpiprof: no point-to-point or one-sided messages\n";
+  } else if (P <= kMatrixRanks) {
+    oss << "mpiprof: point-to-point and one-sided bytes (row = sender, column = receiver)\n";
+    format_matrix(oss, bytes, true);
+    oss << "mpiprof: messages (row = sender, column = receiver)\n";
+    format_matrix(oss, msgs, false);
+  } else {
+    std::vector<Pair> pairs;
+    for (int i = 0; i < P; ++i) {
+      for (int j = 0; j < P; ++j) {
+        if (msgs[i][j] > 0.0) {
+          Pair p;
+          p.from = i;
+          p.to = j;
+          p.bytes = bytes[i][j];
+          p.msgs = msgs[i][j];
+          pairs.push_back(p);
+        }
+      }
+    }
+    std::stable_sort(pairs.begin(), pairs.end(), heavier);
+    const std::size_t shown = std::min(pairs.size(), static_cast<std::size_t>(kMatrixRanks));
+    oss << "mpiprof: heaviest " << shown << " of " << pairs.size()
+        << " sender->receiver pairs (point-to-point and one-sided)\n";
+    for (std::size_t k = 0; k < shown; ++k) {
+      oss << "mpiprof: r" << pairs[k].from << " -> r" << pairs[k].to
+          << " bytes=" << format_bytes(pairs[k].bytes) << " msgs=" << fixed(pairs[k].msgs, 0)
+          << "\n";
+    }
+  }
+  return oss.str();
+}
+
+} // namespace mpiprof
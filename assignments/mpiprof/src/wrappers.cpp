@@ -0,0 +1,481 @@
+/**
+ * @file wrappers.cpp
+ * @brief PMPI wrappers: time and count each call, then forward to PMPI_*.
+ *
+ * MPI libraries export every MPI_X as a weak alias of PMPI_X. Loaded first
+ * (LD_PRELOAD) or linked before the MPI library, these definitions replace
+ * the MPI_X entry points of an unmodified program. Each wrapper reads the
+ * clock, calls PMPI_X and records time, bytes and, for point-to-point and
+ * one-sided calls, the peer as a rank of MPI_COMM_WORLD.
+ *
+ * The counters are plain globals: like the drivers, this assumes only one
+ * thread per process calls MPI (MPI_THREAD_FUNNELED or below).
+ */
+
+// C bindings only: the library must not pull in the MPI C++ bindings
+#ifndef OMPI_SKIP_MPICXX
+#define OMPI_SKIP_MPICXX 1
+#endif
+#ifndef MPICH_SKIP_MPICXX
+#define MPICH_SKIP_MPICXX 1
+#endif
+#include <mpi.h>
+
+#include "mpiprof/profile.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// MPI-3 made input buffers const; the wrappers must match the header's prototypes
+#if defined(MPI_VERSION) && MPI_VERSION >= 3
+#define MPIPROF_CONST const
+#define MPIPROF_HAVE_MPI3 1
+#else
+#define MPIPROF_CONST
+#define MPIPROF_HAVE_MPI3 0
+#endif
+
+namespace {
+
+mpiprof::RankProfile g_profile;
+double g_t0 = 0.0;
+bool g_active = false;
+
+double type_bytes(MPI_Datatype type, int count) {
+  int size = 0;
+  if (count <= 0 || PMPI_Type_size(type, &size) != MPI_SUCCESS) {
+    return 0.0;
+  }
+  return static_cast<double>(size) * static_cast<double>(count);
+}
+
+// World rank of a rank in group g (-1 for MPI_PROC_NULL, MPI_ANY_SOURCE, ...)
+int translate(MPI_Group g, int rank) {
+  MPI_Group world;
+  PMPI_Comm_group(MPI_COMM_WORLD, &world);
+  int out = MPI_UNDEFINED;
+  PMPI_Group_translate_ranks(g, 1, &rank, world, &out);
+  PMPI_Group_free(&world);
+  return (out == MPI_UNDEFINED) ? -1 : out;
+}
+
+int world_rank(MPI_Comm comm, int rank) {
+  if (rank < 0) {
+    return -1;
+  }
+  if (comm == MPI_COMM_WORLD) {
+    return rank;
+  }
+  MPI_Group g;
+  PMPI_Comm_group(comm, &g);
+  const int out = translate(g, rank);
+  PMPI_Group_free(&g);
+  return out;
+}
+
+int window_rank(MPI_Win win, int rank) {
+  if (rank < 0) {
+    return -1;
+  }
+  MPI_Group g;
+  PMPI_Win_get_group(win, &g);
+  const int out = translate(g, rank);
+  PMPI_Group_free(&g);
+  return out;
+}
+
+double received_bytes(MPI_Status* status, MPI_Datatype type) {
+  int count = 0;
+  if (PMPI_Get_count(status, type, &count) != MPI_SUCCESS || count == MPI_UNDEFINED) {
+    return 0.0;
+  }
+  return type_bytes(type, count);
+}
+
+void record(int f, double t0, double bytes) {
+  if (g_active) {
+    g_profile.record(f, bytes, PMPI_Wtime() - t0);
+  }
+}
+
+// Message-matrix counterparts of record(): nothing, not even the rank
+// translation, runs outside MPI_Init .. MPI_Finalize
+void record_send(MPI_Comm comm, int dest, double bytes) {
+  if (g_active) {
+    g_profile.record_send(world_rank(comm, dest), bytes);
+  }
+}
+
+void record_put(MPI_Win win, int target, double bytes) {
+  if (g_active) {
+    g_profile.record_send(window_rank(win, target), bytes);
+  }
+}
+
+void record_get(MPI_Win win, int target, double bytes) {
+  if (g_active) {
+    g_profile.record_get(window_rank(win, target), bytes);
+  }
+}
+
+void start() {
+  int size = 1;
+  PMPI_Comm_size(MPI_COMM_WORLD, &size);
+  g_profile = mpiprof::RankProfile(size);
+  g_t0 = PMPI_Wtime();
+  g_active = true;
+}
+
+// Gather every rank's profile to rank 0 and print the summary there
+void report() {
+  g_active = false;
+  g_profile.wall_s = PMPI_Wtime() - g_t0;
+  int rank = 0;
+  int size = 1;
+  PMPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  PMPI_Comm_size(MPI_COMM_WORLD, &size);
+  std::vector<double> mine;
+  g_profile.pack(mine);
+  const std::size_t n = mine.size();
+  std::vector<double> all(rank == 0 ? n * static_cast<std::size_t>(size) : 1);
+  PMPI_Gather(&mine[0], static_cast<int>(n), MPI_DOUBLE, &all[0], static_cast<int>(n),
+              MPI_DOUBLE, 0, MPI_COMM_WORLD);
+  if (rank != 0) {
+    return;
+  }
+  std::vector<mpiprof::RankProfile> ranks(size);
+  for (int r = 0; r < size; ++r) {
+    ranks[r].unpack(&all[static_cast<std::size_t>(r) * n], n, size);
+  }
+  const std::string text = mpiprof::format_report(ranks);
+  const char* path = std::getenv("MPIPROF_OUTPUT");
+  std::FILE* out = (path && *path) ? std::fopen(path, "w") : 0;
+  std::fputs(text.c_str(), out ? out : stderr);
+  if (out) {
+    std::fclose(out);
+  }
+}
+
+} // namespace
+
+extern "C" {
+
+int MPI_Init(int* argc, char*** argv) {
+  const int rc = PMPI_Init(argc, argv);
+  start();
+  return rc;
+}
+
+int MPI_Init_thread(int* argc, char*** argv, int required, int* provided) {
+  const int rc = PMPI_Init_thread(argc, argv, required, provided);
+  start();
+  return rc;
+}
+
+int MPI_Finalize(void) {
+  if (g_active) {
+    report();
+  }
+  return PMPI_Finalize();
+}
+
+// Point-to-point
+
+int MPI_Send(MPIPROF_CONST void* buf, int count, MPI_Datatype type, int dest, int tag,
+             MPI_Comm comm) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Send(buf, count, type, dest, tag, comm);
+  const double bytes = type_bytes(type, count);
+  record(mpiprof::FN_SEND, t0, bytes);
+  record_send(comm, dest, bytes);
+  return rc;
+}
+
+int MPI_Recv(void* buf, int count, MPI_Datatype type, int source, int tag, MPI_Comm comm,
+             MPI_Status* status) {
+  MPI_Status local;
+  MPI_Status* st = (status == MPI_STATUS_IGNORE) ? &local : status;
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Recv(buf, count, type, source, tag, comm, st);
+  record(mpiprof::FN_RECV, t0, received_bytes(st, type));
+  return rc;
+}
+
+int MPI_Isend(MPIPROF_CONST void* buf, int count, MPI_Datatype type, int dest, int tag,
+              MPI_Comm comm, MPI_Request* request) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Isend(buf, count, type, dest, tag, comm, request);
+  const double bytes = type_bytes(type, count);
+  record(mpiprof::FN_ISEND, t0, bytes);
+  record_send(comm, dest, bytes);
+  return rc;
+}
+
+// Bytes are the posted buffer size: the matched length is only known at completion
+int MPI_Irecv(void* buf, int count, MPI_Datatype type, int source, int tag, MPI_Comm comm,
+              MPI_Request* request) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Irecv(buf, count, type, source, tag, comm, request);
+  record(mpiprof::FN_IRECV, t0, type_bytes(type, count));
+  return rc;
+}
+
+int MPI_Sendrecv(MPIPROF_CONST void* sendbuf, int sendcount, MPI_Datatype sendtype, int dest,
+                 int sendtag, void* recvbuf, int recvcount, MPI_Datatype recvtype, int source,
+                 int recvtag, MPI_Comm comm, MPI_Status* status) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Sendrecv(sendbuf, sendcount, sendtype, dest, sendtag, recvbuf, recvcount,
+                               recvtype, source, recvtag, comm, status);
+  const double bytes = type_bytes(sendtype, sendcount);
+  record(mpiprof::FN_SENDRECV, t0, bytes);
+  record_send(comm, dest, bytes);
+  return rc;
+}
+
+int MPI_Sendrecv_replace(void* buf, int count, MPI_Datatype type, int dest, int sendtag,
+                         int source, int recvtag, MPI_Comm comm, MPI_Status* status) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Sendrecv_replace(buf, count, type, dest, sendtag, source, recvtag, comm,
+                                       status);
+  const double bytes = type_bytes(type, count);
+  record(mpiprof::FN_SENDRECV_REPLACE, t0, bytes);
+  record_send(comm, dest, bytes);
+  return rc;
+}
+
+int MPI_Wait(MPI_Request* request, MPI_Status* status) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Wait(request, status);
+  record(mpiprof::FN_WAIT, t0, 0.0);
+  return rc;
+}
+
+int MPI_Waitall(int count, MPI_Request requests[], MPI_Status statuses[]) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Waitall(count, requests, statuses);
+  record(mpiprof::FN_WAITALL, t0, 0.0);
+  return rc;
+}
+
+// Collectives: bytes are this rank's contribution (or, for MPI_Bcast and
+// MPI_Scatter, what it holds afterwards)
+
+int MPI_Barrier(MPI_Comm comm) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Barrier(comm);
+  record(mpiprof::FN_BARRIER, t0, 0.0);
+  return rc;
+}
+
+int MPI_Bcast(void* buf, int count, MPI_Datatype type, int root, MPI_Comm comm) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Bcast(buf, count, type, root, comm);
+  record(mpiprof::FN_BCAST, t0, type_bytes(type, count));
+  return rc;
+}
+
+int MPI_Reduce(MPIPROF_CONST void* sendbuf, void* recvbuf, int count, MPI_Datatype type,
+               MPI_Op op, int root, MPI_Comm comm) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Reduce(sendbuf, recvbuf, count, type, op, root, comm);
+  record(mpiprof::FN_REDUCE, t0, type_bytes(type, count));
+  return rc;
+}
+
+int MPI_Allreduce(MPIPROF_CONST void* sendbuf, void* recvbuf, int count, MPI_Datatype type,
+                  MPI_Op op, MPI_Comm comm) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Allreduce(sendbuf, recvbuf, count, type, op, comm);
+  record(mpiprof::FN_ALLREDUCE, t0, type_bytes(type, count));
+  return rc;
+}
+
+int MPI_Gather(MPIPROF_CONST void* sendbuf, int sendcount, MPI_Datatype sendtype, void* recvbuf,
+               int recvcount, MPI_Datatype recvtype, int root, MPI_Comm comm) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Gather(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, root,
+                             comm);
+  record(mpiprof::FN_GATHER, t0, type_bytes(sendtype, sendcount));
+  return rc;
+}
+
+int MPI_Gatherv(MPIPROF_CONST void* sendbuf, int sendcount, MPI_Datatype sendtype, void* recvbuf,
+                MPIPROF_CONST int recvcounts[], MPIPROF_CONST int displs[], MPI_Datatype recvtype,
+                int root, MPI_Comm comm) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Gatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs,
+                              recvtype, root, comm);
+  record(mpiprof::FN_GATHERV, t0, type_bytes(sendtype, sendcount));
+  return rc;
+}
+
+int MPI_Scatter(MPIPROF_CONST void* sendbuf, int sendcount, MPI_Datatype sendtype, void* recvbuf,
+                int recvcount, MPI_Datatype recvtype, int root, MPI_Comm comm) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Scatter(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, root,
+                              comm);
+  record(mpiprof::FN_SCATTER, t0, type_bytes(recvtype, recvcount));
+  return rc;
+}
+
+int MPI_Allgather(MPIPROF_CONST void* sendbuf, int sendcount, MPI_Datatype sendtype,
+                  void* recvbuf, int recvcount, MPI_Datatype recvtype, MPI_Comm comm) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Allgather(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm);
+  record(mpiprof::FN_ALLGATHER, t0, type_bytes(sendtype, sendcount));
+  return rc;
+}
+
+int MPI_Allgatherv(MPIPROF_CONST void* sendbuf, int sendcount, MPI_Datatype sendtype,
+                   void* recvbuf, MPIPROF_CONST int recvcounts[], MPIPROF_CONST int displs[],
+                   MPI_Datatype recvtype, MPI_Comm comm) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Allgatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs,
+                                 recvtype, comm);
+  record(mpiprof::FN_ALLGATHERV, t0, type_bytes(sendtype, sendcount));
+  return rc;
+}
+
+int MPI_Alltoall(MPIPROF_CONST void* sendbuf, int sendcount, MPI_Datatype sendtype,
+                 void* recvbuf, int recvcount, MPI_Datatype recvtype, MPI_Comm comm) {
+  int size = 1;
+  PMPI_Comm_size(comm, &size);
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Alltoall(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm);
+  record(mpiprof::FN_ALLTOALL, t0, type_bytes(sendtype, sendcount) * size);
+  return rc;
+}
+
+// One-sided
+
+int MPI_Put(MPIPROF_CONST void* origin, int origin_count, MPI_Datatype origin_type, int target,
+            MPI_Aint target_disp, int target_count, MPI_Datatype target_type, MPI_Win win) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Put(origin, origin_count, origin_type, target, target_disp, target_count,
+                          target_type, win);
+  const double bytes = type_bytes(origin_type, origin_count);
+  record(mpiprof::FN_PUT, t0, bytes);
+  record_put(win, target, bytes);
+  return rc;
+}
+
+int MPI_Get(void* origin, int origin_count, MPI_Datatype origin_type, int target,
+            MPI_Aint target_disp, int target_count, MPI_Datatype target_type, MPI_Win win) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Get(origin, origin_count, origin_type, target, target_disp, target_count,
+                          target_type, win);
+  const double bytes = type_bytes(origin_type, origin_count);
+  record(mpiprof::FN_GET, t0, bytes);
+  record_get(win, target, bytes);
+  return rc;
+}
+
+int MPI_Accumulate(MPIPROF_CONST void* origin, int origin_count, MPI_Datatype origin_type,
+                   int target, MPI_Aint target_disp, int target_count, MPI_Datatype target_type,
+                   MPI_Op op, MPI_Win win) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Accumulate(origin, origin_count, origin_type, target, target_disp,
+                                 target_count, target_type, op, win);
+  const double bytes = type_bytes(origin_type, origin_count);
+  record(mpiprof::FN_ACCUMULATE, t0, bytes);
+  record_put(win, target, bytes);
+  return rc;
+}
+
+int MPI_Win_fence(int assert_flags, MPI_Win win) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Win_fence(assert_flags, win);
+  record(mpiprof::FN_WIN_FENCE, t0, 0.0);
+  return rc;
+}
+
+int MPI_Win_post(MPI_Group group, int assert_flags, MPI_Win win) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Win_post(group, assert_flags, win);
+  record(mpiprof::FN_WIN_POST, t0, 0.0);
+  return rc;
+}
+
+int MPI_Win_start(MPI_Group group, int assert_flags, MPI_Win win) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Win_start(group, assert_flags, win);
+  record(mpiprof::FN_WIN_START, t0, 0.0);
+  return rc;
+}
+
+int MPI_Win_complete(MPI_Win win) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Win_complete(win);
+  record(mpiprof::FN_WIN_COMPLETE, t0, 0.0);
+  return rc;
+}
+
+int MPI_Win_wait(MPI_Win win) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Win_wait(win);
+  record(mpiprof::FN_WIN_WAIT, t0, 0.0);
+  return rc;
+}
+
+int MPI_Win_lock(int lock_type, int rank, int assert_flags, MPI_Win win) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Win_lock(lock_type, rank, assert_flags, win);
+  record(mpiprof::FN_WIN_LOCK, t0, 0.0);
+  return rc;
+}
+
+int MPI_Win_unlock(int rank, MPI_Win win) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Win_unlock(rank, win);
+  record(mpiprof::FN_WIN_UNLOCK, t0, 0.0);
+  return rc;
+}
+
+#if MPIPROF_HAVE_MPI3
+int MPI_Rget(void* origin, int origin_count, MPI_Datatype origin_type, int target,
+             MPI_Aint target_disp, int target_count, MPI_Datatype target_type, MPI_Win win,
+             MPI_Request* request) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Rget(origin, origin_count, origin_type, target, target_disp, target_count,
+                           target_type, win, request);
+  const double bytes = type_bytes(origin_type, origin_count);
+  record(mpiprof::FN_RGET, t0, bytes);
+  record_get(win, target, bytes);
+  return rc;
+}
+
+int MPI_Fetch_and_op(const void* origin, void* result, MPI_Datatype type, int target,
+                     MPI_Aint target_disp, MPI_Op op, MPI_Win win) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Fetch_and_op(origin, result, type, target, target_disp, op, win);
+  const double bytes = type_bytes(type, 1);
+  record(mpiprof::FN_FETCH_AND_OP, t0, bytes);
+  record_get(win, target, bytes);
+  return rc;
+}
+
+int MPI_Win_flush(int rank, MPI_Win win) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Win_flush(rank, win);
+  record(mpiprof::FN_WIN_FLUSH, t0, 0.0);
+  return rc;
+}
+
+int MPI_Win_lock_all(int assert_flags, MPI_Win win) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Win_lock_all(assert_flags, win);
+  record(mpiprof::FN_WIN_LOCK_ALL, t0, 0.0);
+  return rc;
+}
+
+int MPI_Win_unlock_all(MPI_Win win) {
+  const double t0 = PMPI_Wtime();
+  const int rc = PMPI_Win_unlock_all(win);
+  record(mpiprof::FN_WIN_UNLOCK_ALL, t0, 0.0);
+  return rc;
+}
+#endif
+
+} // extern "C"
@@ -0,0 +1,123 @@
+// unit_tests.cpp: Unity-based tests for the MPI profile statistics and report.
+#include "mpiprof/profile.h"
+
+extern "C" {
+#include "vendor/unity/unity.h"
+}
+
+#include <string>
+#include <vector>
+
+// Calls accumulate per function; peers outside the job are ignored.
+static void test_record(void)
+{
+    mpiprof::RankProfile p(2);
+    p.record(mpiprof::FN_BCAST, 800.0, 0.5);
+    p.record(mpiprof::FN_BCAST, 800.0, 0.25);
+    p.record(mpiprof::FN_COUNT, 1.0, 1.0);
+    p.record_send(1, 64.0);
+    p.record_send(2, 64.0);
+    p.record_send(-1, 64.0);
+    p.record_get(0, 8.0);
+    TEST_ASSERT_TRUE(p.functions[mpiprof::FN_BCAST].calls == 2.0);
+    TEST_ASSERT_TRUE(p.functions[mpiprof::FN_BCAST].bytes == 1600.0);
+    TEST_ASSERT_TRUE(p.functions[mpiprof::FN_BCAST].seconds == 0.75);
+    TEST_ASSERT_TRUE(p.sent_bytes[1] == 64.0 && p.sent_msgs[1] == 1.0);
+    TEST_ASSERT_TRUE(p.sent_bytes[0] == 0.0);
+    TEST_ASSERT_TRUE(p.got_bytes[0] == 8.0 && p.got_msgs[0] == 1.0);
+    TEST_ASSERT_TRUE(std::string(mpiprof::function_name(mpiprof::FN_BCAST)) == "MPI_Bcast");
+    TEST_ASSERT_TRUE(std::string(mpiprof::function_name(mpiprof::FN_ACCUMULATE)) == "MPI_Accumulate");
+    TEST_ASSERT_TRUE(std::string(mpiprof::function_name(mpiprof::FN_WIN_UNLOCK)) == "MPI_Win_unlock");
+    TEST_ASSERT_TRUE(std::string(mpiprof::function_name(mpiprof::FN_WIN_UNLOCK_ALL)) ==
+                     "MPI_Win_unlock_all");
+}
+
+// A packed profile unpacks unchanged; a wrong length is rejected.
+static void test_pack_roundtrip(void)
+{
+    mpiprof::RankProfile p(3);
+    p.record(mpiprof::FN_SEND, 1024.0, 0.125);
+    p.record_send(2, 1024.0);
+    p.record_get(1, 16.0);
+    p.wall_s = 2.5;
+    std::vector<double> packed;
+    p.pack(packed);
+    TEST_ASSERT_TRUE(packed.size() == mpiprof::RankProfile::packed_size(3));
+
+    mpiprof::RankProfile q;
+    TEST_ASSERT_TRUE(!q.unpack(&packed[0], packed.size() - 1, 3));
+    TEST_ASSERT_TRUE(q.unpack(&packed[0], packed.size(), 3));
+    TEST_ASSERT_TRUE(q.functions[mpiprof::FN_SEND].bytes == 1024.0);
+    TEST_ASSERT_TRUE(q.functions[mpiprof::FN_SEND].seconds == 0.125);
+    TEST_ASSERT_TRUE(q.sent_bytes[2] == 1024.0 && q.sent_msgs[2] == 1.0);
+    TEST_ASSERT_TRUE(q.got_bytes[1] == 16.0);
+    TEST_ASSERT_TRUE(q.wall_s == 2.5);
+}
+
+static void test_format_bytes(void)
+{
+    TEST_ASSERT_TRUE(mpiprof::format_bytes(0.0) == "0");
+    TEST_ASSERT_TRUE(mpiprof::format_bytes(512.0) == "512");
+    TEST_ASSERT_TRUE(mpiprof::format_bytes(4096.0) == "4.0K");
+    TEST_ASSERT_TRUE(mpiprof::format_bytes(1.5 * 1024.0 * 1024.0) == "1.5M");
+}
+
+// Two ranks ping-ponging: functions sorted by time with their share of the
+// wall time, and a matrix where a get counts as target -> reader.
+static void test_report(void)
+{
+    std::vector<mpiprof::RankProfile> ranks(2, mpiprof::RankProfile(2));
+    ranks[0].wall_s = 2.0;
+    ranks[1].wall_s = 2.0;
+    ranks[0].record(mpiprof::FN_SEND, 1024.0, 0.1);
+    ranks[0].record_send(1, 1024.0);
+    ranks[1].record(mpiprof::FN_RECV, 1024.0, 0.3);
+    ranks[1].record(mpiprof::FN_BARRIER, 0.0, 1.0);
+    ranks[1].record(mpiprof::FN_GET, 2048.0, 0.2);
+    ranks[1].record_get(0, 2048.0);
+
+    const std::string r = mpiprof::format_report(ranks);
+    TEST_ASSERT_TRUE(r.find("mpiprof: ranks=2 wall_s=2.000 mpi_s=1.600") != std::string::npos);
+    TEST_ASSERT_TRUE(r.find("mpi_pct=40.0%") != std::string::npos);
+    const std::size_t barrier = r.find("mpiprof: MPI_Barrier ");
+    const std::size_t recv = r.find("mpiprof: MPI_Recv ");
+    TEST_ASSERT_TRUE(barrier != std::string::npos && recv != std::string::npos && barrier < recv);
+    TEST_ASSERT_TRUE(r.find("1.000000   1.000000    25.0") != std::string::npos);
+    TEST_ASSERT_TRUE(r.find("MPI_Bcast") == std::string::npos);
+    // Row r0: nothing to itself, 1 KiB sent plus 2 KiB read by r1
+    TEST_ASSERT_TRUE(r.find("mpiprof:     r0       0    3.0K\n") != std::string::npos);
+    TEST_ASSERT_TRUE(r.find("mpiprof:     r0       0       2\n") != std::string::npos);
+
+    std::vector<mpiprof::RankProfile> quiet(2, mpiprof::RankProfile(2));
+    quiet[0].record(mpiprof::FN_BARRIER, 0.0, 0.1);
+    TEST_ASSERT_TRUE(mpiprof::format_report(quiet).find("no point-to-point") != std::string::npos);
+}
+
+// Beyond kMatrixRanks ranks only the heaviest pairs are listed.
+static void test_report_large_job(void)
+{
+    const int P = mpiprof::kMatrixRanks + 4;
+    std::vector<mpiprof::RankProfile> ranks(P, mpiprof::RankProfile(P));
+    for (int r = 0; r < P; ++r)
+    {
+        ranks[r].record(mpiprof::FN_SEND, 8.0 * (r + 1), 0.01);
+        ranks[r].record_send((r + 1) % P, 8.0 * (r + 1));
+    }
+    const std::string rep = mpiprof::format_report(ranks);
+    TEST_ASSERT_TRUE(rep.find("heaviest 16 of 20 sender->receiver pairs") != std::string::npos);
+    TEST_ASSERT_TRUE(rep.find("mpiprof: r19 -> r0 bytes=160 msgs=1\n") != std::string::npos);
+    TEST_ASSERT_TRUE(rep.find("r0 -> r1 ") == std::string::npos);
+}
+
+int main(void)
+{
+    UnityBegin("mpiprof");
+
+    RUN_TEST(test_record);
+    RUN_TEST(test_pack_roundtrip);
+    RUN_TEST(test_format_bytes);
+    RUN_TEST(test_report);
+    RUN_TEST(test_report_large_job);
+
+    return UnityEnd();
+}
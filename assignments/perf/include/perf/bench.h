@@ -0,0 +1,183 @@
+/**
+ * @file bench.h
+ * @brief Benchmark harness shared by the drivers: clock, repetitions, statistics.
+ *
+ * A single timed run says little: the first run pays for page faults and
+ * cold caches, and any run can be hit by the OS or a noisy neighbour. The
+ * harness runs a kernel `warmup` times untimed, then `reps` times timed on a
+ * monotonic wall clock, drops outliers and summarizes the rest:
+ * @code
+ *   perf::Sampler s(cfg);
+ *   while (s.next()) {
+ *     kernel();
+ *   }
+ *   const perf::Stats st = s.stats();
+ * @endcode
+ * Outliers are samples further than `outlier_k` scaled median absolute
+ * deviations (MAD x 1.4826, a robust standard deviation) from the median.
+ * The 95% confidence interval of the mean uses Student's t.
+ *
+ * Results can be written as JSON (one document per run) or appended as CSV
+ * rows (one row per result, so a file collects a history of runs).
+ */
+
+#ifndef PERF_BENCH_H
+#define PERF_BENCH_H
+
+#include <string>
+#include <vector>
+
+namespace perf {
+
+/**
+ * @brief Seconds on a monotonic high-resolution clock.
+ *
+ * CLOCK_MONOTONIC on POSIX, QueryPerformanceCounter on Windows. Unlike
+ * std::clock() this is wall time, so threaded kernels are not overcounted,
+ * and unlike gettimeofday() it never jumps when the system time is set.
+ */
+double now_seconds();
+
+/**
+ * @brief Current UTC time as ISO 8601, e.g. "2024-05-01T12:00:00Z".
+ */
+std::string utc_timestamp();
+
+/**
+ * @brief s as a quoted JSON string: quotes and backslashes escaped,
+ *        control characters as \u00XX. Shared by the report and trace
+ *        writers.
+ */
+std::string json_string(const std::string& s);
+
+/**
+ * @brief Harness settings, filled from the command line by parse_bench_option().
+ */
+struct BenchConfig {
+  int warmup;             ///< Untimed runs before measuring
+  int reps;               ///< Timed runs
+  double outlier_k;       ///< Drop samples beyond k scaled MADs of the median (0 = keep all)
+  std::string json_path;  ///< Write results as JSON here (empty = no file)
+  std::string csv_path;   ///< Append results as CSV rows here (empty = no file)
+  std::string log_path;   ///< Asynchronous log file, one per rank (empty = none; see log.h)
+
+  BenchConfig();
+};
+
+/**
+ * @brief Usage text of the harness options, for the drivers' usage lines.
+ */
+const char* bench_usage();
+
+/**
+ * @brief Parse the harness option at argv[i], if it is one.
+ *
+ * Options: --warmup W, --reps R, --outlier-k K, --json FILE, --csv FILE, --log FILE.
+ *
+ * @param argc Argument count
+ * @param argv Argument vector
+ * @param i    Index of the option; advanced past its value when consumed
+ * @param cfg  Settings to update
+ * @param err  Reason when the option's value is missing or invalid
+ * @return 1 if consumed, 0 if argv[i] is not a harness option, -1 on error
+ */
+int parse_bench_option(int argc, char** argv, int& i, BenchConfig& cfg, std::string& err);
+
+/**
+ * @brief Summary of a set of timings (seconds).
+ */
+struct Stats {
+  int samples;    ///< Timed runs
+  int kept;       ///< Runs left after dropping outliers
+  int outliers;   ///< Runs dropped
+  double min;     ///< Fastest kept run
+  double max;     ///< Slowest kept run
+  double median;  ///< Median of kept runs
+  double mean;    ///< Mean of kept runs
+  double stddev;  ///< Sample standard deviation of kept runs
+  double ci95;    ///< Half-width of the 95% confidence interval of the mean
+
+  Stats();
+};
+
+/**
+ * @brief Summarize timings, dropping outliers first.
+ *
+ * @param samples   Timings in seconds
+ * @param outlier_k Outlier threshold in scaled MADs (<= 0 keeps all)
+ */
+Stats summarize(const std::vector<double>& samples, double outlier_k);
+
+/**
+ * @brief One log line, e.g. "bench: reps=5 kept=5 outliers=0 min_ms=... median_ms=...
+ *        mean_ms=... max_ms=... stddev_ms=... ci95_ms=...".
+ */
+std::string format_stats(const Stats& s);
+
+/**
+ * @brief Drives warm-up and timed runs of a kernel (see the file comment).
+ */
+class Sampler {
+ public:
+  explicit Sampler(const BenchConfig& cfg);
+
+  /**
+   * @brief Finish the current run and start the next one.
+   *
+   * A finished timed run is logged at LOG_DEBUG (log file only, see log.h).
+   * @return false once all warm-up and timed runs are done
+   */
+  bool next();
+
+  /// Whether the run in progress is a warm-up run.
+  bool warming_up() const;
+
+  /// Timings of the completed timed runs, in seconds.
+  const std::vector<double>& samples() const;
+
+  /// summarize(samples(), outlier_k).
+  Stats stats() const;
+
+ private:
+  int warmup_;
+  int reps_;
+  double outlier_k_;
+  int run_;  ///< Runs started so far
+  double start_;
+  std::vector<double> samples_;
+};
+
+/**
+ * @brief Results of one driver run, written as JSON and/or CSV.
+ *
+ * Parameters are a "key=value key=value" string, as in the log lines.
+ * The CSV columns are the same for every driver:
+ * benchmark,host,timestamp,params,samples,kept,outliers,min_s,median_s,mean_s,max_s,stddev_s,ci95_s
+ */
+class BenchReport {
+ public:
+  explicit BenchReport(const std::string& benchmark);
+
+  /// Add a result (e.g. one message size of a sweep).
+  void add(const std::string& params, const std::vector<double>& samples, const Stats& s);
+
+  /**
+   * @brief Write to cfg.json_path and append to cfg.csv_path (each if set).
+   * @return false (with err) if a file cannot be written
+   */
+  bool write(const BenchConfig& cfg, std::string& err) const;
+
+ private:
+  struct Result {
+    std::string params;
+    std::vector<double> samples;
+    Stats stats;
+  };
+
+  std::string benchmark_;
+  std::vector<Result> results_;
+};
+
+} // namespace perf
+
+#endif
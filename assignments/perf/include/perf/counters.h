@@ -0,0 +1,148 @@
+/**
+ * @file counters.h
+ * @brief Hardware performance counters around a kernel (Linux perf_event_open).
+ *
+ * A CounterSet counts cycles, instructions, cache references and misses,
+ * branches and branch misses, and floating-point operations for each
+ * thread of a kernel, without an external profiler. Counters are opened
+ * for the OS threads of an OpenMP parallel region with a given thread
+ * count; GNU and LLVM OpenMP keep a persistent pool, so later regions of
+ * that size (the kernel's) run on the same threads. User-space events only.
+ *
+ * Everything degrades gracefully: on other platforms, without
+ * <linux/perf_event.h>, or when perf_event_paranoid forbids access, open()
+ * fails with a reason; a single unsupported event (e.g. in a VM) is marked
+ * invalid and the rest are still counted. When the PMU has fewer counters
+ * than events, the kernel multiplexes them and values are scaled by
+ * time_enabled / time_running (flagged as multiplexed).
+ *
+ * FP operations come from model-specific raw events: on Intel the
+ * FP_ARITH_INST_RETIRED double-precision events (scalar, 128/256/512-bit
+ * packed, weighted by lanes; Skylake and later), on AMD Zen the retired
+ * SSE/AVX FLOPs event. Elsewhere they are reported as unavailable.
+ */
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <string>
+#include <vector>
+
+namespace perf {
+
+/**
+ * @brief Counted quantities.
+ */
+enum CounterKind {
+  COUNTER_CYCLES,
+  COUNTER_INSTRUCTIONS,
+  COUNTER_CACHE_REFERENCES,
+  COUNTER_CACHE_MISSES,
+  COUNTER_BRANCHES,
+  COUNTER_BRANCH_MISSES,
+  COUNTER_FP_OPS,
+  COUNTER_KINDS
+};
+
+/**
+ * @brief Short name used in log lines, e.g. "cache_misses".
+ */
+const char* counter_name(CounterKind kind);
+
+/**
+ * @brief Counter readings of one thread or a sum of threads.
+ *
+ * Values are doubles: C++98 has no 64-bit integer type, and a double holds
+ * counts exactly up to 2^53.
+ */
+struct CounterValues {
+  double value[COUNTER_KINDS];  ///< Scaled counts
+  bool valid[COUNTER_KINDS];    ///< Whether each counter was available
+  bool multiplexed;             ///< Some counter ran part of the time (scaled)
+
+  CounterValues();
+};
+
+/**
+ * @brief Element-wise sum; a counter is valid only if valid in every input.
+ */
+CounterValues sum_counters(const std::vector<CounterValues>& parts);
+
+/**
+ * @brief One log line of counts and derived ratios (IPC, miss rates);
+ *        unavailable counters print as "n/a".
+ */
+std::string format_counters(const CounterValues& v);
+
+/**
+ * @brief Per-thread hardware counters for a kernel.
+ *
+ * Typical use:
+ * @code
+ *   perf::CounterSet ctr;
+ *   if (ctr.open(threads, err)) ctr.start();
+ *   kernel();               // OpenMP region with `threads` threads
+ *   ctr.stop();
+ *   log(perf::format_counters(ctr.read_total()));
+ * @endcode
+ * start()/stop() may be repeated to accumulate over several calls; reset()
+ * zeroes the counts. All calls are made from the main thread.
+ */
+class CounterSet {
+ public:
+  CounterSet();
+  ~CounterSet();
+
+  /**
+   * @brief Open counters for the threads of a parallel region.
+   *
+   * @param threads Threads of the kernel's parallel regions (1 = this thread)
+   * @param err     Reason if nothing could be opened; on success, the
+   *                counters that are unavailable (empty if none)
+   * @return true if at least one counter is open
+   */
+  bool open(int threads, std::string& err);
+
+  /// Close all counters (also done by the destructor).
+  void close();
+
+  /// Whether open() succeeded.
+  bool is_open() const;
+
+  /// Threads being counted.
+  int threads() const;
+
+  /// Zero all counts.
+  void reset();
+
+  /// Enable counting.
+  void start();
+
+  /// Disable counting.
+  void stop();
+
+  /// Counts of thread t (0 <= t < threads()).
+  CounterValues read_thread(int t) const;
+
+  /// Counts summed over all threads.
+  CounterValues read_total() const;
+
+ private:
+  struct Event {
+    int fd;
+    int thread;
+    CounterKind kind;
+    double weight;  ///< Multiplier into the counter (FP lanes per instruction)
+  };
+
+  CounterSet(const CounterSet&);
+  CounterSet& operator=(const CounterSet&);
+
+  std::vector<Event> events_;
+  std::vector<bool> valid_;  ///< threads_ x COUNTER_KINDS, row per thread
+  int threads_;
+};
+
+} // namespace perf
+
+#endif
@@ -0,0 +1,44 @@
+/**
+ * @file freivalds.h
+ * @brief Random vector and rounding tolerance of the Freivalds check.
+ *
+ * Freivalds' algorithm checks C = A * B in O(N^2): for a random vector r,
+ * compare A (B r) with C r. The drivers compare row by row and scale each
+ * row's difference by (|A| (|B| r))_i, so a correct product computed in
+ * floating point stays below a small multiple of N * machine epsilon
+ * (recursive summation of N products in both C and the check).
+ *
+ * The tolerance also bounds what the check can see. An error d in C[i][j]
+ * moves row i's residual by |d| * r_j / (|A| (|B| r))_i, so it is caught
+ * only when that exceeds the tolerance. For the drivers' inputs
+ * (A[i][k] = i + 1, B[k][j] = 1 / (j + 1)) one missing k-term in C[i][j]
+ * moves it by about r_j / ((j + 1) * N * H_N), H_N the harmonic number:
+ * caught in the first columns at any N, but in the last columns only up
+ * to N of about 2 * 10^4. Errors spread over many elements, such as a
+ * missed tile or k-block of a blocked or out-of-core multiply, add up in
+ * C r and stay far above the tolerance.
+ */
+
+#ifndef PERF_FREIVALDS_H
+#define PERF_FREIVALDS_H
+
+#include <vector>
+
+namespace perf {
+
+/**
+ * @brief Fill r with N pseudo-random values in (0, 1] from seed (xorshift32).
+ *
+ * Deterministic, so ranks sharing the seed build the same vector and a check
+ * can be repeated from a logged seed.
+ */
+void freivalds_vector(unsigned int seed, int N, std::vector<double>& r);
+
+/**
+ * @brief Largest scaled row residual accepted as rounding error: 64 * N * eps.
+ */
+double freivalds_tolerance(int N);
+
+} // namespace perf
+
+#endif
@@ -0,0 +1,90 @@
+/**
+ * @file histogram.h
+ * @brief Log-bucketed latency histogram (HDR style) and tail percentiles.
+ *
+ * A mean or median says nothing about the slow iterations that OS noise and
+ * interrupts cause, and in a tightly coupled job the slowest rank sets the
+ * pace. The histogram keeps every sample at a fixed relative precision with
+ * bounded memory, as HdrHistogram does: each power-of-two range of values
+ * [2^k, 2^(k+1)) units is split into 2^sub_bucket_bits equal buckets, so a
+ * bucket is at most 2^-sub_bucket_bits of its values wide (0.8% for the
+ * default 7 bits) from 1 ns up to hours.
+ * @code
+ *   perf::Histogram h;
+ *   for (...) h.add(seconds);
+ *   const double p99 = h.percentile(99.0);
+ * @endcode
+ */
+
+#ifndef PERF_HISTOGRAM_H
+#define PERF_HISTOGRAM_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace perf {
+
+/**
+ * @brief Counts of values (seconds) in logarithmic buckets.
+ */
+class Histogram {
+ public:
+  /**
+   * @param sub_bucket_bits Linear buckets per power of two, as a power of two (1..16)
+   * @param unit            Smallest distinguished value; smaller values share bucket 0
+   */
+  explicit Histogram(int sub_bucket_bits = 7, double unit = 1e-9);
+
+  /// Count one value (negative values count as 0).
+  void add(double value);
+
+  /// Count every value of samples.
+  void add_all(const std::vector<double>& samples);
+
+  /// Values counted so far.
+  unsigned long count() const;
+
+  /// Smallest and largest value counted (exact; 0 when empty).
+  double min() const;
+  double max() const;
+
+  /**
+   * @brief Value at or below which p percent of the values lie.
+   *
+   * Returns the upper edge of the bucket holding the value of rank
+   * ceil(p * count / 100), capped at max(), so p = 100 is max() and the
+   * error is at most one bucket width. 0 when empty.
+   */
+  double percentile(double p) const;
+
+  /// A non-empty bucket: values in [lower, upper).
+  struct Bucket {
+    double lower;
+    double upper;
+    unsigned long count;
+  };
+
+  /// Non-empty buckets in increasing order.
+  std::vector<Bucket> buckets() const;
+
+ private:
+  std::size_t index_of(double value) const;
+  double lower_edge(std::size_t index) const;
+
+  int sub_bits_;
+  double unit_;
+  std::vector<unsigned long> counts_;
+  unsigned long count_;
+  double min_;
+  double max_;
+};
+
+/**
+ * @brief "p50_us=... p90_us=... p99_us=... p99.9_us=... max_us=..." of a histogram.
+ */
+std::string format_percentiles_us(const Histogram& h);
+
+} // namespace perf
+
+#endif
@@ -0,0 +1,89 @@
+/**
+ * @file log.h
+ * @brief Asynchronous logger for threads and ranks.
+ *
+ * Logging through `std::cout << ... << std::endl` flushes on every line and
+ * is not safe from several threads. Once log_open() is called, messages go
+ * into a ring buffer owned by the calling thread instead: a single producer
+ * (the thread) and a single consumer (a background flusher), so writing a
+ * message takes no lock and no system call. Every `flush_interval_s` the
+ * flusher drains all rings, orders the messages by time and writes them out.
+ *
+ * - INFO lines go to stdout as "[INFO] msg" when `console` is set (rank 0 by
+ *   default), so the console looks as before.
+ * - With a log file, every message is written there as
+ *   "<seconds since open> r<rank> t<thread> <LEVEL> msg". Each rank of an MPI
+ *   run writes its own file; DEBUG messages (e.g. per-iteration progress
+ *   inside a hot loop) only go to the file.
+ * - ERROR messages drain the rings and are written to stderr at once.
+ * - A full ring drops messages rather than block; the count is reported when
+ *   the log is closed.
+ *
+ * Before log_open() (and after log_close()) the functions write synchronously
+ * like the old loggers. Call log_close() once no other thread logs any more;
+ * log_open() also registers it with atexit().
+ */
+
+#ifndef PERF_LOG_H
+#define PERF_LOG_H
+
+#include <string>
+
+namespace perf {
+
+/// Message severity.
+enum LogLevel {
+  LOG_DEBUG,  ///< Log file only
+  LOG_INFO,   ///< stdout (if console) and log file
+  LOG_ERROR   ///< stderr and log file, written immediately
+};
+
+/**
+ * @brief Logger settings.
+ */
+struct LogConfig {
+  int rank;                 ///< Rank tag (0 for single-process drivers)
+  int ranks;                ///< Number of ranks; > 1 gives one file per rank
+  bool console;             ///< Write INFO messages to stdout
+  std::string path;         ///< Log file (empty = none), see log_file_path()
+  int capacity;             ///< Slots per thread ring (a slot holds ~230 characters)
+  double flush_interval_s;  ///< Flusher period
+
+  /// rank 0 of 1, console on, no file, 1024 slots, 20 ms.
+  LogConfig();
+};
+
+/**
+ * @brief Log file of a rank: `path` itself for one rank, else "<path>.<rank>".
+ */
+std::string log_file_path(const std::string& path, int rank, int ranks);
+
+/**
+ * @brief Start asynchronous logging (closing a previous session first).
+ * @return false (with err) if the log file cannot be created or the flusher
+ *         thread cannot start; logging then stays synchronous
+ */
+bool log_open(const LogConfig& cfg, std::string& err);
+
+/// Drain all rings, stop the flusher and close the file.
+void log_close();
+
+/// Whether asynchronous logging is active.
+bool log_is_open();
+
+/// Log a message from any thread.
+void log_write(LogLevel level, const std::string& msg);
+
+/// Log a printf-style message from any thread without allocating (truncated at 1 KiB).
+void log_printf(LogLevel level, const char* fmt, ...)
+#if defined(__GNUC__)
+    __attribute__((format(printf, 2, 3)))
+#endif
+    ;
+
+/// Write out everything logged so far.
+void log_flush();
+
+} // namespace perf
+
+#endif
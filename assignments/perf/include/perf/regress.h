@@ -0,0 +1,105 @@
+/**
+ * @file regress.h
+ * @brief Performance regression checks against per-host baselines.
+ *
+ * `perf-regress` runs a driver at a fixed size with the harness's --csv
+ * output, reads the median time of each result and compares it with the
+ * baseline stored for this host. A result slower than baseline x
+ * (1 + tolerance) is a regression. The first run of a test on a host
+ * records its baseline. Every check is appended to a history file, so
+ * slow drifts that stay inside the band remain visible.
+ *
+ * Files in the baseline directory:
+ *  - <host>.baseline: one line per result, "test<TAB>params<TAB>median_s".
+ *  - <host>.history.csv:
+ *    timestamp,test,params,median_s,baseline_s,ratio,tolerance,status.
+ */
+
+#ifndef PERF_REGRESS_H
+#define PERF_REGRESS_H
+
+#include <string>
+#include <vector>
+
+namespace perf {
+
+/**
+ * @brief One result read from a harness CSV file.
+ */
+struct RunResult {
+  std::string params;  ///< "key=value ..." as written by BenchReport
+  double median_s;     ///< Median time of the result
+  double ci95_s;       ///< Half-width of its confidence interval
+
+  RunResult();
+};
+
+/**
+ * @brief Read the result rows of a harness CSV file (see BenchReport).
+ *
+ * @return false (with err) if the file is missing, has no rows or a bad row
+ */
+bool read_run_csv(const std::string& path, std::vector<RunResult>& out, std::string& err);
+
+/**
+ * @brief Baseline medians of one host, keyed by test and params.
+ */
+struct Baseline {
+  std::vector<std::string> tests;
+  std::vector<std::string> params;
+  std::vector<double> median_s;
+
+  /// Index of (test, params), or -1.
+  int find(const std::string& test, const std::string& params) const;
+
+  /// Insert or replace the median of (test, params).
+  void set(const std::string& test, const std::string& params, double median);
+};
+
+/**
+ * @brief Load a baseline file; a missing file gives an empty baseline.
+ *
+ * @return false (with err) only for an unreadable or malformed file
+ */
+bool load_baseline(const std::string& path, Baseline& out, std::string& err);
+
+/**
+ * @brief Write a baseline file (replacing it).
+ */
+bool save_baseline(const std::string& path, const Baseline& b, std::string& err);
+
+/**
+ * @brief Outcome of one comparison.
+ */
+enum Verdict {
+  VERDICT_NEW,         ///< No baseline yet; this run becomes the baseline
+  VERDICT_OK,          ///< Within the tolerance band
+  VERDICT_FASTER,      ///< Faster than baseline x (1 - tolerance)
+  VERDICT_REGRESSION   ///< Slower than baseline x (1 + tolerance)
+};
+
+/**
+ * @brief Name used in logs and the history file ("new", "ok", "faster", "REGRESSION").
+ */
+const char* verdict_name(Verdict v);
+
+/**
+ * @brief Compare a median with its baseline (baseline <= 0 means none).
+ */
+Verdict compare_to_baseline(double median_s, double baseline_s, double tolerance);
+
+/**
+ * @brief Baseline and history file paths of a host in a directory.
+ */
+std::string baseline_path(const std::string& dir, const std::string& host);
+std::string history_path(const std::string& dir, const std::string& host);
+
+/**
+ * @brief Append one check to the history file (header written if new).
+ */
+bool append_history(const std::string& path, const std::string& test, const RunResult& r,
+                    double baseline_s, double tolerance, Verdict v, std::string& err);
+
+} // namespace perf
+
+#endif
@@ -0,0 +1,174 @@
+/**
+ * @file roofline.h
+ * @brief Measured compute and bandwidth ceilings of a host (roofline model).
+ *
+ * Two ceilings bound any kernel: sustained floating-point throughput and
+ * memory bandwidth. A kernel doing F flops while moving Q bytes has
+ * arithmetic intensity AI = F / Q and can reach at most
+ * min(peak, AI * bandwidth). Reporting a rate against that bound says how
+ * much of the machine a driver actually uses.
+ *
+ * Both ceilings are measured, not taken from data sheets: a multiply-add
+ * chain over independent accumulators for flops, and the four STREAM
+ * kernels (copy, scale, add, triad) for bandwidth, each serially and with
+ * all OpenMP threads. They are compiled with the same flags as the drivers,
+ * so "peak" is what portable C++98 code reaches on this host.
+ *
+ * Measuring takes about a second, so results are cached per host in
+ * $PERF_ROOFLINE_DIR (else $HOME, else the working directory) as
+ * .perf-roofline-<host>, a key=value file that `perf-roofline` writes.
+ */
+
+#ifndef PERF_ROOFLINE_H
+#define PERF_ROOFLINE_H
+
+#include <cstddef>
+#include <string>
+
+namespace perf {
+
+/**
+ * @brief Sustained STREAM bandwidths in GB/s (10^9 bytes per second).
+ */
+struct StreamRates {
+  double copy_gbs;   ///< c = a
+  double scale_gbs;  ///< b = s * c
+  double add_gbs;    ///< c = a + b
+  double triad_gbs;  ///< a = b + s * c
+
+  StreamRates();
+};
+
+/**
+ * @brief Ceilings of one host, serial and with all threads.
+ */
+struct Roofline {
+  std::string host;          ///< Host the figures belong to
+  int threads;               ///< OpenMP threads used for the parallel figures
+  double fma_gflops_serial;  ///< Multiply-add throughput of one thread
+  double fma_gflops;         ///< Multiply-add throughput of all threads
+  StreamRates stream_serial; ///< Bandwidth of one thread
+  StreamRates stream;        ///< Bandwidth of all threads
+
+  Roofline();
+};
+
+/**
+ * @brief The two roofline ceilings a result is compared against.
+ */
+struct Ceiling {
+  double peak_gflops;  ///< Compute ceiling
+  double bw_gbs;       ///< Bandwidth ceiling (STREAM triad)
+
+  Ceiling();
+  Ceiling(double peak, double bw);
+};
+
+/**
+ * @brief Where a measured rate sits under the roofline.
+ */
+struct RooflinePoint {
+  double ai;                 ///< Flops per byte; HUGE_VAL when no bytes move
+  double attainable_gflops;  ///< min(peak, ai * bw)
+  double pct_peak;           ///< Rate as a percentage of the compute ceiling
+  double pct_attainable;     ///< Rate as a percentage of the attainable bound
+  bool memory_bound;         ///< ai * bw < peak
+
+  RooflinePoint();
+};
+
+/**
+ * @brief Name of this host (gethostname), or "localhost" if unavailable.
+ */
+std::string host_name();
+
+/**
+ * @brief Threads an OpenMP parallel region would use here (1 without OpenMP).
+ */
+int default_threads();
+
+/**
+ * @brief Multiply-add throughput in GFLOPS with the given thread count.
+ *
+ * Each thread updates 8 independent accumulators (x = x * m + a) for at
+ * least 50 ms; the best of three runs counts.
+ */
+double measure_fma_gflops(int threads);
+
+/**
+ * @brief STREAM bandwidth over three arrays of n doubles.
+ *
+ * Each kernel is timed five times and the best run counts. Use arrays well
+ * beyond the last-level cache (measure_roofline() uses 2^23 elements).
+ */
+StreamRates measure_stream(std::size_t n, int threads);
+
+/**
+ * @brief Measure all ceilings of this host with default_threads() threads.
+ */
+void measure_roofline(Roofline& out);
+
+/**
+ * @brief Cache file path for a host (see the file comment).
+ */
+std::string roofline_cache_path(const std::string& host);
+
+/**
+ * @brief Read a cache file written by save_roofline().
+ *
+ * @param path Cache file
+ * @param host Expected host; a file written for another host is rejected
+ * @param out  Output ceilings
+ * @param err  Reason on failure (missing file, wrong host, bad value)
+ * @return true if out was filled
+ */
+bool load_roofline(const std::string& path, const std::string& host, Roofline& out,
+                   std::string& err);
+
+/**
+ * @brief Write ceilings to a cache file.
+ *
+ * @return false (with err) if the file cannot be written
+ */
+bool save_roofline(const std::string& path, const Roofline& r, std::string& err);
+
+/**
+ * @brief This host's ceilings: from the cache, else measured and saved.
+ *
+ * A cache measured with a different thread count is measured again. A
+ * failure to save is reported in err but does not fail the call.
+ *
+ * @return true if the ceilings were measured by this call
+ */
+bool acquire_roofline(Roofline& out, std::string& err);
+
+/**
+ * @brief Ceiling of a single-threaded kernel.
+ */
+Ceiling serial_ceiling(const Roofline& r);
+
+/**
+ * @brief Ceiling of a kernel using all r.threads threads.
+ */
+Ceiling parallel_ceiling(const Roofline& r);
+
+/**
+ * @brief Place a measured run under the roofline.
+ *
+ * @param c       Ceilings
+ * @param flops   Floating-point operations of the run
+ * @param bytes   Bytes moved to or from memory (0 for in-register kernels)
+ * @param seconds Elapsed time of the run
+ */
+RooflinePoint roofline_point(const Ceiling& c, double flops, double bytes, double seconds);
+
+/**
+ * @brief One log line, e.g. "roofline: ai=85.33 bound=compute
+ *        attainable_gflops=9.80 peak_gflops=9.80 bw_gbs=11.20
+ *        pct_peak=42.1% pct_attainable=42.1%".
+ */
+std::string format_roofline(const Ceiling& c, const RooflinePoint& p);
+
+} // namespace perf
+
+#endif
@@ -0,0 +1,34 @@
+/**
+ * @file sysmem.h
+ * @brief Memory budget derived from the RAM actually available.
+ *
+ * Replaces fixed allocation ceilings in the drivers: a run may use a
+ * fraction of MemAvailable (/proc/meminfo, which counts reclaimable page
+ * cache), else of sysconf free pages, else a conservative 1 GiB.
+ */
+
+#ifndef PERF_SYSMEM_H
+#define PERF_SYSMEM_H
+
+#include <cstddef>
+
+namespace perf {
+
+/**
+ * @brief Bytes of RAM available to new allocations on this host.
+ *
+ * MemAvailable from /proc/meminfo, else sysconf(_SC_AVPHYS_PAGES) pages.
+ *
+ * @return Available bytes, or 0 if neither source exists
+ */
+std::size_t available_memory_bytes();
+
+/**
+ * @brief Bytes a run may allocate: 3/4 of available_memory_bytes(), or
+ *        1 GiB when that is unknown.
+ */
+std::size_t memory_budget_bytes();
+
+} // namespace perf
+
+#endif
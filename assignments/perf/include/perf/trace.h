@@ -0,0 +1,111 @@
+/**
+ * @file trace.h
+ * @brief Phase tracing for threads and ranks, written as Chrome trace JSON.
+ *
+ * A single elapsed time hides where a run spends it: which thread finished
+ * its tiles late, how long a rank waited at a barrier, whether I/O overlapped
+ * compute. Between trace_start() and trace_stop() every thread records
+ * begin/end events of named phases into a buffer of its own (no lock, no
+ * system call; the check is one flag read when tracing is off):
+ * @code
+ *   perf::trace_start(rank);
+ *   {
+ *     perf::TraceScope phase("broadcast");
+ *     ...
+ *   }
+ *   std::vector<perf::TraceEvent> events;
+ *   perf::trace_stop(events);
+ *   perf::write_chrome_trace("run.json", events, names, err);
+ * @endcode
+ * The file loads in chrome://tracing or https://ui.perfetto.dev: one process
+ * per rank (pid), one track per thread (tid), nested phases as stacked bars.
+ * Times are now_seconds() of the recording process; an MPI driver gathers the
+ * events of all ranks to one file and shifts each rank by its clock offset
+ * first (as the assignment5 driver does).
+ */
+
+#ifndef PERF_TRACE_H
+#define PERF_TRACE_H
+
+#include <string>
+#include <vector>
+
+namespace perf {
+
+/**
+ * @brief One recorded event.
+ */
+struct TraceEvent {
+  std::string name;  ///< Phase name
+  char ph;           ///< 'B' (begin) or 'E' (end)
+  double ts;         ///< now_seconds() of the recording process
+  int pid;           ///< Rank
+  int tid;           ///< Thread, numbered in order of its first event
+
+  TraceEvent();
+};
+
+/**
+ * @brief Start recording (discarding a previous session's events).
+ *
+ * @param pid      Process id of the events (the rank)
+ * @param capacity Events kept per thread; later ones are dropped and counted.
+ *                 A begin is dropped together with its end and the phases
+ *                 nested in it, so a full buffer never leaves a phase open.
+ */
+void trace_start(int pid, int capacity = 1 << 18);
+
+/// Whether events are being recorded.
+bool trace_enabled();
+
+/**
+ * @brief Begin a phase on the calling thread.
+ *
+ * @param name Phase name; must outlive the session (use a string literal)
+ */
+void trace_begin(const char* name);
+
+/// End the phase begun last on the calling thread.
+void trace_end(const char* name);
+
+/**
+ * @brief Stop recording and collect the events of all threads, by time.
+ *
+ * Call once no other thread records any more (e.g. after the parallel
+ * regions and worker threads have finished).
+ * @return Events dropped by full buffers
+ */
+unsigned long trace_stop(std::vector<TraceEvent>& out);
+
+/**
+ * @brief Begin/end pair for a scope; does nothing when tracing is off.
+ */
+class TraceScope {
+ public:
+  explicit TraceScope(const char* name) : name_(trace_enabled() ? name : 0) {
+    if (name_) trace_begin(name_);
+  }
+  ~TraceScope() {
+    if (name_) trace_end(name_);
+  }
+
+ private:
+  const char* name_;
+  TraceScope(const TraceScope&);
+  TraceScope& operator=(const TraceScope&);
+};
+
+/**
+ * @brief Write events as Chrome trace JSON, times in microseconds from the earliest.
+ *
+ * @param path          Output file
+ * @param events        Events of one or more processes
+ * @param process_names Optional label per pid (e.g. "rank 1 (node07)"); may be empty
+ * @param err           Reason on failure
+ */
+bool write_chrome_trace(const std::string& path, const std::vector<TraceEvent>& events,
+                        const std::vector<std::string>& process_names, std::string& err);
+
+} // namespace perf
+
+#endif
@@ -0,0 +1,357 @@
+/**
+ * @file bench.cpp
+ * @brief Benchmark harness: monotonic clock, sampler, statistics and output files.
+ */
+
+#include "perf/bench.h"
+#include "perf/log.h"
+#include "perf/roofline.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+
+#if defined(_WIN32)
+#define NOMINMAX  // Stats::min / Stats::max
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <sys/time.h>
+#include <time.h>
+#endif
+
+namespace perf {
+
+// Scale from median absolute deviation to standard deviation (normal data)
+static const double kMadScale = 1.4826;
+
+// Two-sided 95% Student's t for 1..30 degrees of freedom
+static const double kT95[30] = {
+  12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+  2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+  2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+double now_seconds() {
+#if defined(_WIN32)
+  LARGE_INTEGER freq;
+  LARGE_INTEGER count;
+  QueryPerformanceFrequency(&freq);
+  QueryPerformanceCounter(&count);
+  return static_cast<double>(count.QuadPart) / static_cast<double>(freq.QuadPart);
+#elif defined(CLOCK_MONOTONIC)
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<double>(ts.tv_sec) + 1e-9 * static_cast<double>(ts.tv_nsec);
+#elif defined(__unix__) || defined(__APPLE__)
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return static_cast<double>(tv.tv_sec) + 1e-6 * static_cast<double>(tv.tv_usec);
+#else
+  return static_cast<double>(std::clock()) / static_cast<double>(CLOCKS_PER_SEC);
+#endif
+}
+
+BenchConfig::BenchConfig() : warmup(1), reps(5), outlier_k(3.0) {}
+
+Stats::Stats()
+    : samples(0), kept(0), outliers(0), min(0.0), max(0.0), median(0.0), mean(0.0),
+      stddev(0.0), ci95(0.0) {}
+
+const char* bench_usage() {
+  return "[--warmup W] [--reps R] [--outlier-k K] [--json FILE] [--csv FILE] [--log FILE]";
+}
+
+static bool parse_int_value(const char* s, int& out) {
+  if (!s || *s == '\0') return false;
+  errno = 0;
+  char* endp = 0;
+  const long v = std::strtol(s, &endp, 10);
+  if (errno == ERANGE || endp == s || *endp != '\0') return false;
+  if (v < INT_MIN || v > INT_MAX) return false;
+  out = static_cast<int>(v);
+  return true;
+}
+
+static bool parse_double_value(const char* s, double& out) {
+  if (!s || *s == '\0') return false;
+  errno = 0;
+  char* endp = 0;
+  const double v = std::strtod(s, &endp);
+  if (errno == ERANGE || endp == s || *endp != '\0') return false;
+  out = v;
+  return true;
+}
+
+int parse_bench_option(int argc, char** argv, int& i, BenchConfig& cfg, std::string& err) {
+  const std::string a = argv[i];
+  if (a != "--warmup" && a != "--reps" && a != "--outlier-k" && a != "--json" && a != "--csv" &&
+      a != "--log") {
+    return 0;
+  }
+  if (i + 1 >= argc) {
+    err = "missing value for " + a;
+    return -1;
+  }
+  const char* v = argv[i + 1];
+  if (a == "--warmup") {
+    if (!parse_int_value(v, cfg.warmup) || cfg.warmup < 0) {
+      err = "--warmup must be an integer >= 0";
+      return -1;
+    }
+  } else if (a == "--reps") {
+    if (!parse_int_value(v, cfg.reps) || cfg.reps <= 0) {
+      err = "--reps must be an integer > 0";
+      return -1;
+    }
+  } else if (a == "--outlier-k") {
+    if (!parse_double_value(v, cfg.outlier_k) || !(cfg.outlier_k >= 0.0)) {
+      err = "--outlier-k must be a number >= 0";
+      return -1;
+    }
+  } else if (a == "--json") {
+    cfg.json_path = v;
+  } else if (a == "--log") {
+    cfg.log_path = v;
+  } else {
+    cfg.csv_path = v;
+  }
+  i += 2;
+  return 1;
+}
+
+// Median of a sorted, non-empty vector
+static double sorted_median(const std::vector<double>& v) {
+  const std::size_t n = v.size();
+  return (n % 2 == 1) ? v[n / 2] : 0.5 * (v[n / 2 - 1] + v[n / 2]);
+}
+
+Stats summarize(const std::vector<double>& samples, double outlier_k) {
+  Stats s;
+  s.samples = static_cast<int>(samples.size());
+  if (samples.empty()) {
+    return s;
+  }
+  std::vector<double> sorted(samples);
+  std::sort(sorted.begin(), sorted.end());
+  const double med = sorted_median(sorted);
+
+  std::vector<double> dev(sorted.size());
+  for (std::size_t i = 0; i < sorted.size(); ++i) {
+    dev[i] = std::fabs(sorted[i] - med);
+  }
+  std::sort(dev.begin(), dev.end());
+  const double spread = kMadScale * sorted_median(dev);
+
+  // With identical timings (spread 0) nothing is an outlier
+  std::vector<double> kept;
+  for (std::size_t i = 0; i < sorted.size(); ++i) {
+    if (outlier_k <= 0.0 || spread <= 0.0 || std::fabs(sorted[i] - med) <= outlier_k * spread) {
+      kept.push_back(sorted[i]);
+    }
+  }
+  const std::size_t n = kept.size();
+  s.kept = static_cast<int>(n);
+  s.outliers = s.samples - s.kept;
+  s.min = kept.front();
+  s.max = kept.back();
+  s.median = sorted_median(kept);
+
+  double sum = 0.0;
+  for (std::size_t i = 0; i < n; ++i) {
+    sum += kept[i];
+  }
+  s.mean = sum / static_cast<double>(n);
+  if (n > 1) {
+    double ss = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+      ss += (kept[i] - s.mean) * (kept[i] - s.mean);
+    }
+    s.stddev = std::sqrt(ss / static_cast<double>(n - 1));
+    // Beyond the table t approaches 1.96; 2.4/df matches it to 0.01 at df 40..120
+    const std::size_t df = n - 1;
+    const double t = (df <= 30) ? kT95[df - 1] : 1.96 + 2.4 / static_cast<double>(df);
+    s.ci95 = t * s.stddev / std::sqrt(static_cast<double>(n));
+  }
+  return s;
+}
+
+std::string format_stats(const Stats& s) {
+  std::ostringstream oss;
+  oss.setf(std::ios::fixed);
+  oss.precision(3);
+  oss << "bench: reps=" << s.samples << " kept=" << s.kept << " outliers=" << s.outliers
+      << " min_ms=" << s.min * 1e3 << " median_ms=" << s.median * 1e3
+      << " mean_ms=" << s.mean * 1e3 << " max_ms=" << s.max * 1e3
+      << " stddev_ms=" << s.stddev * 1e3 << " ci95_ms=" << s.ci95 * 1e3;
+  return oss.str();
+}
+
+Sampler::Sampler(const BenchConfig& cfg)
+    : warmup_(cfg.warmup), reps_(cfg.reps), outlier_k_(cfg.outlier_k), run_(0), start_(0.0) {}
+
+bool Sampler::next() {
+  if (run_ > warmup_) {
+    samples_.push_back(now_seconds() - start_);
+    // Clock stopped: the (asynchronous) log line is not part of the sample
+    log_printf(LOG_DEBUG, "bench: sample=%d seconds=%.9f", static_cast<int>(samples_.size()),
+               samples_.back());
+  }
+  if (run_ >= warmup_ + reps_) {
+    return false;
+  }
+  ++run_;
+  start_ = now_seconds();
+  return true;
+}
+
+bool Sampler::warming_up() const {
+  return run_ <= warmup_;
+}
+
+const std::vector<double>& Sampler::samples() const {
+  return samples_;
+}
+
+Stats Sampler::stats() const {
+  return summarize(samples_, outlier_k_);
+}
+
+BenchReport::BenchReport(const std::string& benchmark) : benchmark_(benchmark) {}
+
+void BenchReport::add(const std::string& params, const std::vector<double>& samples,
+                      const Stats& s) {
+  Result r;
+  r.params = params;
+  r.samples = samples;
+  r.stats = s;
+  results_.push_back(r);
+}
+
+static std::string number(double v) {
+  char buf[32];
+  std::sprintf(buf, "%.9g", v);
+  return buf;
+}
+
+std::string json_string(const std::string& s) {
+  std::string out = "\"";
+  for (std::size_t i = 0; i < s.size(); ++i) {
+    const char c = s[i];
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char buf[8];
+      std::sprintf(buf, "\\u%04x", static_cast<unsigned int>(static_cast<unsigned char>(c)));
+      out += buf;
+    } else {
+      out += c;
+    }
+  }
+  return out + "\"";
+}
+
+// "N=512 threads=4" as a JSON object; numeric values stay numbers
+static std::string json_params(const std::string& params) {
+  std::istringstream in(params);
+  std::string token;
+  std::string out = "{";
+  bool first = true;
+  while (in >> token) {
+    const std::string::size_type eq = token.find('=');
+    const std::string key = (eq == std::string::npos) ? token : token.substr(0, eq);
+    const std::string value = (eq == std::string::npos) ? std::string() : token.substr(eq + 1);
+    // JSON numbers: optional minus, digits first, finite (no "inf", "0x1", "+5")
+    double v = 0.0;
+    const bool numeric = !value.empty() && (value[0] == '-' || (value[0] >= '0' && value[0] <= '9'))
+                         && parse_double_value(value.c_str(), v) && v - v == 0.0
+                         && value.find_first_of("xX") == std::string::npos;
+    out += first ? "" : ", ";
+    out += json_string(key) + ": ";
+    out += numeric ? value : json_string(value);
+    first = false;
+  }
+  return out + "}";
+}
+
+std::string utc_timestamp() {
+  const std::time_t now = std::time(0);
+  char buf[32];
+  if (std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now)) == 0) {
+    return "";
+  }
+  return buf;
+}
+
+bool BenchReport::write(const BenchConfig& cfg, std::string& err) const {
+  const std::string host = host_name();
+  const std::string stamp = utc_timestamp();
+  if (!cfg.json_path.empty()) {
+    std::ofstream out(cfg.json_path.c_str());
+    if (!out) {
+      err = "cannot write " + cfg.json_path;
+      return false;
+    }
+    out << "{\n  \"benchmark\": " << json_string(benchmark_)
+        << ",\n  \"host\": " << json_string(host)
+        << ",\n  \"timestamp\": " << json_string(stamp)
+        << ",\n  \"warmup\": " << cfg.warmup << ",\n  \"reps\": " << cfg.reps
+        << ",\n  \"outlier_k\": " << number(cfg.outlier_k) << ",\n  \"results\": [";
+    for (std::size_t r = 0; r < results_.size(); ++r) {
+      const Stats& s = results_[r].stats;
+      out << (r == 0 ? "\n" : ",\n")
+          << "    {\"params\": " << json_params(results_[r].params)
+          << ", \"samples\": " << s.samples << ", \"kept\": " << s.kept
+          << ", \"outliers\": " << s.outliers << ", \"min_s\": " << number(s.min)
+          << ", \"median_s\": " << number(s.median) << ", \"mean_s\": " << number(s.mean)
+          << ", \"max_s\": " << number(s.max) << ", \"stddev_s\": " << number(s.stddev)
+          << ", \"ci95_s\": " << number(s.ci95) << ", \"samples_s\": [";
+      for (std::size_t i = 0; i < results_[r].samples.size(); ++i) {
+        out << (i == 0 ? "" : ", ") << number(results_[r].samples[i]);
+      }
+      out << "]}";
+    }
+    out << "\n  ]\n}\n";
+    if (!out) {
+      err = "cannot write " + cfg.json_path;
+      return false;
+    }
+  }
+  if (!cfg.csv_path.empty()) {
+    // The header goes into new (or empty) files only, so runs can share a file
+    bool fresh = true;
+    {
+      std::ifstream probe(cfg.csv_path.c_str());
+      fresh = !probe || probe.peek() == std::ifstream::traits_type::eof();
+    }
+    std::ofstream out(cfg.csv_path.c_str(), std::ios::app);
+    if (!out) {
+      err = "cannot write " + cfg.csv_path;
+      return false;
+    }
+    if (fresh) {
+      out << "benchmark,host,timestamp,params,samples,kept,outliers,"
+             "min_s,median_s,mean_s,max_s,stddev_s,ci95_s\n";
+    }
+    for (std::size_t r = 0; r < results_.size(); ++r) {
+      const Stats& s = results_[r].stats;
+      out << benchmark_ << "," << host << "," << stamp << ",\"" << results_[r].params << "\","
+          << s.samples << "," << s.kept << "," << s.outliers << "," << number(s.min) << ","
+          << number(s.median) << "," << number(s.mean) << "," << number(s.max) << ","
+          << number(s.stddev) << "," << number(s.ci95) << "\n";
+    }
+    if (!out) {
+      err = "cannot write " + cfg.csv_path;
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace perf
@@ -0,0 +1,403 @@
+/**
+ * @file counters.cpp
+ * @brief CounterSet on Linux perf_event_open; a stub elsewhere.
+ *
+ * Each (thread, event) pair is its own file descriptor rather than part of
+ * an event group: a group larger than the PMU never gets scheduled at all,
+ * while independent events are multiplexed and can be scaled.
+ */
+
+#include "perf/counters.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#if defined(PERF_HAVE_PERF_EVENT)
+#include <linux/perf_event.h>
+#include <stdint.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+namespace perf {
+
+static const char* const kCounterNames[COUNTER_KINDS] = {
+  "cycles", "instructions", "cache_refs", "cache_misses",
+  "branches", "branch_misses", "fp_ops"
+};
+
+const char* counter_name(CounterKind kind) {
+  const int k = static_cast<int>(kind);
+  return (k >= 0 && k < COUNTER_KINDS) ? kCounterNames[k] : "unknown";
+}
+
+CounterValues::CounterValues() : multiplexed(false) {
+  for (int k = 0; k < COUNTER_KINDS; ++k) {
+    value[k] = 0.0;
+    valid[k] = false;
+  }
+}
+
+CounterValues sum_counters(const std::vector<CounterValues>& parts) {
+  CounterValues total;
+  if (parts.empty()) {
+    return total;
+  }
+  for (int k = 0; k < COUNTER_KINDS; ++k) {
+    total.valid[k] = true;
+  }
+  for (std::size_t p = 0; p < parts.size(); ++p) {
+    for (int k = 0; k < COUNTER_KINDS; ++k) {
+      total.value[k] += parts[p].value[k];
+      total.valid[k] = total.valid[k] && parts[p].valid[k];
+    }
+    total.multiplexed = total.multiplexed || parts[p].multiplexed;
+  }
+  return total;
+}
+
+/**
+ * @brief Append " name=value" or " name=n/a".
+ */
+static void put_count(std::ostringstream& oss, const CounterValues& v, CounterKind k) {
+  oss << " " << counter_name(k) << "=";
+  if (v.valid[k]) {
+    oss << v.value[k];
+  } else {
+    oss << "n/a";
+  }
+}
+
+/**
+ * @brief Append " name=num/den" (as a ratio or percentage) or " name=n/a".
+ */
+static void put_ratio(std::ostringstream& oss, const char* name, const CounterValues& v,
+                      CounterKind num, CounterKind den, double scale, const char* unit) {
+  oss << " " << name << "=";
+  if (v.valid[num] && v.valid[den] && v.value[den] > 0.0) {
+    oss << scale * v.value[num] / v.value[den] << unit;
+  } else {
+    oss << "n/a";
+  }
+}
+
+std::string format_counters(const CounterValues& v) {
+  std::ostringstream oss;
+  oss.precision(4);
+  put_count(oss, v, COUNTER_CYCLES);
+  put_count(oss, v, COUNTER_INSTRUCTIONS);
+  put_ratio(oss, "ipc", v, COUNTER_INSTRUCTIONS, COUNTER_CYCLES, 1.0, "");
+  put_count(oss, v, COUNTER_CACHE_REFERENCES);
+  put_count(oss, v, COUNTER_CACHE_MISSES);
+  put_ratio(oss, "cache_miss_rate", v, COUNTER_CACHE_MISSES, COUNTER_CACHE_REFERENCES, 100.0, "%");
+  put_count(oss, v, COUNTER_BRANCHES);
+  put_count(oss, v, COUNTER_BRANCH_MISSES);
+  put_ratio(oss, "branch_miss_rate", v, COUNTER_BRANCH_MISSES, COUNTER_BRANCHES, 100.0, "%");
+  put_count(oss, v, COUNTER_FP_OPS);
+  if (v.multiplexed) {
+    oss << " multiplexed=yes";
+  }
+  // Drop the leading space
+  return oss.str().substr(1);
+}
+
+CounterSet::CounterSet() : threads_(0) {}
+
+CounterSet::~CounterSet() {
+  close();
+}
+
+bool CounterSet::is_open() const {
+  return !events_.empty();
+}
+
+int CounterSet::threads() const {
+  return threads_;
+}
+
+#if defined(PERF_HAVE_PERF_EVENT)
+
+/**
+ * @brief One event to open per thread.
+ */
+struct EventSpec {
+  CounterKind kind;
+  uint32_t type;
+  uint64_t config;
+  double weight;
+};
+
+/**
+ * @brief vendor_id from /proc/cpuinfo ("GenuineIntel", "AuthenticAMD", ...).
+ */
+static std::string cpu_vendor() {
+  std::ifstream in("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.compare(0, 9, "vendor_id") == 0) {
+      const std::string::size_type colon = line.find(':');
+      if (colon != std::string::npos && colon + 2 <= line.size()) {
+        return line.substr(colon + 2);
+      }
+    }
+  }
+  return std::string();
+}
+
+static void add_spec(std::vector<EventSpec>& specs, CounterKind kind, uint32_t type,
+                     uint64_t config, double weight) {
+  EventSpec s;
+  s.kind = kind;
+  s.type = type;
+  s.config = config;
+  s.weight = weight;
+  specs.push_back(s);
+}
+
+static void event_specs(std::vector<EventSpec>& specs) {
+  add_spec(specs, COUNTER_CYCLES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, 1.0);
+  add_spec(specs, COUNTER_INSTRUCTIONS, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, 1.0);
+  add_spec(specs, COUNTER_CACHE_REFERENCES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES, 1.0);
+  add_spec(specs, COUNTER_CACHE_MISSES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, 1.0);
+  add_spec(specs, COUNTER_BRANCHES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS, 1.0);
+  add_spec(specs, COUNTER_BRANCH_MISSES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, 1.0);
+
+  // Raw config is (umask << 8) | event
+  const std::string vendor = cpu_vendor();
+  if (vendor == "GenuineIntel") {
+    // FP_ARITH_INST_RETIRED (event 0xC7), double precision, by vector width
+    add_spec(specs, COUNTER_FP_OPS, PERF_TYPE_RAW, 0x01C7, 1.0);  // scalar
+    add_spec(specs, COUNTER_FP_OPS, PERF_TYPE_RAW, 0x04C7, 2.0);  // 128-bit packed
+    add_spec(specs, COUNTER_FP_OPS, PERF_TYPE_RAW, 0x10C7, 4.0);  // 256-bit packed
+    add_spec(specs, COUNTER_FP_OPS, PERF_TYPE_RAW, 0x40C7, 8.0);  // 512-bit packed
+  } else if (vendor == "AuthenticAMD") {
+    // Retired SSE/AVX FLOPs (event 0x03, all types); already counts flops
+    add_spec(specs, COUNTER_FP_OPS, PERF_TYPE_RAW, 0xFF03, 1.0);
+  }
+}
+
+static int open_event(const EventSpec& spec, long tid) {
+  struct perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = spec.type;
+  attr.config = spec.config;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return static_cast<int>(syscall(SYS_perf_event_open, &attr, static_cast<pid_t>(tid), -1, -1, 0));
+}
+
+static std::string paranoid_level() {
+  std::ifstream in("/proc/sys/kernel/perf_event_paranoid");
+  std::string level;
+  in >> level;
+  return level.empty() ? std::string("?") : level;
+}
+
+static std::string open_failure(int err) {
+  if (err == EACCES || err == EPERM) {
+    return "perf_event_open not permitted (kernel.perf_event_paranoid=" + paranoid_level() + ")";
+  }
+  if (err == ENOENT || err == ENODEV || err == EOPNOTSUPP || err == EINVAL) {
+    return "hardware counters not supported here (no PMU, e.g. a virtual machine)";
+  }
+  if (err == ENOSYS) {
+    return "perf_event_open not available in this kernel";
+  }
+  return std::string("perf_event_open failed: ") + std::strerror(err);
+}
+
+bool CounterSet::open(int threads, std::string& err) {
+  close();
+  err.clear();
+  if (threads < 1) {
+    threads = 1;
+  }
+
+  // OS thread ids of the parallel region's threads
+  std::vector<long> tids(static_cast<std::size_t>(threads), 0L);
+  if (threads == 1) {
+    tids[0] = syscall(SYS_gettid);
+  } else {
+#if defined(_OPENMP)
+    #pragma omp parallel num_threads(threads)
+    {
+      const int t = omp_get_thread_num();
+      if (t < threads) {
+        tids[static_cast<std::size_t>(t)] = syscall(SYS_gettid);
+      }
+    }
+#else
+    tids.assign(1, syscall(SYS_gettid));
+#endif
+  }
+  // The runtime may grant fewer threads than asked for
+  while (tids.size() > 1 && tids.back() == 0L) {
+    tids.pop_back();
+  }
+  threads_ = static_cast<int>(tids.size());
+  valid_.assign(static_cast<std::size_t>(threads_) * COUNTER_KINDS, false);
+
+  std::vector<EventSpec> specs;
+  event_specs(specs);
+  int first_errno = 0;
+  for (int t = 0; t < threads_; ++t) {
+    bool failed[COUNTER_KINDS];
+    bool seen[COUNTER_KINDS];
+    for (int k = 0; k < COUNTER_KINDS; ++k) {
+      failed[k] = false;
+      seen[k] = false;
+    }
+    const std::size_t first = events_.size();
+    for (std::size_t s = 0; s < specs.size(); ++s) {
+      seen[specs[s].kind] = true;
+      const int fd = open_event(specs[s], tids[static_cast<std::size_t>(t)]);
+      if (fd < 0) {
+        if (first_errno == 0) {
+          first_errno = errno;
+        }
+        failed[specs[s].kind] = true;
+        continue;
+      }
+      Event e;
+      e.fd = fd;
+      e.thread = t;
+      e.kind = specs[s].kind;
+      e.weight = specs[s].weight;
+      events_.push_back(e);
+    }
+    // A counter made of several events (FP) needs all of them
+    std::vector<Event> kept(events_.begin(), events_.begin() + first);
+    for (std::size_t i = first; i < events_.size(); ++i) {
+      if (failed[events_[i].kind]) {
+        ::close(events_[i].fd);
+      } else {
+        kept.push_back(events_[i]);
+      }
+    }
+    events_.swap(kept);
+    for (int k = 0; k < COUNTER_KINDS; ++k) {
+      valid_[static_cast<std::size_t>(t) * COUNTER_KINDS + k] = seen[k] && !failed[k];
+    }
+  }
+
+  if (events_.empty()) {
+    err = first_errno ? open_failure(first_errno) : std::string("no counters to open");
+    threads_ = 0;
+    valid_.clear();
+    return false;
+  }
+  for (int k = 0; k < COUNTER_KINDS; ++k) {
+    bool all = true;
+    for (int t = 0; t < threads_; ++t) {
+      all = all && valid_[static_cast<std::size_t>(t) * COUNTER_KINDS + k];
+    }
+    if (!all) {
+      err += std::string(err.empty() ? "" : ",") + counter_name(static_cast<CounterKind>(k));
+    }
+  }
+  reset();
+  return true;
+}
+
+void CounterSet::close() {
+  for (std::size_t i = 0; i < events_.size(); ++i) {
+    ::close(events_[i].fd);
+  }
+  events_.clear();
+  valid_.clear();
+  threads_ = 0;
+}
+
+void CounterSet::reset() {
+  for (std::size_t i = 0; i < events_.size(); ++i) {
+    ioctl(events_[i].fd, PERF_EVENT_IOC_RESET, 0);
+  }
+}
+
+void CounterSet::start() {
+  for (std::size_t i = 0; i < events_.size(); ++i) {
+    ioctl(events_[i].fd, PERF_EVENT_IOC_ENABLE, 0);
+  }
+}
+
+void CounterSet::stop() {
+  for (std::size_t i = 0; i < events_.size(); ++i) {
+    ioctl(events_[i].fd, PERF_EVENT_IOC_DISABLE, 0);
+  }
+}
+
+CounterValues CounterSet::read_thread(int t) const {
+  CounterValues v;
+  if (t < 0 || t >= threads_) {
+    return v;
+  }
+  for (int k = 0; k < COUNTER_KINDS; ++k) {
+    v.valid[k] = valid_[static_cast<std::size_t>(t) * COUNTER_KINDS + k];
+  }
+  for (std::size_t i = 0; i < events_.size(); ++i) {
+    if (events_[i].thread != t) {
+      continue;
+    }
+    // value, time_enabled, time_running
+    uint64_t buf[3] = {0, 0, 0};
+    if (::read(events_[i].fd, buf, sizeof(buf)) != static_cast<ssize_t>(sizeof(buf))) {
+      v.valid[events_[i].kind] = false;
+      continue;
+    }
+    double count = static_cast<double>(buf[0]);
+    if (buf[2] < buf[1]) {
+      v.multiplexed = true;
+      count = (buf[2] > 0) ? count * static_cast<double>(buf[1]) / static_cast<double>(buf[2]) : 0.0;
+    }
+    v.value[events_[i].kind] += events_[i].weight * count;
+  }
+  return v;
+}
+
+#else // !PERF_HAVE_PERF_EVENT
+
+bool CounterSet::open(int threads, std::string& err) {
+  (void)threads;
+  close();
+  err = "hardware counters need Linux perf_event_open";
+  return false;
+}
+
+void CounterSet::close() {
+  events_.clear();
+  valid_.clear();
+  threads_ = 0;
+}
+
+void CounterSet::reset() {}
+
+void CounterSet::start() {}
+
+void CounterSet::stop() {}
+
+CounterValues CounterSet::read_thread(int t) const {
+  (void)t;
+  return CounterValues();
+}
+
+#endif // PERF_HAVE_PERF_EVENT
+
+CounterValues CounterSet::read_total() const {
+  std::vector<CounterValues> parts;
+  for (int t = 0; t < threads_; ++t) {
+    parts.push_back(read_thread(t));
+  }
+  return sum_counters(parts);
+}
+
+} // namespace perf
@@ -0,0 +1,34 @@
+/**
+ * @file freivalds.cpp
+ * @brief xorshift32 vector and rounding tolerance of the Freivalds check.
+ */
+
+#include "perf/freivalds.h"
+
+#include <cfloat>
+
+namespace perf {
+
+// Safety factor over the N * eps rounding bound (see freivalds.h for what
+// it leaves undetected)
+static const double kToleranceFactor = 64.0;
+
+void freivalds_vector(unsigned int seed, int N, std::vector<double>& r) {
+  r.resize(N > 0 ? static_cast<std::size_t>(N) : 0);
+  // xorshift32 masked to 32 bits (unsigned int may be wider); a zero
+  // state would stay zero
+  unsigned int x = (seed & 0xFFFFFFFFu) ? (seed & 0xFFFFFFFFu) : 2463534242u;
+  for (int j = 0; j < N; ++j) {
+    x ^= (x << 13) & 0xFFFFFFFFu;
+    x ^= x >> 17;
+    x ^= (x << 5) & 0xFFFFFFFFu;
+    // Top 24 bits scaled into (0, 1]
+    r[j] = (static_cast<double>(x >> 8) + 1.0) / 16777216.0;
+  }
+}
+
+double freivalds_tolerance(int N) {
+  return kToleranceFactor * static_cast<double>(N > 1 ? N : 1) * DBL_EPSILON;
+}
+
+} // namespace perf
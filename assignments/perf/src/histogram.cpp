@@ -0,0 +1,129 @@
+/**
+ * @file histogram.cpp
+ * @brief Log-bucketed histogram: bucket index arithmetic and percentiles.
+ */
+
+#include "perf/histogram.h"
+
+#include <cmath>
+#include <cstdio>
+
+namespace perf {
+
+Histogram::Histogram(int sub_bucket_bits, double unit)
+    : sub_bits_(sub_bucket_bits < 1 ? 1 : (sub_bucket_bits > 16 ? 16 : sub_bucket_bits)),
+      unit_(unit > 0.0 ? unit : 1e-9),
+      count_(0),
+      min_(0.0),
+      max_(0.0) {}
+
+// Bucket 0 holds [0, unit); then, for x = value / unit in [2^k, 2^(k+1)),
+// bucket 1 + k * S + floor((x / 2^k - 1) * S) with S = 2^sub_bits
+std::size_t Histogram::index_of(double value) const {
+  const double x = value / unit_;
+  if (!(x >= 1.0)) {
+    return 0;
+  }
+  const std::size_t S = static_cast<std::size_t>(1) << sub_bits_;
+  int e = 0;
+  const double m = std::frexp(x < 4.0e18 ? x : 4.0e18, &e);  // x = m * 2^e, m in [0.5, 1)
+  std::size_t sub = static_cast<std::size_t>((2.0 * m - 1.0) * static_cast<double>(S));
+  if (sub >= S) {
+    sub = S - 1;
+  }
+  return 1 + static_cast<std::size_t>(e - 1) * S + sub;
+}
+
+double Histogram::lower_edge(std::size_t index) const {
+  if (index == 0) {
+    return 0.0;
+  }
+  const std::size_t S = static_cast<std::size_t>(1) << sub_bits_;
+  const std::size_t k = (index - 1) / S;
+  const std::size_t sub = (index - 1) % S;
+  return unit_ * std::ldexp(1.0 + static_cast<double>(sub) / static_cast<double>(S),
+                            static_cast<int>(k));
+}
+
+void Histogram::add(double value) {
+  if (!(value > 0.0)) {
+    value = 0.0;
+  }
+  const std::size_t i = index_of(value);
+  if (i >= counts_.size()) {
+    counts_.resize(i + 1, 0);
+  }
+  ++counts_[i];
+  if (count_ == 0 || value < min_) {
+    min_ = value;
+  }
+  if (count_ == 0 || value > max_) {
+    max_ = value;
+  }
+  ++count_;
+}
+
+void Histogram::add_all(const std::vector<double>& samples) {
+  for (std::size_t i = 0; i < samples.size(); ++i) {
+    add(samples[i]);
+  }
+}
+
+unsigned long Histogram::count() const {
+  return count_;
+}
+
+double Histogram::min() const {
+  return min_;
+}
+
+double Histogram::max() const {
+  return max_;
+}
+
+double Histogram::percentile(double p) const {
+  if (count_ == 0) {
+    return 0.0;
+  }
+  // p * count first: p / 100 is inexact, and 99.9 / 100 * 1000 rounds to
+  // just above 999, which would step to the next rank (the max). The
+  // relative slack covers the same error for p values not exact in binary.
+  const double rank = p * static_cast<double>(count_) / 100.0;
+  double want = std::ceil(rank - rank * 1e-12);
+  if (want < 1.0) {
+    want = 1.0;
+  }
+  unsigned long seen = 0;
+  for (std::size_t i = 0; i < counts_.size(); ++i) {
+    seen += counts_[i];
+    if (static_cast<double>(seen) >= want) {
+      const double upper = lower_edge(i + 1);
+      return (upper < max_) ? (upper > min_ ? upper : min_) : max_;
+    }
+  }
+  return max_;
+}
+
+std::vector<Histogram::Bucket> Histogram::buckets() const {
+  std::vector<Bucket> out;
+  for (std::size_t i = 0; i < counts_.size(); ++i) {
+    if (counts_[i] > 0) {
+      Bucket b;
+      b.lower = lower_edge(i);
+      b.upper = lower_edge(i + 1);
+      b.count = counts_[i];
+      out.push_back(b);
+    }
+  }
+  return out;
+}
+
+std::string format_percentiles_us(const Histogram& h) {
+  char buf[160];
+  std::sprintf(buf, "p50_us=%.2f p90_us=%.2f p99_us=%.2f p99.9_us=%.2f max_us=%.2f",
+               h.percentile(50.0) * 1e6, h.percentile(90.0) * 1e6, h.percentile(99.0) * 1e6,
+               h.percentile(99.9) * 1e6, h.max() * 1e6);
+  return buf;
+}
+
+} // namespace perf
@@ -0,0 +1,505 @@
+/**
+ * @file log.cpp
+ * @brief Per-thread ring buffers drained by a background flusher.
+ *
+ * Each ring has one producer (its thread) and one consumer (the flusher, or a
+ * thread draining for an ERROR or log_flush()). head is only written by the
+ * producer and tail only by the consumer; a memory fence between filling the
+ * slots and publishing head (and between reading them and advancing tail) is
+ * all the synchronization a message needs. New rings are pushed onto a list
+ * with compare-and-swap. Only consumers take a lock, to serialize output.
+ */
+
+#include "perf/log.h"
+#include "perf/bench.h"
+#include "perf/roofline.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <errno.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <time.h>
+#endif
+
+#if defined(_MSC_VER)
+#define PERF_LOG_TLS __declspec(thread)
+#else
+#define PERF_LOG_TLS __thread
+#endif
+
+namespace perf {
+
+LogConfig::LogConfig()
+    : rank(0), ranks(1), console(true), capacity(1024), flush_interval_s(0.02) {}
+
+std::string log_file_path(const std::string& path, int rank, int ranks) {
+  if (path.empty() || ranks <= 1) {
+    return path;
+  }
+  char buf[16];
+  std::sprintf(buf, ".%d", rank);
+  return path + buf;
+}
+
+namespace {
+
+const int SLOT_TEXT = 232;
+
+// One slot of a ring; a longer message continues in the following slots
+struct Slot {
+  double t;
+  int level;
+  int len;
+  int more;
+  char text[SLOT_TEXT];
+};
+
+struct Ring {
+  Ring* next;
+  int thread;
+  unsigned long capacity;          // power of two
+  Slot* slots;
+  volatile unsigned long head;     // next slot to fill (producer)
+  volatile unsigned long tail;     // next slot to read (consumer)
+  volatile unsigned long dropped;  // messages lost to a full ring (producer)
+};
+
+// A drained message
+struct Entry {
+  double t;
+  int level;
+  int thread;
+  std::string text;
+};
+
+bool earlier(const Entry& a, const Entry& b) {
+  return a.t < b.t;
+}
+
+void fence() {
+#if defined(_MSC_VER)
+  MemoryBarrier();
+#else
+  __sync_synchronize();
+#endif
+}
+
+bool push_ring(Ring* volatile* list, Ring* expected, Ring* desired) {
+#if defined(_MSC_VER)
+  return InterlockedCompareExchangePointer(reinterpret_cast<PVOID volatile*>(list), desired,
+                                           expected) == expected;
+#else
+  return __sync_bool_compare_and_swap(list, expected, desired);
+#endif
+}
+
+int next_thread_id(volatile long* counter) {
+#if defined(_MSC_VER)
+  return static_cast<int>(InterlockedIncrement(counter) - 1);
+#else
+  return static_cast<int>(__sync_fetch_and_add(counter, 1L));
+#endif
+}
+
+// Serializes consumers (output), never producers
+class Mutex {
+ public:
+#if defined(_WIN32)
+  Mutex() { InitializeCriticalSection(&m_); }
+  ~Mutex() { DeleteCriticalSection(&m_); }
+  void lock() { EnterCriticalSection(&m_); }
+  void unlock() { LeaveCriticalSection(&m_); }
+
+ private:
+  CRITICAL_SECTION m_;
+#else
+  Mutex() { pthread_mutex_init(&m_, 0); }
+  ~Mutex() { pthread_mutex_destroy(&m_); }
+  void lock() { pthread_mutex_lock(&m_); }
+  void unlock() { pthread_mutex_unlock(&m_); }
+
+ private:
+  pthread_mutex_t m_;
+#endif
+};
+
+// Stop request for the flusher, which sleeps on it for a whole period and
+// wakes early only when log_close() sets it
+class StopSignal {
+ public:
+#if defined(_WIN32)
+  StopSignal() : set_(false) { event_ = CreateEvent(0, TRUE, FALSE, 0); }
+  ~StopSignal() { CloseHandle(event_); }
+  void set() {
+    set_ = true;
+    SetEvent(event_);
+  }
+  void reset() {
+    set_ = false;
+    ResetEvent(event_);
+  }
+  // Whether stop was requested, waiting up to s seconds for it
+  bool wait(double s) {
+    if (!set_) {
+      WaitForSingleObject(event_, static_cast<DWORD>(s * 1e3));
+    }
+    return set_;
+  }
+
+ private:
+  HANDLE event_;
+  volatile bool set_;
+#else
+  StopSignal() : set_(false) {
+    pthread_mutex_init(&m_, 0);
+    pthread_cond_init(&c_, 0);
+  }
+  ~StopSignal() {
+    pthread_cond_destroy(&c_);
+    pthread_mutex_destroy(&m_);
+  }
+  void set() {
+    pthread_mutex_lock(&m_);
+    set_ = true;
+    pthread_cond_signal(&c_);
+    pthread_mutex_unlock(&m_);
+  }
+  void reset() {
+    pthread_mutex_lock(&m_);
+    set_ = false;
+    pthread_mutex_unlock(&m_);
+  }
+  // Whether stop was requested, waiting up to s seconds for it
+  bool wait(double s) {
+    timeval now;
+    gettimeofday(&now, 0);
+    const double until = static_cast<double>(now.tv_sec) + 1e-6 * now.tv_usec + s;
+    timespec deadline;
+    deadline.tv_sec = static_cast<time_t>(until);
+    deadline.tv_nsec = static_cast<long>((until - static_cast<double>(deadline.tv_sec)) * 1e9);
+    pthread_mutex_lock(&m_);
+    int rc = 0;
+    while (!set_ && rc != ETIMEDOUT) {
+      rc = pthread_cond_timedwait(&c_, &m_, &deadline);
+    }
+    const bool stop = set_;
+    pthread_mutex_unlock(&m_);
+    return stop;
+  }
+
+ private:
+  pthread_mutex_t m_;
+  pthread_cond_t c_;
+  bool set_;
+#endif
+};
+
+LogConfig g_cfg;
+std::FILE* g_file = 0;
+double g_t0 = 0.0;
+volatile int g_open = 0;
+StopSignal g_stop;
+volatile int g_generation = 0;
+volatile long g_next_thread = 0;
+Ring* volatile g_rings = 0;
+Mutex g_out;
+bool g_atexit = false;
+#if defined(_WIN32)
+HANDLE g_flusher = 0;
+#else
+pthread_t g_flusher;
+#endif
+
+// The calling thread's ring for this session, created on first use
+PERF_LOG_TLS Ring* t_ring = 0;
+PERF_LOG_TLS int t_generation = -1;
+
+Ring* my_ring() {
+  if (t_ring && t_generation == g_generation) {
+    return t_ring;
+  }
+  Ring* r = new Ring;
+  r->capacity = static_cast<unsigned long>(g_cfg.capacity);
+  r->slots = new Slot[r->capacity];
+  r->head = 0;
+  r->tail = 0;
+  r->dropped = 0;
+  r->thread = next_thread_id(&g_next_thread);
+  do {
+    r->next = g_rings;
+  } while (!push_ring(&g_rings, r->next, r));
+  t_ring = r;
+  t_generation = g_generation;
+  return r;
+}
+
+void push(LogLevel level, const char* text, std::size_t len) {
+  Ring* r = my_ring();
+  const double t = now_seconds() - g_t0;
+  unsigned long needed = (len == 0) ? 1 : static_cast<unsigned long>((len + SLOT_TEXT - 1) / SLOT_TEXT);
+  if (needed > r->capacity) {
+    needed = r->capacity;
+    len = static_cast<std::size_t>(needed) * SLOT_TEXT;
+  }
+  const unsigned long head = r->head;
+  const unsigned long tail = r->tail;
+  fence();  // slots up to tail are no longer read
+  if (head - tail + needed > r->capacity) {
+    r->dropped = r->dropped + 1;
+    return;
+  }
+  std::size_t off = 0;
+  for (unsigned long k = 0; k < needed; ++k) {
+    Slot& s = r->slots[(head + k) & (r->capacity - 1)];
+    const std::size_t n = std::min(len - off, static_cast<std::size_t>(SLOT_TEXT));
+    s.t = t;
+    s.level = level;
+    s.len = static_cast<int>(n);
+    s.more = (k + 1 < needed) ? 1 : 0;
+    std::memcpy(s.text, text + off, n);
+    off += n;
+  }
+  fence();  // slots are filled before they are published
+  r->head = head + needed;
+}
+
+const char* level_name(int level) {
+  return level == LOG_ERROR ? "ERROR" : (level == LOG_INFO ? "INFO" : "DEBUG");
+}
+
+void write_file_line(double t, int thread, int level, const std::string& text) {
+  if (g_file) {
+    std::fprintf(g_file, "%.6f r%d t%d %s %s\n", t, g_cfg.rank, thread, level_name(level),
+                 text.c_str());
+  }
+}
+
+// Move every published message to the outputs; caller holds g_out
+void drain_locked() {
+  std::vector<Entry> entries;
+  for (Ring* r = g_rings; r; r = r->next) {
+    const unsigned long head = r->head;
+    fence();  // slots before head are complete
+    unsigned long tail = r->tail;
+    while (tail != head) {
+      Entry e;
+      const Slot& first = r->slots[tail & (r->capacity - 1)];
+      e.t = first.t;
+      e.level = first.level;
+      e.thread = r->thread;
+      bool more = true;
+      while (more && tail != head) {
+        const Slot& s = r->slots[tail & (r->capacity - 1)];
+        e.text.append(s.text, static_cast<std::size_t>(s.len));
+        more = s.more != 0;
+        ++tail;
+      }
+      entries.push_back(e);
+    }
+    fence();  // slots are read before they are handed back
+    r->tail = tail;
+  }
+  if (entries.empty()) {
+    return;
+  }
+  std::stable_sort(entries.begin(), entries.end(), earlier);
+  bool console = false;
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    const Entry& e = entries[i];
+    if (e.level == LOG_INFO && g_cfg.console) {
+      std::fprintf(stdout, "[INFO] %s\n", e.text.c_str());
+      console = true;
+    }
+    write_file_line(e.t, e.thread, e.level, e.text);
+  }
+  if (console) {
+    std::fflush(stdout);
+  }
+  if (g_file) {
+    std::fflush(g_file);
+  }
+}
+
+void close_at_exit() {
+  log_close();
+}
+
+} // namespace
+
+// Flusher thread: drain every flush_interval_s until log_close()
+#if defined(_WIN32)
+static DWORD WINAPI flusher_main(LPVOID)
+#else
+extern "C" void* perf_log_flusher_main(void*)
+#endif
+{
+  // One wake-up per period, so timed regions see no extra interrupts;
+  // log_close() ends the wait early
+  while (!g_stop.wait(g_cfg.flush_interval_s)) {
+    g_out.lock();
+    drain_locked();
+    g_out.unlock();
+  }
+  return 0;
+}
+
+bool log_open(const LogConfig& cfg, std::string& err) {
+  log_close();
+  g_cfg = cfg;
+  unsigned long cap = 16;
+  while (cap < static_cast<unsigned long>(cfg.capacity) && cap < (1UL << 20)) {
+    cap <<= 1;
+  }
+  g_cfg.capacity = static_cast<int>(cap);
+  if (!(g_cfg.flush_interval_s > 0.0)) {
+    g_cfg.flush_interval_s = LogConfig().flush_interval_s;
+  }
+
+  const std::string path = log_file_path(cfg.path, cfg.rank, cfg.ranks);
+  if (!path.empty()) {
+    g_file = std::fopen(path.c_str(), "w");
+    if (!g_file) {
+      err = "cannot write log file " + path;
+      return false;
+    }
+    std::fprintf(g_file, "# perf log: host=%s rank=%d/%d started=%s\n", host_name().c_str(),
+                 cfg.rank, cfg.ranks, utc_timestamp().c_str());
+  }
+
+  g_t0 = now_seconds();
+  g_next_thread = 0;
+  g_stop.reset();
+  g_generation = g_generation + 1;
+  fence();
+#if defined(_WIN32)
+  g_flusher = CreateThread(0, 0, flusher_main, 0, 0, 0);
+  const bool started = g_flusher != 0;
+#else
+  const bool started = pthread_create(&g_flusher, 0, perf_log_flusher_main, 0) == 0;
+#endif
+  if (!started) {
+    err = "cannot start the log flusher thread";
+    if (g_file) {
+      std::fclose(g_file);
+      g_file = 0;
+    }
+    return false;
+  }
+  g_open = 1;
+  if (!g_atexit) {
+    std::atexit(close_at_exit);
+    g_atexit = true;
+  }
+  my_ring();  // the opening thread is t0
+  return true;
+}
+
+void log_close() {
+  if (!g_open) {
+    return;
+  }
+  g_stop.set();
+#if defined(_WIN32)
+  WaitForSingleObject(g_flusher, INFINITE);
+  CloseHandle(g_flusher);
+#else
+  pthread_join(g_flusher, 0);
+#endif
+  g_out.lock();
+  drain_locked();
+  unsigned long dropped = 0;
+  while (g_rings) {
+    Ring* r = g_rings;
+    g_rings = r->next;
+    dropped += r->dropped;
+    delete[] r->slots;
+    delete r;
+  }
+  if (dropped > 0) {
+    char buf[128];
+    std::sprintf(buf, "log: %lu messages dropped (ring full; raise the ring capacity)", dropped);
+    if (g_cfg.console) {
+      std::fprintf(stdout, "[INFO] %s\n", buf);
+      std::fflush(stdout);
+    }
+    write_file_line(now_seconds() - g_t0, 0, LOG_INFO, buf);
+  }
+  if (g_file) {
+    std::fclose(g_file);
+    g_file = 0;
+  }
+  g_open = 0;
+  g_generation = g_generation + 1;
+  g_out.unlock();
+}
+
+bool log_is_open() {
+  return g_open != 0;
+}
+
+void log_write(LogLevel level, const std::string& msg) {
+  if (!g_open) {
+    if (level == LOG_INFO) {
+      std::cout << "[INFO] " << msg << std::endl;
+    } else if (level == LOG_ERROR) {
+      std::cerr << "[ERROR] " << msg << std::endl;
+    }
+    return;
+  }
+  if (level != LOG_ERROR) {
+    push(level, msg.data(), msg.size());
+    return;
+  }
+  const int thread = my_ring()->thread;
+  g_out.lock();
+  drain_locked();
+  std::fprintf(stderr, "[ERROR] %s\n", msg.c_str());
+  std::fflush(stderr);
+  write_file_line(now_seconds() - g_t0, thread, LOG_ERROR, msg);
+  if (g_file) {
+    std::fflush(g_file);
+  }
+  g_out.unlock();
+}
+
+void log_printf(LogLevel level, const char* fmt, ...) {
+  char buf[1024];
+  va_list ap;
+  va_start(ap, fmt);
+  const int n = std::vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  if (n < 0) {
+    return;
+  }
+  const std::size_t len = std::min(static_cast<std::size_t>(n), sizeof(buf) - 1);
+  if (g_open && level != LOG_ERROR) {
+    push(level, buf, len);
+  } else {
+    log_write(level, std::string(buf, len));
+  }
+}
+
+void log_flush() {
+  if (!g_open) {
+    std::fflush(stdout);
+    return;
+  }
+  g_out.lock();
+  drain_locked();
+  g_out.unlock();
+}
+
+} // namespace perf
@@ -0,0 +1,205 @@
+/**
+ * @file regress.cpp
+ * @brief Harness CSV reader, per-host baselines and history for perf-regress.
+ */
+
+#include "perf/regress.h"
+#include "perf/bench.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace perf {
+
+RunResult::RunResult() : median_s(0.0), ci95_s(0.0) {}
+
+// Split a CSV line; fields may be double-quoted (quotes inside are doubled)
+static void split_csv(const std::string& line, std::vector<std::string>& out) {
+  out.clear();
+  std::string field;
+  bool quoted = false;
+  for (std::size_t i = 0; i < line.size(); ++i) {
+    const char c = line[i];
+    if (quoted) {
+      if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+        field += '"';
+        ++i;
+      } else if (c == '"') {
+        quoted = false;
+      } else {
+        field += c;
+      }
+    } else if (c == '"') {
+      quoted = true;
+    } else if (c == ',') {
+      out.push_back(field);
+      field.clear();
+    } else if (c != '\r') {
+      field += c;
+    }
+  }
+  out.push_back(field);
+}
+
+static bool parse_seconds(const std::string& s, double& out) {
+  if (s.empty()) return false;
+  errno = 0;
+  char* endp = 0;
+  const double v = std::strtod(s.c_str(), &endp);
+  if (errno == ERANGE || endp == s.c_str() || *endp != '\0' || !(v >= 0.0)) return false;
+  out = v;
+  return true;
+}
+
+bool read_run_csv(const std::string& path, std::vector<RunResult>& out, std::string& err) {
+  std::ifstream in(path.c_str());
+  if (!in) {
+    err = "no results in " + path + " (did the run fail?)";
+    return false;
+  }
+  // Columns of BenchReport: params is 3, median_s 8, ci95_s 12
+  std::string line;
+  std::vector<std::string> f;
+  out.clear();
+  while (std::getline(in, line)) {
+    if (line.empty() || line.compare(0, 10, "benchmark,") == 0) {
+      continue;
+    }
+    split_csv(line, f);
+    RunResult r;
+    if (f.size() < 13 || !parse_seconds(f[8], r.median_s) || !parse_seconds(f[12], r.ci95_s)) {
+      err = "malformed row in " + path + ": " + line;
+      return false;
+    }
+    r.params = f[3];
+    out.push_back(r);
+  }
+  if (out.empty()) {
+    err = "no results in " + path;
+    return false;
+  }
+  return true;
+}
+
+int Baseline::find(const std::string& test, const std::string& p) const {
+  for (std::size_t i = 0; i < tests.size(); ++i) {
+    if (tests[i] == test && params[i] == p) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+void Baseline::set(const std::string& test, const std::string& p, double median) {
+  const int i = find(test, p);
+  if (i >= 0) {
+    median_s[i] = median;
+    return;
+  }
+  tests.push_back(test);
+  params.push_back(p);
+  median_s.push_back(median);
+}
+
+bool load_baseline(const std::string& path, Baseline& out, std::string& err) {
+  out = Baseline();
+  std::ifstream in(path.c_str());
+  if (!in) {
+    return true;
+  }
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    const std::string::size_type t1 = line.find('\t');
+    const std::string::size_type t2 = (t1 == std::string::npos) ? t1 : line.find('\t', t1 + 1);
+    double median = 0.0;
+    if (t2 == std::string::npos || !parse_seconds(line.substr(t2 + 1), median)) {
+      err = "malformed line in " + path + ": " + line;
+      return false;
+    }
+    out.set(line.substr(0, t1), line.substr(t1 + 1, t2 - t1 - 1), median);
+  }
+  return true;
+}
+
+bool save_baseline(const std::string& path, const Baseline& b, std::string& err) {
+  std::ofstream out(path.c_str());
+  if (!out) {
+    err = "cannot write " + path;
+    return false;
+  }
+  out << "# perf-regress baseline: test<TAB>params<TAB>median_s (updated " << utc_timestamp()
+      << ")\n";
+  out.precision(9);
+  for (std::size_t i = 0; i < b.tests.size(); ++i) {
+    out << b.tests[i] << "\t" << b.params[i] << "\t" << b.median_s[i] << "\n";
+  }
+  if (!out) {
+    err = "cannot write " + path;
+    return false;
+  }
+  return true;
+}
+
+const char* verdict_name(Verdict v) {
+  switch (v) {
+    case VERDICT_NEW: return "new";
+    case VERDICT_OK: return "ok";
+    case VERDICT_FASTER: return "faster";
+    case VERDICT_REGRESSION: return "REGRESSION";
+  }
+  return "?";
+}
+
+Verdict compare_to_baseline(double median_s, double baseline_s, double tolerance) {
+  if (!(baseline_s > 0.0)) {
+    return VERDICT_NEW;
+  }
+  if (median_s > baseline_s * (1.0 + tolerance)) {
+    return VERDICT_REGRESSION;
+  }
+  if (median_s < baseline_s * (1.0 - tolerance)) {
+    return VERDICT_FASTER;
+  }
+  return VERDICT_OK;
+}
+
+std::string baseline_path(const std::string& dir, const std::string& host) {
+  return dir + "/" + host + ".baseline";
+}
+
+std::string history_path(const std::string& dir, const std::string& host) {
+  return dir + "/" + host + ".history.csv";
+}
+
+bool append_history(const std::string& path, const std::string& test, const RunResult& r,
+                    double baseline_s, double tolerance, Verdict v, std::string& err) {
+  bool fresh = true;
+  {
+    std::ifstream probe(path.c_str());
+    fresh = !probe || probe.peek() == std::ifstream::traits_type::eof();
+  }
+  std::ofstream out(path.c_str(), std::ios::app);
+  if (!out) {
+    err = "cannot write " + path;
+    return false;
+  }
+  if (fresh) {
+    out << "timestamp,test,params,median_s,baseline_s,ratio,tolerance,status\n";
+  }
+  out.precision(9);
+  out << utc_timestamp() << "," << test << ",\"" << r.params << "\"," << r.median_s << ","
+      << baseline_s << "," << ((baseline_s > 0.0) ? r.median_s / baseline_s : 0.0) << ","
+      << tolerance << "," << verdict_name(v) << "\n";
+  if (!out) {
+    err = "cannot write " + path;
+    return false;
+  }
+  return true;
+}
+
+} // namespace perf
@@ -0,0 +1,182 @@
+/**
+ * @file regress_main.cpp
+ * @brief perf-regress: run a driver and check its medians against this host's baseline.
+ *
+ * The command after "--" gets "--csv FILE" appended, so it must be a driver
+ * using the benchmark harness (directly or under mpiexec). Each result row is
+ * compared with the baseline and appended to the history (see regress.h).
+ * Results without a baseline are recorded as the new baseline; --update (or
+ * PERF_UPDATE_BASELINE=1) replaces existing ones after a deliberate change.
+ *
+ * Usage: perf-regress --name TEST --dir DIR [--tolerance T] [--update] -- COMMAND [ARGS...]
+ * Exit status: 0 within tolerance, 1 regression, 2 usage or run failure.
+ */
+
+#include "perf/regress.h"
+#include "perf/roofline.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+static void print_line(const std::string& s) {
+  std::cout << "[INFO] " << s << std::endl;
+}
+
+static void print_error(const std::string& s) {
+  std::cerr << "[ERROR] " << s << std::endl;
+}
+
+static void usage() {
+  std::cerr << "Usage: perf-regress --name TEST --dir DIR [--tolerance T] [--update] -- COMMAND [ARGS...]"
+            << std::endl;
+}
+
+// Quote one argument for the platform shell used by std::system
+static std::string shell_quote(const std::string& arg) {
+#if defined(_WIN32)
+  return "\"" + arg + "\"";
+#else
+  std::string out = "'";
+  for (std::size_t i = 0; i < arg.size(); ++i) {
+    if (arg[i] == '\'') {
+      out += "'\\''";
+    } else {
+      out += arg[i];
+    }
+  }
+  return out + "'";
+#endif
+}
+
+static bool make_dir(const std::string& dir) {
+#if defined(_WIN32)
+  return _mkdir(dir.c_str()) == 0 || errno == EEXIST;
+#else
+  return mkdir(dir.c_str(), 0777) == 0 || errno == EEXIST;
+#endif
+}
+
+int main(int argc, char** argv) {
+  std::string name;
+  std::string dir;
+  double tolerance = 0.15;
+  const char* env_update = std::getenv("PERF_UPDATE_BASELINE");
+  bool update = env_update && std::strcmp(env_update, "0") != 0 && *env_update != '\0';
+  int cmd = -1;
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    if (a == "--") {
+      cmd = i + 1;
+      break;
+    }
+    if (a == "--update") {
+      update = true;
+      continue;
+    }
+    if ((a == "--name" || a == "--dir" || a == "--tolerance") && i + 1 >= argc) {
+      print_error("missing value for " + a);
+      usage();
+      return 2;
+    }
+    if (a == "--name") {
+      name = argv[++i];
+    } else if (a == "--dir") {
+      dir = argv[++i];
+    } else if (a == "--tolerance") {
+      char* endp = 0;
+      tolerance = std::strtod(argv[++i], &endp);
+      if (*endp != '\0' || !(tolerance > 0.0)) {
+        print_error("--tolerance must be a positive fraction, e.g. 0.15");
+        return 2;
+      }
+    } else {
+      print_error("unknown option: " + a);
+      usage();
+      return 2;
+    }
+  }
+  if (name.empty() || dir.empty() || cmd < 0 || cmd >= argc) {
+    usage();
+    return 2;
+  }
+  if (!make_dir(dir)) {
+    print_error("cannot create " + dir);
+    return 2;
+  }
+
+  const std::string host = perf::host_name();
+  const std::string run_csv = dir + "/" + host + "." + name + ".run.csv";
+  std::remove(run_csv.c_str());
+  std::string command;
+  for (int i = cmd; i < argc; ++i) {
+    command += shell_quote(argv[i]) + " ";
+  }
+  command += "--csv " + shell_quote(run_csv);
+  print_line("run: " + command);
+  std::cout.flush();
+  if (std::system(command.c_str()) != 0) {
+    print_error("command failed: " + command);
+    std::remove(run_csv.c_str());
+    return 2;
+  }
+
+  std::vector<perf::RunResult> results;
+  perf::Baseline base;
+  std::string err;
+  const bool read = perf::read_run_csv(run_csv, results, err);
+  std::remove(run_csv.c_str());
+  if (!read || !perf::load_baseline(perf::baseline_path(dir, host), base, err)) {
+    print_error(err);
+    return 2;
+  }
+
+  bool regression = false;
+  bool changed = false;
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    const perf::RunResult& r = results[i];
+    const int b = base.find(name, r.params);
+    const double baseline_s = (b >= 0) ? base.median_s[b] : 0.0;
+    const perf::Verdict v = perf::compare_to_baseline(r.median_s, baseline_s, tolerance);
+    regression = regression || (v == perf::VERDICT_REGRESSION && !update);
+    if (v == perf::VERDICT_NEW || update) {
+      base.set(name, r.params, r.median_s);
+      changed = true;
+    }
+    std::ostringstream oss;
+    oss.precision(4);
+    oss << "perf: test=" << name << " params=\"" << r.params << "\" median_ms=" << r.median_s * 1e3
+        << " ci95_ms=" << r.ci95_s * 1e3 << " baseline_ms=" << baseline_s * 1e3
+        << " ratio=" << ((baseline_s > 0.0) ? r.median_s / baseline_s : 0.0)
+        << " tolerance=" << tolerance * 100.0 << "% status=" << perf::verdict_name(v)
+        << (update && b >= 0 ? " (baseline updated)" : "");
+    if (v == perf::VERDICT_REGRESSION && !update) {
+      print_error(oss.str());
+    } else {
+      print_line(oss.str());
+    }
+    if (!perf::append_history(perf::history_path(dir, host), name, r, baseline_s, tolerance, v,
+                              err)) {
+      print_error(err);
+    }
+  }
+  if (changed && !perf::save_baseline(perf::baseline_path(dir, host), base, err)) {
+    print_error(err);
+    return 2;
+  }
+  print_line("baseline=" + perf::baseline_path(dir, host) + " history=" +
+             perf::history_path(dir, host));
+  return regression ? 1 : 0;
+}
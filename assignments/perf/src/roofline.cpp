@@ -0,0 +1,390 @@
+/**
+ * @file roofline.cpp
+ * @brief Roofline measurement, cache file and report formatting.
+ *
+ * Timings use the harness's monotonic wall clock (bench.h): std::clock()
+ * adds up CPU time over threads and would hide any parallel speedup.
+ */
+
+#include "perf/roofline.h"
+#include "perf/bench.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+namespace perf {
+
+// Independent accumulators per thread in fma_chain(); enough to hide
+// multiply-add latency on current cores
+static const int kFmaLanes = 8;
+// Minimum duration of one FMA run, in seconds
+static const double kFmaMinSeconds = 0.05;
+static const int kFmaReps = 3;
+static const int kStreamReps = 5;
+// STREAM array length: 64 MiB per array, well past last-level caches
+static const std::size_t kStreamElements = static_cast<std::size_t>(1) << 23;
+static const std::size_t kStreamMinElements = static_cast<std::size_t>(1) << 20;
+
+// Written with every result so the measured loops cannot be optimized away
+static volatile double g_sink = 0.0;
+
+StreamRates::StreamRates() : copy_gbs(0.0), scale_gbs(0.0), add_gbs(0.0), triad_gbs(0.0) {}
+
+Roofline::Roofline() : threads(1), fma_gflops_serial(0.0), fma_gflops(0.0) {}
+
+Ceiling::Ceiling() : peak_gflops(0.0), bw_gbs(0.0) {}
+
+Ceiling::Ceiling(double peak, double bw) : peak_gflops(peak), bw_gbs(bw) {}
+
+RooflinePoint::RooflinePoint()
+    : ai(0.0), attainable_gflops(0.0), pct_peak(0.0), pct_attainable(0.0), memory_bound(false) {}
+
+std::string host_name() {
+#if defined(__unix__) || defined(__APPLE__)
+  char buf[256];
+  if (gethostname(buf, sizeof(buf)) == 0) {
+    buf[sizeof(buf) - 1] = '\0';
+    if (buf[0] != '\0') {
+      return std::string(buf);
+    }
+  }
+#endif
+  return "localhost";
+}
+
+int default_threads() {
+#if defined(_OPENMP)
+  const int t = omp_get_max_threads();
+  return (t > 0) ? t : 1;
+#else
+  return 1;
+#endif
+}
+
+/**
+ * @brief 2 * kFmaLanes * iters flops on one thread; returns a checksum.
+ *
+ * The lanes are separate scalars rather than an array so that even an
+ * unoptimized build keeps loop overhead out of the measurement.
+ */
+static double fma_chain(long iters) {
+  double x0 = 1.000, x1 = 1.001, x2 = 1.002, x3 = 1.003;
+  double x4 = 1.004, x5 = 1.005, x6 = 1.006, x7 = 1.007;
+  // x converges to a / (1 - m) = 1, so values stay finite for any length
+  const double m = 0.999999;
+  const double a = 1e-6;
+  for (long it = 0; it < iters; ++it) {
+    x0 = x0 * m + a;
+    x1 = x1 * m + a;
+    x2 = x2 * m + a;
+    x3 = x3 * m + a;
+    x4 = x4 * m + a;
+    x5 = x5 * m + a;
+    x6 = x6 * m + a;
+    x7 = x7 * m + a;
+  }
+  return x0 + x1 + x2 + x3 + x4 + x5 + x6 + x7;
+}
+
+/**
+ * @brief Seconds for every thread to run fma_chain(iters).
+ */
+static double time_fma(long iters, int threads) {
+  double sum = 0.0;
+  const double t0 = now_seconds();
+#if defined(_OPENMP)
+  #pragma omp parallel num_threads(threads) reduction(+:sum) if(threads > 1)
+#endif
+  {
+    sum += fma_chain(iters);
+  }
+  const double dt = now_seconds() - t0;
+  g_sink = sum;
+  (void)threads;
+  return dt;
+}
+
+double measure_fma_gflops(int threads) {
+  if (threads < 1) {
+    threads = 1;
+  }
+  // Calibrate the length on one thread, then keep it for every run
+  long iters = 1L << 14;
+  while (time_fma(iters, 1) < kFmaMinSeconds && iters < (1L << 40)) {
+    iters *= 2;
+  }
+  double best = 0.0;
+  for (int rep = 0; rep < kFmaReps; ++rep) {
+    const double dt = time_fma(iters, threads);
+    if (rep == 0 || dt < best) {
+      best = dt;
+    }
+  }
+  const double flops = 2.0 * kFmaLanes * static_cast<double>(iters) * threads;
+  return (best > 0.0) ? flops / (best * 1e9) : 0.0;
+}
+
+StreamRates measure_stream(std::size_t n, int threads) {
+  StreamRates out;
+  if (n == 0) {
+    return out;
+  }
+  if (threads < 1) {
+    threads = 1;
+  }
+  std::vector<double> a(n);
+  std::vector<double> b(n);
+  std::vector<double> c(n);
+  double* pa = &a[0];
+  double* pb = &b[0];
+  double* pc = &c[0];
+  const long len = static_cast<long>(n);
+  const double s = 3.0;
+
+  // Touch the pages with the threads that will use them (first-touch NUMA)
+#if defined(_OPENMP)
+  #pragma omp parallel for num_threads(threads) schedule(static) if(threads > 1)
+#endif
+  for (long i = 0; i < len; ++i) {
+    pa[i] = 1.0;
+    pb[i] = 2.0;
+    pc[i] = 0.0;
+  }
+
+  double best[4] = {0.0, 0.0, 0.0, 0.0};
+  for (int rep = 0; rep < kStreamReps; ++rep) {
+    double t[5];
+    t[0] = now_seconds();
+#if defined(_OPENMP)
+    #pragma omp parallel for num_threads(threads) schedule(static) if(threads > 1)
+#endif
+    for (long i = 0; i < len; ++i) {
+      pc[i] = pa[i];
+    }
+    t[1] = now_seconds();
+#if defined(_OPENMP)
+    #pragma omp parallel for num_threads(threads) schedule(static) if(threads > 1)
+#endif
+    for (long i = 0; i < len; ++i) {
+      pb[i] = s * pc[i];
+    }
+    t[2] = now_seconds();
+#if defined(_OPENMP)
+    #pragma omp parallel for num_threads(threads) schedule(static) if(threads > 1)
+#endif
+    for (long i = 0; i < len; ++i) {
+      pc[i] = pa[i] + pb[i];
+    }
+    t[3] = now_seconds();
+#if defined(_OPENMP)
+    #pragma omp parallel for num_threads(threads) schedule(static) if(threads > 1)
+#endif
+    for (long i = 0; i < len; ++i) {
+      pa[i] = pb[i] + s * pc[i];
+    }
+    t[4] = now_seconds();
+    for (int k = 0; k < 4; ++k) {
+      const double dt = t[k + 1] - t[k];
+      if (rep == 0 || dt < best[k]) {
+        best[k] = dt;
+      }
+    }
+  }
+  g_sink = pa[len / 2];
+
+  // Bytes per element as counted by STREAM: two arrays for copy and scale,
+  // three for add and triad (write-allocate traffic is not counted)
+  const double bytes = static_cast<double>(n) * sizeof(double);
+  out.copy_gbs = (best[0] > 0.0) ? 2.0 * bytes / (best[0] * 1e9) : 0.0;
+  out.scale_gbs = (best[1] > 0.0) ? 2.0 * bytes / (best[1] * 1e9) : 0.0;
+  out.add_gbs = (best[2] > 0.0) ? 3.0 * bytes / (best[2] * 1e9) : 0.0;
+  out.triad_gbs = (best[3] > 0.0) ? 3.0 * bytes / (best[3] * 1e9) : 0.0;
+  return out;
+}
+
+/**
+ * @brief STREAM with the largest array length (up to kStreamElements) that
+ *        can be allocated.
+ */
+static StreamRates measure_stream_fitting(int threads) {
+  for (std::size_t n = kStreamElements; n >= kStreamMinElements; n /= 2) {
+    try {
+      return measure_stream(n, threads);
+    } catch (const std::bad_alloc&) {
+      // Retry with half the arrays
+    }
+  }
+  return StreamRates();
+}
+
+void measure_roofline(Roofline& out) {
+  out = Roofline();
+  out.host = host_name();
+  out.threads = default_threads();
+  out.fma_gflops_serial = measure_fma_gflops(1);
+  out.fma_gflops = (out.threads > 1) ? measure_fma_gflops(out.threads) : out.fma_gflops_serial;
+  out.stream_serial = measure_stream_fitting(1);
+  out.stream = (out.threads > 1) ? measure_stream_fitting(out.threads) : out.stream_serial;
+}
+
+std::string roofline_cache_path(const std::string& host) {
+  const char* dir = std::getenv("PERF_ROOFLINE_DIR");
+  if (!dir || !*dir) {
+    dir = std::getenv("HOME");
+  }
+  std::string path = (dir && *dir) ? std::string(dir) + "/" : std::string();
+  return path + ".perf-roofline-" + host;
+}
+
+bool load_roofline(const std::string& path, const std::string& host, Roofline& out,
+                   std::string& err) {
+  std::ifstream in(path.c_str());
+  if (!in) {
+    err = "no roofline cache at " + path;
+    return false;
+  }
+  Roofline r;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    const std::string::size_type eq = line.find('=');
+    if (eq == std::string::npos) {
+      err = "malformed line in " + path + ": " + line;
+      return false;
+    }
+    const std::string key = line.substr(0, eq);
+    const std::string val = line.substr(eq + 1);
+    const double v = std::atof(val.c_str());
+    if (key == "host") {
+      r.host = val;
+    } else if (key == "threads") {
+      r.threads = std::atoi(val.c_str());
+    } else if (key == "fma_gflops_serial") {
+      r.fma_gflops_serial = v;
+    } else if (key == "fma_gflops") {
+      r.fma_gflops = v;
+    } else if (key == "copy_gbs_serial") {
+      r.stream_serial.copy_gbs = v;
+    } else if (key == "scale_gbs_serial") {
+      r.stream_serial.scale_gbs = v;
+    } else if (key == "add_gbs_serial") {
+      r.stream_serial.add_gbs = v;
+    } else if (key == "triad_gbs_serial") {
+      r.stream_serial.triad_gbs = v;
+    } else if (key == "copy_gbs") {
+      r.stream.copy_gbs = v;
+    } else if (key == "scale_gbs") {
+      r.stream.scale_gbs = v;
+    } else if (key == "add_gbs") {
+      r.stream.add_gbs = v;
+    } else if (key == "triad_gbs") {
+      r.stream.triad_gbs = v;
+    }
+    // Unknown keys are ignored so newer files stay readable
+  }
+  if (r.host != host) {
+    err = path + " was measured on host '" + r.host + "'";
+    return false;
+  }
+  if (r.threads < 1 || r.fma_gflops_serial <= 0.0 || r.fma_gflops <= 0.0 ||
+      r.stream_serial.triad_gbs <= 0.0 || r.stream.triad_gbs <= 0.0) {
+    err = "invalid values in " + path;
+    return false;
+  }
+  out = r;
+  return true;
+}
+
+bool save_roofline(const std::string& path, const Roofline& r, std::string& err) {
+  std::ofstream out(path.c_str());
+  if (!out) {
+    err = "cannot write roofline cache " + path;
+    return false;
+  }
+  out << "# roofline ceilings (written by perf-roofline or the first driver run)\n"
+      << "host=" << r.host << "\n"
+      << "threads=" << r.threads << "\n"
+      << "fma_gflops_serial=" << r.fma_gflops_serial << "\n"
+      << "fma_gflops=" << r.fma_gflops << "\n"
+      << "copy_gbs_serial=" << r.stream_serial.copy_gbs << "\n"
+      << "scale_gbs_serial=" << r.stream_serial.scale_gbs << "\n"
+      << "add_gbs_serial=" << r.stream_serial.add_gbs << "\n"
+      << "triad_gbs_serial=" << r.stream_serial.triad_gbs << "\n"
+      << "copy_gbs=" << r.stream.copy_gbs << "\n"
+      << "scale_gbs=" << r.stream.scale_gbs << "\n"
+      << "add_gbs=" << r.stream.add_gbs << "\n"
+      << "triad_gbs=" << r.stream.triad_gbs << "\n";
+  out.flush();
+  if (!out) {
+    err = "write failed for " + path;
+    return false;
+  }
+  return true;
+}
+
+bool acquire_roofline(Roofline& out, std::string& err) {
+  const std::string host = host_name();
+  const std::string path = roofline_cache_path(host);
+  std::string load_err;
+  if (load_roofline(path, host, out, load_err) && out.threads == default_threads()) {
+    return false;
+  }
+  measure_roofline(out);
+  save_roofline(path, out, err);
+  return true;
+}
+
+Ceiling serial_ceiling(const Roofline& r) {
+  return Ceiling(r.fma_gflops_serial, r.stream_serial.triad_gbs);
+}
+
+Ceiling parallel_ceiling(const Roofline& r) {
+  return Ceiling(r.fma_gflops, r.stream.triad_gbs);
+}
+
+RooflinePoint roofline_point(const Ceiling& c, double flops, double bytes, double seconds) {
+  RooflinePoint p;
+  const double gflops = (seconds > 0.0) ? flops / (seconds * 1e9) : 0.0;
+  p.ai = (bytes > 0.0) ? flops / bytes : HUGE_VAL;
+  const double mem_bound = (bytes > 0.0) ? p.ai * c.bw_gbs : HUGE_VAL;
+  p.memory_bound = mem_bound < c.peak_gflops;
+  p.attainable_gflops = p.memory_bound ? mem_bound : c.peak_gflops;
+  p.pct_peak = (c.peak_gflops > 0.0) ? 100.0 * gflops / c.peak_gflops : 0.0;
+  p.pct_attainable = (p.attainable_gflops > 0.0) ? 100.0 * gflops / p.attainable_gflops : 0.0;
+  return p;
+}
+
+std::string format_roofline(const Ceiling& c, const RooflinePoint& p) {
+  std::ostringstream oss;
+  oss.setf(std::ios::fixed);
+  oss.precision(2);
+  oss << "roofline: ai=";
+  if (p.ai == HUGE_VAL) {
+    oss << "inf";
+  } else {
+    oss << p.ai;
+  }
+  oss << " bound=" << (p.memory_bound ? "memory" : "compute")
+      << " attainable_gflops=" << p.attainable_gflops
+      << " peak_gflops=" << c.peak_gflops
+      << " bw_gbs=" << c.bw_gbs
+      << " pct_peak=" << p.pct_peak << "%"
+      << " pct_attainable=" << p.pct_attainable << "%";
+  return oss.str();
+}
+
+} // namespace perf
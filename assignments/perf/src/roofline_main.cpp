@@ -0,0 +1,58 @@
+/**
+ * @file roofline_main.cpp
+ * @brief perf-roofline: measure this host's ceilings and write the cache.
+ *
+ * Run once per host (with the OMP_NUM_THREADS the drivers will use) before
+ * MPI jobs; single-process drivers also measure on first use. Prints the
+ * figures and the cache path.
+ *
+ * Usage: perf-roofline
+ */
+
+#include "perf/roofline.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+static void print_line(const std::string& s) {
+  std::cout << "[INFO] " << s << std::endl;
+}
+
+static std::string format_stream(const char* label, const perf::StreamRates& s) {
+  std::ostringstream oss;
+  oss.setf(std::ios::fixed);
+  oss.precision(2);
+  oss << label << " copy_gbs=" << s.copy_gbs << " scale_gbs=" << s.scale_gbs
+      << " add_gbs=" << s.add_gbs << " triad_gbs=" << s.triad_gbs;
+  return oss.str();
+}
+
+int main(int argc, char** argv) {
+  (void)argv;
+  if (argc != 1) {
+    std::cerr << "Usage: perf-roofline" << std::endl;
+    return 1;
+  }
+  perf::Roofline r;
+  perf::measure_roofline(r);
+  {
+    std::ostringstream oss;
+    oss.setf(std::ios::fixed);
+    oss.precision(2);
+    oss << "host=" << r.host << " threads=" << r.threads
+        << " fma_gflops_serial=" << r.fma_gflops_serial << " fma_gflops=" << r.fma_gflops;
+    print_line(oss.str());
+  }
+  print_line(format_stream("stream serial:", r.stream_serial));
+  print_line(format_stream("stream threads:", r.stream));
+
+  const std::string path = perf::roofline_cache_path(r.host);
+  std::string err;
+  if (!perf::save_roofline(path, r, err)) {
+    std::cerr << "[ERROR] " << err << std::endl;
+    return 1;
+  }
+  print_line("cache=" + path);
+  return 0;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file sysmem.cpp
+ * @brief Available-memory probes behind the drivers' allocation guards.
+ */
+
+#include "perf/sysmem.h"
+
+#include <cstdio>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+namespace perf {
+
+// Used when no probe works: the drivers' former fixed guard
+static const std::size_t kFallbackBudget = static_cast<std::size_t>(1) << 30;
+
+// Parse "MemAvailable:  123456 kB"; 0 if the file or the line is absent
+static std::size_t meminfo_available() {
+  std::FILE* f = std::fopen("/proc/meminfo", "r");
+  if (!f) {
+    return 0;
+  }
+  char line[256];
+  std::size_t bytes = 0;
+  while (std::fgets(line, sizeof(line), f)) {
+    if (std::strncmp(line, "MemAvailable:", 13) == 0) {
+      unsigned long kb = 0;
+      if (std::sscanf(line + 13, "%lu", &kb) == 1) {
+        bytes = static_cast<std::size_t>(kb) * 1024;
+      }
+      break;
+    }
+  }
+  std::fclose(f);
+  return bytes;
+}
+
+std::size_t available_memory_bytes() {
+  const std::size_t mem = meminfo_available();
+  if (mem > 0) {
+    return mem;
+  }
+#if defined(_SC_AVPHYS_PAGES) && defined(_SC_PAGESIZE)
+  const long pages = sysconf(_SC_AVPHYS_PAGES);
+  const long page = sysconf(_SC_PAGESIZE);
+  if (pages > 0 && page > 0) {
+    return static_cast<std::size_t>(pages) * static_cast<std::size_t>(page);
+  }
+#endif
+  return 0;
+}
+
+std::size_t memory_budget_bytes() {
+  const std::size_t avail = available_memory_bytes();
+  if (avail == 0) {
+    return kFallbackBudget;
+  }
+  return avail / 4 * 3;
+}
+
+} // namespace perf
@@ -0,0 +1,232 @@
+/**
+ * @file trace.cpp
+ * @brief Per-thread event buffers and the Chrome trace writer.
+ *
+ * Each thread appends to a buffer only it writes; new buffers are pushed onto
+ * a list with compare-and-swap, so recording never takes a lock. The buffers
+ * are read by trace_stop() only, once the recording threads are done (a
+ * parallel region's join or a thread join orders their writes before it).
+ */
+
+#include "perf/trace.h"
+#include "perf/bench.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+#if defined(_MSC_VER)
+#define PERF_TRACE_TLS __declspec(thread)
+#else
+#define PERF_TRACE_TLS __thread
+#endif
+
+namespace perf {
+
+TraceEvent::TraceEvent() : ph('B'), ts(0.0), pid(0), tid(0) {}
+
+namespace {
+
+struct Record {
+  const char* name;
+  double ts;
+  char ph;
+};
+
+struct Buffer {
+  Buffer* next;
+  int tid;
+  std::vector<Record> records;
+  unsigned long dropped;
+  std::size_t open;  // kept begins whose end is still to come
+  std::size_t skip;  // nesting depth inside a dropped begin
+};
+
+bool push_buffer(Buffer* volatile* list, Buffer* expected, Buffer* desired) {
+#if defined(_MSC_VER)
+  return InterlockedCompareExchangePointer(reinterpret_cast<PVOID volatile*>(list), desired,
+                                           expected) == expected;
+#else
+  return __sync_bool_compare_and_swap(list, expected, desired);
+#endif
+}
+
+int next_tid(volatile long* counter) {
+#if defined(_MSC_VER)
+  return static_cast<int>(InterlockedIncrement(counter) - 1);
+#else
+  return static_cast<int>(__sync_fetch_and_add(counter, 1L));
+#endif
+}
+
+volatile int g_enabled = 0;
+volatile int g_generation = 0;
+volatile long g_next_tid = 0;
+int g_pid = 0;
+std::size_t g_capacity = 0;
+Buffer* volatile g_buffers = 0;
+
+// The calling thread's buffer for this session, created on first use
+PERF_TRACE_TLS Buffer* t_buffer = 0;
+PERF_TRACE_TLS int t_generation = -1;
+
+Buffer* my_buffer() {
+  if (t_buffer && t_generation == g_generation) {
+    return t_buffer;
+  }
+  Buffer* b = new Buffer;
+  b->tid = next_tid(&g_next_tid);
+  b->dropped = 0;
+  b->open = 0;
+  b->skip = 0;
+  b->records.reserve(std::min(g_capacity, static_cast<std::size_t>(1024)));
+  do {
+    b->next = g_buffers;
+  } while (!push_buffer(&g_buffers, b->next, b));
+  t_buffer = b;
+  t_generation = g_generation;
+  return b;
+}
+
+void record(const char* name, char ph) {
+  if (!g_enabled) {
+    return;
+  }
+  const double ts = now_seconds();
+  Buffer* b = my_buffer();
+  // A begin is kept only with room for its end and the ends of the phases
+  // still open, so every kept begin gets its end. A dropped begin drops the
+  // phases nested in it and its own end, and the trace stays balanced.
+  if (ph == 'B') {
+    if (b->skip > 0 || b->records.size() + b->open + 2 > g_capacity) {
+      ++b->skip;
+      ++b->dropped;
+      return;
+    }
+    ++b->open;
+  } else if (b->skip > 0) {
+    --b->skip;
+    ++b->dropped;
+    return;
+  } else if (b->open > 0) {
+    --b->open;
+  } else if (b->records.size() >= g_capacity) {
+    // End of a phase begun before trace_start()
+    ++b->dropped;
+    return;
+  }
+  Record r;
+  r.name = name;
+  r.ts = ts;
+  r.ph = ph;
+  b->records.push_back(r);
+}
+
+// Frees the buffers of the current session; returns the dropped count
+unsigned long collect(std::vector<TraceEvent>* out) {
+  unsigned long dropped = 0;
+  Buffer* b = g_buffers;
+  g_buffers = 0;
+  while (b) {
+    if (out) {
+      for (std::size_t i = 0; i < b->records.size(); ++i) {
+        TraceEvent e;
+        e.name = b->records[i].name;
+        e.ph = b->records[i].ph;
+        e.ts = b->records[i].ts;
+        e.pid = g_pid;
+        e.tid = b->tid;
+        out->push_back(e);
+      }
+    }
+    dropped += b->dropped;
+    Buffer* next = b->next;
+    delete b;
+    b = next;
+  }
+  g_next_tid = 0;
+  return dropped;
+}
+
+bool earlier(const TraceEvent& a, const TraceEvent& b) {
+  return a.ts < b.ts;
+}
+
+} // namespace
+
+void trace_start(int pid, int capacity) {
+  g_enabled = 0;
+  collect(0);
+  g_pid = pid;
+  g_capacity = (capacity > 0) ? static_cast<std::size_t>(capacity) : 0;
+  g_generation = g_generation + 1;
+  g_enabled = 1;
+}
+
+bool trace_enabled() {
+  return g_enabled != 0;
+}
+
+void trace_begin(const char* name) {
+  record(name, 'B');
+}
+
+void trace_end(const char* name) {
+  record(name, 'E');
+}
+
+unsigned long trace_stop(std::vector<TraceEvent>& out) {
+  g_enabled = 0;
+  out.clear();
+  const unsigned long dropped = collect(&out);
+  g_generation = g_generation + 1;
+  // Stable: a zero-length phase keeps its begin before its end
+  std::stable_sort(out.begin(), out.end(), earlier);
+  return dropped;
+}
+
+bool write_chrome_trace(const std::string& path, const std::vector<TraceEvent>& events,
+                        const std::vector<std::string>& process_names, std::string& err) {
+  std::ofstream out(path.c_str());
+  if (!out) {
+    err = "cannot write " + path;
+    return false;
+  }
+  double t0 = 0.0;
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    if (i == 0 || events[i].ts < t0) {
+      t0 = events[i].ts;
+    }
+  }
+  out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+  const char* sep = "\n";
+  for (std::size_t p = 0; p < process_names.size(); ++p) {
+    out << sep << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << p
+        << ", \"tid\": 0, \"args\": {\"name\": " << json_string(process_names[p]) << "}}";
+    sep = ",\n";
+  }
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    const TraceEvent& e = events[i];
+    char ts[32];
+    std::sprintf(ts, "%.3f", (e.ts - t0) * 1e6);
+    out << sep << "{\"name\": " << json_string(e.name) << ", \"ph\": \"" << e.ph
+        << "\", \"ts\": " << ts << ", \"pid\": " << e.pid << ", \"tid\": " << e.tid << "}";
+    sep = ",\n";
+  }
+  out << "\n]}\n";
+  out.close();
+  if (!out) {
+    err = "cannot write " + path;
+    return false;
+  }
+  return true;
+}
+
+} // namespace perf
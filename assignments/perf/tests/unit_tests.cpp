@@ -0,0 +1,602 @@
+// unit_tests.cpp: Unity-based tests for the shared perf library.
+#include "perf/bench.h"
+#include "perf/counters.h"
+#include "perf/freivalds.h"
+#include "perf/histogram.h"
+#include "perf/log.h"
+#include "perf/regress.h"
+#include "perf/roofline.h"
+#include "perf/sysmem.h"
+#include "perf/trace.h"
+
+extern "C" {
+#include "vendor/unity/unity.h"
+}
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+// AI below the ridge point is memory bound, above it compute bound, and a
+// kernel that moves no bytes is compute bound with infinite AI.
+static void test_roofline_point(void)
+{
+    const perf::Ceiling c(10.0, 5.0);  // ridge at AI = 2 flops/byte
+
+    const perf::RooflinePoint mem = perf::roofline_point(c, 1e9, 1e9, 0.5);
+    TEST_ASSERT_TRUE(mem.memory_bound);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-12, 1.0, mem.ai);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 5.0, mem.attainable_gflops);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 20.0, mem.pct_peak);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 40.0, mem.pct_attainable);
+
+    const perf::RooflinePoint cpu = perf::roofline_point(c, 8e9, 1e9, 1.0);
+    TEST_ASSERT_TRUE(!cpu.memory_bound);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 10.0, cpu.attainable_gflops);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 80.0, cpu.pct_attainable);
+
+    const perf::RooflinePoint reg = perf::roofline_point(c, 1e9, 0.0, 1.0);
+    TEST_ASSERT_TRUE(!reg.memory_bound);
+    TEST_ASSERT_TRUE(reg.ai == HUGE_VAL);
+    TEST_ASSERT_TRUE(perf::format_roofline(c, reg).find("ai=inf") != std::string::npos);
+}
+
+// A saved cache reads back unchanged and is rejected for another host.
+static void test_roofline_cache_roundtrip(void)
+{
+    const std::string path = "perf_test_roofline_cache";
+    perf::Roofline r;
+    r.host = "nodeA";
+    r.threads = 4;
+    r.fma_gflops_serial = 2.5;
+    r.fma_gflops = 9.75;
+    r.stream_serial.triad_gbs = 6.5;
+    r.stream.triad_gbs = 18.25;
+    r.stream.copy_gbs = 17.0;
+    std::string err;
+    TEST_ASSERT_TRUE(perf::save_roofline(path, r, err));
+
+    perf::Roofline got;
+    TEST_ASSERT_TRUE(perf::load_roofline(path, "nodeA", got, err));
+    TEST_ASSERT_TRUE(got.threads == 4);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-12, 2.5, got.fma_gflops_serial);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-12, 9.75, got.fma_gflops);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-12, 18.25, perf::parallel_ceiling(got).bw_gbs);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-12, 6.5, perf::serial_ceiling(got).bw_gbs);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-12, 17.0, got.stream.copy_gbs);
+
+    TEST_ASSERT_TRUE(!perf::load_roofline(path, "nodeB", got, err));
+    std::remove(path.c_str());
+}
+
+// Small measurements complete and give positive rates.
+static void test_measurements_positive(void)
+{
+    TEST_ASSERT_TRUE(perf::measure_fma_gflops(1) > 0.0);
+    const perf::StreamRates s = perf::measure_stream(1 << 16, 1);
+    TEST_ASSERT_TRUE(s.copy_gbs > 0.0);
+    TEST_ASSERT_TRUE(s.triad_gbs > 0.0);
+}
+
+// Sums keep only counters valid in every part; n/a is printed for the rest.
+static void test_counter_sum_and_format(void)
+{
+    std::vector<perf::CounterValues> parts(2);
+    for (int t = 0; t < 2; ++t)
+    {
+        parts[t].valid[perf::COUNTER_CYCLES] = true;
+        parts[t].valid[perf::COUNTER_INSTRUCTIONS] = true;
+        parts[t].value[perf::COUNTER_CYCLES] = 100.0;
+        parts[t].value[perf::COUNTER_INSTRUCTIONS] = 150.0;
+    }
+    parts[1].valid[perf::COUNTER_FP_OPS] = true;
+    parts[1].multiplexed = true;
+
+    const perf::CounterValues total = perf::sum_counters(parts);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-12, 200.0, total.value[perf::COUNTER_CYCLES]);
+    TEST_ASSERT_TRUE(total.valid[perf::COUNTER_INSTRUCTIONS]);
+    TEST_ASSERT_TRUE(!total.valid[perf::COUNTER_FP_OPS]);
+    TEST_ASSERT_TRUE(total.multiplexed);
+
+    const std::string line = perf::format_counters(total);
+    TEST_ASSERT_TRUE(line.find("ipc=1.5") != std::string::npos);
+    TEST_ASSERT_TRUE(line.find("fp_ops=n/a") != std::string::npos);
+    TEST_ASSERT_TRUE(line.find("multiplexed=yes") != std::string::npos);
+}
+
+// Opening counters either works (and counts a loop) or fails with a reason;
+// it never aborts, whatever the platform or perf_event_paranoid allow.
+static void test_counters_open_or_explain(void)
+{
+    perf::CounterSet ctr;
+    std::string err;
+    if (!ctr.open(1, err))
+    {
+        TEST_ASSERT_TRUE(!err.empty());
+        TEST_ASSERT_TRUE(!ctr.is_open());
+        return;
+    }
+    ctr.start();
+    TEST_ASSERT_TRUE(perf::measure_fma_gflops(1) > 0.0);
+    ctr.stop();
+    const perf::CounterValues v = ctr.read_total();
+    if (v.valid[perf::COUNTER_INSTRUCTIONS])
+    {
+        TEST_ASSERT_TRUE(v.value[perf::COUNTER_INSTRUCTIONS] > 0.0);
+    }
+    ctr.close();
+    TEST_ASSERT_TRUE(!ctr.is_open());
+}
+
+// A slow sample far from the rest is dropped; the others give exact
+// statistics, and k = 0 keeps everything.
+static void test_summarize_outliers(void)
+{
+    std::vector<double> t;
+    t.push_back(1.0);
+    t.push_back(1.2);
+    t.push_back(0.8);
+    t.push_back(1.1);
+    t.push_back(0.9);
+    t.push_back(9.0);
+
+    const perf::Stats s = perf::summarize(t, 3.0);
+    TEST_ASSERT_TRUE(s.samples == 6);
+    TEST_ASSERT_TRUE(s.kept == 5);
+    TEST_ASSERT_TRUE(s.outliers == 1);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-12, 0.8, s.min);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-12, 1.2, s.max);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-12, 1.0, s.median);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-12, 1.0, s.mean);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-12, std::sqrt(0.025), s.stddev);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 2.776 * std::sqrt(0.025) / std::sqrt(5.0), s.ci95);
+
+    const perf::Stats all = perf::summarize(t, 0.0);
+    TEST_ASSERT_TRUE(all.kept == 6);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-12, 9.0, all.max);
+    TEST_ASSERT_TRUE(perf::summarize(std::vector<double>(), 3.0).kept == 0);
+}
+
+// The sampler runs warm-up plus timed runs and times only the latter.
+static void test_sampler_runs(void)
+{
+    perf::BenchConfig cfg;
+    cfg.warmup = 2;
+    cfg.reps = 3;
+    perf::Sampler s(cfg);
+    int runs = 0;
+    int warm = 0;
+    while (s.next())
+    {
+        ++runs;
+        warm += s.warming_up() ? 1 : 0;
+    }
+    TEST_ASSERT_TRUE(runs == 5);
+    TEST_ASSERT_TRUE(warm == 2);
+    TEST_ASSERT_TRUE(s.samples().size() == 3);
+    TEST_ASSERT_TRUE(s.stats().min >= 0.0);
+    TEST_ASSERT_TRUE(perf::now_seconds() > 0.0);
+}
+
+// Harness options are recognized, validated, or left to the driver.
+static void test_parse_bench_option(void)
+{
+    const char* args[] = { "prog", "--reps", "7", "--csv", "out.csv", "--warmup", "-1", "--n" };
+    char** argv = const_cast<char**>(args);
+    perf::BenchConfig cfg;
+    std::string err;
+    int i = 1;
+    TEST_ASSERT_TRUE(perf::parse_bench_option(8, argv, i, cfg, err) == 1);
+    TEST_ASSERT_TRUE(i == 3 && cfg.reps == 7);
+    TEST_ASSERT_TRUE(perf::parse_bench_option(8, argv, i, cfg, err) == 1);
+    TEST_ASSERT_TRUE(cfg.csv_path == "out.csv");
+    TEST_ASSERT_TRUE(perf::parse_bench_option(8, argv, i, cfg, err) == -1);
+    i = 7;
+    TEST_ASSERT_TRUE(perf::parse_bench_option(8, argv, i, cfg, err) == 0);
+}
+
+// JSON holds the parameters as an object; CSV gets one header and a row per run.
+static void test_report_files(void)
+{
+    perf::BenchConfig cfg;
+    cfg.json_path = "perf_test_bench.json";
+    cfg.csv_path = "perf_test_bench.csv";
+    std::remove(cfg.csv_path.c_str());
+    std::vector<double> t(3, 0.5);
+    perf::BenchReport report("demo");
+    report.add("N=64 mode=blocked", t, perf::summarize(t, 3.0));
+    std::string err;
+    TEST_ASSERT_TRUE(report.write(cfg, err));
+    TEST_ASSERT_TRUE(report.write(cfg, err));
+
+    std::ifstream json(cfg.json_path.c_str());
+    const std::string doc((std::istreambuf_iterator<char>(json)), std::istreambuf_iterator<char>());
+    TEST_ASSERT_TRUE(doc.find("\"params\": {\"N\": 64, \"mode\": \"blocked\"}") != std::string::npos);
+    TEST_ASSERT_TRUE(doc.find("\"median_s\": 0.5") != std::string::npos);
+
+    std::ifstream csv(cfg.csv_path.c_str());
+    std::string line;
+    int lines = 0;
+    int headers = 0;
+    while (std::getline(csv, line))
+    {
+        ++lines;
+        headers += (line.compare(0, 10, "benchmark,") == 0) ? 1 : 0;
+    }
+    TEST_ASSERT_TRUE(lines == 3);
+    TEST_ASSERT_TRUE(headers == 1);
+    std::remove(cfg.json_path.c_str());
+    std::remove(cfg.csv_path.c_str());
+}
+
+// Quotes, backslashes and control characters are escaped; the rest is copied.
+static void test_json_string(void)
+{
+    TEST_ASSERT_TRUE(perf::json_string("N=64") == "\"N=64\"");
+    TEST_ASSERT_TRUE(perf::json_string("a\"b\\c") == "\"a\\\"b\\\\c\"");
+    TEST_ASSERT_TRUE(perf::json_string(std::string("x\ny\x01")) == "\"x\\u000ay\\u0001\"");
+}
+
+// Medians inside the band pass, slower ones regress, and no baseline is new.
+static void test_compare_to_baseline(void)
+{
+    TEST_ASSERT_TRUE(perf::compare_to_baseline(1.0, 0.0, 0.1) == perf::VERDICT_NEW);
+    TEST_ASSERT_TRUE(perf::compare_to_baseline(1.05, 1.0, 0.1) == perf::VERDICT_OK);
+    TEST_ASSERT_TRUE(perf::compare_to_baseline(0.95, 1.0, 0.1) == perf::VERDICT_OK);
+    TEST_ASSERT_TRUE(perf::compare_to_baseline(1.2, 1.0, 0.1) == perf::VERDICT_REGRESSION);
+    TEST_ASSERT_TRUE(perf::compare_to_baseline(0.8, 1.0, 0.1) == perf::VERDICT_FASTER);
+    TEST_ASSERT_TRUE(std::string(perf::verdict_name(perf::VERDICT_REGRESSION)) == "REGRESSION");
+}
+
+// Harness CSV rows read back as results; a baseline saved from them reloads
+// unchanged, and a missing baseline file is empty rather than an error.
+static void test_baseline_roundtrip(void)
+{
+    perf::BenchConfig cfg;
+    cfg.csv_path = "perf_test_regress.csv";
+    std::remove(cfg.csv_path.c_str());
+    std::vector<double> t(3, 0.25);
+    perf::BenchReport report("demo");
+    report.add("N=64 mode=blocked", t, perf::summarize(t, 3.0));
+    report.add("N=128 mode=blocked", t, perf::summarize(t, 3.0));
+    std::string err;
+    TEST_ASSERT_TRUE(report.write(cfg, err));
+
+    std::vector<perf::RunResult> runs;
+    TEST_ASSERT_TRUE(perf::read_run_csv(cfg.csv_path, runs, err));
+    TEST_ASSERT_TRUE(runs.size() == 2);
+    TEST_ASSERT_TRUE(runs[1].params == "N=128 mode=blocked");
+    TEST_ASSERT_DOUBLE_WITHIN(1e-12, 0.25, runs[1].median_s);
+    std::remove(cfg.csv_path.c_str());
+    TEST_ASSERT_TRUE(!perf::read_run_csv(cfg.csv_path, runs, err));
+
+    const std::string path = perf::baseline_path(".", "perf_test_host");
+    std::remove(path.c_str());
+    perf::Baseline b;
+    TEST_ASSERT_TRUE(perf::load_baseline(path, b, err));
+    TEST_ASSERT_TRUE(b.tests.empty());
+    b.set("demo", "N=64 mode=blocked", 0.5);
+    b.set("demo", "N=128 mode=blocked", 0.75);
+    b.set("demo", "N=128 mode=blocked", 1.5);
+    TEST_ASSERT_TRUE(perf::save_baseline(path, b, err));
+
+    perf::Baseline got;
+    TEST_ASSERT_TRUE(perf::load_baseline(path, got, err));
+    TEST_ASSERT_TRUE(got.tests.size() == 2);
+    const int i = got.find("demo", "N=128 mode=blocked");
+    TEST_ASSERT_TRUE(i >= 0);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-12, 1.5, got.median_s[i]);
+    TEST_ASSERT_TRUE(got.find("other", "N=128 mode=blocked") == -1);
+    std::remove(path.c_str());
+}
+
+// The log file gets tagged lines, long messages whole, and a count of the
+// messages a full ring dropped; rank files get a suffix.
+static void test_log_file(void)
+{
+    TEST_ASSERT_TRUE(perf::log_file_path("run.log", 0, 1) == "run.log");
+    TEST_ASSERT_TRUE(perf::log_file_path("run.log", 3, 4) == "run.log.3");
+
+    perf::LogConfig cfg;
+    cfg.path = "perf_test_log.txt";
+    cfg.console = false;
+    cfg.capacity = 16;
+    cfg.flush_interval_s = 5.0;  // nothing drains until log_close()
+    std::string err;
+    TEST_ASSERT_TRUE(perf::log_open(cfg, err));
+    TEST_ASSERT_TRUE(perf::log_is_open());
+    perf::log_printf(perf::LOG_DEBUG, "first %d", 1);
+    const std::string long_msg(500, 'x');
+    perf::log_write(perf::LOG_INFO, long_msg);
+    for (int i = 0; i < 40; ++i)
+    {
+        perf::log_printf(perf::LOG_DEBUG, "fill %d", i);
+    }
+    perf::log_close();
+    TEST_ASSERT_TRUE(!perf::log_is_open());
+
+    std::ifstream in(cfg.path.c_str());
+    const std::string doc((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    TEST_ASSERT_TRUE(doc.compare(0, 11, "# perf log:") == 0);
+    TEST_ASSERT_TRUE(doc.find(" r0 t0 DEBUG first 1\n") != std::string::npos);
+    TEST_ASSERT_TRUE(doc.find(" r0 t0 INFO " + long_msg + "\n") != std::string::npos);
+    TEST_ASSERT_TRUE(doc.find("fill 10\n") != std::string::npos);
+    TEST_ASSERT_TRUE(doc.find("fill 39\n") == std::string::npos);
+    TEST_ASSERT_TRUE(doc.find("log: 28 messages dropped") != std::string::npos);
+    std::remove(cfg.path.c_str());
+}
+
+// Message i of producer t: every fifth spans several ring slots, and the
+// filler letter names the producer, so a torn or mixed line shows.
+static std::string producer_message(int t, int i)
+{
+    std::ostringstream oss;
+    oss << "p" << t << " m" << i << " " << std::string(i % 5 == 0 ? 600 : 20, static_cast<char>('a' + t));
+    return oss.str();
+}
+
+static const int kProducers = 4;
+static const int kMessages = 500;
+
+#if defined(_WIN32)
+static DWORD WINAPI producer_main(LPVOID arg)
+#else
+extern "C" void* perf_test_producer_main(void* arg)
+#endif
+{
+    const int t = static_cast<int>(reinterpret_cast<std::size_t>(arg));
+    for (int i = 0; i < kMessages; ++i)
+    {
+        perf::log_write(perf::LOG_DEBUG, producer_message(t, i));
+    }
+    return 0;
+}
+
+// Several threads logging while the flusher drains: every message arrives
+// exactly once and whole.
+static void test_log_threads(void)
+{
+    perf::LogConfig cfg;
+    cfg.path = "perf_test_log_threads.txt";
+    cfg.console = false;
+    cfg.capacity = 4096;         // room for every message: none dropped
+    cfg.flush_interval_s = 0.001;  // drain while the producers write
+    std::string err;
+    TEST_ASSERT_TRUE(perf::log_open(cfg, err));
+#if defined(_WIN32)
+    HANDLE threads[kProducers];
+    for (std::size_t t = 0; t < static_cast<std::size_t>(kProducers); ++t)
+    {
+        threads[t] = CreateThread(0, 0, producer_main, reinterpret_cast<LPVOID>(t), 0, 0);
+        TEST_ASSERT_TRUE(threads[t] != 0);
+    }
+    for (int t = 0; t < kProducers; ++t)
+    {
+        WaitForSingleObject(threads[t], INFINITE);
+        CloseHandle(threads[t]);
+    }
+#else
+    pthread_t threads[kProducers];
+    for (std::size_t t = 0; t < static_cast<std::size_t>(kProducers); ++t)
+    {
+        TEST_ASSERT_TRUE(pthread_create(&threads[t], 0, perf_test_producer_main,
+                                        reinterpret_cast<void*>(t)) == 0);
+    }
+    for (int t = 0; t < kProducers; ++t)
+    {
+        pthread_join(threads[t], 0);
+    }
+#endif
+    perf::log_close();
+
+    std::vector<int> seen(kProducers * kMessages, 0);
+    std::ifstream in(cfg.path.c_str());
+    std::string line;
+    int lines = 0;
+    while (std::getline(in, line))
+    {
+        const std::size_t at = line.find(" DEBUG ");
+        if (line.empty() || line[0] == '#' || at == std::string::npos)
+        {
+            continue;
+        }
+        ++lines;
+        const std::string msg = line.substr(at + 7);
+        int t = -1, i = -1;
+        TEST_ASSERT_TRUE(std::sscanf(msg.c_str(), "p%d m%d", &t, &i) == 2);
+        TEST_ASSERT_TRUE(t >= 0 && t < kProducers && i >= 0 && i < kMessages);
+        TEST_ASSERT_TRUE(msg == producer_message(t, i));
+        ++seen[t * kMessages + i];
+    }
+    TEST_ASSERT_TRUE(lines == kProducers * kMessages);
+    for (std::size_t k = 0; k < seen.size(); ++k)
+    {
+        TEST_ASSERT_TRUE(seen[k] == 1);
+    }
+    in.close();
+    std::remove(cfg.path.c_str());
+}
+
+// A full buffer drops whole phases, so the trace stays balanced.
+static void test_trace_events(void)
+{
+    std::vector<perf::TraceEvent> events;
+    TEST_ASSERT_TRUE(!perf::trace_enabled());
+    {
+        perf::TraceScope off("off");  // not recorded
+    }
+    perf::trace_start(2, 5);
+    TEST_ASSERT_TRUE(perf::trace_enabled());
+    {
+        perf::TraceScope outer("outer");
+        perf::TraceScope inner("in\"ner");
+        perf::TraceScope nested("dropped");  // no room left for its end: dropped
+        perf::TraceScope deeper("dropped");  // inside a dropped phase
+    }
+    perf::trace_begin("late");  // 4 of 5 used: the pair does not fit
+    perf::trace_end("late");
+    TEST_ASSERT_TRUE(perf::trace_stop(events) == 6);
+    TEST_ASSERT_TRUE(!perf::trace_enabled());
+
+    // Balanced: every end closes the phase begun last, and none stays open
+    std::vector<std::string> open;
+    for (std::size_t i = 0; i < events.size(); ++i)
+    {
+        if (events[i].ph == 'B')
+        {
+            open.push_back(events[i].name);
+        }
+        else
+        {
+            TEST_ASSERT_TRUE(!open.empty() && open.back() == events[i].name);
+            open.pop_back();
+        }
+    }
+    TEST_ASSERT_TRUE(open.empty());
+
+    TEST_ASSERT_TRUE(events.size() == 4);
+    TEST_ASSERT_TRUE(events[0].name == "outer" && events[0].ph == 'B');
+    TEST_ASSERT_TRUE(events[1].name == "in\"ner" && events[1].ph == 'B');
+    TEST_ASSERT_TRUE(events[2].name == "in\"ner" && events[2].ph == 'E');
+    TEST_ASSERT_TRUE(events[3].name == "outer" && events[3].ph == 'E');
+    TEST_ASSERT_TRUE(events[0].pid == 2 && events[0].tid == 0);
+    TEST_ASSERT_TRUE(events[3].ts >= events[0].ts);
+
+    const std::string path = "perf_test_trace.json";
+    std::vector<std::string> names(3, "rank");
+    std::string err;
+    TEST_ASSERT_TRUE(perf::write_chrome_trace(path, events, names, err));
+    std::ifstream in(path.c_str());
+    const std::string doc((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    TEST_ASSERT_TRUE(doc.find("\"traceEvents\": [") != std::string::npos);
+    TEST_ASSERT_TRUE(doc.find("{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 2") !=
+                     std::string::npos);
+    TEST_ASSERT_TRUE(doc.find("{\"name\": \"outer\", \"ph\": \"B\", \"ts\": 0.000, \"pid\": 2, "
+                              "\"tid\": 0}") != std::string::npos);
+    TEST_ASSERT_TRUE(doc.find("\"in\\\"ner\"") != std::string::npos);
+    TEST_ASSERT_TRUE(doc.find("]}") != std::string::npos);
+    in.close();
+    std::remove(path.c_str());
+}
+
+// Buckets keep 1/2^bits relative precision: percentiles land within one
+// bucket of the exact value, and the maximum is exact.
+static void test_histogram_percentiles(void)
+{
+    perf::Histogram empty;
+    TEST_ASSERT_TRUE(empty.count() == 0 && empty.percentile(99.0) == 0.0);
+
+    perf::Histogram h(7, 1e-9);
+    for (int i = 1; i <= 1000; ++i)
+    {
+        h.add(i * 1e-6);  // 1 us .. 1 ms
+    }
+    h.add(-1.0);  // counted as 0
+    TEST_ASSERT_TRUE(h.count() == 1001);
+    TEST_ASSERT_TRUE(h.min() == 0.0 && h.max() == 1e-3);
+    const double p50 = h.percentile(50.0);
+    const double p99 = h.percentile(99.0);
+    TEST_ASSERT_TRUE(p50 >= 500e-6 && p50 <= 500e-6 * (1.0 + 1.0 / 128.0));
+    TEST_ASSERT_TRUE(p99 >= 990e-6 && p99 <= 990e-6 * (1.0 + 1.0 / 128.0));
+    TEST_ASSERT_TRUE(h.percentile(100.0) == 1e-3);
+    TEST_ASSERT_TRUE(h.percentile(0.0) <= 1e-9);  // bucket 0 holds [0, unit)
+
+    // Buckets tile the range: ascending, each at most 1/128 of its lower edge wide
+    const std::vector<perf::Histogram::Bucket> b = h.buckets();
+    unsigned long total = 0;
+    for (std::size_t i = 0; i < b.size(); ++i)
+    {
+        total += b[i].count;
+        TEST_ASSERT_TRUE(i == 0 || b[i].lower >= b[i - 1].upper);
+        TEST_ASSERT_TRUE(i == 0 || b[i].upper - b[i].lower <= b[i].lower / 128.0 * 1.000001);
+    }
+    TEST_ASSERT_TRUE(total == 1001 && b[0].lower == 0.0);
+
+    // Rank ceil(p / 100 * n) exactly: with n / 1000 slow values, p99.9 of
+    // 1000 or 10000 values is the last fast one (rank 999 / 9990), not slow
+    const int sizes[2] = {1000, 10000};
+    for (int s = 0; s < 2; ++s)
+    {
+        perf::Histogram exact(7, 1e-9);
+        for (int i = 0; i < sizes[s]; ++i)
+        {
+            exact.add(i < sizes[s] - sizes[s] / 1000 ? 1e-6 : 1e-3);
+        }
+        TEST_ASSERT_TRUE(exact.count() == static_cast<unsigned long>(sizes[s]));
+        TEST_ASSERT_TRUE(exact.percentile(99.9) <= 1e-6 * (1.0 + 1.0 / 128.0));
+        TEST_ASSERT_TRUE(exact.percentile(99.95) == 1e-3);
+    }
+
+    perf::Histogram one;
+    one.add(2.5e-6);
+    TEST_ASSERT_TRUE(perf::format_percentiles_us(one) ==
+                     "p50_us=2.50 p90_us=2.50 p99_us=2.50 p99.9_us=2.50 max_us=2.50");
+}
+
+// The vector is reproducible from its seed, in (0, 1], and seed 0 does not
+// get stuck at zero; the tolerance grows with N.
+static void test_freivalds_vector(void)
+{
+    std::vector<double> r, again, zero;
+    perf::freivalds_vector(7u, 1000, r);
+    perf::freivalds_vector(7u, 1000, again);
+    perf::freivalds_vector(0u, 10, zero);
+    TEST_ASSERT_TRUE(r.size() == 1000 && r == again);
+    double sum = 0.0;
+    for (std::size_t j = 0; j < r.size(); ++j)
+    {
+        TEST_ASSERT_TRUE(r[j] > 0.0 && r[j] <= 1.0);
+        sum += r[j];
+    }
+    TEST_ASSERT_DOUBLE_WITHIN(0.05, 0.5, sum / 1000.0);
+    TEST_ASSERT_TRUE(zero[9] > 0.0);
+    TEST_ASSERT_TRUE(perf::freivalds_tolerance(0) == perf::freivalds_tolerance(1));
+    TEST_ASSERT_DOUBLE_WITHIN(1e-25, 64.0 * 100 * 2.220446049250313e-16,
+                              perf::freivalds_tolerance(100));
+}
+
+// The budget is positive, and within what the host reports when it reports
+// anything (1 GiB otherwise).
+static void test_memory_budget(void)
+{
+    const std::size_t avail = perf::available_memory_bytes();
+    const std::size_t budget = perf::memory_budget_bytes();
+    TEST_ASSERT_TRUE(budget > 0);
+    TEST_ASSERT_TRUE(avail == 0 ? budget == (static_cast<std::size_t>(1) << 30)
+                                : budget <= avail);
+}
+
+int main(void)
+{
+    UnityBegin("perf");
+
+    RUN_TEST(test_roofline_point);
+    RUN_TEST(test_roofline_cache_roundtrip);
+    RUN_TEST(test_measurements_positive);
+    RUN_TEST(test_counter_sum_and_format);
+    RUN_TEST(test_counters_open_or_explain);
+    RUN_TEST(test_summarize_outliers);
+    RUN_TEST(test_sampler_runs);
+    RUN_TEST(test_parse_bench_option);
+    RUN_TEST(test_report_files);
+    RUN_TEST(test_json_string);
+    RUN_TEST(test_compare_to_baseline);
+    RUN_TEST(test_baseline_roundtrip);
+    RUN_TEST(test_log_file);
+    RUN_TEST(test_log_threads);
+    RUN_TEST(test_trace_events);
+    RUN_TEST(test_histogram_percentiles);
+    RUN_TEST(test_freivalds_vector);
+    RUN_TEST(test_memory_budget);
+
+    return UnityEnd();
+}
@@ -1,12 +1,13 @@
 /*
-  assignment2.cpp — Standalone matrix multiply (C++98), no external deps.
+  assignment2.cpp — Standalone matrix multiply (C++98). The memory budget
+  probe is shared with the assignments (assignments/perf/src/sysmem.cpp).
 
   Build:
     # GCC / Clang
-    g++ -std=c++98 -O2 -Wall -Wextra -o assignment2 assignment2.cpp
+    g++ -std=c++98 -O2 -Wall -Wextra -I../assignments/perf/include -o assignment2 assignment2.cpp ../assignments/perf/src/sysmem.cpp
 
     # MSVC (x64 Native Tools)
-    cl /EHsc /W4 assignment2.cpp /Fe:assignment2.exe
+    cl /EHsc /W4 /I..\assignments\perf\include assignment2.cpp ..\assignments\perf\src\sysmem.cpp /Fe:assignment2.exe
 
   Run (example):
     ./assignment2 512
@@ -32,6 +33,8 @@
 #include <climits>
 #include <new>
 
+#include "perf/sysmem.h"
+
 /* ----- Logging ----- */
 
 static void log_info(const std::string& m)  { std::cout << "[INFO] "  << m << std::endl; }
@@ -162,16 +165,17 @@ int main(int argc, char** argv) {
     return 1;
   }
 
-  /* Memory guard: estimate 3*N*N*sizeof(double) and reject if > ~1 GiB. */
+  /* Memory guard: estimate 3*N*N*sizeof(double) and reject if it exceeds the RAM budget. */
   const unsigned long long bytes =
       3ULL *
       static_cast<unsigned long long>(N) *
       static_cast<unsigned long long>(N) *
       static_cast<unsigned long long>(sizeof(double));
-  const unsigned long long ONE_GIB = 1ULL << 30;
-  if (bytes > ONE_GIB) {
+  const unsigned long long budget = static_cast<unsigned long long>(perf::memory_budget_bytes());
+  if (bytes > budget) {
     std::ostringstream oss;
-    oss << "allocation would exceed ~1 GiB (estimate=" << bytes << " bytes). Choose smaller N.";
+    oss << "allocation would exceed memory budget (estimate=" << bytes
+        << " bytes, budget=" << budget << " bytes). Choose smaller N.";
     log_error(oss.str());
     return 1;
   }
@@ -1,18 +1,19 @@
 // assignment3_task2.cpp
 //
 // Build with OpenMP (Linux/macOS, GCC/Clang):
-//   g++ -std=c++98 -O2 -fopenmp -Wall -Wextra -o assignment3_task2 assignment3_task2.cpp
+//   g++ -std=c++98 -O2 -fopenmp -Wall -Wextra -I../assignments/perf/include -o assignment3_task2 assignment3_task2.cpp ../assignments/perf/src/sysmem.cpp
 //
 // Build without OpenMP:
-//   g++ -std=c++98 -O2 -Wall -Wextra -Wpedantic -o assignment3_task2 assignment3_task2.cpp
+//   g++ -std=c++98 -O2 -Wall -Wextra -Wpedantic -I../assignments/perf/include -o assignment3_task2 assignment3_task2.cpp ../assignments/perf/src/sysmem.cpp
 //
 // Build with MSVC (OpenMP):
-//   cl /EHsc /W4 /openmp assignment3_task2.cpp /Fe:assignment3_task2.exe
+//   cl /EHsc /W4 /openmp /I..\assignments\perf\include assignment3_task2.cpp ..\assignments\perf\src\sysmem.cpp /Fe:assignment3_task2.exe
 //
 // Run:
 //   ./assignment3_task2 512
 //
-// Single-translation-unit version of assignment3-task2.
+// Single-translation-unit version of assignment3-task2 (the memory budget
+// probe is shared with the assignments: assignments/perf/src/sysmem.cpp).
 // Computes C = A · B for N×N matrices with:
 //   A[i][j] = i + 1
 //   B[i][j] = 1.0 / (j + 1)
@@ -29,6 +30,7 @@
 #include <cstdio>
 #include <cerrno>
 #include <climits>
+#include <cstddef>
 #include <ctime>
 #include <new>
 
@@ -36,6 +38,8 @@
 #include <omp.h>
 #endif
 
+#include "perf/sysmem.h"
+
 // Forward declarations
 bool parse_n(int argc, char** argv, int& n);
 bool is_n_reasonable(int n);
@@ -131,20 +135,18 @@ bool is_n_reasonable(int n)
         static_cast<double>(n) *
         static_cast<double>(sizeof(double));
 
-    const double limit = 1024.0 * 1024.0 * 1024.0; // ~1 GiB
+    const double limit = static_cast<double>(perf::memory_budget_bytes());
 
     if (bytes > limit)
     {
-        log_error("N too large: estimated memory usage exceeds ~1 GiB");
+        std::ostringstream oss;
+        oss << "N too large: estimated memory usage " << bytes
+            << " bytes exceeds budget of " << limit << " bytes";
+        log_error(oss.str());
         return false;
     }
 
-    // Also guard against N*N overflow in 32-bit int indexing assumptions.
-    if (n > 46340) // since 46340^2 < 2^31-1
-    {
-        log_error("N too large: may overflow 32-bit index computations");
-        return false;
-    }
+    // Indices are computed in size_t, so N*N may exceed INT_MAX.
 
     return true;
 }
@@ -152,7 +154,7 @@ bool is_n_reasonable(int n)
 // Initialize A and B with the specified formulas.
 void init_matrices(std::vector<double>& A, std::vector<double>& B, int N)
 {
-    const int size = N * N;
+    const std::size_t size = static_cast<std::size_t>(N) * static_cast<std::size_t>(N);
     A.resize(size);
     B.resize(size);
 
@@ -160,7 +162,7 @@ void init_matrices(std::vector<double>& A, std::vector<double>& B, int N)
     for (int i = 0; i < N; ++i)
     {
         const double value = static_cast<double>(i + 1);
-        const int row = i * N;
+        const std::size_t row = static_cast<std::size_t>(i) * static_cast<std::size_t>(N);
         for (int j = 0; j < N; ++j)
         {
             A[row + j] = value;
@@ -173,7 +175,7 @@ void init_matrices(std::vector<double>& A, std::vector<double>& B, int N)
         const double value = 1.0 / static_cast<double>(j + 1);
         for (int i = 0; i < N; ++i)
         {
-            B[i * N + j] = value;
+            B[static_cast<std::size_t>(i) * N + j] = value;
         }
     }
 }
@@ -184,18 +186,18 @@ void multiply_serial(const std::vector<double>& A,
                      std::vector<double>& C,
                      int N)
 {
-    const int size = N * N;
+    const std::size_t size = static_cast<std::size_t>(N) * static_cast<std::size_t>(N);
     C.assign(size, 0.0);
 
     for (int i = 0; i < N; ++i)
     {
-        const int row = i * N;
+        const std::size_t row = static_cast<std::size_t>(i) * static_cast<std::size_t>(N);
         for (int j = 0; j < N; ++j)
         {
             double sum = 0.0;
             for (int k = 0; k < N; ++k)
             {
-                sum += A[row + k] * B[k * N + j];
+                sum += A[row + k] * B[static_cast<std::size_t>(k) * N + j];
             }
             C[row + j] = sum;
         }
@@ -208,7 +210,7 @@ void multiply_parallel(const std::vector<double>& A,
                        std::vector<double>& C,
                        int N)
 {
-    const int size = N * N;
+    const std::size_t size = static_cast<std::size_t>(N) * static_cast<std::size_t>(N);
     C.assign(size, 0.0);
 
 #if defined(_OPENMP)
@@ -216,13 +218,13 @@ void multiply_parallel(const std::vector<double>& A,
     #pragma omp parallel for schedule(static)
     for (int i = 0; i < N; ++i)
     {
-        const int row = i * N;
+        const std::size_t row = static_cast<std::size_t>(i) * static_cast<std::size_t>(N);
         for (int j = 0; j < N; ++j)
         {
             double sum = 0.0;
             for (int k = 0; k < N; ++k)
             {
-                sum += A[row + k] * B[k * N + j];
+                sum += A[row + k] * B[static_cast<std::size_t>(k) * N + j];
             }
             C[row + j] = sum;
         }
@@ -322,7 +324,7 @@ int main(int argc, char** argv)
     try
     {
         init_matrices(A, B, N);
-        C.resize(N * N);
+        C.resize(static_cast<std::size_t>(N) * static_cast<std::size_t>(N));
     }
     catch (const std::bad_alloc&)
     {
@@ -349,10 +351,11 @@ int main(int argc, char** argv)
     if (N > 0)
     {
         const int last = N - 1;
-        const double c00 = C[0 * N + 0];
-        const double c0L = C[0 * N + last];
-        const double cL0 = C[last * N + 0];
-        const double cLL = C[last * N + last];
+        const std::size_t lastRow = static_cast<std::size_t>(last) * static_cast<std::size_t>(N);
+        const double c00 = C[0];
+        const double c0L = C[last];
+        const double cL0 = C[lastRow];
+        const double cLL = C[lastRow + last];
 
         std::ostringstream oss;
         oss.setf(std::ios::fixed);
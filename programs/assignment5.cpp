@@ -1,10 +1,10 @@
 // assignment5.cpp — MPI row-block matrix multiply (C++98, MPI-1 compatible)
 //
 // Build (Linux/macOS, Open MPI):
-//   mpic++ -std=c++98 -O2 -Wall -Wextra -Wpedantic -o assignment5 assignment5.cpp
+//   mpic++ -std=c++98 -O2 -Wall -Wextra -Wpedantic -I../assignments/perf/include -o assignment5 assignment5.cpp ../assignments/perf/src/sysmem.cpp
 //
 // Build (Windows/Cygwin, Open MPI):
-//   mpic++ -std=c++98 -O2 -Wall -Wextra -Wpedantic -o assignment5 assignment5.cpp
+//   mpic++ -std=c++98 -O2 -Wall -Wextra -Wpedantic -I../assignments/perf/include -o assignment5 assignment5.cpp ../assignments/perf/src/sysmem.cpp
 //
 // Run (2 ranks example):
 //   mpirun -np 2 ./assignment5 1024 --iters 3
@@ -21,9 +21,13 @@
 #include <sstream>
 #include <cstdlib>
 #include <cstdio>
+#include <cstring>
+#include <cstddef>
 #include <stdexcept>
 #include <limits>
 
+#include "perf/sysmem.h"
+
 static const int TAG_C00    = 100;
 static const int TAG_C0N1   = 101;
 static const int TAG_CN10   = 102;
@@ -38,6 +42,28 @@ static void log_error_any(int rank, const std::string& msg) {
     std::cerr << msg << std::endl;
 }
 
+// Number of ranks running on this rank's host (collective; MPI-1 only:
+// compares processor names gathered from all ranks).
+static int ranks_on_host() {
+    int P = 1;
+    MPI_Comm_size(MPI_COMM_WORLD, &P);
+    char name[MPI_MAX_PROCESSOR_NAME];
+    std::memset(name, 0, sizeof(name));
+    int len = 0;
+    MPI_Get_processor_name(name, &len);
+    std::vector<char> all(static_cast<std::size_t>(P) * MPI_MAX_PROCESSOR_NAME);
+    MPI_Allgather(name, MPI_MAX_PROCESSOR_NAME, MPI_CHAR,
+                  &all[0], MPI_MAX_PROCESSOR_NAME, MPI_CHAR, MPI_COMM_WORLD);
+    int same = 0;
+    for (int p = 0; p < P; ++p) {
+        if (std::strncmp(name, &all[static_cast<std::size_t>(p) * MPI_MAX_PROCESSOR_NAME],
+                         MPI_MAX_PROCESSOR_NAME) == 0) {
+            ++same;
+        }
+    }
+    return same > 0 ? same : 1;
+}
+
 // ---------- CLI parsing ----------
 static void print_usage() {
     std::cerr << "Usage: assignment5 <N> [--iters K]" << std::endl;
@@ -108,10 +134,12 @@ static bool parse_args(int argc, char** argv, int& N, int& iters, int rank) {
     }
     const std::size_t elemsB = sN * sN;
     const std::size_t bytesB = elemsB * sizeof(double);
-    const std::size_t THRESHOLD = (static_cast<std::size_t>(1) << 30); // ~1 GiB
-    if (bytesB > THRESHOLD) {
+    // Every rank holds its own B, so ranks on one host split its budget
+    const std::size_t budget = perf::memory_budget_bytes() / static_cast<std::size_t>(ranks_on_host());
+    if (bytesB > budget) {
         std::ostringstream oss;
-        oss << "[ERROR] requested B size " << (bytesB / (1024.0*1024.0)) << " MiB exceeds conservative threshold (~1024 MiB).";
+        oss << "[ERROR] requested B size " << (bytesB / (1024.0*1024.0)) << " MiB exceeds per-rank budget ("
+            << (budget / (1024.0*1024.0)) << " MiB).";
         log_error_any(rank, oss.str());
         return false;
     }
@@ -153,16 +181,23 @@ static void fill_B(std::vector<double>& B, int N) {
     // B[i][j] = 1.0 / (j+1)
     // Stored row-major 1D: idx = i*N + j
     for (int i = 0; i < N; ++i) {
-        const int base = i * N;
+        const std::size_t base = static_cast<std::size_t>(i) * static_cast<std::size_t>(N);
         for (int j = 0; j < N; ++j) {
             B[base + j] = 1.0 / static_cast<double>(j + 1);
         }
     }
 }
 
+// MPI counts are int: N*N exceeds INT_MAX from N = 46341, so B is sent in chunks
 static bool bcast_B(std::vector<double>& B, int N) {
-    const int rc = MPI_Bcast((B.empty() ? NULL : &B[0]), N * N, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-    return rc == MPI_SUCCESS;
+    const std::size_t total = static_cast<std::size_t>(N) * static_cast<std::size_t>(N);
+    const std::size_t chunk = static_cast<std::size_t>(1) << 30;
+    for (std::size_t done = 0; done < total; done += chunk) {
+        const std::size_t part = (total - done < chunk) ? total - done : chunk;
+        const int rc = MPI_Bcast(&B[done], static_cast<int>(part), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        if (rc != MPI_SUCCESS) return false;
+    }
+    return true;
 }
 
 // ---------- Local compute over this rank's row block ----------
@@ -176,13 +211,13 @@ static void compute_block(const std::vector<double>& B,
     for (int ii = 0; ii < local_rows; ++ii) {
         const int ig = row0 + ii;              // global row index
         const double a_row_value = static_cast<double>(ig) + 1.0; // since A[i][k] = i+1
-        double* c_row = (local_rows == 0 ? (double*)0 : &Cloc[ii * N]);
+        double* c_row = (local_rows == 0 ? (double*)0 : &Cloc[static_cast<std::size_t>(ii) * N]);
         for (int j = 0; j < N; ++j) {
             // Compute dot( A_row, B_col )
             // A_row[k] = a_row_value (constant over k), so sum = (i+1) * sum_k B[k*N+j].
             double sum = 0.0;
             for (int k = 0; k < N; ++k) {
-                sum += a_row_value * B[k * N + j];
+                sum += a_row_value * B[static_cast<std::size_t>(k) * N + j];
             }
             c_row[j] = sum;
         }
@@ -200,8 +235,8 @@ static void send_boundary_values_to_root(const std::vector<double>& Cloc,
     // (0,0) and (0,N-1)
     if (0 >= row0 && 0 < row1) {
         const int li = 0 - row0;
-        const double c00  = Cloc[li * N + 0];
-        const double c0N1 = Cloc[li * N + (N - 1)];
+        const double c00  = Cloc[static_cast<std::size_t>(li) * N + 0];
+        const double c0N1 = Cloc[static_cast<std::size_t>(li) * N + (N - 1)];
         if (rank != 0) {
             MPI_Send((void*)&c00,  1, MPI_DOUBLE, 0, TAG_C00,  MPI_COMM_WORLD);
             MPI_Send((void*)&c0N1, 1, MPI_DOUBLE, 0, TAG_C0N1, MPI_COMM_WORLD);
@@ -212,8 +247,8 @@ static void send_boundary_values_to_root(const std::vector<double>& Cloc,
     // (N-1,0) and (N-1,N-1)
     if ((N - 1) >= row0 && (N - 1) < row1) {
         const int li = (N - 1) - row0;
-        const double cN10  = Cloc[li * N + 0];
-        const double cN1N1 = Cloc[li * N + (N - 1)];
+        const double cN10  = Cloc[static_cast<std::size_t>(li) * N + 0];
+        const double cN1N1 = Cloc[static_cast<std::size_t>(li) * N + (N - 1)];
         if (rank != 0) {
             MPI_Send((void*)&cN10,  1, MPI_DOUBLE, 0, TAG_CN10,  MPI_COMM_WORLD);
             MPI_Send((void*)&cN1N1, 1, MPI_DOUBLE, 0, TAG_CN1N1, MPI_COMM_WORLD);
@@ -237,8 +272,8 @@ static void collect_and_log_boundaries_root(const std::vector<double>& Cloc,
     // Get (0,0) and (0,N-1)
     if (owner_r0 == 0) {
         const int li = 0 - row0;
-        c00  = Cloc[li * N + 0];
-        c0N1 = Cloc[li * N + (N - 1)];
+        c00  = Cloc[static_cast<std::size_t>(li) * N + 0];
+        c0N1 = Cloc[static_cast<std::size_t>(li) * N + (N - 1)];
     } else {
         MPI_Recv((void*)&c00,  1, MPI_DOUBLE, owner_r0, TAG_C00,  MPI_COMM_WORLD, &st);
         MPI_Recv((void*)&c0N1, 1, MPI_DOUBLE, owner_r0, TAG_C0N1, MPI_COMM_WORLD, &st);
@@ -247,8 +282,8 @@ static void collect_and_log_boundaries_root(const std::vector<double>& Cloc,
     // Get (N-1,0) and (N-1,N-1)
     if (owner_rN1 == 0) {
         const int li = (N - 1) - row0;
-        cN10  = Cloc[li * N + 0];
-        cN1N1 = Cloc[li * N + (N - 1)];
+        cN10  = Cloc[static_cast<std::size_t>(li) * N + 0];
+        cN1N1 = Cloc[static_cast<std::size_t>(li) * N + (N - 1)];
     } else {
         MPI_Recv((void*)&cN10,  1, MPI_DOUBLE, owner_rN1, TAG_CN10,  MPI_COMM_WORLD, &st);
         MPI_Recv((void*)&cN1N1, 1, MPI_DOUBLE, owner_rN1, TAG_CN1N1, MPI_COMM_WORLD, &st);